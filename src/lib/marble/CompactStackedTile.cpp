@@ -0,0 +1,139 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include "CompactStackedTile.h"
+
+#include "StackedTile.h"
+#include "TextureTile.h"
+
+#include <QHash>
+#include <QSharedPointer>
+
+#include <cstring>
+
+namespace Marble
+{
+
+// zlib favoring speed over size, tiles are expanded while rendering
+const int COMPRESSION_LEVEL = 1;
+
+CompactStackedTile::CompactStackedTile( const TileId &id, const QImage &resultImage,
+                                        const QVector<QSharedPointer<TextureTile> > &tiles, TileCacheCompression compression )
+    : m_id( id ),
+      m_byteCount( 0 )
+{
+    Q_ASSERT( compression != NoTileCacheCompression );
+
+    m_images.append( compress( resultImage, compression ) );
+
+    // Texture tiles may share their images, compress each of them once only.
+    // They stay lossless even if they share the result image, updated tiles
+    // are blended again from them.
+    QHash<qint64, int> imageIndex;
+    if ( compression == LosslessTileCacheCompression ) {
+        imageIndex.insert( resultImage.cacheKey(), 0 );
+    }
+    foreach ( const QSharedPointer<TextureTile> &tile, tiles ) {
+        const QImage *const image = tile->image();
+        int index = imageIndex.value( image->cacheKey(), -1 );
+        if ( index < 0 ) {
+            index = m_images.size();
+            imageIndex.insert( image->cacheKey(), index );
+            m_images.append( compress( *image, LosslessTileCacheCompression ) );
+        }
+
+        const TextureTileData data = { tile->id(), tile->blending(), index };
+        m_tiles.append( data );
+    }
+
+    foreach ( const CompressedImage &image, m_images ) {
+        m_byteCount += image.data.size() + image.colorTable.size() * sizeof( QRgb );
+    }
+}
+
+StackedTile *CompactStackedTile::toStackedTile() const
+{
+    QVector<QImage> images;
+    images.reserve( m_images.size() );
+    foreach ( const CompressedImage &image, m_images ) {
+        images.append( uncompress( image ) );
+    }
+
+    QVector<QSharedPointer<TextureTile> > tiles;
+    tiles.reserve( m_tiles.size() );
+    foreach ( const TextureTileData &data, m_tiles ) {
+        tiles.append( QSharedPointer<TextureTile>( new TextureTile( data.id, images.at( data.image ), data.blending ) ) );
+    }
+
+    return new StackedTile( m_id, images.first(), tiles );
+}
+
+int CompactStackedTile::byteCount() const
+{
+    return m_byteCount;
+}
+
+CompactStackedTile::CompressedImage CompactStackedTile::compress( const QImage &image, TileCacheCompression compression )
+{
+    QImage storedImage = image;
+    if ( compression == ReducedColorTileCacheCompression && image.depth() == 32 && isOpaque( image ) ) {
+        storedImage = image.convertToFormat( QImage::Format_RGB16 );
+    }
+
+    CompressedImage result;
+    result.width = image.width();
+    result.height = image.height();
+    result.format = image.format();
+    result.storedFormat = storedImage.format();
+    result.colorTable = storedImage.colorTable();
+    result.data = qCompress( storedImage.constBits(), storedImage.byteCount(), COMPRESSION_LEVEL );
+
+    return result;
+}
+
+QImage CompactStackedTile::uncompress( const CompressedImage &image )
+{
+    if ( image.width == 0 || image.height == 0 ) {
+        return QImage();
+    }
+
+    const QByteArray data = qUncompress( image.data );
+
+    QImage result( image.width, image.height, image.storedFormat );
+    Q_ASSERT( data.size() == result.byteCount() );
+    std::memcpy( result.bits(), data.constData(), qMin( data.size(), result.byteCount() ) );
+    result.setColorTable( image.colorTable );
+
+    if ( image.storedFormat != image.format ) {
+        return result.convertToFormat( image.format );
+    }
+
+    return result;
+}
+
+bool CompactStackedTile::isOpaque( const QImage &image )
+{
+    if ( !image.hasAlphaChannel() ) {
+        return true;
+    }
+
+    for ( int y = 0; y < image.height(); ++y ) {
+        const QRgb *const line = reinterpret_cast<const QRgb *>( image.constScanLine( y ) );
+        for ( int x = 0; x < image.width(); ++x ) {
+            if ( qAlpha( line[x] ) != 255 ) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+}
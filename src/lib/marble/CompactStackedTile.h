@@ -0,0 +1,86 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#ifndef MARBLE_COMPACTSTACKEDTILE_H
+#define MARBLE_COMPACTSTACKEDTILE_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QSharedPointer>
+#include <QVector>
+
+#include "MarbleGlobal.h"
+#include "TileId.h"
+
+namespace Marble
+{
+
+class Blending;
+class StackedTile;
+class TextureTile;
+
+/**
+ * @short A compressed copy of a StackedTile which is not displayed.
+ *
+ * The result image and the images of the texture tiles are compressed, so
+ * many more tiles fit into the volatile tile cache. toStackedTile() expands
+ * them again once the tile is needed.
+ *
+ * ReducedColorTileCacheCompression only reduces the result image. The
+ * texture tiles are always kept lossless, because updated tiles are blended
+ * again from them.
+ */
+class CompactStackedTile
+{
+ public:
+    CompactStackedTile( const TileId &id, const QImage &resultImage,
+                        const QVector<QSharedPointer<TextureTile> > &tiles, TileCacheCompression compression );
+
+    /**
+     * Returns a new stacked tile with the images expanded again. The caller
+     * takes ownership. Thread-safe.
+     */
+    StackedTile *toStackedTile() const;
+
+    int byteCount() const;
+
+ private:
+    Q_DISABLE_COPY( CompactStackedTile )
+
+    struct CompressedImage
+    {
+        int width;
+        int height;
+        QImage::Format format;
+        QImage::Format storedFormat;
+        QVector<QRgb> colorTable;
+        QByteArray data;
+    };
+
+    struct TextureTileData
+    {
+        TileId id;
+        const Blending *blending;
+        int image;
+    };
+
+    static CompressedImage compress( const QImage &image, TileCacheCompression compression );
+    static QImage uncompress( const CompressedImage &image );
+    static bool isOpaque( const QImage &image );
+
+    const TileId m_id;
+    QVector<CompressedImage> m_images;
+    QVector<TextureTileData> m_tiles;
+    int m_byteCount;
+};
+
+}
+
+#endif
@@ -16,9 +16,6 @@
 // posix
 #include <cmath>
 
-// Qt
-#include <QRunnable>
-
 // Marble
 #include "GeoPainter.h"
 #include "MarbleDebug.h"
@@ -29,32 +26,63 @@
 
 using namespace Marble;
 
-class EquirectScanlineTextureMapper::RenderJob : public QRunnable
+class EquirectScanlineTextureMapper::RenderJob : public ScanlineRenderScheduler::Job
 {
 public:
-    RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewportParams, MapQuality mapQuality, int yTop, int yBottom );
+    RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewportParams, MapQuality mapQuality,
+               qreal centerLon, const QRect &validRect,
+               ScanlineTextureMapperContext::Statistics *statistics );
 
-    virtual void run();
+    virtual void renderRows( int yPaintedTop, int yPaintedBottom );
 
 private:
-    StackedTileLoader *const m_tileLoader;
-    const int m_tileLevel;
+    void renderSpan( int y, qreal lat, int xBegin, int xEnd );
+
     QImage *const m_canvasImage;
-    const ViewportParams *const m_viewport;
-    const MapQuality m_mapQuality;
-    const int m_yPaintedTop;
-    const int m_yPaintedBottom;
+    const int m_imageWidth;
+    const QRect m_validRect;
+    ScanlineTextureMapperContext m_context;
+
+    const bool m_interlaced;
+    const bool m_highQuality;
+    const bool m_printQuality;
+
+    // the degree of interpolation
+    const int m_n;
+
+    // how many degrees are being represented per pixel.
+    float m_pixel2Rad;  // FIXME chainging to qreal may crash Marble when the equator is visible
+    qreal m_leftLon;
+    int m_yTop;
 };
 
-EquirectScanlineTextureMapper::RenderJob::RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, int yTop, int yBottom )
-    : m_tileLoader( tileLoader ),
-      m_tileLevel( tileLevel ),
-      m_canvasImage( canvasImage ),
-      m_viewport( viewport ),
-      m_mapQuality( mapQuality ),
-      m_yPaintedTop( yTop ),
-      m_yPaintedBottom( yBottom )
+EquirectScanlineTextureMapper::RenderJob::RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality,
+                                                     qreal centerLon, const QRect &validRect,
+                                                     ScanlineTextureMapperContext::Statistics *statistics )
+    : m_canvasImage( canvasImage ),
+      m_imageWidth( canvasImage->width() ),
+      m_validRect( validRect ),
+      m_context( tileLoader, tileLevel, statistics ),
+      m_interlaced( mapQuality == LowQuality ),
+      m_highQuality( mapQuality == HighQuality || mapQuality == PrintQuality ),
+      m_printQuality( mapQuality == PrintQuality ),
+      m_n( ScanlineTextureMapperContext::interpolationStep( viewport, mapQuality ) )
 {
+    const int imageHeight = m_canvasImage->height();
+    const qint64  radius  = viewport->radius();
+    const qreal rad2Pixel = (qreal)( 2 * radius ) / M_PI;
+    m_pixel2Rad = 1.0/rad2Pixel;
+
+    // Calculate translation of center point
+    const qreal centerLat = viewport->centerLatitude();
+
+    const int yCenterOffset = (int)( centerLat * rad2Pixel );
+
+    m_yTop = imageHeight / 2 - radius + yCenterOffset;
+
+    m_leftLon = + centerLon - ( m_imageWidth / 2 * m_pixel2Rad );
+    while ( m_leftLon < -M_PI ) m_leftLon += 2 * M_PI;
+    while ( m_leftLon >  M_PI ) m_leftLon -= 2 * M_PI;
 }
 
 
@@ -62,7 +90,10 @@ EquirectScanlineTextureMapper::EquirectScanlineTextureMapper( StackedTileLoader
     : TextureMapperInterface(),
       m_tileLoader( tileLoader ),
       m_radius( 0 ),
-      m_oldYPaintedTop( 0 )
+      m_canvasTileLevel( -1 ),
+      m_canvasMapQuality( NormalQuality ),
+      m_canvasCenterLon( 0.0 ),
+      m_canvasYCenterOffset( 0 )
 {
 }
 
@@ -87,23 +118,88 @@ void EquirectScanlineTextureMapper::mapTexture( GeoPainter *painter,
         m_repaintNeeded = true;
     }
 
-    if ( m_repaintNeeded ) {
-        mapTexture( viewport, tileZoomLevel, painter->mapQuality() );
+    const MapQuality mapQuality = painter->mapQuality();
+    if ( tileZoomLevel != m_canvasTileLevel || mapQuality != m_canvasMapQuality ) {
+        m_repaintNeeded = true;
+    }
+
+    const qreal rad2Pixel = (qreal)( 2 * viewport->radius() ) / M_PI;
+    const qreal centerLon = viewport->centerLongitude();
+    const int yCenterOffset = (int)( viewport->centerLatitude() * rad2Pixel );
+
+    bool mapped = false;
 
-        if ( texColorizer ) {
-            texColorizer->colorize( &m_canvasImage, viewport, painter->mapQuality() );
+    if ( !m_repaintNeeded && ( centerLon != m_canvasCenterLon || yCenterOffset != m_canvasYCenterOffset ) ) {
+        // The map just got moved: Scroll the canvas by whole pixels and map
+        // the exposed parts only. The remaining subpixel offset gets
+        // compensated by mapping these parts for the scrolled center.
+        qreal deltaLon = m_canvasCenterLon - centerLon;
+        if ( deltaLon < -M_PI ) deltaLon += 2 * M_PI;
+        if ( deltaLon >= M_PI ) deltaLon -= 2 * M_PI;
+
+        const int dx = qRound( deltaLon * rad2Pixel );
+        const int dy = yCenterOffset - m_canvasYCenterOffset;
+        const QRect canvasRect = m_canvasImage.rect();
+
+        if ( qAbs( dx ) < canvasRect.width() && qAbs( dy ) < canvasRect.height() ) {
+            ScanlineTextureMapperContext::scrollCanvas( &m_canvasImage, dx, dy );
+
+            qreal scrolledCenterLon = m_canvasCenterLon - dx / rad2Pixel;
+            if ( scrolledCenterLon < -M_PI ) scrolledCenterLon += 2 * M_PI;
+            if ( scrolledCenterLon >= M_PI ) scrolledCenterLon -= 2 * M_PI;
+
+            mapTexture( viewport, tileZoomLevel, mapQuality, scrolledCenterLon,
+                        canvasRect.translated( dx, dy ).intersected( canvasRect ) );
+            m_canvasCenterLon = scrolledCenterLon;
+            m_canvasYCenterOffset = yCenterOffset;
+            mapped = true;
+        }
+        else {
+            m_repaintNeeded = true;
         }
+    }
+
+    if ( m_repaintNeeded ) {
+        mapTexture( viewport, tileZoomLevel, mapQuality, centerLon, QRect() );
+        m_canvasCenterLon = centerLon;
+        m_canvasYCenterOffset = yCenterOffset;
+        m_canvasTileLevel = tileZoomLevel;
+        m_canvasMapQuality = mapQuality;
+        mapped = true;
 
         m_repaintNeeded = false;
     }
 
-    painter->drawImage( dirtyRect, m_canvasImage, dirtyRect );
+    if ( texColorizer ) {
+        // colorize a copy, so the canvas can still be scrolled later on
+        if ( mapped || m_colorizedImage.size() != m_canvasImage.size() ) {
+            m_colorizedImage = m_canvasImage.copy();
+            texColorizer->colorize( &m_colorizedImage, viewport, mapQuality );
+        }
+
+        painter->drawImage( dirtyRect, m_colorizedImage, dirtyRect );
+    }
+    else {
+        painter->drawImage( dirtyRect, m_canvasImage, dirtyRect );
+    }
+}
+
+void EquirectScanlineTextureMapper::setCenterChanged()
+{
+    // mapTexture() scrolls the canvas on its own
 }
 
-void EquirectScanlineTextureMapper::mapTexture( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality )
+QString EquirectScanlineTextureMapper::runtimeTrace() const
+{
+    return m_scheduler.runtimeTrace() + m_statistics.runtimeTrace();
+}
+
+void EquirectScanlineTextureMapper::mapTexture( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality,
+                                                qreal centerLon, const QRect &validRect )
 {
     // Reset backend
     m_tileLoader->resetTilehash();
+    m_statistics.reset();
 
     // Initialize needed constants:
 
@@ -119,7 +215,6 @@ void EquirectScanlineTextureMapper::mapTexture( const ViewportParams *viewport,
 
     // Calculate y-range the represented by the center point, yTop and
     // what actually can be painted
-    const int yTop     = imageHeight / 2 - radius + yCenterOffset;;
     int yPaintedTop    = imageHeight / 2 - radius + yCenterOffset;
     int yPaintedBottom = imageHeight / 2 + radius + yCenterOffset;
  
@@ -128,126 +223,106 @@ void EquirectScanlineTextureMapper::mapTexture( const ViewportParams *viewport,
     if (yPaintedBottom < 0)             yPaintedBottom = 0;
     if (yPaintedBottom > imageHeight) yPaintedBottom = imageHeight;
 
-    const int numThreads = m_threadPool.maxThreadCount();
-    const int yStep = ( yPaintedBottom - yPaintedTop ) / numThreads;
-    for ( int i = 0; i < numThreads; ++i ) {
-        const int yStart = yPaintedTop +  i      * yStep;
-        const int yEnd   = yPaintedTop + (i + 1) * yStep;
-        QRunnable *const job = new RenderJob( m_tileLoader, tileZoomLevel, &m_canvasImage, viewport, mapQuality, yStart, yEnd );
-        m_threadPool.start( job );
+    QVector<ScanlineRenderScheduler::Job *> jobs;
+    for ( int i = 0; i < m_scheduler.threadCount(); ++i ) {
+        jobs << new RenderJob( m_tileLoader, tileZoomLevel, &m_canvasImage, viewport, mapQuality, centerLon, validRect, &m_statistics );
     }
 
-    // Remove unused lines
-    const int clearStart = ( yPaintedTop - m_oldYPaintedTop <= 0 ) ? yPaintedBottom : 0;
-    const int clearStop  = ( yPaintedTop - m_oldYPaintedTop <= 0 ) ? imageHeight  : yTop;
+    // keep pairs of interlaced rows together
+    const int rowAlignment = ( mapQuality == LowQuality ) ? 2 : 1;
+    m_scheduler.start( jobs, yPaintedTop, yPaintedBottom, rowAlignment );
 
-    QRgb * const itClearBegin = (QRgb*)( m_canvasImage.scanLine( clearStart ) );
-    QRgb * const itClearEnd = (QRgb*)( m_canvasImage.scanLine( clearStop ) );
-
-    for ( QRgb * it = itClearBegin; it < itClearEnd; ++it ) {
-        *(it) = 0;
-    }
-
-    m_threadPool.waitForDone();
+    // Remove unused lines
+    ScanlineTextureMapperContext::clearRows( &m_canvasImage, 0, yPaintedTop );
+    ScanlineTextureMapperContext::clearRows( &m_canvasImage, yPaintedBottom, imageHeight );
 
-    m_oldYPaintedTop = yPaintedTop;
+    m_scheduler.waitForDone();
 
     m_tileLoader->cleanupTilehash();
 }
 
-void EquirectScanlineTextureMapper::RenderJob::run()
+void EquirectScanlineTextureMapper::RenderJob::renderRows( int yPaintedTop, int yPaintedBottom )
 {
     // Scanline based algorithm to do texture mapping
 
-    const int imageHeight = m_canvasImage->height();
-    const int imageWidth  = m_canvasImage->width();
-    const qint64  radius  = m_viewport->radius();
-    // Calculate how many degrees are being represented per pixel.
-    const qreal rad2Pixel = (qreal)( 2 * radius ) / M_PI;
-    const float pixel2Rad = 1.0/rad2Pixel;  // FIXME chainging to qreal may crash Marble when the equator is visible
-
-    const bool interlaced   = ( m_mapQuality == LowQuality );
-    const bool highQuality  = ( m_mapQuality == HighQuality
-                             || m_mapQuality == PrintQuality );
-    const bool printQuality = ( m_mapQuality == PrintQuality );
+    for ( int y = yPaintedTop; y < yPaintedBottom; ++y ) {
 
-    // Evaluate the degree of interpolation
-    const int n = ScanlineTextureMapperContext::interpolationStep( m_viewport, m_mapQuality );
-
-    // Calculate translation of center point
-    const qreal centerLon = m_viewport->centerLongitude();
-    const qreal centerLat = m_viewport->centerLatitude();
+        const qreal lat = M_PI/2 - (y - m_yTop )* m_pixel2Rad;
 
-    const int yCenterOffset = (int)( centerLat * rad2Pixel );
-
-    const int yTop = imageHeight / 2 - radius + yCenterOffset;
-
-    qreal leftLon = + centerLon - ( imageWidth / 2 * pixel2Rad );
-    while ( leftLon < -M_PI ) leftLon += 2 * M_PI;
-    while ( leftLon >  M_PI ) leftLon -= 2 * M_PI;
-
-    const int maxInterpolationPointX = n * (int)( imageWidth / n - 1 ) + 1;
-
-
-    // initialize needed variables that are modified during texture mapping:
+        // Only the parts of the scanline that were not scrolled into
+        // the canvas need to be mapped
+        if ( y >= m_validRect.top() && y <= m_validRect.bottom() ) {
+            renderSpan( y, lat, 0, m_validRect.left() );
+            renderSpan( y, lat, m_validRect.right() + 1, m_imageWidth );
+        }
+        else {
+            renderSpan( y, lat, 0, m_imageWidth );
+        }
 
-    ScanlineTextureMapperContext context( m_tileLoader, m_tileLevel );
+        // copy scanline to improve performance
+        if ( m_interlaced && y + 1 < yPaintedBottom ) { 
 
+            const int pixelByteSize = m_canvasImage->bytesPerLine() / m_imageWidth;
 
-    // Scanline based algorithm to do texture mapping
+            memcpy( m_canvasImage->scanLine( y + 1 ),
+                    m_canvasImage->scanLine( y     ),
+                    m_imageWidth * pixelByteSize );
+            ++y;
+        }
+    }
+}
 
-    for ( int y = m_yPaintedTop; y < m_yPaintedBottom; ++y ) {
+void EquirectScanlineTextureMapper::RenderJob::renderSpan( int y, qreal lat, int xBegin, int xEnd )
+{
+    if ( xBegin >= xEnd ) {
+        return;
+    }
 
-        QRgb * scanLine = (QRgb*)( m_canvasImage->scanLine( y ) );
+    const int n = m_n;
 
-        qreal lon = leftLon;
-        const qreal lat = M_PI/2 - (y - yTop )* pixel2Rad;
+    // Interpolate across whole scanlines like before, but keep partial
+    // spans from writing beyond their end
+    const int maxInterpolationPointX = ( xBegin == 0 && xEnd == m_imageWidth ) ? n * (int)( m_imageWidth / n - 1 ) + 1
+                                                                              : xEnd - n;
 
-        for ( int x = 0; x < imageWidth; ++x ) {
+    QRgb * scanLine = (QRgb*)( m_canvasImage->scanLine( y ) ) + xBegin;
 
-            // Prepare for interpolation
-            bool interpolate = false;
-            if ( x > 0 && x <= maxInterpolationPointX ) {
-                x += n - 1;
-                lon += (n - 1) * pixel2Rad;
-                interpolate = !printQuality;
-            }
-            else {
-                interpolate = false;
-            }
+    qreal lon = m_leftLon + xBegin * m_pixel2Rad;
+    while ( lon > M_PI ) lon -= 2 * M_PI;
 
-            if ( lon < -M_PI ) lon += 2 * M_PI;
-            if ( lon >  M_PI ) lon -= 2 * M_PI;
+    for ( int x = xBegin; x < xEnd; ++x ) {
 
-            if ( interpolate ) {
-                if (highQuality)
-                    context.pixelValueApproxF( lon, lat, scanLine, n );
-                else
-                    context.pixelValueApprox( lon, lat, scanLine, n );
+        // Prepare for interpolation
+        bool interpolate = false;
+        if ( x > xBegin && x <= maxInterpolationPointX ) {
+            x += n - 1;
+            lon += (n - 1) * m_pixel2Rad;
+            interpolate = !m_printQuality;
+        }
+        else {
+            interpolate = false;
+        }
 
-                scanLine += ( n - 1 );
-            }
+        if ( lon < -M_PI ) lon += 2 * M_PI;
+        if ( lon >  M_PI ) lon -= 2 * M_PI;
 
-            if ( x < imageWidth ) {
-                if ( highQuality )
-                    context.pixelValueF( lon, lat, scanLine );
-                else
-                    context.pixelValue( lon, lat, scanLine );
-            }
+        if ( interpolate ) {
+            if (m_highQuality)
+                m_context.pixelValueApproxF( lon, lat, scanLine, n );
+            else
+                m_context.pixelValueApprox( lon, lat, scanLine, n );
 
-            ++scanLine;
-            lon += pixel2Rad;
+            scanLine += ( n - 1 );
         }
 
-        // copy scanline to improve performance
-        if ( interlaced && y + 1 < m_yPaintedBottom ) { 
-
-            const int pixelByteSize = m_canvasImage->bytesPerLine() / imageWidth;
-
-            memcpy( m_canvasImage->scanLine( y + 1 ),
-                    m_canvasImage->scanLine( y     ),
-                    imageWidth * pixelByteSize );
-            ++y;
+        if ( x < xEnd ) {
+            if ( m_highQuality )
+                m_context.pixelValueF( lon, lat, scanLine );
+            else
+                m_context.pixelValue( lon, lat, scanLine );
         }
+
+        ++scanLine;
+        lon += m_pixel2Rad;
     }
 }
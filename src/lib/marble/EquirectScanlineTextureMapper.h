@@ -15,10 +15,11 @@
 
 
 #include "TextureMapperInterface.h"
+#include "ScanlineRenderScheduler.h"
+#include "ScanlineTextureMapperContext.h"
 
 #include "MarbleGlobal.h"
 
-#include <QThreadPool>
 #include <QImage>
 
 
@@ -37,8 +38,13 @@ class EquirectScanlineTextureMapper : public TextureMapperInterface
                              const QRect &dirtyRect,
                              TextureColorizer *texColorizer );
 
+    virtual void setCenterChanged();
+
+    virtual QString runtimeTrace() const;
+
  private:
-    void mapTexture( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality );
+    void mapTexture( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality,
+                     qreal centerLon, const QRect &validRect );
 
  private:
     class RenderJob;
@@ -46,8 +52,13 @@ class EquirectScanlineTextureMapper : public TextureMapperInterface
     StackedTileLoader *const m_tileLoader;
     int m_radius;
     QImage m_canvasImage;
-    int    m_oldYPaintedTop;
-    QThreadPool m_threadPool;
+    QImage m_colorizedImage;
+    int    m_canvasTileLevel;
+    MapQuality m_canvasMapQuality;
+    qreal  m_canvasCenterLon;
+    int    m_canvasYCenterOffset;
+    ScanlineRenderScheduler m_scheduler;
+    ScanlineTextureMapperContext::Statistics m_statistics;
 };
 
 }
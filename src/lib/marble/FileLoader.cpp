@@ -50,7 +50,9 @@ public:
           m_documentRole ( role ),
           m_styleMap( new GeoDataStyleMap ),
           m_document( 0 ),
-          m_renderOrder( renderOrder )
+          m_renderOrder( renderOrder ),
+          m_parsing( false ),
+          m_canceled( false )
     {
         if( m_style ) {
             m_styleMap->setId(QStringLiteral("default-map"));
@@ -67,7 +69,9 @@ public:
           m_contents ( contents ),
           m_documentRole ( role ),
           m_styleMap( 0 ),
-          m_document( 0 )
+          m_document( 0 ),
+          m_parsing( false ),
+          m_canceled( false )
     {
     }
 
@@ -81,7 +85,10 @@ public:
     static int spacePopIdx( qint64 population );
     static int areaPopIdx( qreal area );
 
+    void prepareDocument( GeoDataDocument *doc );
     void documentParsed( GeoDataDocument *doc, const QString& error);
+    void documentPartParsed( GeoDataDocument *part );
+    void parsingDone();
 
     FileLoader *q;
     ParsingRunnerManager m_runner;
@@ -95,6 +102,8 @@ public:
     GeoDataDocument *m_document;
     QString m_error;
     int m_renderOrder;
+    bool m_parsing;
+    bool m_canceled;
 };
 
 FileLoader::FileLoader( QObject* parent, const PluginManager *pluginManager, bool recenter, const QString& file,
@@ -170,6 +179,12 @@ void FileLoader::run()
             // use runners: pnt, gpx, osm
             connect( &d->m_runner, SIGNAL(parsingFinished(GeoDataDocument*,QString)),
                     this, SLOT(documentParsed(GeoDataDocument*,QString)) );
+            connect( &d->m_runner, SIGNAL(partialDocumentParsed(GeoDataDocument*)),
+                    this, SLOT(documentPartParsed(GeoDataDocument*)) );
+            connect( &d->m_runner, SIGNAL(parsingFinished()),
+                    this, SLOT(parsingDone()) );
+            d->m_runner.setPartialResultsEnabled( true );
+            d->m_parsing = true;
             d->m_runner.parseFile( defaultSourceName, d->m_documentRole );
         }
         else {
@@ -212,30 +227,85 @@ bool FileLoader::recenter() const
     return d->m_recenter;
 }
 
+void FileLoader::cancel()
+{
+    wait();
+    d->m_canceled = true;
+    d->m_document = 0;
+    d->m_runner.cancel();
+    if ( !d->m_parsing ) {
+        deleteLater();
+    }
+}
+
+void FileLoaderPrivate::prepareDocument( GeoDataDocument *doc )
+{
+    doc->setProperty( m_property );
+    if( m_style ) {
+        doc->addStyleMap( *m_styleMap );
+        doc->addStyle( m_style );
+    }
+
+    if (m_renderOrder != 0) {
+        foreach (GeoDataPlacemark* placemark, doc->placemarkList()) {
+            if (placemark->geometry() && placemark->geometry()->nodeType() == GeoDataTypes::GeoDataPolygonType) {
+                GeoDataPolygon *polygon = static_cast<GeoDataPolygon*>(placemark->geometry());
+                polygon->setRenderOrder(m_renderOrder);
+            }
+        }
+    }
+
+    createFilterProperties( doc );
+}
+
 void FileLoaderPrivate::documentParsed( GeoDataDocument* doc, const QString& error )
 {
+    if ( m_canceled ) {
+        delete doc;
+        return;
+    }
+
     m_error = error;
     if ( doc ) {
-        m_document = doc;
-        doc->setProperty( m_property );
-        if( m_style ) {
-            doc->addStyleMap( *m_styleMap );
-            doc->addStyle( m_style );
+        prepareDocument( doc );
+        if ( m_document ) {
+            // the file was delivered in parts, this is the last one
+            emit q->documentPartLoaded( q, doc );
+        } else {
+            m_document = doc;
+            emit q->newGeoDataDocumentAdded( m_document );
         }
+    }
+    emit q->loaderFinished( q );
+}
 
-        if (m_renderOrder != 0) {
-            foreach (GeoDataPlacemark* placemark, doc->placemarkList()) {
-                if (placemark->geometry() && placemark->geometry()->nodeType() == GeoDataTypes::GeoDataPolygonType) {
-                    GeoDataPolygon *polygon = static_cast<GeoDataPolygon*>(placemark->geometry());
-                    polygon->setRenderOrder(m_renderOrder);
-                }
-            }
-        }
+void FileLoaderPrivate::documentPartParsed( GeoDataDocument *part )
+{
+    if ( m_canceled ) {
+        delete part;
+        return;
+    }
 
-        createFilterProperties( doc );
+    if ( !m_document ) {
+        // all parts go below a common document, which stands for the file
+        m_document = new GeoDataDocument;
+        m_document->setDocumentRole( m_documentRole );
+        m_document->setFileName( part->fileName() );
+        m_document->setProperty( m_property );
         emit q->newGeoDataDocumentAdded( m_document );
     }
-    emit q->loaderFinished( q );
+
+    prepareDocument( part );
+    emit q->documentPartLoaded( q, part );
+}
+
+void FileLoaderPrivate::parsingDone()
+{
+    m_parsing = false;
+    if ( m_canceled ) {
+        // all documents the runners delivered late are deleted
+        q->deleteLater();
+    }
 }
 
 void FileLoaderPrivate::createFilterProperties( GeoDataContainer *container )
@@ -38,12 +38,28 @@ class FileLoader : public QThread
         GeoDataDocument *document();
         QString error() const;
 
+        /**
+         * Stops loading the file. Documents which are still delivered by the
+         * runners are deleted, no further signals are emitted. The loader
+         * deletes itself once the runners are done and must not be used
+         * after this call.
+         */
+        void cancel();
+
     Q_SIGNALS:
         void loaderFinished( FileLoader* );
         void newGeoDataDocumentAdded( GeoDataDocument* );
 
+        /**
+         * A part of a large file was loaded while the rest is still being
+         * parsed. The part belongs below document().
+         */
+        void documentPartLoaded( FileLoader*, GeoDataDocument *part );
+
 private:
         Q_PRIVATE_SLOT ( d, void documentParsed( GeoDataDocument *, QString) )
+        Q_PRIVATE_SLOT ( d, void documentPartParsed( GeoDataDocument * ) )
+        Q_PRIVATE_SLOT ( d, void parsingDone() )
 
         friend class FileLoaderPrivate;
 
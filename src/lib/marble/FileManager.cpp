@@ -53,6 +53,8 @@ public:
     void appendLoader( FileLoader *loader );
     void closeFile( const QString &key );
     void cleanupLoader( FileLoader *loader );
+    void addDocumentPart( FileLoader *loader, GeoDataDocument *part );
+    void addLoadedDocument( FileLoader *loader, GeoDataDocument *doc );
 
     FileManager *const q;
     GeoDataTreeModel *const m_treeModel;
@@ -105,6 +107,8 @@ void FileManagerPrivate::appendLoader( FileLoader *loader )
 {
     QObject::connect( loader, SIGNAL(loaderFinished(FileLoader*)),
              q, SLOT(cleanupLoader(FileLoader*)) );
+    QObject::connect( loader, SIGNAL(documentPartLoaded(FileLoader*,GeoDataDocument*)),
+             q, SLOT(addDocumentPart(FileLoader*,GeoDataDocument*)) );
 
     m_loaderList.append( loader );
     loader->start();
@@ -117,13 +121,21 @@ void FileManager::removeFile( const QString& key )
             disconnect( loader, 0, this, 0 );
             loader->wait();
             d->m_loaderList.removeAll( loader );
-            delete loader->document();
+            if ( d->m_fileItemHash.contains( key ) ) {
+                // parts of the file are shown already
+                d->closeFile( key );
+            } else {
+                delete loader->document();
+            }
+            // stops the runners, the loader deletes what they still deliver
+            loader->cancel();
             return;
         }
     }
 
     if( d->m_fileItemHash.contains( key ) ) {
         d->closeFile( key );
+        return;
     }
 
     mDebug() << "could not identify " << key;
@@ -154,7 +166,9 @@ void FileManager::closeFile( const GeoDataDocument *document )
     QHash < QString, GeoDataDocument* >::iterator const endpoint = d->m_fileItemHash.end();
     for (; itpoint != endpoint; ++itpoint ) {
         if( d->m_fileItemHash.value( itpoint.key() ) == document ) {
-            d->closeFile( itpoint.key() );
+            // the file may still be loading in parts
+            const QString key = itpoint.key();
+            removeFile( key );
             return;
         }
     }
@@ -180,18 +194,18 @@ int FileManager::pendingFiles() const
 
 void FileManagerPrivate::cleanupLoader( FileLoader* loader )
 {
+    if ( !m_loaderList.contains( loader ) ) {
+        // the file was removed while this call was queued
+        return;
+    }
+
     GeoDataDocument *doc = loader->document();
     m_loaderList.removeAll( loader );
     if ( loader->isFinished() ) {
         if ( doc ) {
-            if ( doc->name().isEmpty() && !doc->fileName().isEmpty() )
-            {
-                QFileInfo file( doc->fileName() );
-                doc->setName( file.baseName() );
+            if ( m_fileItemHash.value( loader->path() ) != doc ) {
+                addLoadedDocument( loader, doc );
             }
-            m_treeModel->addDocument( doc );
-            m_fileItemHash.insert( loader->path(), doc );
-            emit q->fileAdded( loader->path() );
             if( loader->recenter() ) {
                 m_latLonBox |= doc->latLonAltBox();
             }
@@ -217,4 +231,26 @@ void FileManagerPrivate::cleanupLoader( FileLoader* loader )
     }
 }
 
+void FileManagerPrivate::addDocumentPart( FileLoader *loader, GeoDataDocument *part )
+{
+    GeoDataDocument *doc = loader->document();
+    if ( m_fileItemHash.value( loader->path() ) != doc ) {
+        // show the file while the remaining parts are being loaded
+        addLoadedDocument( loader, doc );
+    }
+    m_treeModel->addFeature( doc, part );
+}
+
+void FileManagerPrivate::addLoadedDocument( FileLoader *loader, GeoDataDocument *doc )
+{
+    if ( doc->name().isEmpty() && !doc->fileName().isEmpty() )
+    {
+        QFileInfo file( doc->fileName() );
+        doc->setName( file.baseName() );
+    }
+    m_treeModel->addDocument( doc );
+    m_fileItemHash.insert( loader->path(), doc );
+    emit q->fileAdded( loader->path() );
+}
+
 #include "moc_FileManager.cpp"
@@ -84,6 +84,7 @@ class FileManager : public QObject
  private:
 
     Q_PRIVATE_SLOT( d, void cleanupLoader( FileLoader *loader ) )
+    Q_PRIVATE_SLOT( d, void addDocumentPart( FileLoader *loader, GeoDataDocument *part ) )
 
     Q_DISABLE_COPY( FileManager )
 
@@ -21,6 +21,7 @@
 #include "MarbleGlobal.h"
 #include "MarbleDebug.h"
 #include "MarbleDirs.h"
+#include "TilePackArchive.h"
 
 using namespace Marble;
 
@@ -116,6 +117,21 @@ void FileStorageWatcherThread::getCurrentCacheSize()
             m_filesCache.insert(file.lastModified(), file.absoluteFilePath());
         }
     }
+
+    // packed themes keep their tiles in a few pack files in the theme directory
+    QDirIterator planetIt( basePath, QDir::Dirs | QDir::NoDotAndDotDot );
+    while ( planetIt.hasNext() && !m_willQuit ) {
+        planetIt.next();
+        QDirIterator themeIt( planetIt.filePath(), QDir::Dirs | QDir::NoDotAndDotDot );
+        while ( themeIt.hasNext() ) {
+            themeIt.next();
+            TilePackArchive *const archive = TilePackArchive::find( themeIt.filePath() );
+            if ( archive ) {
+                dataSize += archive->size();
+                m_tilePackArchives.append( archive );
+            }
+        }
+    }
     m_currentCacheSize = dataSize;
 }
 
@@ -133,6 +149,10 @@ void FileStorageWatcherThread::ensureCacheSize()
     && !m_willQuit ) {
 
         mDebug() << "Deleting extra cached tiles";
+        if ( !m_deleting ) {
+            shrinkTilePackArchives();
+        }
+
         // The counter for deleted files
         m_filesDeleted = 0;
         // We have not reached our soft limit, yet.
@@ -177,6 +197,17 @@ bool FileStorageWatcherThread::keepDeleting() const
 	     ( m_filesDeleted <= maxFilesDelete ) &&
               !m_willQuit );
 }
+
+void FileStorageWatcherThread::shrinkTilePackArchives()
+{
+    const quint64 cacheSize = m_currentCacheSize;
+    const quint64 excess = m_currentCacheSize - m_cacheSoftLimit;
+    foreach ( TilePackArchive *archive, m_tilePackArchives ) {
+        const qint64 share = qint64( qreal( excess ) * archive->size() / cacheSize );
+        const qint64 removedBytes = archive->removeOldestTiles( share, maxBaseTileLevel + 1 );
+        m_currentCacheSize -= qMin<quint64>( qMax<qint64>( removedBytes, 0 ), m_currentCacheSize );
+    }
+}
 // End of methods of our Thread
 
 
@@ -15,9 +15,12 @@
 #include <QMutex>
 #include <QMultiMap>
 #include <QDateTime>
+#include <QVector>
 
 namespace Marble
 {
+
+class TilePackArchive;
     
 // Lives inside the new Thread
 class FileStorageWatcherThread : public QObject
@@ -77,9 +80,16 @@ class FileStorageWatcherThread : public QObject
 	 * Returns true if it is necessary to delete files.
 	 */
 	bool keepDeleting() const;
+
+	/**
+	 * Removes the oldest tiles of the tile pack archives, each in proportion
+	 * to its share of the cache size.
+	 */
+	void shrinkTilePackArchives();
 	
 	QString m_dataDirectory;
     QMultiMap<QDateTime,QString> m_filesCache;
+    QVector<TilePackArchive *> m_tilePackArchives;
     quint64 m_cacheLimit;
 	quint64 m_cacheSoftLimit;
     quint64 m_currentCacheSize;
@@ -16,7 +16,6 @@
 
 // Qt
 #include <qmath.h>
-#include <QRunnable>
 #include <QImage>
 
 // Marble
@@ -33,31 +32,27 @@
 
 using namespace Marble;
 
-class GenericScanlineTextureMapper::RenderJob : public QRunnable
+class GenericScanlineTextureMapper::RenderJob : public ScanlineRenderScheduler::Job
 {
 public:
-    RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, int yTop, int yBottom );
+    RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality,
+               ScanlineTextureMapperContext::Statistics *statistics );
 
-    virtual void run();
+    virtual void renderRows( int yTop, int yBottom );
 
 private:
-    StackedTileLoader *const m_tileLoader;
-    const int m_tileLevel;
     QImage *const m_canvasImage;
     const ViewportParams *const m_viewport;
     const MapQuality m_mapQuality;
-    const int m_yTop;
-    const int m_yBottom;
+    ScanlineTextureMapperContext m_context;
 };
 
-GenericScanlineTextureMapper::RenderJob::RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, int yTop, int yBottom )
-    : m_tileLoader( tileLoader ),
-      m_tileLevel( tileLevel ),
-      m_canvasImage( canvasImage ),
+GenericScanlineTextureMapper::RenderJob::RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality,
+                                                    ScanlineTextureMapperContext::Statistics *statistics )
+    : m_canvasImage( canvasImage ),
       m_viewport( viewport ),
       m_mapQuality( mapQuality ),
-      m_yTop( yTop ),
-      m_yBottom( yBottom )
+      m_context( tileLoader, tileLevel, statistics )
 {
 }
 
@@ -66,7 +61,7 @@ GenericScanlineTextureMapper::GenericScanlineTextureMapper( StackedTileLoader *t
     : TextureMapperInterface()
     , m_tileLoader( tileLoader )
     , m_radius( 0 )
-    , m_threadPool()
+    , m_scheduler()
 {
 }
 
@@ -109,10 +104,16 @@ void GenericScanlineTextureMapper::mapTexture( GeoPainter *painter,
     painter->drawImage( rect, m_canvasImage, rect );
 }
 
+QString GenericScanlineTextureMapper::runtimeTrace() const
+{
+    return m_scheduler.runtimeTrace() + m_statistics.runtimeTrace();
+}
+
 void GenericScanlineTextureMapper::mapTexture( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality )
 {
     // Reset backend
     m_tileLoader->resetTilehash();
+    m_statistics.reset();
 
     const int imageHeight = viewport->height();
     const qint64  radius      = viewport->radius() * viewport->currentProjection()->clippingRadius();
@@ -125,21 +126,20 @@ void GenericScanlineTextureMapper::mapTexture( const ViewportParams *viewport, i
     const int yBottom = ( yTop == 0 ) ? imageHeight - skip
                                       : yTop + radius + radius - skip;
 
-    const int numThreads = m_threadPool.maxThreadCount();
-    const int yStep = qCeil(qreal( yBottom - yTop ) / qreal(numThreads));
-    for ( int i = 0; i < numThreads; ++i ) {
-        const int yStart = yTop +  i      * yStep;
-        const int yEnd   = qMin(yBottom, yTop + (i + 1) * yStep);
-        QRunnable *const job = new RenderJob( m_tileLoader, tileZoomLevel, &m_canvasImage, viewport, mapQuality, yStart, yEnd );
-        m_threadPool.start( job );
+    QVector<ScanlineRenderScheduler::Job *> jobs;
+    for ( int i = 0; i < m_scheduler.threadCount(); ++i ) {
+        jobs << new RenderJob( m_tileLoader, tileZoomLevel, &m_canvasImage, viewport, mapQuality, &m_statistics );
     }
 
-    m_threadPool.waitForDone();
+    // keep pairs of interlaced rows together
+    m_scheduler.start( jobs, yTop, yBottom, skip + 1 );
+
+    m_scheduler.waitForDone();
 
     m_tileLoader->cleanupTilehash();
 }
 
-void GenericScanlineTextureMapper::RenderJob::run()
+void GenericScanlineTextureMapper::RenderJob::renderRows( int yTop, int yBottom )
 {
     const int imageWidth  = m_canvasImage->width();
     const int imageHeight  = m_canvasImage->height();
@@ -159,15 +159,12 @@ void GenericScanlineTextureMapper::RenderJob::run()
     GeoDataCoordinates northPole(0, m_viewport->currentProjection()->maxLat(), 0);
     m_viewport->screenCoordinates(northPole, northPoleX, northPoleY, globeHidesNorthPole );
 
-    // initialize needed variables that are modified during texture mapping:
-
-    ScanlineTextureMapperContext context( m_tileLoader, m_tileLevel );
 
     qreal clipRadius = radius * m_viewport->currentProjection()->clippingRadius();
 
 
     // Paint the map.
-    for ( int y = m_yTop; y < m_yBottom; ++y ) {
+    for ( int y = yTop; y < yBottom; ++y ) {
 
         // rx is the radius component in x direction
         const int rx = (int)sqrt( (qreal)( clipRadius * clipRadius
@@ -242,25 +239,25 @@ void GenericScanlineTextureMapper::RenderJob::run()
 
             if ( interpolate ) {
                 if ( highQuality )
-                    context.pixelValueApproxF( lon, lat, scanLine, n );
+                    m_context.pixelValueApproxF( lon, lat, scanLine, n );
                 else
-                    context.pixelValueApprox( lon, lat, scanLine, n );
+                    m_context.pixelValueApprox( lon, lat, scanLine, n );
 
                 scanLine += ( n - 1 );
             }
 
             if ( x < imageWidth ) {
                 if ( highQuality )
-                    context.pixelValueF( lon, lat, scanLine );
+                    m_context.pixelValueF( lon, lat, scanLine );
                 else
-                    context.pixelValue( lon, lat, scanLine );
+                    m_context.pixelValue( lon, lat, scanLine );
             }
 
             ++scanLine;
         }
 
         // copy scanline to improve performance
-        if ( interlaced && y + 1 < m_yBottom ) {
+        if ( interlaced && y + 1 < yBottom ) {
 
             const int pixelByteSize = m_canvasImage->bytesPerLine() / imageWidth;
 
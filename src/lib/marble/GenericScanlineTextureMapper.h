@@ -13,8 +13,9 @@
 
 
 #include "TextureMapperInterface.h"
+#include "ScanlineRenderScheduler.h"
+#include "ScanlineTextureMapperContext.h"
 
-#include <QThreadPool>
 #include <QImage>
 
 #include <MarbleGlobal.h>
@@ -36,6 +37,8 @@ class GenericScanlineTextureMapper : public TextureMapperInterface
                              const QRect &dirtyRect,
                              TextureColorizer *texColorizer );
 
+    virtual QString runtimeTrace() const;
+
  private:
     class RenderJob;
 
@@ -44,7 +47,8 @@ class GenericScanlineTextureMapper : public TextureMapperInterface
     StackedTileLoader *const m_tileLoader;
     int m_radius;
     QImage m_canvasImage;
-    QThreadPool m_threadPool;
+    ScanlineRenderScheduler m_scheduler;
+    ScanlineTextureMapperContext::Statistics m_statistics;
 };
 
 }
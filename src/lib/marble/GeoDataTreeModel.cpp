@@ -17,6 +17,7 @@
 #include <QBrush>
 #include <QModelIndex>
 #include <QList>
+#include <QSet>
 #include <QItemSelectionModel>
 
 // Marble
@@ -915,6 +916,66 @@ void GeoDataTreeModel::removeDocument( GeoDataDocument *document )
     removeFeature( document );
 }
 
+void GeoDataTreeModel::addDocuments( const QVector<GeoDataDocument*> &documents )
+{
+    if ( documents.isEmpty() ) {
+        return;
+    }
+
+    const int first = d->m_rootDocument->size();
+    beginInsertRows( QModelIndex(), first, first + documents.size() - 1 );
+    foreach ( GeoDataDocument *document, documents ) {
+        d->m_rootDocument->append( document );
+    }
+    d->checkParenting( d->m_rootDocument );
+    endInsertRows();
+
+    foreach ( GeoDataDocument *document, documents ) {
+        emit added( document );
+    }
+}
+
+void GeoDataTreeModel::removeDocuments( const QVector<GeoDataDocument*> &documents )
+{
+    if ( documents.isEmpty() ) {
+        return;
+    }
+
+    QSet<const GeoDataFeature*> removedDocuments;
+    foreach ( const GeoDataDocument *document, documents ) {
+        removedDocuments.insert( document );
+    }
+
+    QVector<int> rows;
+    const QVector<GeoDataFeature*> features = d->m_rootDocument->featureList();
+    for ( int row = 0; row < features.size(); ++row ) {
+        if ( removedDocuments.contains( features.at( row ) ) ) {
+            rows << row;
+        }
+    }
+
+    // remove ranges of consecutive rows, starting at the end so that the
+    // rows of the remaining ranges stay valid
+    int last = rows.size() - 1;
+    while ( last >= 0 ) {
+        int first = last;
+        while ( first > 0 && rows.at( first - 1 ) == rows.at( first ) - 1 ) {
+            --first;
+        }
+
+        const int firstRow = rows.at( first );
+        const int lastRow = rows.at( last );
+        beginRemoveRows( QModelIndex(), firstRow, lastRow );
+        d->m_rootDocument->remove( firstRow, lastRow - firstRow + 1 );
+        for ( int row = firstRow; row <= lastRow; ++row ) {
+            emit removed( features.at( row ) );
+        }
+        endRemoveRows();
+
+        last = first - 1;
+    }
+}
+
 void GeoDataTreeModel::setRootDocument( GeoDataDocument* document )
 {
     beginResetModel();
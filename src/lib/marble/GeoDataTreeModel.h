@@ -14,6 +14,7 @@
 #include "marble_export.h"
 
 #include <QAbstractItemModel>
+#include <QVector>
 
 class QItemSelectionModel;
 
@@ -101,6 +102,20 @@ public Q_SLOTS:
 
     void removeDocument( GeoDataDocument* document );
 
+    /**
+      * Appends all @p documents to the root document in a single insertion,
+      * so that views and proxy models get notified only once.
+      */
+    void addDocuments( const QVector<GeoDataDocument*> &documents );
+
+    /**
+      * Removes all @p documents from the root document. Documents in
+      * consecutive rows get removed together, so that views and proxy models
+      * get notified once for each range of rows instead of once per document.
+      * Documents which are not in the root document are ignored.
+      */
+    void removeDocuments( const QVector<GeoDataDocument*> &documents );
+
     int addTourPrimitive( const QModelIndex &parent, GeoDataTourPrimitive *primitive, int row = -1 );
     bool removeTourPrimitive( const QModelIndex &parent, int index );
     bool swapTourPrimitives( const QModelIndex &parent, int indexA, int indexB );
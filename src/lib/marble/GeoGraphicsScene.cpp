@@ -20,16 +20,24 @@
 #include "GeoDataDocument.h"
 #include "GeoDataTypes.h"
 #include "GeoGraphicsItem.h"
-#include "TileId.h"
-#include "TileCoordsPyramid.h"
 #include "MarbleDebug.h"
 
-#include <QMap>
-#include <QRect>
+#include <QMultiHash>
+#include <QVector>
 
 namespace Marble
 {
 
+// Points and other tiny items end up in the nodes of this level
+static const int maximumIndexLevel = 18;
+
+/*
+ * The items are kept in a loose quadtree over longitude and latitude: Each
+ * item is stored in the node of the deepest level whose cells are at least as
+ * large as the item, at the cell which contains its center. As the bounds of
+ * the nodes get extended by half a cell in each direction, they fully contain
+ * all their items. Items crossing the date line are kept in the root node.
+ */
 class GeoGraphicsScenePrivate
 {
 public:
@@ -44,8 +52,43 @@ public:
         q->clear();
     }
 
-    QMap<TileId, QList<GeoGraphicsItem*> > m_items;
-    QMultiHash<const GeoDataFeature*, TileId> m_features;
+    struct Bounds
+    {
+        qreal north;
+        qreal south;
+        qreal east;
+        qreal west;
+    };
+
+    struct Entry
+    {
+        GeoGraphicsItem *item;
+        Bounds bounds;
+    };
+
+    struct Node
+    {
+        Node()
+        {
+            children[0] = children[1] = children[2] = children[3] = 0;
+        }
+
+        ~Node()
+        {
+            for ( int i = 0; i < 4; ++i ) {
+                delete children[i];
+            }
+        }
+
+        QVector<Entry> entries;
+        Node *children[4];
+
+     private:
+        Q_DISABLE_COPY( Node )
+    };
+
+    Node m_root;
+    QMultiHash<const GeoDataFeature*, Node*> m_features;
 
     // Stores the items which have been clicked;
     QList<GeoGraphicsItem*> m_selectedItems;
@@ -54,8 +97,121 @@ public:
 
     void selectItem( GeoGraphicsItem *item );
     void applyHighlightStyle(GeoGraphicsItem *item, const GeoDataStyle::Ptr &style );
+
+    Node *node( const Bounds &bounds );
+    void collectItems( const Node *node, int level, int x, int y,
+                       const Bounds *ranges, int rangeCount, int zoomLevel,
+                       QVector<GeoGraphicsItem*> &items ) const;
+    static bool intersects( const Bounds &bounds, const Bounds &range );
+    static void deleteItems( Node *node );
 };
 
+GeoGraphicsScenePrivate::Node *GeoGraphicsScenePrivate::node( const Bounds &bounds )
+{
+    // Items crossing the date line do not have a cell
+    if ( bounds.west > bounds.east ) {
+        return &m_root;
+    }
+
+    const qreal extent = qMax( ( bounds.east - bounds.west ) / ( 2 * M_PI ),
+                               ( bounds.north - bounds.south ) / M_PI );
+    int level = 0;
+    while ( level < maximumIndexLevel && extent <= 1.0 / ( 1 << ( level + 1 ) ) ) {
+        ++level;
+    }
+
+    const int cells = 1 << level;
+    const qreal centerLon = 0.5 * ( bounds.west + bounds.east );
+    const qreal centerLat = 0.5 * ( bounds.north + bounds.south );
+    const int x = qBound( 0, int( ( centerLon + M_PI ) / ( 2 * M_PI ) * cells ), cells - 1 );
+    const int y = qBound( 0, int( ( M_PI / 2 - centerLat ) / M_PI * cells ), cells - 1 );
+
+    Node *result = &m_root;
+    for ( int i = level - 1; i >= 0; --i ) {
+        const int child = ( ( y >> i ) & 1 ) * 2 + ( ( x >> i ) & 1 );
+        if ( !result->children[child] ) {
+            result->children[child] = new Node;
+        }
+        result = result->children[child];
+    }
+
+    return result;
+}
+
+void GeoGraphicsScenePrivate::collectItems( const Node *node, int level, int x, int y,
+                                            const Bounds *ranges, int rangeCount, int zoomLevel,
+                                            QVector<GeoGraphicsItem*> &items ) const
+{
+    // the loose bounds of the node, extended by half a cell in each direction
+    const qreal width = 2 * M_PI / ( 1 << level );
+    const qreal height = M_PI / ( 1 << level );
+    const Bounds looseBounds = {
+        M_PI / 2 - ( y - 0.5 ) * height,
+        M_PI / 2 - ( y + 1.5 ) * height,
+        -M_PI + ( x + 1.5 ) * width,
+        -M_PI + ( x - 0.5 ) * width
+    };
+
+    bool hasIntersection = false;
+    for ( int i = 0; i < rangeCount && !hasIntersection; ++i ) {
+        hasIntersection = intersects( looseBounds, ranges[i] );
+    }
+    if ( !hasIntersection ) {
+        return;
+    }
+
+    foreach ( const Entry &entry, node->entries ) {
+        if ( entry.item->minZoomLevel() > zoomLevel || !entry.item->visible() ) {
+            continue;
+        }
+
+        // testing all ranges at once reports each item once only
+        for ( int i = 0; i < rangeCount; ++i ) {
+            if ( intersects( entry.bounds, ranges[i] ) ) {
+                items.append( entry.item );
+                break;
+            }
+        }
+    }
+
+    for ( int i = 0; i < 4; ++i ) {
+        if ( node->children[i] ) {
+            collectItems( node->children[i], level + 1, 2 * x + ( i & 1 ), 2 * y + ( i >> 1 ),
+                          ranges, rangeCount, zoomLevel, items );
+        }
+    }
+}
+
+bool GeoGraphicsScenePrivate::intersects( const Bounds &bounds, const Bounds &range )
+{
+    if ( bounds.south > range.north || bounds.north < range.south ) {
+        return false;
+    }
+
+    if ( bounds.west > bounds.east ) {
+        // crossing the date line
+        return range.east >= bounds.west || range.west <= bounds.east;
+    }
+
+    return bounds.west <= range.east && bounds.east >= range.west;
+}
+
+void GeoGraphicsScenePrivate::deleteItems( Node *node )
+{
+    foreach ( const Entry &entry, node->entries ) {
+        delete entry.item;
+    }
+    node->entries.clear();
+
+    for ( int i = 0; i < 4; ++i ) {
+        if ( node->children[i] ) {
+            deleteItems( node->children[i] );
+            delete node->children[i];
+            node->children[i] = 0;
+        }
+    }
+}
+
 GeoDataStyle::Ptr GeoGraphicsScenePrivate::highlightStyle( const GeoDataDocument *document,
                                                        const GeoDataStyleMap &styleMap )
 {
@@ -96,63 +252,26 @@ GeoGraphicsScene::~GeoGraphicsScene()
 
 QList< GeoGraphicsItem* > GeoGraphicsScene::items( const GeoDataLatLonBox &box, int zoomLevel ) const
 {
-    if ( box.west() > box.east() ) {
-        // Handle boxes crossing the IDL by splitting it into two separate boxes
-        GeoDataLatLonBox left;
-        left.setWest( -M_PI );
-        left.setEast( box.east() );
-        left.setNorth( box.north() );
-        left.setSouth( box.south() );
-
-        GeoDataLatLonBox right;
-        right.setWest( box.west() );
-        right.setEast( M_PI );
-        right.setNorth( box.north() );
-        right.setSouth( box.south() );
-
-        QList< GeoGraphicsItem* > allItems = items( left, zoomLevel );
-        foreach( GeoGraphicsItem* item, items( right, zoomLevel ) ) {
-            if ( !allItems.contains( item ) ) {
-                allItems << item;
-            }
-        }
-        return allItems;
-    }
+    QVector<GeoGraphicsItem*> result;
+    items( box, zoomLevel, result );
+    return result.toList();
+}
 
-    QList< GeoGraphicsItem* > result;
-    QRect rect;
-    qreal north, south, east, west;
-    box.boundaries( north, south, east, west );
-    TileId key;
-
-    key = TileId::fromCoordinates( GeoDataCoordinates(west, north, 0), zoomLevel );
-    rect.setLeft( key.x() );
-    rect.setTop( key.y() );
-
-    key = TileId::fromCoordinates( GeoDataCoordinates(east, south, 0), zoomLevel );
-    rect.setRight( key.x() );
-    rect.setBottom( key.y() );
-    
-    TileCoordsPyramid pyramid( 0, zoomLevel );
-    pyramid.setBottomLevelCoords( rect );
-
-    for ( int level = pyramid.topLevel(); level <= pyramid.bottomLevel(); ++level ) {
-        QRect const coords = pyramid.coords( level );
-        int x1, y1, x2, y2;
-        coords.getCoords( &x1, &y1, &x2, &y2 );
-        for ( int x = x1; x <= x2; ++x ) {
-            for ( int y = y1; y <= y2; ++y ) {
-                const TileId tileId = TileId( 0, level, x, y );
-                foreach(GeoGraphicsItem *object, d->m_items.value( tileId )) {
-                    if (object->minZoomLevel() <= zoomLevel && object->visible()) {
-                        result.push_back(object);
-                    }
-                }
-            }
-        }
+void GeoGraphicsScene::items( const GeoDataLatLonBox &box, int zoomLevel, QVector<GeoGraphicsItem*> &result ) const
+{
+    GeoGraphicsScenePrivate::Bounds ranges[2];
+    int rangeCount = 1;
+    box.boundaries( ranges[0].north, ranges[0].south, ranges[0].east, ranges[0].west );
+
+    if ( box.west() > box.east() ) {
+        // Handle boxes crossing the IDL by splitting it into two separate ranges
+        ranges[1] = ranges[0];
+        ranges[0].west = -M_PI;
+        ranges[1].east = M_PI;
+        rangeCount = 2;
     }
 
-    return result;
+    d->collectItems( &d->m_root, 0, 0, 0, ranges, rangeCount, zoomLevel, result );
 }
 
 QList< GeoGraphicsItem* > GeoGraphicsScene::selectedItems() const
@@ -179,10 +298,9 @@ void GeoGraphicsScene::applyHighlight( const QVector< GeoDataPlacemark* > &selec
      * items to use highlight style
      */
     foreach( const GeoDataPlacemark *placemark, selectedPlacemarks ) {
-        QList<TileId> tiles = d->m_features.values( placemark );
-        foreach( const TileId &tileId, tiles ) {
-            QList<GeoGraphicsItem*> clickedItems = d->m_items[tileId];
-            foreach ( GeoGraphicsItem *item, clickedItems ) {
+        foreach( const GeoGraphicsScenePrivate::Node *node, d->m_features.values( placemark ) ) {
+            foreach ( const GeoGraphicsScenePrivate::Entry &entry, node->entries ) {
+                GeoGraphicsItem *const item = entry.item;
                 if ( item->feature() == placemark ) {
                     GeoDataObject *parent = placemark->parent();
                     if ( parent ) {
@@ -226,48 +344,38 @@ void GeoGraphicsScene::applyHighlight( const QVector< GeoDataPlacemark* > &selec
 
 void GeoGraphicsScene::removeItem( const GeoDataFeature* feature )
 {
-    QList<TileId> keys = d->m_features.values( feature );
-    foreach( const TileId& key, keys ) {
-        QList< GeoGraphicsItem* >& tileList = d->m_items[key];
-        foreach( GeoGraphicsItem* item, tileList ) {
+    foreach( GeoGraphicsScenePrivate::Node *node, d->m_features.values( feature ) ) {
+        QVector<GeoGraphicsScenePrivate::Entry> &entries = node->entries;
+        for ( int i = entries.size() - 1; i >= 0; --i ) {
+            GeoGraphicsItem *const item = entries.at( i ).item;
             if( item->feature() == feature ) {
-                d->m_features.remove( feature );
-                tileList.removeAll( item );
+                d->m_selectedItems.removeAll( item );
+                entries.remove( i );
                 delete item;
-                break;
             }
         }
     }
+    d->m_features.remove( feature );
 }
 
 void GeoGraphicsScene::clear()
 {
-    foreach(const QList<GeoGraphicsItem*> &list, d->m_items.values()) {
-        qDeleteAll(list);
-    }
-    d->m_items.clear();
+    GeoGraphicsScenePrivate::deleteItems( &d->m_root );
     d->m_features.clear();
+    d->m_selectedItems.clear();
 }
 
 void GeoGraphicsScene::addItem( GeoGraphicsItem* item )
 {
-    // Select zoom level so that the object fit in single tile
-    int zoomLevel;
-    qreal north, south, east, west;
-    item->latLonAltBox().boundaries( north, south, east, west );
-    for(zoomLevel = item->minZoomLevel(); zoomLevel >= 0; zoomLevel--)
-    {
-        if( TileId::fromCoordinates( GeoDataCoordinates(west, north, 0), zoomLevel ) ==
-            TileId::fromCoordinates( GeoDataCoordinates(east, south, 0), zoomLevel ) )
-            break;
+    GeoGraphicsScenePrivate::Entry entry;
+    entry.item = item;
+    item->latLonAltBox().boundaries( entry.bounds.north, entry.bounds.south, entry.bounds.east, entry.bounds.west );
+
+    GeoGraphicsScenePrivate::Node *const node = d->node( entry.bounds );
+    node->entries.append( entry );
+    if ( !d->m_features.contains( item->feature(), node ) ) {
+        d->m_features.insert( item->feature(), node );
     }
-
-    const TileId key = TileId::fromCoordinates( GeoDataCoordinates(west, north, 0), zoomLevel ); // same as GeoDataCoordinates(east, south, 0), see above
-
-    QList< GeoGraphicsItem* >& tileList = d->m_items[key];
-    QList< GeoGraphicsItem* >::iterator position = qLowerBound( tileList.begin(), tileList.end(), item, GeoGraphicsItem::zValueLessThan );
-    tileList.insert( position, item );
-    d->m_features.insert( item->feature(), key );
 }
 
 }
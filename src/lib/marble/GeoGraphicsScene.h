@@ -17,6 +17,7 @@
 
 #include <QObject>
 #include <QList>
+#include <QVector>
 
 namespace Marble
 {
@@ -68,6 +69,16 @@ public:
      */
     QList<GeoGraphicsItem *> items( const GeoDataLatLonBox &box, int maxZoomLevel ) const;
 
+    /**
+     * @brief Append the items in the specified box to @p items
+     *
+     * Unlike the overload returning a list, this does not allocate anything
+     * once @p items has enough capacity, so callers can reuse the vector
+     * for each frame. Items are appended once only, even for boxes crossing
+     * the date line.
+     */
+    void items( const GeoDataLatLonBox &box, int maxZoomLevel, QVector<GeoGraphicsItem *> &items ) const;
+
     /**
      * @brief Get the list of items which belong to a placemark
      * that has been clicked.
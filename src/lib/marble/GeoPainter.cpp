@@ -28,6 +28,8 @@
 #include "MarbleGlobal.h"
 #include "ViewportParams.h"
 #include "AbstractProjection.h"
+#include "LabelGrid.h"
+#include "ProjectedGeometryCache.h"
 
 // #define MARBLE_DEBUG
 
@@ -37,6 +39,8 @@ GeoPainterPrivate::GeoPainterPrivate( GeoPainter* q, const ViewportParams *viewp
         : m_viewport( viewport ),
         m_mapQuality( mapQuality ),
         m_x( new qreal[100] ),
+        m_geometryCache( 0 ),
+        m_labelGrid( 0 ),
         m_parent(q)
 {
 }
@@ -46,6 +50,15 @@ GeoPainterPrivate::~GeoPainterPrivate()
     delete[] m_x;
 }
 
+void GeoPainterPrivate::screenCoordinates( const GeoDataLineString &lineString, QVector<QPolygonF*> &polygons ) const
+{
+    if ( m_geometryCache ) {
+        m_geometryCache->screenCoordinates( lineString, m_viewport, polygons );
+    } else {
+        m_viewport->screenCoordinates( lineString, polygons );
+    }
+}
+
 void GeoPainterPrivate::createAnnotationLayout (  qreal x, qreal y,
                                                   const QSizeF& bubbleSize,
                                                   qreal bubbleOffsetX, qreal bubbleOffsetY,
@@ -213,6 +226,30 @@ GeoPainter::~GeoPainter()
 }
 
 
+void GeoPainter::setProjectedGeometryCache( ProjectedGeometryCache *cache )
+{
+    d->m_geometryCache = cache;
+}
+
+
+ProjectedGeometryCache *GeoPainter::projectedGeometryCache() const
+{
+    return d->m_geometryCache;
+}
+
+
+void GeoPainter::setLabelGrid( LabelGrid *grid )
+{
+    d->m_labelGrid = grid;
+}
+
+
+LabelGrid *GeoPainter::labelGrid() const
+{
+    return d->m_labelGrid;
+}
+
+
 MapQuality GeoPainter::mapQuality() const
 {
     return d->m_mapQuality;
@@ -573,7 +610,7 @@ void GeoPainter::drawPolyline ( const GeoDataLineString & lineString,
     }
 
     QVector<QPolygonF*> polygons;
-    d->m_viewport->screenCoordinates( lineString, polygons );
+    d->screenCoordinates( lineString, polygons );
 
     if (labelPositionFlags.testFlag(FollowLine)) {
         const qreal maximumLabelFontSize = 20;
@@ -596,7 +633,11 @@ void GeoPainter::drawPolyline ( const GeoDataLineString & lineString,
                 QFont font = this->font();
                 font.setPointSizeF(fontSize);
                 setFont(font);
-                int labelWidth = fontMetrics().width( labelText );
+                const int textWidth = d->m_labelGrid ? d->m_labelGrid->textWidth( font, labelText )
+                                                     : fontMetrics().width( labelText );
+                const int textHeight = d->m_labelGrid ? d->m_labelGrid->textHeight( font )
+                                                      : fontMetrics().height();
+                int labelWidth = textWidth;
                 if (labelText.size() < 20) {
                     labelWidth *= (20.0 / labelText.size());
                 }
@@ -630,6 +671,22 @@ void GeoPainter::drawPolyline ( const GeoDataLineString & lineString,
                             angle2 = GeoPainterPrivate::normalizeAngle(angle2);
                             bool upsideDown = angle > 90.0 && angle < 270.0;
 
+                            if ( d->m_labelGrid ) {
+                                // Only the text itself is occupied, not the padding of
+                                // short labels: It starts at the start of the slot, or
+                                // ends at its end if drawn upside down. The rotated text
+                                // stays within the box spanned by its ends, grown by
+                                // the text height on all sides.
+                                const qreal textStart = upsideDown ? startPercent + textRelativeLength - textWidth / pathLength
+                                                                   : startPercent;
+                                const QPointF textEnd = path.pointAtPercent( qMin<qreal>( 1.0, textStart + textWidth / pathLength ) );
+                                const QRectF labelRect = QRectF( path.pointAtPercent( textStart ), textEnd ).normalized()
+                                        .adjusted( -textHeight, -textHeight, textHeight, textHeight );
+                                if ( !d->m_labelGrid->tryOccupy( labelRect ) ) {
+                                    continue;
+                                }
+                            }
+
                             if ( qAbs(angle - angle2) < 3.0 ) {
                                 if ( upsideDown ) {
                                     angle += 180.0;
@@ -660,8 +717,11 @@ void GeoPainter::drawPolyline ( const GeoDataLineString & lineString,
             restore();
         }
     } else {
-        int labelWidth = fontMetrics().width( labelText );
+        int labelWidth = d->m_labelGrid ? d->m_labelGrid->textWidth( font(), labelText )
+                                        : fontMetrics().width( labelText );
         int labelAscent = fontMetrics().ascent();
+        const QSizeF labelSize( labelWidth, d->m_labelGrid ? d->m_labelGrid->textHeight( font() )
+                                                           : fontMetrics().height() );
 
         QVector<QPointF> labelNodes;
         foreach( QPolygonF* itPolygon, polygons ) {
@@ -681,7 +741,11 @@ void GeoPainter::drawPolyline ( const GeoDataLineString & lineString,
                     qreal ymax = viewport().height() - 10.0 - labelAscent;
                     if ( labelPosition.y() > ymax ) labelPosition.setY( ymax );
 
-                    drawText( QRectF( labelPosition, fontMetrics().size( 0, labelText) ), labelText );
+                    const QRectF labelRect( labelPosition, labelSize );
+                    if ( d->m_labelGrid && !d->m_labelGrid->tryOccupy( labelRect ) ) {
+                        continue;
+                    }
+                    drawText( labelRect, labelText );
                 }
                 setPen(oldPen);
             }
@@ -703,7 +767,7 @@ void GeoPainter::drawPolyline(const GeoDataLineString& lineString)
     }
 
     QVector<QPolygonF*> polygons;
-    d->m_viewport->screenCoordinates(lineString, polygons);
+    d->screenCoordinates(lineString, polygons);
 
     foreach(const QPolygonF* itPolygon, polygons) {
         ClipPainter::drawPolyline(*itPolygon);
@@ -761,7 +825,7 @@ void GeoPainter::drawPolygon ( const GeoDataLinearRing & linearRing,
     }
 
     QVector<QPolygonF*> polygons;
-    d->m_viewport->screenCoordinates( linearRing, polygons );
+    d->screenCoordinates( linearRing, polygons );
 
     foreach( QPolygonF* itPolygon, polygons ) {
         ClipPainter::drawPolygon( *itPolygon, fillRule );
@@ -830,7 +894,7 @@ void GeoPainter::drawPolygon ( const GeoDataPolygon & polygon,
 
     QVector<QPolygonF*> outerPolygons;
     QVector<QPolygonF*> innerPolygons;
-    d->m_viewport->screenCoordinates( polygon.outerBoundary(), outerPolygons );
+    d->screenCoordinates( polygon.outerBoundary(), outerPolygons );
 
     QPen const oldPen = pen();
 
@@ -866,7 +930,7 @@ void GeoPainter::drawPolygon ( const GeoDataPolygon & polygon,
             foreach( const GeoDataLinearRing& itInnerBoundary, innerBoundaries ) {
                 QVector<QPolygonF*> innerPolygonsPerBoundary;
 
-                d->m_viewport->screenCoordinates( itInnerBoundary, innerPolygonsPerBoundary );
+                d->screenCoordinates( itInnerBoundary, innerPolygonsPerBoundary );
 
                 foreach( QPolygonF* innerPolygonPerBoundary, innerPolygonsPerBoundary ) {
                     innerPolygons << innerPolygonPerBoundary;
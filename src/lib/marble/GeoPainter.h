@@ -35,6 +35,8 @@ class GeoDataLineString;
 class GeoDataLinearRing;
 class GeoDataPoint;
 class GeoDataPolygon;
+class LabelGrid;
+class ProjectedGeometryCache;
 
 
 /*!
@@ -119,6 +121,31 @@ class MARBLE_EXPORT GeoPainter : public ClipPainter
     MapQuality mapQuality() const;
 
 
+/*!
+    \brief Sets a cache for the screen polygons of line strings and polygons.
+
+    Painting line strings, linear rings and polygons then reuses the screen
+    polygons projected for the same viewport during earlier frames. The
+    painter does not take ownership of the \a cache; pass 0 to project
+    every geometry again.
+*/
+    void setProjectedGeometryCache( ProjectedGeometryCache *cache );
+
+    ProjectedGeometryCache *projectedGeometryCache() const;
+
+
+/*!
+    \brief Sets a grid that tracks the screen area taken by labels.
+
+    Labels of line strings are then only drawn where they do not overlap
+    labels drawn earlier into the same \a grid. The painter does not take
+    ownership of the \a grid; pass 0 to draw all labels.
+*/
+    void setLabelGrid( LabelGrid *grid );
+
+    LabelGrid *labelGrid() const;
+
+
 /*!
     \brief Draws a text annotation that points to a geodesic position.
 
@@ -14,6 +14,8 @@
 #include "MarbleGlobal.h"
 //#include "GeoPainter.h"
 
+#include <QVector>
+
 class QPolygonF;
 class QSizeF;
 class QPainterPath;
@@ -24,7 +26,10 @@ namespace Marble
 
 class ViewportParams;
 class GeoDataCoordinates;
+class GeoDataLineString;
 class GeoPainter;
+class LabelGrid;
+class ProjectedGeometryCache;
 
 class GeoPainterPrivate
 {
@@ -49,9 +54,13 @@ class GeoPainterPrivate
 
     void drawTextRotated( const QPointF &startPoint, qreal angle, const QString &text );
 
+    void screenCoordinates( const GeoDataLineString &lineString, QVector<QPolygonF*> &polygons ) const;
+
     const ViewportParams *const m_viewport;
     const MapQuality       m_mapQuality;
     qreal             *const m_x;
+    ProjectedGeometryCache *m_geometryCache;
+    LabelGrid *m_labelGrid;
 
 private:
     GeoPainter* m_parent;
@@ -0,0 +1,229 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include "ImageAtlas.h"
+
+#include <QImage>
+
+namespace Marble
+{
+
+// free pixels around each image, so neighbors do not bleed into each other
+static const int padding = 1;
+
+ImageAtlas::ImageAtlas( const QSize &pageSize, int maximumPages ) :
+    m_pageSize( pageSize ),
+    m_maximumPages( qMax( 1, maximumPages ) ),
+    m_painter( 0 ),
+    m_frame( 0 ),
+    m_batchCount( 0 ),
+    m_queuedPage( -1 )
+{
+}
+
+ImageAtlas::~ImageAtlas()
+{
+}
+
+void ImageAtlas::begin( QPainter *painter )
+{
+    m_painter = painter;
+    ++m_frame;
+    m_batchCount = 0;
+    m_queuedPage = -1;
+    m_fragments.resize( 0 );
+}
+
+void ImageAtlas::end()
+{
+    flush();
+    m_painter = 0;
+}
+
+bool ImageAtlas::draw( const QString &key, const QPointF &position )
+{
+    QHash<QString, Entry>::const_iterator it = m_entries.constFind( key );
+    if ( it == m_entries.constEnd() ) {
+        return false;
+    }
+
+    queue( it.value(), position );
+    return true;
+}
+
+void ImageAtlas::draw( const QString &key, const QPointF &position, const QImage &image )
+{
+    if ( image.isNull() || draw( key, position ) ) {
+        return;
+    }
+
+    Entry entry;
+    if ( !allocate( image.size(), entry ) ) {
+        flush();
+        if ( m_painter ) {
+            m_painter->drawImage( position, image );
+            ++m_batchCount;
+        }
+        return;
+    }
+
+    Page &page = m_pages[entry.page];
+    QPainter pagePainter( &page.pixmap );
+    pagePainter.setCompositionMode( QPainter::CompositionMode_Source );
+    pagePainter.drawImage( entry.rect.topLeft(), image );
+    pagePainter.end();
+
+    page.keys.append( key );
+    m_entries.insert( key, entry );
+
+    queue( entry, position );
+}
+
+bool ImageAtlas::contains( const QString &key ) const
+{
+    return m_entries.contains( key );
+}
+
+int ImageAtlas::pageCount() const
+{
+    return m_pages.size();
+}
+
+int ImageAtlas::batchCount() const
+{
+    return m_batchCount;
+}
+
+bool ImageAtlas::allocate( const QSize &size, Entry &entry )
+{
+    const QSize paddedSize = size + QSize( padding, padding );
+    if ( paddedSize.width() > m_pageSize.width() || paddedSize.height() > m_pageSize.height() ) {
+        return false;
+    }
+
+    for ( int i = 0; i < m_pages.size(); ++i ) {
+        if ( allocate( i, paddedSize, entry.rect ) ) {
+            entry.page = i;
+            entry.rect.setSize( size );
+            return true;
+        }
+    }
+
+    int pageIndex;
+    if ( m_pages.size() < m_maximumPages ) {
+        Page page;
+        page.pixmap = QPixmap( m_pageSize );
+        page.pixmap.fill( Qt::transparent );
+        page.lastUse = m_frame;
+        m_pages.append( page );
+        pageIndex = m_pages.size() - 1;
+    } else {
+        // queued fragments may refer to the page about to be cleared
+        flush();
+
+        pageIndex = 0;
+        for ( int i = 1; i < m_pages.size(); ++i ) {
+            if ( m_pages.at( i ).lastUse < m_pages.at( pageIndex ).lastUse ) {
+                pageIndex = i;
+            }
+        }
+        clearPage( pageIndex );
+    }
+
+    const bool allocated = allocate( pageIndex, paddedSize, entry.rect );
+    Q_ASSERT( allocated );
+    Q_UNUSED( allocated );
+    entry.page = pageIndex;
+    entry.rect.setSize( size );
+    return true;
+}
+
+bool ImageAtlas::allocate( int pageIndex, const QSize &size, QRect &rect )
+{
+    Page &page = m_pages[pageIndex];
+
+    // use the lowest shelf the image fits into
+    int best = -1;
+    for ( int i = 0; i < page.shelves.size(); ++i ) {
+        const Shelf &shelf = page.shelves.at( i );
+        if ( shelf.height >= size.height()
+             && shelf.width + size.width() <= m_pageSize.width()
+             && ( best < 0 || shelf.height < page.shelves.at( best ).height ) ) {
+            best = i;
+        }
+    }
+
+    // open a new shelf if the image would waste more than half of the best one
+    if ( best < 0 || page.shelves.at( best ).height > 2 * size.height() ) {
+        const int top = page.shelves.isEmpty() ? 0 : page.shelves.last().top + page.shelves.last().height;
+        if ( top + size.height() <= m_pageSize.height() ) {
+            Shelf shelf;
+            shelf.top = top;
+            shelf.height = size.height();
+            shelf.width = 0;
+            page.shelves.append( shelf );
+            best = page.shelves.size() - 1;
+        }
+    }
+
+    if ( best < 0 ) {
+        return false;
+    }
+
+    Shelf &shelf = page.shelves[best];
+    rect = QRect( QPoint( shelf.width, shelf.top ), size );
+    shelf.width += size.width();
+    return true;
+}
+
+void ImageAtlas::clearPage( int pageIndex )
+{
+    Page &page = m_pages[pageIndex];
+    foreach ( const QString &key, page.keys ) {
+        m_entries.remove( key );
+    }
+    page.keys.clear();
+    page.shelves.clear();
+    page.pixmap.fill( Qt::transparent );
+    if ( m_queuedPage == pageIndex ) {
+        m_queuedPage = -1;
+    }
+}
+
+void ImageAtlas::queue( const Entry &entry, const QPointF &position )
+{
+    if ( entry.page != m_queuedPage ) {
+        flush();
+        m_queuedPage = entry.page;
+    }
+
+    m_pages[entry.page].lastUse = m_frame;
+
+    // fragments are positioned by their center
+    const QPointF center = position + QPointF( 0.5 * entry.rect.width(), 0.5 * entry.rect.height() );
+    m_fragments.append( QPainter::PixmapFragment::create( center, QRectF( entry.rect ) ) );
+}
+
+void ImageAtlas::flush()
+{
+    if ( m_fragments.isEmpty() ) {
+        return;
+    }
+
+    if ( m_painter && m_queuedPage >= 0 ) {
+        m_painter->drawPixmapFragments( m_fragments.constData(), m_fragments.size(),
+                                        m_pages.at( m_queuedPage ).pixmap );
+        ++m_batchCount;
+    }
+
+    m_fragments.resize( 0 );
+}
+
+}
@@ -0,0 +1,125 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#ifndef MARBLE_IMAGEATLAS_H
+#define MARBLE_IMAGEATLAS_H
+
+#include <QHash>
+#include <QPainter>
+#include <QPixmap>
+#include <QRect>
+#include <QString>
+#include <QVector>
+
+#include "marble_export.h"
+
+class QImage;
+
+namespace Marble
+{
+
+/**
+ * @short Packs many small images into a few large pixmaps and draws them in batches.
+ *
+ * Images are stored under a key into pages of a fixed size. Drawing an image
+ * queues a fragment of its page, and consecutive fragments of the same page
+ * get drawn with a single QPainter::drawPixmapFragments() call. The drawing
+ * order is kept.
+ *
+ * Once all pages are full, the least recently drawn page is cleared to make
+ * room for new images.
+ */
+class MARBLE_EXPORT ImageAtlas
+{
+ public:
+    explicit ImageAtlas( const QSize &pageSize = QSize( 1024, 1024 ), int maximumPages = 4 );
+    ~ImageAtlas();
+
+    /**
+     * Starts drawing onto @p painter.
+     */
+    void begin( QPainter *painter );
+
+    /**
+     * Draws all queued images and stops drawing onto the painter.
+     */
+    void end();
+
+    /**
+     * Queues the image stored under @p key to be drawn with its top left
+     * corner at @p position. Returns false if there is no such image.
+     */
+    bool draw( const QString &key, const QPointF &position );
+
+    /**
+     * Stores @p image under @p key and queues it to be drawn with its top
+     * left corner at @p position. Images exceeding the page size are drawn
+     * directly.
+     */
+    void draw( const QString &key, const QPointF &position, const QImage &image );
+
+    /**
+     * Returns whether an image is stored under @p key.
+     */
+    bool contains( const QString &key ) const;
+
+    int pageCount() const;
+
+    /**
+     * Returns the number of pixmaps drawn by the last begin()/end() pair.
+     */
+    int batchCount() const;
+
+ private:
+    Q_DISABLE_COPY( ImageAtlas )
+
+    struct Shelf
+    {
+        int top;
+        int height;
+        int width;
+    };
+
+    struct Page
+    {
+        QPixmap pixmap;
+        QVector<Shelf> shelves;
+        QVector<QString> keys;
+        int lastUse;
+    };
+
+    struct Entry
+    {
+        int page;
+        QRect rect;
+    };
+
+    bool allocate( const QSize &size, Entry &entry );
+    bool allocate( int pageIndex, const QSize &size, QRect &rect );
+    void clearPage( int pageIndex );
+    void queue( const Entry &entry, const QPointF &position );
+    void flush();
+
+    const QSize m_pageSize;
+    const int m_maximumPages;
+
+    QVector<Page> m_pages;
+    QHash<QString, Entry> m_entries;
+
+    QPainter *m_painter;
+    int m_frame;
+    int m_batchCount;
+    int m_queuedPage;
+    QVector<QPainter::PixmapFragment> m_fragments;
+};
+
+}
+
+#endif
@@ -0,0 +1,174 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include "LabelGrid.h"
+
+#include <QFont>
+
+#include <cmath>
+
+namespace Marble
+{
+
+// edge length of the cells in pixels, about the size of a short label
+static const int cellSize = 64;
+
+// the number of widths and fonts cached before the cache gets cleared; labels
+// following lines get their font size from the zoom level, so fonts come and go
+static const int maximumCachedWidths = 20000;
+static const int maximumCachedFonts = 100;
+
+LabelGrid::FontMetrics::FontMetrics( const QFont &font ) :
+    metrics( font ),
+    height( metrics.height() )
+{
+}
+
+LabelGrid::LabelGrid() :
+    m_columns( 0 ),
+    m_rows( 0 ),
+    m_cachedWidths( 0 )
+{
+}
+
+LabelGrid::~LabelGrid()
+{
+    qDeleteAll( m_fontMetrics );
+}
+
+void LabelGrid::reset( const QSize &size )
+{
+    m_columns = qMax( 1, ( size.width() + cellSize - 1 ) / cellSize );
+    m_rows = qMax( 1, ( size.height() + cellSize - 1 ) / cellSize );
+
+    m_labels.resize( 0 );
+
+    // keep the capacity of the cells for the next pass
+    m_cells.resize( m_columns * m_rows );
+    for ( int i = 0; i < m_cells.size(); ++i ) {
+        m_cells[i].resize( 0 );
+    }
+}
+
+bool LabelGrid::isFree( const QRectF &rect ) const
+{
+    if ( m_cells.isEmpty() ) {
+        return true;
+    }
+
+    int left, top, right, bottom;
+    cellRange( rect, left, top, right, bottom );
+
+    for ( int row = top; row <= bottom; ++row ) {
+        for ( int column = left; column <= right; ++column ) {
+            const QVector<int> &cell = m_cells.at( row * m_columns + column );
+            for ( int i = 0; i < cell.size(); ++i ) {
+                if ( rect.intersects( m_labels.at( cell.at( i ) ) ) ) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+void LabelGrid::occupy( const QRectF &rect )
+{
+    if ( m_cells.isEmpty() ) {
+        return;
+    }
+
+    const int index = m_labels.size();
+    m_labels.append( rect );
+
+    int left, top, right, bottom;
+    cellRange( rect, left, top, right, bottom );
+
+    for ( int row = top; row <= bottom; ++row ) {
+        for ( int column = left; column <= right; ++column ) {
+            m_cells[row * m_columns + column].append( index );
+        }
+    }
+}
+
+bool LabelGrid::tryOccupy( const QRectF &rect )
+{
+    if ( !isFree( rect ) ) {
+        return false;
+    }
+
+    occupy( rect );
+    return true;
+}
+
+int LabelGrid::labelCount() const
+{
+    return m_labels.size();
+}
+
+int LabelGrid::textHeight( const QFont &font )
+{
+    return fontMetrics( font ).height;
+}
+
+int LabelGrid::textWidth( const QFont &font, const QString &text )
+{
+    if ( m_cachedWidths >= maximumCachedWidths ) {
+        clearTextMetrics();
+    }
+
+    FontMetrics &metrics = fontMetrics( font );
+
+    QHash<QString, int>::const_iterator it = metrics.widths.constFind( text );
+    if ( it != metrics.widths.constEnd() ) {
+        return it.value();
+    }
+
+    const int width = metrics.metrics.width( text );
+    metrics.widths.insert( text, width );
+    ++m_cachedWidths;
+
+    return width;
+}
+
+void LabelGrid::cellRange( const QRectF &rect, int &left, int &top, int &right, int &bottom ) const
+{
+    // labels reaching beyond the screen are kept in the cells at its border
+    left = qBound( 0, int( std::floor( rect.left() / cellSize ) ), m_columns - 1 );
+    right = qBound( 0, int( std::floor( rect.right() / cellSize ) ), m_columns - 1 );
+    top = qBound( 0, int( std::floor( rect.top() / cellSize ) ), m_rows - 1 );
+    bottom = qBound( 0, int( std::floor( rect.bottom() / cellSize ) ), m_rows - 1 );
+}
+
+LabelGrid::FontMetrics &LabelGrid::fontMetrics( const QFont &font )
+{
+    const QString key = font.key();
+
+    FontMetrics *metrics = m_fontMetrics.value( key );
+    if ( !metrics ) {
+        if ( m_fontMetrics.size() >= maximumCachedFonts ) {
+            clearTextMetrics();
+        }
+        metrics = new FontMetrics( font );
+        m_fontMetrics.insert( key, metrics );
+    }
+
+    return *metrics;
+}
+
+void LabelGrid::clearTextMetrics()
+{
+    qDeleteAll( m_fontMetrics );
+    m_fontMetrics.clear();
+    m_cachedWidths = 0;
+}
+
+}
@@ -0,0 +1,109 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#ifndef MARBLE_LABELGRID_H
+#define MARBLE_LABELGRID_H
+
+#include <QFontMetrics>
+#include <QHash>
+#include <QRectF>
+#include <QSize>
+#include <QString>
+#include <QVector>
+
+#include "marble_export.h"
+
+class QFont;
+
+namespace Marble
+{
+
+/**
+ * @short Keeps track of the screen areas taken by labels.
+ *
+ * The screen is divided into square cells, and each label rectangle is
+ * recorded in all cells it covers. Checking a candidate position then only
+ * compares it with the labels in the cells it covers, independent of the
+ * number of labels on the screen. The cells keep their memory between
+ * layout passes, so a pass does not allocate once the grid got warm.
+ *
+ * Besides that the grid caches the text metrics of labels, which are
+ * expensive to calculate and needed for each candidate position. The cache
+ * is limited in size and starts over once it is full.
+ */
+class MARBLE_EXPORT LabelGrid
+{
+ public:
+    LabelGrid();
+    ~LabelGrid();
+
+    /**
+     * Removes all labels and adjusts the grid to a screen of @p size.
+     * The cached text metrics are kept.
+     */
+    void reset( const QSize &size );
+
+    /**
+     * Returns whether @p rect does not intersect any of the labels.
+     */
+    bool isFree( const QRectF &rect ) const;
+
+    /**
+     * Records @p rect as taken by a label.
+     */
+    void occupy( const QRectF &rect );
+
+    /**
+     * Records @p rect as taken if it is free. Returns whether it was.
+     */
+    bool tryOccupy( const QRectF &rect );
+
+    /**
+     * Returns the number of labels since the last reset().
+     */
+    int labelCount() const;
+
+    /**
+     * Returns the height of text set in @p font.
+     */
+    int textHeight( const QFont &font );
+
+    /**
+     * Returns the width of @p text set in @p font.
+     */
+    int textWidth( const QFont &font, const QString &text );
+
+ private:
+    Q_DISABLE_COPY( LabelGrid )
+
+    struct FontMetrics
+    {
+        explicit FontMetrics( const QFont &font );
+
+        QFontMetrics metrics;
+        int height;
+        QHash<QString, int> widths;
+    };
+
+    void cellRange( const QRectF &rect, int &left, int &top, int &right, int &bottom ) const;
+    FontMetrics &fontMetrics( const QFont &font );
+    void clearTextMetrics();
+
+    int m_columns;
+    int m_rows;
+    QVector<QRectF> m_labels;
+    QVector<QVector<int> > m_cells;
+    QHash<QString, FontMetrics *> m_fontMetrics;
+    int m_cachedWidths;
+};
+
+}
+
+#endif
@@ -191,6 +191,15 @@ enum RenderStatus {
     Incomplete ///< Data is missing and some error occurred when trying to retrieve it (e.g. network failure)
 };
 
+/**
+ * @brief Describes how tiles are kept in the volatile tile cache while they are not displayed
+ */
+enum TileCacheCompression {
+    NoTileCacheCompression,          ///< Tiles are kept as they are and get displayed again right away
+    LosslessTileCacheCompression,    ///< Tiles are compressed without any loss
+    ReducedColorTileCacheCompression ///< Opaque result images are reduced to 16 bit colors before they get compressed
+};
+
 const int defaultLevelZeroColumns = 2;
 const int defaultLevelZeroRows = 1;
 
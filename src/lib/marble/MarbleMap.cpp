@@ -173,7 +173,7 @@ MarbleMapPrivate::MarbleMapPrivate( MarbleMap *parent, MarbleModel *model ) :
     m_floatItemsLayer(parent),
     m_textureLayer( model->downloadManager(), model->pluginManager(), model->sunLocator(), model->groundOverlayModel() ),
     m_placemarkLayer( model->placemarkModel(), model->placemarkSelectionModel(), model->clock(), &m_styleBuilder ),
-    m_vectorTileLayer( model->downloadManager(), model->pluginManager(), model->treeModel() ),
+    m_vectorTileLayer( model->downloadManager(), model->pluginManager(), model->treeModel(), &m_styleBuilder ),
     m_isLockedToSubSolarPoint( false ),
     m_isSubSolarPointIconVisible( false )
 {
@@ -206,6 +206,8 @@ MarbleMapPrivate::MarbleMapPrivate( MarbleMap *parent, MarbleModel *model ) :
 
     QObject::connect( &m_geometryLayer, SIGNAL(repaintNeeded()),
                       parent, SIGNAL(repaintNeeded()));
+    QObject::connect( &m_vectorTileLayer, SIGNAL(renderBundleReady(QSharedPointer<Marble::TileRenderBundle>)),
+                      &m_geometryLayer, SLOT(addRenderBundle(QSharedPointer<Marble::TileRenderBundle>)) );
 
     /*
      * Slot handleHighlight finds all placemarks
@@ -384,6 +386,7 @@ void MarbleMap::setViewContext( ViewContext viewContext )
 
     const MapQuality oldQuality = d->m_viewParams.mapQuality();
     d->m_viewParams.setViewContext( viewContext );
+    d->m_placemarkLayer.setViewContext( viewContext );
     emit viewContextChanged( viewContext );
 
     if ( d->m_viewParams.mapQuality() != oldQuality ) {
@@ -705,6 +708,11 @@ quint64 MarbleMap::volatileTileCacheLimit() const
     return d->m_textureLayer.volatileCacheLimit();
 }
 
+TileCacheCompression MarbleMap::volatileTileCacheCompression() const
+{
+    return d->m_textureLayer.tileCacheCompression();
+}
+
 
 void MarbleMap::rotateBy(qreal deltaLon, qreal deltaLat)
 {
@@ -1283,6 +1291,11 @@ void MarbleMap::setVolatileTileCacheLimit( quint64 kilobytes )
     d->m_textureLayer.setVolatileCacheLimit( kilobytes );
 }
 
+void MarbleMap::setVolatileTileCacheCompression( TileCacheCompression compression )
+{
+    d->m_textureLayer.setTileCacheCompression( compression );
+}
+
 AngleUnit MarbleMap::defaultAngleUnit() const
 {
     if ( GeoDataCoordinates::defaultNotation() == GeoDataCoordinates::Decimal ) {
@@ -366,6 +366,11 @@ class MARBLE_EXPORT MarbleMap : public QObject
      */
     quint64 volatileTileCacheLimit() const;
 
+    /**
+     * @brief  Returns how the volatile tile cache keeps tiles that are not displayed.
+     */
+    TileCacheCompression volatileTileCacheCompression() const;
+
     /**
      * @brief Returns a list of all RenderPlugins in the model, this includes float items
      * @return the list of RenderPlugins
@@ -663,6 +668,15 @@ class MARBLE_EXPORT MarbleMap : public QObject
      */
     void setVolatileTileCacheLimit( quint64 kiloBytes );
 
+    /**
+     * @brief  Set how the volatile tile cache keeps tiles that are not displayed.
+     *
+     * Compressed tiles let many more tiles fit into the cache, e.g. on devices
+     * with little memory, at the expense of expanding them once they are
+     * displayed again.
+     */
+    void setVolatileTileCacheCompression( TileCacheCompression compression );
+
     void setDefaultAngleUnit( AngleUnit angleUnit );
 
     void setDefaultFont( const QFont& font );
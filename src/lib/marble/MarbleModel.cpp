@@ -50,7 +50,7 @@
 
 #include "DgmlAuxillaryDictionary.h"
 #include "MarbleClock.h"
-#include "FileStoragePolicy.h"
+#include "PackedTileStoragePolicy.h"
 #include "FileStorageWatcher.h"
 #include "PositionTracking.h"
 #include "HttpDownloadManager.h"
@@ -159,7 +159,7 @@ class MarbleModelPrivate
     // View and paint stuff
     GeoSceneDocument        *m_mapTheme;
 
-    FileStoragePolicy        m_storagePolicy;
+    PackedTileStoragePolicy  m_storagePolicy;
     HttpDownloadManager      m_downloadManager;
 
     // Cache related
@@ -526,6 +526,11 @@ quint64 MarbleWidget::volatileTileCacheLimit() const
     return d->m_map.volatileTileCacheLimit();
 }
 
+TileCacheCompression MarbleWidget::volatileTileCacheCompression() const
+{
+    return d->m_map.volatileTileCacheCompression();
+}
+
 
 void MarbleWidget::setZoom( int newZoom, FlyToMode mode )
 {
@@ -958,6 +963,11 @@ void MarbleWidget::setVolatileTileCacheLimit( quint64 kiloBytes )
     d->m_map.setVolatileTileCacheLimit( kiloBytes );
 }
 
+void MarbleWidget::setVolatileTileCacheCompression( TileCacheCompression compression )
+{
+    d->m_map.setVolatileTileCacheCompression( compression );
+}
+
 // This slot will called when the Globe starts to create the tiles.
 
 void MarbleWidget::creatingTilesStart( TileCreator *creator,
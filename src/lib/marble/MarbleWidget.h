@@ -576,6 +576,11 @@ class MARBLE_EXPORT MarbleWidget : public QWidget
      */
     quint64 volatileTileCacheLimit() const;
 
+    /**
+     * @brief  Returns how the volatile tile cache keeps tiles that are not displayed.
+     */
+    TileCacheCompression volatileTileCacheCompression() const;
+
     //@}
 
     /// @name Miscellaneous
@@ -977,6 +982,12 @@ class MARBLE_EXPORT MarbleWidget : public QWidget
      */
     void setVolatileTileCacheLimit( quint64 kiloBytes );
 
+    /**
+     * @brief  Set how the volatile tile cache keeps tiles that are not displayed.
+     * @param  compression Compressed tiles let many more tiles fit into the cache.
+     */
+    void setVolatileTileCacheCompression( TileCacheCompression compression );
+
     /**
      * @brief A slot that is called when the model starts to create new tiles.
      * @param creator the tile creator object.
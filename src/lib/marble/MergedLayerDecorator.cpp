@@ -21,9 +21,11 @@
 #include "blendings/Blending.h"
 #include "blendings/BlendingFactory.h"
 #include "SunLocator.h"
+#include "SunShadingMask.h"
 #include "MarbleMath.h"
 #include "MarbleDebug.h"
 #include "GeoDataGroundOverlay.h"
+#include "GeoDataLatLonBox.h"
 #include "GeoSceneTextureTileDataset.h"
 #include "ImageF.h"
 #include "StackedTile.h"
@@ -39,24 +41,57 @@
 
 using namespace Marble;
 
+class Q_DECL_HIDDEN MergedLayerDecorator::CompositionState
+{
+public:
+    struct GroundOverlay
+    {
+        GeoDataLatLonBox latLonBox;
+        QImage icon;
+    };
+
+    CompositionState();
+
+    // the ground overlays covering the tile, the tile's bounds are only needed for them
+    QVector<GroundOverlay> m_groundOverlays;
+    GeoDataLatLonBox m_tileLatLonBox;
+    bool m_isMercatorTileProjection;
+    QString m_themeId;
+    int m_levelZeroColumns;
+    int m_levelZeroRows;
+    bool m_showSunShading;
+    bool m_showCityLights;
+    bool m_showTileId;
+};
+
+MergedLayerDecorator::CompositionState::CompositionState() :
+    m_isMercatorTileProjection( false ),
+    m_levelZeroColumns( 0 ),
+    m_levelZeroRows( 0 ),
+    m_showSunShading( false ),
+    m_showCityLights( false ),
+    m_showTileId( false )
+{
+}
+
 class Q_DECL_HIDDEN MergedLayerDecorator::Private
 {
 public:
     Private( TileLoader *tileLoader, const SunLocator *sunLocator );
 
-    static int maxDivisor( int maximum, int fullLength );
-
-    StackedTile *createTile( const QVector<QSharedPointer<TextureTile> > &tiles ) const;
+    StackedTile *createTile( const QVector<QSharedPointer<TextureTile> > &tiles, const CompositionState &state ) const;
 
-    void renderGroundOverlays( QImage *tileImage, const QVector<QSharedPointer<TextureTile> > &tiles ) const;
-    void paintSunShading( QImage *tileImage, const TileId &id ) const;
-    void paintTileId( QImage *tileImage, const TileId &id ) const;
+    static void renderGroundOverlays( QImage *tileImage, const TileId &id, const CompositionState &state );
+    void paintSunShading( QImage *tileImage, const TileId &id, const CompositionState &state ) const;
+    static void paintTileId( QImage *tileImage, const TileId &id, const QString &themeId );
 
     void detectMaxTileLevel();
     QVector<const GeoSceneTextureTileDataset *> findRelevantTextureLayers( const TileId &stackedTileId ) const;
 
     TileLoader *const m_tileLoader;
     const SunLocator *const m_sunLocator;
+    // shared by the sun shading of the decorator and SunLightBlending
+    SunShadingMask m_sunShadingMask;
     BlendingFactory m_blendingFactory;
     QVector<const GeoSceneTextureTileDataset *> m_textureLayers;
     QList<const GeoDataGroundOverlay *> m_groundOverlays;
@@ -72,7 +107,8 @@ public:
 MergedLayerDecorator::Private::Private( TileLoader *tileLoader, const SunLocator *sunLocator ) :
     m_tileLoader( tileLoader ),
     m_sunLocator( sunLocator ),
-    m_blendingFactory( sunLocator ),
+    m_sunShadingMask( sunLocator ),
+    m_blendingFactory( sunLocator, &m_sunShadingMask ),
     m_textureLayers(),
     m_maxTileLevel( 0 ),
     m_themeId(),
@@ -160,7 +196,7 @@ QSize MergedLayerDecorator::tileSize() const
     return d->m_textureLayers.at( 0 )->tileSize();
 }
 
-StackedTile *MergedLayerDecorator::Private::createTile( const QVector<QSharedPointer<TextureTile> > &tiles ) const
+StackedTile *MergedLayerDecorator::Private::createTile( const QVector<QSharedPointer<TextureTile> > &tiles, const CompositionState &state ) const
 {
     Q_ASSERT( !tiles.isEmpty() );
 
@@ -172,7 +208,7 @@ StackedTile *MergedLayerDecorator::Private::createTile( const QVector<QSharedPoi
 
     // if there are more than one active texture layers, we have to convert the
     // result tile into QImage::Format_ARGB32_Premultiplied to make blending possible
-    const bool withConversion = tiles.count() > 1 || m_showSunShading || m_showTileId || !m_groundOverlays.isEmpty();
+    const bool withConversion = tiles.count() > 1 || state.m_showSunShading || state.m_showTileId || !state.m_groundOverlays.isEmpty();
     foreach ( const QSharedPointer<TextureTile> &tile, tiles ) {
 
         // Image blending. If there are several images in the same tile (like clouds
@@ -199,55 +235,42 @@ StackedTile *MergedLayerDecorator::Private::createTile( const QVector<QSharedPoi
         }
     }
 
-    renderGroundOverlays( &resultImage, tiles );
+    renderGroundOverlays( &resultImage, id, state );
 
-    if ( m_showSunShading && !m_showCityLights ) {
-        paintSunShading( &resultImage, id );
+    if ( state.m_showSunShading && !state.m_showCityLights ) {
+        paintSunShading( &resultImage, id, state );
     }
 
-    if ( m_showTileId ) {
-        paintTileId( &resultImage, id );
+    if ( state.m_showTileId ) {
+        paintTileId( &resultImage, id, state.m_themeId );
     }
 
     return new StackedTile( id, resultImage, tiles );
 }
 
-void MergedLayerDecorator::Private::renderGroundOverlays( QImage *tileImage, const QVector<QSharedPointer<TextureTile> > &tiles ) const
+void MergedLayerDecorator::Private::renderGroundOverlays( QImage *tileImage, const TileId &tileId, const CompositionState &state )
 {
-
-    /* All tiles are covering the same area. Pick one. */
-    const TileId tileId = tiles.first()->id();
-
-    GeoDataLatLonBox tileLatLonBox;
-    findRelevantTextureLayers(tileId).first()->tileProjection()->geoCoordinates(tileId, tileLatLonBox);
+    const GeoDataLatLonBox &tileLatLonBox = state.m_tileLatLonBox;
 
     /* Map the ground overlay to the image. */
-    for ( int i =  0; i < m_groundOverlays.size(); ++i ) {
-
-        const GeoDataGroundOverlay* overlay = m_groundOverlays.at( i );
-        if ( !overlay->isGloballyVisible() ) {
-            continue;
-        }
-
-        const GeoDataLatLonBox overlayLatLonBox = overlay->latLonBox();
+    foreach ( const CompositionState::GroundOverlay &overlay, state.m_groundOverlays ) {
 
-        if ( !tileLatLonBox.intersects( overlayLatLonBox.toCircumscribedRectangle() ) ) {
-            continue;
-        }
+        const GeoDataLatLonBox &overlayLatLonBox = overlay.latLonBox;
+        const QImage &icon = overlay.icon;
 
         const qreal pixelToLat = tileLatLonBox.height() / tileImage->height();
         const qreal pixelToLon = tileLatLonBox.width() / tileImage->width();
 
-        const qreal latToPixel = overlay->icon().height() / overlayLatLonBox.height();
-        const qreal lonToPixel = overlay->icon().width() / overlayLatLonBox.width();
+        const qreal latToPixel = icon.height() / overlayLatLonBox.height();
+        const qreal lonToPixel = icon.width() / overlayLatLonBox.width();
 
         const qreal  global_height = tileImage->height()
-                * TileLoaderHelper::levelToRow( m_levelZeroRows, tileId.zoomLevel() );
+                * TileLoaderHelper::levelToRow( state.m_levelZeroRows, tileId.zoomLevel() );
         const qreal pixel2Rad = M_PI / global_height;
         const qreal rad2Pixel = global_height / M_PI;
 
         qreal latPixelPosition = rad2Pixel/2 * gdInv(tileLatLonBox.north());
-        const bool isMercatorTileProjection = (m_textureLayers.at( 0 )->tileProjectionType() ==  GeoSceneAbstractTileProjection::Mercator);
+        const bool isMercatorTileProjection = state.m_isMercatorTileProjection;
 
         for ( int y = 0; y < tileImage->height(); ++y ) {
              QRgb *scanLine = ( QRgb* ) ( tileImage->scanLine( y ) );
@@ -267,24 +290,24 @@ void MergedLayerDecorator::Private::renderGroundOverlays( QImage *tileImage, con
                  GeoDataCoordinates coords(lon, lat);
                  GeoDataCoordinates rotatedCoords(coords);
 
-                 if (overlay->latLonBox().rotation() != 0) {
+                 if (overlayLatLonBox.rotation() != 0) {
                     // Possible TODO: Make this faster by creating the axisMatrix beforehand
                     // and just call Quaternion::rotateAroundAxis(const matrix &m) here.
-                    rotatedCoords = coords.rotateAround(overlayLatLonBox.center(), -overlay->latLonBox().rotation());
+                    rotatedCoords = coords.rotateAround(overlayLatLonBox.center(), -overlayLatLonBox.rotation());
                  }
 
                  // TODO: The rotated latLonBox is bigger. We need to take this into account.
                  // (Currently the GroundOverlay sometimes gets clipped because of that)
-                 if ( overlay->latLonBox().contains( rotatedCoords ) ) {
+                 if ( overlayLatLonBox.contains( rotatedCoords ) ) {
 
                      qreal px = GeoDataLatLonBox::width( rotatedCoords.longitude(), overlayLatLonBox.west() ) * lonToPixel;
-                     qreal py = (qreal)( overlay->icon().height() ) - ( GeoDataLatLonBox::height( rotatedCoords.latitude(), overlayLatLonBox.south() ) * latToPixel ) - 1;
+                     qreal py = (qreal)( icon.height() ) - ( GeoDataLatLonBox::height( rotatedCoords.latitude(), overlayLatLonBox.south() ) * latToPixel ) - 1;
 
-                     if ( px >= 0 && px < overlay->icon().width() && py >= 0 && py < overlay->icon().height() ) {
-                         int alpha = qAlpha( overlay->icon().pixel( px, py ) );
+                     if ( px >= 0 && px < icon.width() && py >= 0 && py < icon.height() ) {
+                         int alpha = qAlpha( icon.pixel( px, py ) );
                          if ( alpha != 0 )
                          {
-                            QRgb result = ImageF::pixelF( overlay->icon(), px, py );
+                            QRgb result = ImageF::pixelF( icon, px, py );
 
                             if (alpha == 255)
                             {
@@ -305,6 +328,11 @@ void MergedLayerDecorator::Private::renderGroundOverlays( QImage *tileImage, con
 }
 
 StackedTile *MergedLayerDecorator::loadTile( const TileId &stackedTileId )
+{
+    return composeTile( loadTextureTiles( stackedTileId ), compositionState( stackedTileId ) );
+}
+
+QVector<QSharedPointer<TextureTile> > MergedLayerDecorator::loadTextureTiles( const TileId &stackedTileId )
 {
     const QVector<const GeoSceneTextureTileDataset *> textureLayers = d->findRelevantTextureLayers( stackedTileId );
     QVector<QSharedPointer<TextureTile> > tiles;
@@ -331,7 +359,40 @@ StackedTile *MergedLayerDecorator::loadTile( const TileId &stackedTileId )
 
     Q_ASSERT( !tiles.isEmpty() );
 
-    return d->createTile( tiles );
+    return tiles;
+}
+
+QSharedPointer<const MergedLayerDecorator::CompositionState> MergedLayerDecorator::compositionState( const TileId &stackedTileId ) const
+{
+    CompositionState *const state = new CompositionState;
+    state->m_themeId = d->m_themeId;
+    state->m_levelZeroColumns = d->m_levelZeroColumns;
+    state->m_levelZeroRows = d->m_levelZeroRows;
+    state->m_showSunShading = d->m_showSunShading;
+    state->m_showCityLights = d->m_showCityLights;
+    state->m_showTileId = d->m_showTileId;
+
+    const QVector<const GeoSceneTextureTileDataset *> textureLayers = d->findRelevantTextureLayers( stackedTileId );
+    if ( !d->m_groundOverlays.isEmpty() && !textureLayers.isEmpty() ) {
+        textureLayers.first()->tileProjection()->geoCoordinates( stackedTileId, state->m_tileLatLonBox );
+        state->m_isMercatorTileProjection = d->m_textureLayers.at( 0 )->tileProjectionType() == GeoSceneAbstractTileProjection::Mercator;
+
+        foreach ( const GeoDataGroundOverlay *overlay, d->m_groundOverlays ) {
+            if ( overlay->isGloballyVisible() &&
+                 state->m_tileLatLonBox.intersects( overlay->latLonBox().toCircumscribedRectangle() ) ) {
+                const CompositionState::GroundOverlay groundOverlay = { overlay->latLonBox(), overlay->icon() };
+                state->m_groundOverlays.append( groundOverlay );
+            }
+        }
+    }
+
+    return QSharedPointer<const CompositionState>( state );
+}
+
+StackedTile *MergedLayerDecorator::composeTile( const QVector<QSharedPointer<TextureTile> > &tiles,
+                                                const QSharedPointer<const CompositionState> &state ) const
+{
+    return d->createTile( tiles, *state );
 }
 
 RenderState MergedLayerDecorator::renderState( const TileId &stackedTileId ) const
@@ -369,12 +430,18 @@ bool MergedLayerDecorator::hasTextureLayer() const
 }
 
 StackedTile *MergedLayerDecorator::updateTile( const StackedTile &stackedTile, const TileId &tileId, const QImage &tileImage )
+{
+    return composeTile( updateTextureTiles( stackedTile.tiles(), tileId, tileImage ), compositionState( stackedTile.id() ) );
+}
+
+QVector<QSharedPointer<TextureTile> > MergedLayerDecorator::updateTextureTiles( const QVector<QSharedPointer<TextureTile> > &textureTiles,
+                                                                                const TileId &tileId, const QImage &tileImage )
 {
     Q_ASSERT( !tileImage.isNull() );
 
     d->detectMaxTileLevel();
 
-    QVector<QSharedPointer<TextureTile> > tiles = stackedTile.tiles();
+    QVector<QSharedPointer<TextureTile> > tiles = textureTiles;
 
     for ( int i = 0; i < tiles.count(); ++ i) {
         if ( tiles[i]->id() == tileId ) {
@@ -384,7 +451,7 @@ StackedTile *MergedLayerDecorator::updateTile( const StackedTile &stackedTile, c
         }
     }
 
-    return d->createTile( tiles );
+    return tiles;
 }
 
 void MergedLayerDecorator::downloadStackedTile( const TileId &id, DownloadUsage usage )
@@ -398,11 +465,27 @@ void MergedLayerDecorator::downloadStackedTile( const TileId &id, DownloadUsage
     }
 }
 
+void MergedLayerDecorator::prefetchStackedTile( const TileId &id )
+{
+    const QVector<const GeoSceneTextureTileDataset *> textureLayers = d->findRelevantTextureLayers( id );
+
+    foreach ( const GeoSceneTextureTileDataset *textureLayer, textureLayers ) {
+        if ( TileLoader::tileStatus( textureLayer, id ) != TileLoader::Available ) {
+            d->m_tileLoader->downloadTile( textureLayer, id, DownloadBrowse );
+        }
+    }
+}
+
 void MergedLayerDecorator::setShowSunShading( bool show )
 {
     d->m_showSunShading = show;
 }
 
+void MergedLayerDecorator::updateSunShading()
+{
+    d->m_sunShadingMask.invalidate();
+}
+
 bool MergedLayerDecorator::showSunShading() const
 {
     return d->m_showSunShading;
@@ -423,7 +506,7 @@ void MergedLayerDecorator::setShowTileId( bool visible )
     d->m_showTileId = visible;
 }
 
-void MergedLayerDecorator::Private::paintSunShading( QImage *tileImage, const TileId &id ) const
+void MergedLayerDecorator::Private::paintSunShading( QImage *tileImage, const TileId &id, const CompositionState &state ) const
 {
     if ( tileImage->depth() != 32 )
         return;
@@ -431,80 +514,31 @@ void MergedLayerDecorator::Private::paintSunShading( QImage *tileImage, const Ti
     // TODO add support for 8-bit maps?
     // add sun shading
     const qreal  global_width  = tileImage->width()
-            * TileLoaderHelper::levelToColumn( m_levelZeroColumns, id.zoomLevel() );
+            * TileLoaderHelper::levelToColumn( state.m_levelZeroColumns, id.zoomLevel() );
     const qreal  global_height = tileImage->height()
-            * TileLoaderHelper::levelToRow( m_levelZeroRows, id.zoomLevel() );
-    const qreal lon_scale = 2*M_PI / global_width;
-    const qreal lat_scale = -M_PI / global_height;
+            * TileLoaderHelper::levelToRow( state.m_levelZeroRows, id.zoomLevel() );
     const int tileHeight = tileImage->height();
     const int tileWidth = tileImage->width();
 
-    // First we determine the supporting point interval for the interpolation.
-    const int n = maxDivisor( 30, tileWidth );
-    const int ipRight = n * (int)( tileWidth / n );
+    QVector<uchar> brightness( tileWidth );
 
     for ( int cur_y = 0; cur_y < tileHeight; ++cur_y ) {
-        const qreal lat = lat_scale * ( id.y() * tileHeight + cur_y ) - 0.5*M_PI;
-        const qreal a = sin( (lat+DEG2RAD * m_sunLocator->getLat() )/2.0 );
-        const qreal c = cos(lat)*cos( -DEG2RAD * m_sunLocator->getLat() );
+        m_sunShadingMask.brightnessRow( id.x() * tileWidth / global_width, 1.0 / global_width,
+                                        ( id.y() * tileHeight + cur_y ) / global_height,
+                                        tileWidth, brightness.data() );
 
         QRgb* scanline = (QRgb*)tileImage->scanLine( cur_y );
 
-        qreal lastShade = -10.0;
-
-        int cur_x = 0;
-
-        while ( cur_x < tileWidth ) {
-
-            const bool interpolate = ( cur_x != 0 && cur_x < ipRight && cur_x + n < tileWidth );
-
-            qreal shade = 0;
-
-            if ( interpolate ) {
-                const int check = cur_x + n;
-                const qreal checklon   = lon_scale * ( id.x() * tileWidth + check );
-                shade = m_sunLocator->shading( checklon, a, c );
-
-                // if the shading didn't change across the interpolation
-                // interval move on and don't change anything.
-                if ( shade == lastShade && shade == 1.0 ) {
-                    scanline += n;
-                    cur_x += n;
-                    continue;
-                }
-                if ( shade == lastShade && shade == 0.0 ) {
-                    for ( int t = 0; t < n; ++t ) {
-                        m_sunLocator->shadePixel( *scanline, shade );
-                        ++scanline;
-                    }
-                    cur_x += n;
-                    continue;
-                }
-                for ( int t = 0; t < n ; ++t ) {
-                    const qreal lon   = lon_scale * ( id.x() * tileWidth + cur_x );
-                    shade = m_sunLocator->shading( lon, a, c );
-                    m_sunLocator->shadePixel( *scanline, shade );
-                    ++scanline;
-                    ++cur_x;
-                }
+        for ( int cur_x = 0; cur_x < tileWidth; ++cur_x ) {
+            // daylight - no change
+            if ( brightness[cur_x] != 255 ) {
+                m_sunLocator->shadePixel( scanline[cur_x], brightness[cur_x] / 255.0 );
             }
-
-            else {
-                // Make sure we don't exceed the image memory
-                if ( cur_x < tileWidth ) {
-                    const qreal lon   = lon_scale * ( id.x() * tileWidth + cur_x );
-                    shade = m_sunLocator->shading( lon, a, c );
-                    m_sunLocator->shadePixel( *scanline, shade );
-                    ++scanline;
-                    ++cur_x;
-                }
-            }
-            lastShade = shade;
         }
     }
 }
 
-void MergedLayerDecorator::Private::paintTileId( QImage *tileImage, const TileId &id ) const
+void MergedLayerDecorator::Private::paintTileId( QImage *tileImage, const TileId &id, const QString &themeId )
 {
     QString filename = QString( "%1_%2.jpg" )
             .arg(id.x(), tileDigits, 10, QLatin1Char('0'))
@@ -558,7 +592,7 @@ void MergedLayerDecorator::Private::paintTileId( QImage *tileImage, const TileId
 
     QPointF  baseline3( ( tileImage->width() - testFm.boundingRect(filename).width() ) / 2,
                         tileImage->height() * 0.75 );
-    outlinepath.addText( baseline3, testFont, m_themeId );
+    outlinepath.addText( baseline3, testFont, themeId );
 
     painter.drawPath( outlinepath );
 
@@ -602,25 +636,3 @@ QVector<const GeoSceneTextureTileDataset *> MergedLayerDecorator::Private::findR
 
     return result;
 }
-
-// TODO: This should likely go into a math class in the future ...
-
-int MergedLayerDecorator::Private::maxDivisor( int maximum, int fullLength )
-{
-    // Find the optimal interpolation interval n for the
-    // current image canvas width
-    int best = 2;
-
-    int  nEvalMin = fullLength;
-    for ( int it = 1; it <= maximum; ++it ) {
-        // The optimum is the interval which results in the least amount
-        // supporting points taking into account the rest which can't
-        // get used for interpolation.
-        int nEval = fullLength / it + fullLength % it;
-        if ( nEval < nEvalMin ) {
-            nEvalMin = nEval;
-            best = it;
-        }
-    }
-    return best;
-}
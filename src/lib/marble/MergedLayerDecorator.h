@@ -18,6 +18,7 @@
 
 #include <QVector>
 #include <QList>
+#include <QSharedPointer>
 
 #include "GeoSceneTextureTileDataset.h"
 
@@ -31,6 +32,7 @@ namespace Marble
 class GeoDataGroundOverlay;
 class SunLocator;
 class StackedTile;
+class TextureTile;
 class Tile;
 class TileId;
 class TileLoader;
@@ -39,6 +41,8 @@ class RenderState;
 class MergedLayerDecorator
 {
  public:
+    class CompositionState;
+
     MergedLayerDecorator( TileLoader * const tileLoader, const SunLocator* sunLocator );
     virtual ~MergedLayerDecorator();
 
@@ -65,11 +69,53 @@ class MergedLayerDecorator
 
     StackedTile *updateTile( const StackedTile &stackedTile, const TileId &tileId, const QImage &tileImage );
 
+    /**
+     * Loads the images of all texture layers of the stacked tile @p id
+     * without blending them, see composeTile().
+     */
+    QVector<QSharedPointer<TextureTile> > loadTextureTiles( const TileId &id );
+
+    /**
+     * Returns @p tiles with the texture tile @p tileId replaced by
+     * @p tileImage, see composeTile().
+     */
+    QVector<QSharedPointer<TextureTile> > updateTextureTiles( const QVector<QSharedPointer<TextureTile> > &tiles,
+                                                              const TileId &tileId, const QImage &tileImage );
+
+    /**
+     * Copies the settings and ground overlays composeTile() depends on for
+     * the stacked tile @p stackedTileId, so the decorator may be changed
+     * while the tile gets composed. Ground overlay icons get loaded here.
+     */
+    QSharedPointer<const CompositionState> compositionState( const TileId &stackedTileId ) const;
+
+    /**
+     * Blends the texture tiles of a stacked tile into a new stacked tile
+     * according to @p state. This is the expensive part of loading a tile.
+     * Unlike the other methods it may be called from any thread, also
+     * concurrently.
+     */
+    StackedTile *composeTile( const QVector<QSharedPointer<TextureTile> > &tiles,
+                              const QSharedPointer<const CompositionState> &state ) const;
+
     void downloadStackedTile( const TileId &id, DownloadUsage usage );
 
+    /**
+     * Schedules the download of those layers of the stacked tile @p id
+     * that are not available locally yet. Unlike downloadStackedTile(),
+     * available tiles are never downloaded again.
+     */
+    void prefetchStackedTile( const TileId &id );
+
     void setShowSunShading( bool show );
     bool showSunShading() const;
 
+    /**
+     * Makes sure the sun shading gets computed from scratch, e.g. because
+     * the twilight zone changed. Tiles blended before keep their shading.
+     */
+    void updateSunShading();
+
     void setShowCityLights( bool show );
     bool showCityLights() const;
 
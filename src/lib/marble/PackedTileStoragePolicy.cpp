@@ -0,0 +1,125 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+
+// Own
+#include "PackedTileStoragePolicy.h"
+
+// Qt
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+
+// Marble
+#include "MarbleDebug.h"
+#include "MarbleDirs.h"
+#include "MarbleGlobal.h"
+#include "TilePackArchive.h"
+
+using namespace Marble;
+
+PackedTileStoragePolicy::PackedTileStoragePolicy( const QString &dataDirectory, QObject *parent )
+    : FileStoragePolicy( dataDirectory, parent ),
+      m_dataDirectory( dataDirectory )
+{
+    if ( m_dataDirectory.isEmpty() )
+        m_dataDirectory = MarbleDirs::localPath() + QLatin1String("/cache/");
+}
+
+PackedTileStoragePolicy::~PackedTileStoragePolicy()
+{
+}
+
+bool PackedTileStoragePolicy::fileExists( const QString &fileName ) const
+{
+    QString directory;
+    TilePackArchive::Key key;
+    if ( isImageFile( fileName ) && TilePackArchive::parseFileName( fullFileName( fileName ), directory, key ) ) {
+        const TilePackArchive *const archive = TilePackArchive::find( directory );
+        if ( archive && archive->contains( key ) ) {
+            return true;
+        }
+    }
+
+    return FileStoragePolicy::fileExists( fileName );
+}
+
+bool PackedTileStoragePolicy::updateFile( const QString &fileName, const QByteArray &data )
+{
+    QString directory;
+    TilePackArchive::Key key;
+    if ( !isImageFile( fileName ) || !TilePackArchive::parseFileName( fullFileName( fileName ), directory, key ) ) {
+        return FileStoragePolicy::updateFile( fileName, data );
+    }
+
+    TilePackArchive *const archive = TilePackArchive::find( directory );
+    if ( !archive ) {
+        return FileStoragePolicy::updateFile( fileName, data );
+    }
+
+    // the pack files may also shrink if inserting the tile compacts them
+    const qint64 oldSize = archive->size();
+    if ( !archive->insertTile( key, data ) ) {
+        m_errorMsg = archive->lastErrorMessage();
+        qCritical() << "TilePackArchive::insertTile" << m_errorMsg;
+        emit sizeChanged( archive->size() - oldSize );
+        return false;
+    }
+
+    emit sizeChanged( archive->size() - oldSize );
+    return true;
+}
+
+void PackedTileStoragePolicy::clearCache()
+{
+    FileStoragePolicy::clearCache();
+
+    if ( m_dataDirectory.isEmpty() || !m_dataDirectory.endsWith(QLatin1String( "data" )) )
+    {
+        return;
+    }
+
+    const QString cachedMapsDirectory = m_dataDirectory + QLatin1String("/maps");
+
+    QDirIterator it( cachedMapsDirectory, QDir::NoDotAndDotDot | QDir::Dirs );
+    while (it.hasNext()) {
+        it.next();
+        QDirIterator itPlanet( it.filePath(), QDir::NoDotAndDotDot | QDir::Dirs );
+        while (itPlanet.hasNext()) {
+            itPlanet.next();
+            TilePackArchive *const archive = TilePackArchive::find( itPlanet.filePath() );
+            if ( archive ) {
+                emit sizeChanged( -archive->removeTiles( maxBaseTileLevel + 1 ) );
+            }
+        }
+    }
+}
+
+QString PackedTileStoragePolicy::lastErrorMessage() const
+{
+    return m_errorMsg.isEmpty() ? FileStoragePolicy::lastErrorMessage() : m_errorMsg;
+}
+
+QString PackedTileStoragePolicy::fullFileName( const QString &fileName ) const
+{
+    QFileInfo const dirInfo( fileName );
+    return dirInfo.isAbsolute() ? fileName : m_dataDirectory + QLatin1Char('/') + fileName;
+}
+
+bool PackedTileStoragePolicy::isImageFile( const QString &fileName )
+{
+    const QString lowerCase = fileName.toLower();
+    return lowerCase.endsWith( QLatin1String( ".jpg" ) )
+        || lowerCase.endsWith( QLatin1String( ".jpeg" ) )
+        || lowerCase.endsWith( QLatin1String( ".png" ) )
+        || lowerCase.endsWith( QLatin1String( ".gif" ) );
+}
+
+#include "moc_PackedTileStoragePolicy.cpp"
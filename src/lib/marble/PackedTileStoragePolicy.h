@@ -0,0 +1,57 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#ifndef MARBLE_PACKEDTILESTORAGEPOLICY_H
+#define MARBLE_PACKEDTILESTORAGEPOLICY_H
+
+#include "FileStoragePolicy.h"
+
+namespace Marble
+{
+
+/**
+ * @short Storage policy that writes texture tiles into tile pack archives.
+ *
+ * Image tiles of map themes whose cache directory contains a TilePackArchive
+ * are appended to the archive instead of being written as individual files.
+ * All other files, and tiles of themes without an archive, are handled like
+ * in FileStoragePolicy. Existing directory caches can be converted with the
+ * tilepack-import tool, which also enables packed storage for the theme.
+ */
+class PackedTileStoragePolicy : public FileStoragePolicy
+{
+    Q_OBJECT
+
+    public:
+        explicit PackedTileStoragePolicy( const QString &dataDirectory = QString(), QObject *parent = 0 );
+
+        ~PackedTileStoragePolicy();
+
+        bool fileExists( const QString &fileName ) const;
+
+        bool updateFile( const QString &fileName, const QByteArray &data );
+
+        void clearCache();
+
+        QString lastErrorMessage() const;
+
+    private:
+        Q_DISABLE_COPY( PackedTileStoragePolicy )
+
+        QString fullFileName( const QString &fileName ) const;
+        static bool isImageFile( const QString &fileName );
+
+        QString m_dataDirectory;
+        QString m_errorMsg;
+};
+
+}
+
+#endif
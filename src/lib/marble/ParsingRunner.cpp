@@ -13,11 +13,33 @@ namespace Marble
 {
 
 ParsingRunner::ParsingRunner( QObject *parent )
-    : QObject( parent )
+    : QObject( parent ),
+      m_partialResultsEnabled( false ),
+      m_canceled( 0 )
 {
     // nothing to do
 }
 
+void ParsingRunner::setPartialResultsEnabled( bool enabled )
+{
+    m_partialResultsEnabled = enabled;
+}
+
+bool ParsingRunner::partialResultsEnabled() const
+{
+    return m_partialResultsEnabled;
+}
+
+void ParsingRunner::cancel()
+{
+    m_canceled.storeRelease( 1 );
+}
+
+bool ParsingRunner::isCanceled() const
+{
+    return m_canceled.loadAcquire() != 0;
+}
+
 }
 
 #include "moc_ParsingRunner.cpp"
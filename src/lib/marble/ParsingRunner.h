@@ -12,6 +12,7 @@
 #ifndef MARBLE_PARSINGRUNNER_H
 #define MARBLE_PARSINGRUNNER_H
 
+#include <QAtomicInt>
 #include <QObject>
 #include "marble_export.h"
 
@@ -33,6 +34,35 @@ public:
       * plugin capabilities, otherwise MarbleRunnerManager will ignore the plugin
       */
     virtual GeoDataDocument* parseFile( const QString &fileName, DocumentRole role, QString& error ) = 0;
+
+    /**
+      * Allows the runner to deliver large files in parts, see
+      * partialDocumentParsed(). Runners which cannot do so ignore it.
+      * Disabled by default.
+      */
+    void setPartialResultsEnabled( bool enabled );
+    bool partialResultsEnabled() const;
+
+    /**
+      * Asks a running parseFile() to stop early, its result is discarded.
+      * Can be called from any thread. Runners which cannot stop early
+      * ignore it.
+      */
+    void cancel();
+    bool isCanceled() const;
+
+Q_SIGNALS:
+    /**
+      * Emitted from within parseFile() for a part of the file which is ready
+      * before the whole file is parsed, if partial results are enabled. The
+      * document returned by parseFile() then holds the remaining features.
+      * The receiver takes ownership of @p document.
+      */
+    void partialDocumentParsed( GeoDataDocument *document );
+
+private:
+    bool m_partialResultsEnabled;
+    QAtomicInt m_canceled;
 };
 
 }
@@ -17,10 +17,12 @@
 #include "GeoDataPlacemark.h"
 #include "PluginManager.h"
 #include "ParseRunnerPlugin.h"
+#include "ParsingRunner.h"
 #include "RunnerTask.h"
 
 #include <QFileInfo>
 #include <QList>
+#include <QPointer>
 #include <QThreadPool>
 #include <QTimer>
 #include <QMutex>
@@ -45,13 +47,16 @@ public:
     QMutex m_parsingTasksMutex;
     int m_parsingTasks;
     GeoDataDocument *m_fileResult;
+    bool m_partialResultsEnabled;
+    QList<QPointer<ParsingRunner> > m_runners;
 };
 
 ParsingRunnerManager::Private::Private( ParsingRunnerManager *parent, const PluginManager *pluginManager ) :
     q( parent ),
     m_pluginManager( pluginManager ),
     m_parsingTasks(0),
-    m_fileResult( 0 )
+    m_fileResult( 0 ),
+    m_partialResultsEnabled( false )
 {
     qRegisterMetaType<GeoDataDocument*>( "GeoDataDocument*" );
 }
@@ -92,10 +97,14 @@ void ParsingRunnerManager::parseFile( const QString &fileName, DocumentRole role
     const QString completeSuffix = fileInfo.completeSuffix().toLower();
 
     d->m_parsingTasks = 0;
+    d->m_runners.clear();
     foreach( const ParseRunnerPlugin *plugin, plugins ) {
         QStringList const extensions = plugin->fileExtensions();
         if ( extensions.isEmpty() || extensions.contains( suffix ) || extensions.contains( completeSuffix ) ) {
-            ParsingTask *task = new ParsingTask( plugin->newRunner(), this, fileName, role );
+            ParsingRunner *runner = plugin->newRunner();
+            runner->setPartialResultsEnabled( d->m_partialResultsEnabled );
+            d->m_runners << runner;
+            ParsingTask *task = new ParsingTask( runner, this, fileName, role );
             connect( task, SIGNAL(finished()), this, SLOT(cleanupParsingTask()) );
             mDebug() << "parse task " << plugin->nameId() << " " << (quintptr)task;
             ++d->m_parsingTasks;
@@ -123,6 +132,20 @@ GeoDataDocument *ParsingRunnerManager::openFile( const QString &fileName, Docume
     return d->m_fileResult;
 }
 
+void ParsingRunnerManager::setPartialResultsEnabled( bool enabled )
+{
+    d->m_partialResultsEnabled = enabled;
+}
+
+void ParsingRunnerManager::cancel()
+{
+    foreach( const QPointer<ParsingRunner> &runner, d->m_runners ) {
+        if ( runner ) {
+            runner->cancel();
+        }
+    }
+}
+
 void ParsingRunnerManager::Private::addParsingResult(GeoDataDocument *document, const QString &error)
 {
     if ( document || !error.isEmpty() ) {
@@ -48,7 +48,26 @@ public:
     void parseFile( const QString &fileName, DocumentRole role = UserDocument );
     GeoDataDocument *openFile( const QString &fileName, DocumentRole role = UserDocument, int timeout = 30000 );
 
+    /**
+     * Lets runners of subsequent parseFile() calls deliver large files in
+     * parts, see @see partialDocumentParsed. Disabled by default.
+     */
+    void setPartialResultsEnabled( bool enabled );
+
+    /**
+     * Asks the runners of the last parseFile() call to stop. Their results
+     * are discarded, parsingFinished() without arguments is still emitted
+     * once all runners are done.
+     */
+    void cancel();
+
 Q_SIGNALS:
+    /**
+     * A part of the file was parsed. More parts may follow, the rest of the
+     * file is reported by parsingFinished. The receiver takes ownership.
+     */
+    void partialDocumentParsed( GeoDataDocument *document );
+
     /**
      * The file was parsed and potential error message
      */
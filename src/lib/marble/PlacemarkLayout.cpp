@@ -17,8 +17,8 @@
 #include <QPoint>
 #include <QVectorIterator>
 #include <QFont>
-#include <QFontMetrics>
 #include <QItemSelectionModel>
+#include <QElapsedTimer>
 #include <qmath.h>
 
 #include "GeoDataLatLonAltBox.h"
@@ -42,26 +42,12 @@
 #include "MathHelper.h"
 #include <StyleBuilder.h>
 
-namespace
-{   //Helper function that checks for available room for the label
-    bool hasRoomFor(const QVector<Marble::VisiblePlacemark*> & placemarks, const QRectF &labelRect)
-    {
-        // Check if there is another label or symbol that overlaps.
-        QVector<Marble::VisiblePlacemark*>::const_iterator beforeItEnd = placemarks.constEnd();
-        for ( QVector<Marble::VisiblePlacemark*>::ConstIterator beforeIt = placemarks.constBegin();
-              beforeIt != beforeItEnd; ++beforeIt )
-        {
-            if ( labelRect.intersects( (*beforeIt)->labelRect() ) ) {
-                return false;
-            }
-        }
-        return true;
-    }
-}
-
 namespace Marble
 {
 
+// milliseconds spent on laying out new placemarks per frame during animations
+static const qint64 animationTimeBudget = 10;
+
 QSet<GeoDataPlacemark::GeoDataVisualCategory> acceptedVisualCategories()
 {
     QSet<GeoDataPlacemark::GeoDataVisualCategory> visualCategories;
@@ -177,8 +163,9 @@ PlacemarkLayout::PlacemarkLayout( QAbstractItemModel  *placemarkModel,
       m_showLandingSites( false ),
       m_showCraters( false ),
       m_showMaria( false ),
-      m_maxLabelHeight(maxLabelHeight()),
       m_styleResetRequested( true ),
+      m_viewContext( Still ),
+      m_layoutInterrupted( false ),
       m_styleBuilder(styleBuilder)
 {
     Q_ASSERT(m_placemarkModel);
@@ -237,6 +224,16 @@ void PlacemarkLayout::setShowMaria( bool show )
     m_showMaria = show;
 }
 
+void PlacemarkLayout::setViewContext( ViewContext viewContext )
+{
+    m_viewContext = viewContext;
+
+    // complete a layout that was interrupted during the animation
+    if ( m_viewContext == Still && m_layoutInterrupted ) {
+        emit repaintNeeded();
+    }
+}
+
 void PlacemarkLayout::requestStyleReset()
 {
     mDebug() << "Style reset requested.";
@@ -249,7 +246,6 @@ void PlacemarkLayout::styleReset()
     m_labelArea = 0;
     qDeleteAll( m_visiblePlacemarks );
     m_visiblePlacemarks.clear();
-    m_maxLabelHeight = maxLabelHeight();
     m_styleResetRequested = false;
 }
 
@@ -263,7 +259,7 @@ QVector<const GeoDataFeature*> PlacemarkLayout::whichPlacemarkAt( const QPoint&
 
     foreach( VisiblePlacemark* mark, m_paintOrder ) {
         if ( mark->labelRect().contains( curpos )
-             || QRect( mark->symbolPosition(), mark->symbolPixmap().size() ).contains( curpos ) ) {
+             || QRect( mark->symbolPosition(), mark->symbolImage().size() ).contains( curpos ) ) {
             ret.append( mark->placemark() );
         }
     }
@@ -271,12 +267,6 @@ QVector<const GeoDataFeature*> PlacemarkLayout::whichPlacemarkAt( const QPoint&
     return ret;
 }
 
-int PlacemarkLayout::maxLabelHeight() const
-{
-    QFont const standardFont(QStringLiteral("Sans Serif"));
-    return QFontMetrics(standardFont).height();
-}
-
 /// feed an internal QMap of placemarks with TileId as key when model changes
 void PlacemarkLayout::addPlacemarks( const QModelIndex& parent, int first, int last )
 {
@@ -312,6 +302,10 @@ void PlacemarkLayout::removePlacemarks( const QModelIndex& parent, int first, in
 {
     Q_ASSERT( first < m_placemarkModel->rowCount() );
     Q_ASSERT( last < m_placemarkModel->rowCount() );
+
+    // Whole tiles of placemarks get removed at once, so collect them per
+    // cache tile and filter each tile list only once.
+    QHash<TileId, QSet<const GeoDataPlacemark*> > removedPlacemarks;
     for( int i=first; i<=last; ++i ) {
         QModelIndex index = m_placemarkModel->index( i, 0, parent );
         Q_ASSERT( index.isValid() );
@@ -323,7 +317,7 @@ void PlacemarkLayout::removePlacemarks( const QModelIndex& parent, int first, in
 
         int zoomLevel = placemark->zoomLevel();
         TileId key = TileId::fromCoordinates( coordinates, zoomLevel );
-        m_placemarkCache[key].removeAll( placemark );
+        removedPlacemarks[key].insert( placemark );
         if (placemark->hasOsmData()) {
             qint64 const osmId = placemark->osmData().id();
             if (osmId > 0) {
@@ -331,6 +325,24 @@ void PlacemarkLayout::removePlacemarks( const QModelIndex& parent, int first, in
             }
         }
     }
+
+    QHash<TileId, QSet<const GeoDataPlacemark*> >::const_iterator it = removedPlacemarks.constBegin();
+    for ( ; it != removedPlacemarks.constEnd(); ++it ) {
+        QMap<TileId, QList<const GeoDataPlacemark*> >::iterator cached = m_placemarkCache.find( it.key() );
+        if ( cached == m_placemarkCache.end() ) {
+            continue;
+        }
+
+        const QSet<const GeoDataPlacemark*> &placemarks = it.value();
+        QList<const GeoDataPlacemark*> remaining;
+        remaining.reserve( cached.value().size() );
+        foreach ( const GeoDataPlacemark *placemark, cached.value() ) {
+            if ( !placemarks.contains( placemark ) ) {
+                remaining.append( placemark );
+            }
+        }
+        cached.value().swap( remaining );
+    }
     emit repaintNeeded();
 }
 
@@ -403,29 +415,40 @@ QVector<VisiblePlacemark *> PlacemarkLayout::generateLayout( const ViewportParam
     if ( m_placemarkModel->rowCount() <= 0 )
         return QVector<VisiblePlacemark *>();
 
-    if ( m_styleResetRequested ) {
-        styleReset();
+    // Remember the placemarks of the previous frame with their label
+    // rectangles relative to the symbol. They get laid out before the
+    // others, so that they and their labels stay in place while the view
+    // changes. The positions survive a style reset, e.g. after the
+    // selection changed.
+    QHash<const GeoDataPlacemark*, QRectF> previousPlacemarks;
+    previousPlacemarks.reserve( m_paintOrder.size() );
+    foreach ( const VisiblePlacemark *mark, m_paintOrder ) {
+        previousPlacemarks.insert( mark->placemark(), mark->labelRect().translated( -mark->symbolPosition() ) );
     }
 
-    if ( m_maxLabelHeight == 0 ) {
-        return QVector<VisiblePlacemark *>();
+    if ( m_styleResetRequested ) {
+        styleReset();
     }
 
-    const int secnumber = viewport->height() / m_maxLabelHeight + 1;
-    m_rowsection.clear();
-    m_rowsection.resize(secnumber);
+    m_labelGrid.reset( viewport->size() );
 
     m_paintOrder.clear();
     m_labelArea = 0;
+    m_layoutInterrupted = false;
+
+    QElapsedTimer timer;
+    timer.start();
 
     // First handle the selected placemarks as they have the highest priority.
 
     const QModelIndexList selectedIndexes = m_selectionModel->selection().indexes();
+    QSet<const GeoDataPlacemark*> selectedPlacemarks;
 
     for ( int i = 0; i < selectedIndexes.count(); ++i ) {
         const QModelIndex index = selectedIndexes.at( i );
         const GeoDataPlacemark *placemark = dynamic_cast<GeoDataPlacemark*>(qvariant_cast<GeoDataObject*>(index.data( MarblePlacemarkModel::ObjectPointerRole ) ));
         Q_ASSERT(placemark);
+        selectedPlacemarks.insert( placemark );
         const GeoDataCoordinates coordinates = placemarkIconCoordinates( placemark );
 
         if ( !coordinates.isValid() ) {
@@ -442,7 +465,9 @@ QVector<VisiblePlacemark *> PlacemarkLayout::generateLayout( const ViewportParam
                 continue;
             }
 
-        if( layoutPlacemark( placemark, x, y, true) ) {
+        const QHash<const GeoDataPlacemark*, QRectF>::const_iterator previous = previousPlacemarks.constFind( placemark );
+        const QRectF *previousLabelRect = previous != previousPlacemarks.constEnd() ? &previous.value() : 0;
+        if( layoutPlacemark( placemark, x, y, true, previousLabelRect ) ) {
             // Make sure not to draw more placemarks on the screen than
             // specified by placemarksOnScreenLimit().
             if ( placemarksOnScreenLimit( viewport->size() ) )
@@ -453,112 +478,145 @@ QVector<VisiblePlacemark *> PlacemarkLayout::generateLayout( const ViewportParam
 
     // Now handle all other placemarks...
 
-    const QItemSelection selection = m_selectionModel->selection();
-
     QList<const GeoDataPlacemark*> placemarkList;
     foreach ( const TileId &tileId, visibleTiles( viewport ) ) {
         placemarkList += m_placemarkCache.value( tileId );
     }
     qSort(placemarkList.begin(), placemarkList.end(), GeoDataPlacemark::placemarkLayoutOrderCompare);
 
+    // While animating, stop laying out new placemarks once the time budget
+    // is used up. The layout gets completed when the view comes to rest.
+    const qint64 timeBudget = m_viewContext == Animation ? animationTimeBudget : 0;
+
+    // The first pass revalidates the placemarks of the previous frame, the
+    // second one fills the remaining space with the other placemarks.
     auto const viewLatLonAltBox = viewport->viewLatLonAltBox();
-    foreach ( const GeoDataPlacemark *placemark, placemarkList ) {
-        const GeoDataCoordinates coordinates = placemarkIconCoordinates( placemark );
-        if ( !coordinates.isValid() ) {
+    bool limitReached = placemarksOnScreenLimit( viewport->size() );
+    int reused = 0;
+    int candidates = 0;
+    for ( int pass = 0; pass < 2 && !limitReached && !m_layoutInterrupted; ++pass ) {
+        const bool previousPass = pass == 0;
+        if ( previousPass && previousPlacemarks.isEmpty() ) {
             continue;
         }
 
-        int zoomLevel = placemark->zoomLevel();
-        if ( zoomLevel > 18 ) {
-            break;
-        }
-
-        qreal x = 0;
-        qreal y = 0;
-
-        if ( !viewLatLonAltBox.contains( coordinates ) ||
-             ! viewport->screenCoordinates( coordinates, x, y )) {
-                delete m_visiblePlacemarks.take( placemark );
+        for ( int i = 0; i < placemarkList.size(); ++i ) {
+            const GeoDataPlacemark *placemark = placemarkList.at( i );
+            const QHash<const GeoDataPlacemark*, QRectF>::const_iterator previous = previousPlacemarks.constFind( placemark );
+            if ( ( previous != previousPlacemarks.constEnd() ) != previousPass ) {
                 continue;
             }
 
-        if ( !placemark->isGloballyVisible() ) {
-            continue;
-        }
-
-        const GeoDataPlacemark::GeoDataVisualCategory visualCategory = placemark->visualCategory();
-
-        // Skip city marks if we're not showing cities.
-        if ( !m_showCities
-             && visualCategory >= GeoDataPlacemark::SmallCity
-             && visualCategory <= GeoDataPlacemark::Nation )
-            continue;
+            // count the new placemarks only, the kept ones are skipped here
+            if ( !previousPass && timeBudget > 0 && candidates++ % 64 == 0 && timer.elapsed() > timeBudget ) {
+                m_layoutInterrupted = true;
+                break;
+            }
 
-        // Skip terrain marks if we're not showing terrain.
-        if ( !m_showTerrain
-             && visualCategory >= GeoDataPlacemark::Mountain
-             && visualCategory <= GeoDataPlacemark::OtherTerrain )
-            continue;
+            const GeoDataCoordinates coordinates = placemarkIconCoordinates( placemark );
+            if ( !coordinates.isValid() ) {
+                continue;
+            }
 
-        // Skip other places if we're not showing other places.
-        if ( !m_showOtherPlaces
-             && visualCategory >= GeoDataPlacemark::GeographicPole
-             && visualCategory <= GeoDataPlacemark::Observatory )
-            continue;
+            int zoomLevel = placemark->zoomLevel();
+            if ( zoomLevel > 18 ) {
+                break;
+            }
 
-        // Skip landing sites if we're not showing landing sites.
-        if ( !m_showLandingSites
-             && visualCategory >= GeoDataPlacemark::MannedLandingSite
-             && visualCategory <= GeoDataPlacemark::UnmannedHardLandingSite )
-            continue;
+            qreal x = 0;
+            qreal y = 0;
 
-        // Skip craters if we're not showing craters.
-        if ( !m_showCraters
-             && visualCategory == GeoDataPlacemark::Crater )
-            continue;
+            if ( !viewLatLonAltBox.contains( coordinates ) ||
+                 ! viewport->screenCoordinates( coordinates, x, y )) {
+                    delete m_visiblePlacemarks.take( placemark );
+                    continue;
+                }
 
-        // Skip maria if we're not showing maria.
-        if ( !m_showMaria
-             && visualCategory == GeoDataPlacemark::Mare )
-            continue;
+            // We handled selected placemarks already, so we skip them here...
+            if ( !isShown( placemark ) || selectedPlacemarks.contains( placemark ) ) {
+                continue;
+            }
 
-        if ( !m_showPlaces
-             && visualCategory >= GeoDataPlacemark::GeographicPole
-             && visualCategory <= GeoDataPlacemark::Observatory )
-            continue;
+            if( layoutPlacemark( placemark, x, y, false, previousPass ? &previous.value() : 0 ) ) {
+                if ( previousPass ) {
+                    ++reused;
+                }
 
-        // We handled selected placemarks already, so we skip them here...
-        // Assuming that only a small amount of places is selected
-        // we check for the selected state after all other filters
-        bool isSelected = false;
-        foreach ( const QModelIndex &index, selection.indexes() ) {
-            const GeoDataPlacemark *mark = dynamic_cast<GeoDataPlacemark*>(qvariant_cast<GeoDataObject*>(index.data( MarblePlacemarkModel::ObjectPointerRole ) ));
-            if (mark == placemark ) {
-                isSelected = true;
-                break;
+                // Make sure not to draw more placemarks on the screen than
+                // specified by placemarksOnScreenLimit().
+                if ( placemarksOnScreenLimit( viewport->size() ) ) {
+                    limitReached = true;
+                    break;
+                }
             }
         }
-        if ( isSelected )
-            continue;
-
-        if( layoutPlacemark( placemark, x, y, isSelected ) ) {
-            // Make sure not to draw more placemarks on the screen than
-            // specified by placemarksOnScreenLimit().
-            if ( placemarksOnScreenLimit( viewport->size() ) )
-                break;
-        }
     }
 
-    m_runtimeTrace = QStringLiteral("Placemarks: %1 Drawn: %2").arg(placemarkList.count()).arg(m_paintOrder.size());
+    m_runtimeTrace = QStringLiteral("Placemarks: %1 Drawn: %2 Kept: %3%4")
+            .arg(placemarkList.count())
+            .arg(m_paintOrder.size())
+            .arg(reused)
+            .arg(m_layoutInterrupted ? QStringLiteral(" (interrupted)") : QString());
     return m_paintOrder;
 }
 
+bool PlacemarkLayout::isShown( const GeoDataPlacemark *placemark ) const
+{
+    if ( !placemark->isGloballyVisible() ) {
+        return false;
+    }
+
+    const GeoDataPlacemark::GeoDataVisualCategory visualCategory = placemark->visualCategory();
+
+    // Skip city marks if we're not showing cities.
+    if ( !m_showCities
+         && visualCategory >= GeoDataPlacemark::SmallCity
+         && visualCategory <= GeoDataPlacemark::Nation )
+        return false;
+
+    // Skip terrain marks if we're not showing terrain.
+    if ( !m_showTerrain
+         && visualCategory >= GeoDataPlacemark::Mountain
+         && visualCategory <= GeoDataPlacemark::OtherTerrain )
+        return false;
+
+    // Skip other places if we're not showing other places.
+    if ( !m_showOtherPlaces
+         && visualCategory >= GeoDataPlacemark::GeographicPole
+         && visualCategory <= GeoDataPlacemark::Observatory )
+        return false;
+
+    // Skip landing sites if we're not showing landing sites.
+    if ( !m_showLandingSites
+         && visualCategory >= GeoDataPlacemark::MannedLandingSite
+         && visualCategory <= GeoDataPlacemark::UnmannedHardLandingSite )
+        return false;
+
+    // Skip craters if we're not showing craters.
+    if ( !m_showCraters
+         && visualCategory == GeoDataPlacemark::Crater )
+        return false;
+
+    // Skip maria if we're not showing maria.
+    if ( !m_showMaria
+         && visualCategory == GeoDataPlacemark::Mare )
+        return false;
+
+    if ( !m_showPlaces
+         && visualCategory >= GeoDataPlacemark::GeographicPole
+         && visualCategory <= GeoDataPlacemark::Observatory )
+        return false;
+
+    return true;
+}
+
 QString PlacemarkLayout::runtimeTrace() const
 {
     return m_runtimeTrace;
 }
 
-bool PlacemarkLayout::layoutPlacemark( const GeoDataPlacemark *placemark, qreal x, qreal y, bool selected )
+bool PlacemarkLayout::layoutPlacemark( const GeoDataPlacemark *placemark, qreal x, qreal y, bool selected,
+                                       const QRectF *previousLabelRect )
 {
     // Find the corresponding visible placemark
     VisiblePlacemark *mark = m_visiblePlacemarks.value( placemark );
@@ -582,38 +640,42 @@ bool PlacemarkLayout::layoutPlacemark( const GeoDataPlacemark *placemark, qreal
 
     QRectF labelRect;
 
+    QPointF hotSpot = mark->hotSpot();
+    const QPoint symbolPosition( qRound( x - hotSpot.x() ), qRound( y - hotSpot.y() ) );
+
     const QString labelText = placemark->displayName();
     if (!labelText.isEmpty()) {
-        labelRect = roomForLabel(style, x, y, labelText);
+        // Prefer the label position of the previous frame to avoid jumps.
+        // The size is measured again, as the style may have changed since.
+        if ( previousLabelRect && !previousLabelRect->isEmpty() ) {
+            const QRectF previousRect( symbolPosition + previousLabelRect->topLeft(), labelSize( style, labelText ) );
+            if ( m_labelGrid.isFree( previousRect ) ) {
+                labelRect = previousRect;
+            }
+        }
+
+        if ( labelRect.isNull() ) {
+            labelRect = roomForLabel(style, x, y, labelText);
+        }
         if ( labelRect.isNull() ) {
             return false;
         }
     }
 
     // Finally save the label position on the map.
-    QPointF hotSpot = mark->hotSpot();
 
     if( mark->selected() != selected ) {
         mark->setSelected( selected );
     }
-    mark->setSymbolPosition(QPoint(qRound(x - hotSpot.x()),
-                                   qRound(y - hotSpot.y())));
+    mark->setSymbolPosition( symbolPosition );
     mark->setLabelRect( labelRect );
 
     if ( !labelRect.isEmpty() ) {
-        // Add the current placemark to the matching row and its
-        // direct neighbors.
-        int idx = y / m_maxLabelHeight;
-        if ( idx - 1 >= 0 )
-            m_rowsection[ idx - 1 ].append( mark );
-        m_rowsection[ idx ].append( mark );
-        if ( idx + 1 < m_rowsection.size() )
-            m_rowsection[ idx + 1 ].append( mark );
+        m_labelGrid.occupy( labelRect );
     }
 
     m_paintOrder.append( mark );
     m_labelArea += labelRect.width() * labelRect.height();
-    m_maxLabelHeight = qMax(m_maxLabelHeight, qCeil(labelRect.height()));
     return true;
 }
 
@@ -629,23 +691,30 @@ GeoDataCoordinates PlacemarkLayout::placemarkIconCoordinates( const GeoDataPlace
     return GeoDataCoordinates();
 }
 
-QRectF PlacemarkLayout::roomForLabel( const GeoDataStyle::ConstPtr &style,
-                                      const qreal x, const qreal y,
-                                      const QString &labelText ) const
+QSizeF PlacemarkLayout::labelSize( const GeoDataStyle::ConstPtr &style, const QString &labelText )
 {
     QFont labelFont = style->labelStyle().scaledFont();
-    int textHeight = QFontMetrics( labelFont ).height();
+    int textHeight = m_labelGrid.textHeight( labelFont );
 
     int textWidth;
     if ( style->labelStyle().glow() ) {
         labelFont.setWeight( 75 ); // Needed to calculate the correct pixmap size;
-        textWidth = ( QFontMetrics( labelFont ).width( labelText )
+        textWidth = ( m_labelGrid.textWidth( labelFont, labelText )
             + qRound( 2 * s_labelOutlineWidth ) );
     } else {
-        textWidth = ( QFontMetrics( labelFont ).width( labelText ) );
+        textWidth = ( m_labelGrid.textWidth( labelFont, labelText ) );
     }
 
-    const QVector<VisiblePlacemark*> currentsec = m_rowsection.at( y / m_maxLabelHeight );
+    return QSizeF( textWidth, textHeight );
+}
+
+QRectF PlacemarkLayout::roomForLabel( const GeoDataStyle::ConstPtr &style,
+                                      const qreal x, const qreal y,
+                                      const QString &labelText )
+{
+    const QSizeF size = labelSize( style, labelText );
+    const int textWidth = size.width();
+    const int textHeight = size.height();
 
     if ( style->labelStyle().alignment() == GeoDataLabelStyle::Corner ) {
         const int symbolWidth = style->iconStyle().scaledIcon().size().width();
@@ -658,7 +727,7 @@ QRectF PlacemarkLayout::roomForLabel( const GeoDataStyle::ConstPtr &style,
                                               y - textHeight;
             const QRectF labelRect = QRectF( xPos, yPos, textWidth, textHeight );
 
-            if (hasRoomFor(currentsec, labelRect)) {
+            if (m_labelGrid.isFree(labelRect)) {
                 // claim the place immediately if it hasn't been used yet
                 return labelRect;
             }
@@ -666,12 +735,17 @@ QRectF PlacemarkLayout::roomForLabel( const GeoDataStyle::ConstPtr &style,
     }
     else if ( style->labelStyle().alignment() == GeoDataLabelStyle::Center ) {
         int const offsetY = style->iconStyle().scaledIcon().height() / 2.0;
-        QRectF  labelRect( x - textWidth / 2, y - offsetY - textHeight,
-                          textWidth, textHeight );
 
-        if (hasRoomFor(currentsec, labelRect)) {
-            // claim the place immediately if it hasn't been used yet 
-            return labelRect;
+        // Check the positions above and below the symbol
+        for( int i=0; i<2; ++i ) {
+            const qreal yPos = ( i == 0 ) ? y - offsetY - textHeight :
+                                            y + offsetY;
+            const QRectF labelRect( x - textWidth / 2, yPos, textWidth, textHeight );
+
+            if (m_labelGrid.isFree(labelRect)) {
+                // claim the place immediately if it hasn't been used yet
+                return labelRect;
+            }
         }
     }
     else if (style->labelStyle().alignment() == GeoDataLabelStyle::Right)
@@ -689,7 +763,7 @@ QRectF PlacemarkLayout::roomForLabel( const GeoDataStyle::ConstPtr &style,
 
             const QRectF labelRect = QRectF(xPos, yPos, textWidth, textHeight);
 
-            if (hasRoomFor(currentsec, labelRect))
+            if (m_labelGrid.isFree(labelRect))
             {
                 return labelRect;
             }
@@ -24,6 +24,9 @@
 #include <QVector>
 
 #include "GeoDataPlacemark.h"
+#include "LabelGrid.h"
+#include "MarbleGlobal.h"
+#include "marble_export.h"
 #include <GeoDataStyle.h>
 
 class QAbstractItemModel;
@@ -50,7 +53,7 @@ class StyleBuilder;
 
 
 
-class PlacemarkLayout : public QObject
+class MARBLE_EXPORT PlacemarkLayout : public QObject
 {
     Q_OBJECT
 
@@ -81,6 +84,12 @@ class PlacemarkLayout : public QObject
 
     QString runtimeTrace() const;
 
+    /**
+     * Sets the view context. During animations the layout only spends a
+     * limited time on placemarks that were not visible in the previous frame.
+     */
+    void setViewContext( ViewContext viewContext );
+
  public Q_SLOTS:
     // earth
     void setShowPlaces( bool show );
@@ -102,19 +111,21 @@ class PlacemarkLayout : public QObject
     void repaintNeeded();
 
  private:
-    /**
-     * Returns a the maximum height of all possible labels.
-     * WARNING: This is a really slow method as it traverses all placemarks
-     * to check the labelheight.
-     * FIXME: Once a StyleManager that manages all styles has been implemented
-     * just traverse all existing styles.
-     */
-    int maxLabelHeight() const;
-
     void styleReset();
 
     static QSet<TileId> visibleTiles( const ViewportParams *viewport );
-    bool layoutPlacemark( const GeoDataPlacemark *placemark, qreal x, qreal y, bool selected );
+    /**
+     * Lays out @p placemark with its symbol at @p x, @p y. A placemark of the
+     * previous frame passes its label rectangle relative to the symbol as
+     * @p previousLabelRect. Its position is kept if still free.
+     */
+    bool layoutPlacemark( const GeoDataPlacemark *placemark, qreal x, qreal y, bool selected,
+                          const QRectF *previousLabelRect );
+
+    /**
+     * Returns whether @p placemark passes the filters set by setShowPlaces() and friends.
+     */
+    bool isShown( const GeoDataPlacemark *placemark ) const;
 
     /**
      * Returns the coordinates at which an icon should be drawn for the @p placemark.
@@ -123,9 +134,11 @@ class PlacemarkLayout : public QObject
      */
     GeoDataCoordinates placemarkIconCoordinates( const GeoDataPlacemark *placemark ) const;
 
+    QSizeF  labelSize( const GeoDataStyle::ConstPtr &style, const QString &labelText );
+
     QRectF  roomForLabel(const GeoDataStyle::ConstPtr &style,
                          const qreal x, const qreal y,
-                         const QString &labelText ) const;
+                         const QString &labelText );
 
     bool    placemarksOnScreenLimit( const QSize &screenSize ) const;
 
@@ -139,7 +152,7 @@ class PlacemarkLayout : public QObject
     QString m_runtimeTrace;
     int m_labelArea;
     QHash<const GeoDataPlacemark*, VisiblePlacemark*> m_visiblePlacemarks;
-    QVector< QVector< VisiblePlacemark* > >  m_rowsection;
+    LabelGrid m_labelGrid;
 
     /// map providing the list of placemark belonging in TileId as key
     QMap<TileId, QList<const GeoDataPlacemark*> > m_placemarkCache;
@@ -158,8 +171,9 @@ class PlacemarkLayout : public QObject
     bool m_showCraters;
     bool m_showMaria;
 
-    int     m_maxLabelHeight;
     bool    m_styleResetRequested;
+    ViewContext m_viewContext;
+    bool    m_layoutInterrupted;
     const StyleBuilder* m_styleBuilder;
 };
 
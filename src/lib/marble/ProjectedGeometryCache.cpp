@@ -0,0 +1,180 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include "ProjectedGeometryCache.h"
+
+#include "AbstractProjection.h"
+#include "GeoDataCoordinates.h"
+#include "GeoDataLineString.h"
+#include "ViewportParams.h"
+
+#include <QPolygonF>
+
+namespace Marble
+{
+
+ProjectedGeometryCache::Entry::~Entry()
+{
+    qDeleteAll( polygons );
+}
+
+ProjectedGeometryCache::ProjectedGeometryCache( int maximumByteCount ) :
+    m_entries( maximumByteCount ),
+    m_hits( 0 ),
+    m_translations( 0 ),
+    m_misses( 0 )
+{
+}
+
+void ProjectedGeometryCache::screenCoordinates( const GeoDataLineString &lineString, const ViewportParams *viewport,
+                                                QVector<QPolygonF*> &polygons )
+{
+    const ViewportKey key = viewportKey( viewport );
+
+    Entry *entry = m_entries.object( &lineString );
+
+    // the nodes may have been modified in place, or the address may have
+    // been reused by a line string with other nodes
+    if ( entry && ( entry->changeCount != lineString.changeCount()
+                    || entry->size != lineString.size()
+                    || !( entry->latLonAltBox == lineString.latLonAltBox() ) ) ) {
+        m_entries.remove( &lineString );
+        entry = 0;
+    }
+
+    if ( entry ) {
+        const ViewportKey &cached = entry->viewport;
+        const bool sameScale = cached.projection == key.projection
+                            && cached.radius == key.radius
+                            && cached.width == key.width
+                            && cached.height == key.height;
+
+        if ( sameScale && cached.centerLongitude == key.centerLongitude && cached.centerLatitude == key.centerLatitude ) {
+            ++m_hits;
+            copyPolygons( entry, polygons );
+            return;
+        }
+
+        // Cylindrical projections map a pan to a translation of the whole map,
+        // as long as the map does not get repeated horizontally: The repeats
+        // depend on the position of the date line on the screen.
+        if ( sameScale && entry->translatable && isTranslatable( viewport ) ) {
+            const QPointF newOrigin = origin( viewport );
+            const QPointF offset = newOrigin - entry->origin;
+            foreach ( QPolygonF *polygon, entry->polygons ) {
+                polygon->translate( offset );
+            }
+            entry->viewport = key;
+            entry->origin = newOrigin;
+
+            ++m_translations;
+            copyPolygons( entry, polygons );
+            return;
+        }
+    }
+
+    ++m_misses;
+
+    Entry *const newEntry = new Entry;
+    newEntry->viewport = key;
+    newEntry->changeCount = lineString.changeCount();
+    newEntry->size = lineString.size();
+    newEntry->latLonAltBox = lineString.latLonAltBox();
+    newEntry->translatable = isTranslatable( viewport );
+    newEntry->origin = newEntry->translatable ? origin( viewport ) : QPointF();
+    viewport->screenCoordinates( lineString, newEntry->polygons );
+
+    int byteCount = sizeof( Entry );
+    foreach ( const QPolygonF *polygon, newEntry->polygons ) {
+        byteCount += sizeof( QPolygonF ) + polygon->size() * sizeof( QPointF );
+    }
+
+    // insert() deletes entries exceeding the maximum cost right away
+    copyPolygons( newEntry, polygons );
+    m_entries.insert( &lineString, newEntry, byteCount );
+}
+
+void ProjectedGeometryCache::clear()
+{
+    m_entries.clear();
+}
+
+void ProjectedGeometryCache::setMaximumByteCount( int byteCount )
+{
+    m_entries.setMaxCost( byteCount );
+}
+
+int ProjectedGeometryCache::maximumByteCount() const
+{
+    return m_entries.maxCost();
+}
+
+void ProjectedGeometryCache::resetStatistics()
+{
+    m_hits = 0;
+    m_translations = 0;
+    m_misses = 0;
+}
+
+QString ProjectedGeometryCache::runtimeTrace() const
+{
+    const int lookups = m_hits + m_translations + m_misses;
+    const int hitRate = lookups > 0 ? 100 * ( m_hits + m_translations ) / lookups : 0;
+
+    return QStringLiteral( "Projection cache: %1% hits (%2 translated), %3 kB" )
+            .arg( hitRate )
+            .arg( m_translations )
+            .arg( m_entries.totalCost() / 1024 );
+}
+
+ProjectedGeometryCache::ViewportKey ProjectedGeometryCache::viewportKey( const ViewportParams *viewport )
+{
+    const ViewportKey key = {
+        viewport->projection(),
+        viewport->radius(),
+        viewport->width(),
+        viewport->height(),
+        viewport->centerLongitude(),
+        viewport->centerLatitude()
+    };
+
+    return key;
+}
+
+bool ProjectedGeometryCache::isTranslatable( const ViewportParams *viewport )
+{
+    if ( !viewport->currentProjection()->repeatableX() ) {
+        return false;
+    }
+
+    qreal xWest, xEast, y;
+    viewport->screenCoordinates( -M_PI, 0.0, xWest, y );
+    viewport->screenCoordinates( +M_PI, 0.0, xEast, y );
+
+    return xWest <= 0 && xEast >= viewport->width() - 1;
+}
+
+QPointF ProjectedGeometryCache::origin( const ViewportParams *viewport )
+{
+    qreal x, y;
+    viewport->screenCoordinates( 0.0, 0.0, x, y );
+
+    return QPointF( x, y );
+}
+
+void ProjectedGeometryCache::copyPolygons( const Entry *entry, QVector<QPolygonF*> &polygons )
+{
+    polygons.reserve( polygons.size() + entry->polygons.size() );
+    foreach ( const QPolygonF *polygon, entry->polygons ) {
+        polygons.append( new QPolygonF( *polygon ) );
+    }
+}
+
+}
@@ -0,0 +1,111 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#ifndef MARBLE_PROJECTEDGEOMETRYCACHE_H
+#define MARBLE_PROJECTEDGEOMETRYCACHE_H
+
+#include <QCache>
+#include <QPointF>
+#include <QString>
+#include <QVector>
+
+#include "GeoDataLatLonAltBox.h"
+#include "MarbleGlobal.h"
+#include "marble_export.h"
+
+class QPolygonF;
+
+namespace Marble
+{
+
+class GeoDataLineString;
+class ViewportParams;
+
+/**
+ * @short A cache for the screen polygons of line strings.
+ *
+ * Projecting and tessellating geometries is the bulk of the work when
+ * painting vector data, yet most repaints happen for an unchanged viewport,
+ * e.g. because a popup or a float item changed. The cache keeps the screen
+ * polygons of each line string together with the viewport they were
+ * projected for. For cylindrical projections, a viewport that was only
+ * panned reuses them after translating them.
+ *
+ * Line strings are identified by their address, so the cache needs to be
+ * cleared whenever geometries get deleted. Line strings modified in place
+ * get projected again, as their change count differs from the cached one. The total size of the cached
+ * polygons is limited; the least recently used ones are dropped first.
+ */
+class MARBLE_EXPORT ProjectedGeometryCache
+{
+ public:
+    explicit ProjectedGeometryCache( int maximumByteCount = 32 * 1024 * 1024 );
+
+    /**
+     * Appends the screen polygons of @p lineString for @p viewport to
+     * @p polygons, projecting it only if there are no suitable polygons in
+     * the cache. The caller takes ownership of the appended polygons, which
+     * share their points with the cached ones.
+     */
+    void screenCoordinates( const GeoDataLineString &lineString, const ViewportParams *viewport,
+                            QVector<QPolygonF*> &polygons );
+
+    void clear();
+
+    void setMaximumByteCount( int byteCount );
+    int maximumByteCount() const;
+
+    /**
+     * Resets the hit and miss counters, e.g. at the start of a frame.
+     */
+    void resetStatistics();
+
+    QString runtimeTrace() const;
+
+ private:
+    Q_DISABLE_COPY( ProjectedGeometryCache )
+
+    struct ViewportKey
+    {
+        Projection projection;
+        int radius;
+        int width;
+        int height;
+        qreal centerLongitude;
+        qreal centerLatitude;
+    };
+
+    struct Entry
+    {
+        ~Entry();
+
+        ViewportKey viewport;
+        quint32 changeCount;
+        int size;
+        GeoDataLatLonAltBox latLonAltBox;
+        bool translatable;
+        QPointF origin;
+        QVector<QPolygonF*> polygons;
+    };
+
+    static ViewportKey viewportKey( const ViewportParams *viewport );
+    static bool isTranslatable( const ViewportParams *viewport );
+    static QPointF origin( const ViewportParams *viewport );
+    static void copyPolygons( const Entry *entry, QVector<QPolygonF*> &polygons );
+
+    QCache<const GeoDataLineString *, Entry> m_entries;
+    int m_hits;
+    int m_translations;
+    int m_misses;
+};
+
+}
+
+#endif
@@ -87,12 +87,18 @@ ParsingTask::ParsingTask( ParsingRunner *runner, ParsingRunnerManager *manager,
     m_manager(manager)
 {
     connect(this, SIGNAL(parsed(GeoDataDocument*,QString)), m_manager, SLOT(addParsingResult(GeoDataDocument*,QString)));
+    connect(m_runner, SIGNAL(partialDocumentParsed(GeoDataDocument*)), m_manager, SIGNAL(partialDocumentParsed(GeoDataDocument*)));
 }
 
 void ParsingTask::run()
 {
     QString error;
     GeoDataDocument* document = m_runner->parseFile( m_fileName, m_role, error );
+    if ( m_runner->isCanceled() ) {
+        delete document;
+        document = 0;
+        error.clear();
+    }
     emit parsed(document, error);
     m_runner->deleteLater();
     emit finished();
@@ -0,0 +1,494 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include "ScanlineKernels.h"
+
+#include <QAtomicInt>
+#include <QColor>
+
+#include <cmath>
+
+// The vector kernels are compiled for their instruction set only, so the
+// library itself still runs on every x86-64 CPU.
+#if defined( __GNUC__ ) && defined( __x86_64__ )
+#define MARBLE_SCANLINE_KERNELS_X86
+#include <immintrin.h>
+#define MARBLE_TARGET( isa ) __attribute__(( target( isa ) ))
+#endif
+
+namespace Marble
+{
+
+namespace ScanlineKernels
+{
+
+// Number of points that sphericalToLonLat() rotates before converting them
+const int ChunkSize = 64;
+
+static QAtomicInt s_instructionSet( -1 );
+
+static InstructionSet detectInstructionSet()
+{
+#ifdef MARBLE_SCANLINE_KERNELS_X86
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports( "avx2" ) ) {
+        return AVX2;
+    }
+    if ( __builtin_cpu_supports( "sse4.1" ) ) {
+        return SSE41;
+    }
+#endif
+    return Scalar;
+}
+
+InstructionSet supportedInstructionSet()
+{
+    static const InstructionSet supported = detectInstructionSet();
+    return supported;
+}
+
+InstructionSet instructionSet()
+{
+    const int instructionSet = s_instructionSet.load();
+    if ( instructionSet < 0 ) {
+        return supportedInstructionSet();
+    }
+
+    return InstructionSet( instructionSet );
+}
+
+void setInstructionSet( InstructionSet instructionSet )
+{
+    s_instructionSet.store( qMin( instructionSet, supportedInstructionSet() ) );
+}
+
+// Rotation of the points on the sphere. The vector versions evaluate the
+// very same operations in the very same order as the scalar one, and do not
+// use fused multiply-add, so the results are bit-identical.
+
+static void rotateScalar( const matrix &m, qreal qy, qreal qr, const qreal *qx, int count,
+                          qreal *x, qreal *y, qreal *z )
+{
+    for ( int i = 0; i < count; ++i ) {
+        const qreal vx = qx[i];
+        const qreal qr2z = qr - vx * vx;
+        const qreal vz = ( qr2z > 0.0 ) ? sqrt( qr2z ) : 0.0;
+
+        x[i] = m[0][0] * vx + m[1][0] * qy + m[2][0] * vz;
+        y[i] = m[0][1] * vx + m[1][1] * qy + m[2][1] * vz;
+        z[i] = m[0][2] * vx + m[1][2] * qy + m[2][2] * vz;
+    }
+}
+
+#ifdef MARBLE_SCANLINE_KERNELS_X86
+
+MARBLE_TARGET( "sse4.1" )
+static void rotateSSE41( const matrix &m, qreal qy, qreal qr, const qreal *qx, int count,
+                         qreal *x, qreal *y, qreal *z )
+{
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d r = _mm_set1_pd( qr );
+    const __m128d m00 = _mm_set1_pd( m[0][0] );
+    const __m128d m01 = _mm_set1_pd( m[0][1] );
+    const __m128d m02 = _mm_set1_pd( m[0][2] );
+    const __m128d m10y = _mm_set1_pd( m[1][0] * qy );
+    const __m128d m11y = _mm_set1_pd( m[1][1] * qy );
+    const __m128d m12y = _mm_set1_pd( m[1][2] * qy );
+    const __m128d m20 = _mm_set1_pd( m[2][0] );
+    const __m128d m21 = _mm_set1_pd( m[2][1] );
+    const __m128d m22 = _mm_set1_pd( m[2][2] );
+
+    int i = 0;
+    for (; i + 2 <= count; i += 2 ) {
+        const __m128d vx = _mm_loadu_pd( qx + i );
+        // max() returns its second operand for qr2z <= 0, like the scalar version
+        const __m128d vz = _mm_sqrt_pd( _mm_max_pd( _mm_sub_pd( r, _mm_mul_pd( vx, vx ) ), zero ) );
+
+        _mm_storeu_pd( x + i, _mm_add_pd( _mm_add_pd( _mm_mul_pd( m00, vx ), m10y ), _mm_mul_pd( m20, vz ) ) );
+        _mm_storeu_pd( y + i, _mm_add_pd( _mm_add_pd( _mm_mul_pd( m01, vx ), m11y ), _mm_mul_pd( m21, vz ) ) );
+        _mm_storeu_pd( z + i, _mm_add_pd( _mm_add_pd( _mm_mul_pd( m02, vx ), m12y ), _mm_mul_pd( m22, vz ) ) );
+    }
+
+    rotateScalar( m, qy, qr, qx + i, count - i, x + i, y + i, z + i );
+}
+
+MARBLE_TARGET( "avx2" )
+static void rotateAVX2( const matrix &m, qreal qy, qreal qr, const qreal *qx, int count,
+                        qreal *x, qreal *y, qreal *z )
+{
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d r = _mm256_set1_pd( qr );
+    const __m256d m00 = _mm256_set1_pd( m[0][0] );
+    const __m256d m01 = _mm256_set1_pd( m[0][1] );
+    const __m256d m02 = _mm256_set1_pd( m[0][2] );
+    const __m256d m10y = _mm256_set1_pd( m[1][0] * qy );
+    const __m256d m11y = _mm256_set1_pd( m[1][1] * qy );
+    const __m256d m12y = _mm256_set1_pd( m[1][2] * qy );
+    const __m256d m20 = _mm256_set1_pd( m[2][0] );
+    const __m256d m21 = _mm256_set1_pd( m[2][1] );
+    const __m256d m22 = _mm256_set1_pd( m[2][2] );
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4 ) {
+        const __m256d vx = _mm256_loadu_pd( qx + i );
+        const __m256d vz = _mm256_sqrt_pd( _mm256_max_pd( _mm256_sub_pd( r, _mm256_mul_pd( vx, vx ) ), zero ) );
+
+        _mm256_storeu_pd( x + i, _mm256_add_pd( _mm256_add_pd( _mm256_mul_pd( m00, vx ), m10y ), _mm256_mul_pd( m20, vz ) ) );
+        _mm256_storeu_pd( y + i, _mm256_add_pd( _mm256_add_pd( _mm256_mul_pd( m01, vx ), m11y ), _mm256_mul_pd( m21, vz ) ) );
+        _mm256_storeu_pd( z + i, _mm256_add_pd( _mm256_add_pd( _mm256_mul_pd( m02, vx ), m12y ), _mm256_mul_pd( m22, vz ) ) );
+    }
+
+    rotateScalar( m, qy, qr, qx + i, count - i, x + i, y + i, z + i );
+}
+
+#endif
+
+void sphericalToLonLat( const matrix &planetAxisMatrix, qreal qy, qreal qr,
+                        const qreal *qx, int count, qreal *lon, qreal *lat )
+{
+    const InstructionSet set = instructionSet();
+
+    qreal x[ChunkSize];
+    qreal y[ChunkSize];
+    qreal z[ChunkSize];
+
+    for ( int start = 0; start < count; start += ChunkSize ) {
+        const int chunk = qMin( ChunkSize, count - start );
+
+#ifdef MARBLE_SCANLINE_KERNELS_X86
+        if ( set == AVX2 ) {
+            rotateAVX2( planetAxisMatrix, qy, qr, qx + start, chunk, x, y, z );
+        } else if ( set == SSE41 ) {
+            rotateSSE41( planetAxisMatrix, qy, qr, qx + start, chunk, x, y, z );
+        } else
+#endif
+        {
+            Q_UNUSED( set );
+            rotateScalar( planetAxisMatrix, qy, qr, qx + start, chunk, x, y, z );
+        }
+
+        // The same as Quaternion::getSpherical(). The trigonometric functions
+        // are left to the C library, vector approximations would change the
+        // sampled texels.
+        for ( int i = 0; i < chunk; ++i ) {
+            const qreal vy = qBound( -1.0, y[i], 1.0 );
+            lat[start + i] = asin( vy );
+
+            if ( x[i] * x[i] + z[i] * z[i] > 0.00005 ) {
+                lon[start + i] = atan2( x[i], z[i] );
+            } else {
+                lon[start + i] = 0.0;
+            }
+        }
+    }
+}
+
+static void sampleNearestScalar( const uint *bits, int wordsPerLine,
+                                 int posX, int posY, int stepX, int stepY,
+                                 uint *out, int count )
+{
+    for ( int i = 0; i < count; ++i ) {
+        out[i] = bits[( posY >> 7 ) * wordsPerLine + ( posX >> 7 )];
+        posX += stepX;
+        posY += stepY;
+    }
+}
+
+#ifdef MARBLE_SCANLINE_KERNELS_X86
+
+MARBLE_TARGET( "sse4.1" )
+static void sampleNearestSSE41( const uint *bits, int wordsPerLine,
+                                int posX, int posY, int stepX, int stepY,
+                                uint *out, int count )
+{
+    const __m128i lane = _mm_setr_epi32( 0, 1, 2, 3 );
+    const __m128i lineWords = _mm_set1_epi32( wordsPerLine );
+    const __m128i advanceX = _mm_set1_epi32( 4 * stepX );
+    const __m128i advanceY = _mm_set1_epi32( 4 * stepY );
+    __m128i x = _mm_add_epi32( _mm_set1_epi32( posX ), _mm_mullo_epi32( lane, _mm_set1_epi32( stepX ) ) );
+    __m128i y = _mm_add_epi32( _mm_set1_epi32( posY ), _mm_mullo_epi32( lane, _mm_set1_epi32( stepY ) ) );
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4 ) {
+        const __m128i index = _mm_add_epi32( _mm_mullo_epi32( _mm_srai_epi32( y, 7 ), lineWords ),
+                                             _mm_srai_epi32( x, 7 ) );
+        out[i]     = bits[_mm_cvtsi128_si32( index )];
+        out[i + 1] = bits[_mm_extract_epi32( index, 1 )];
+        out[i + 2] = bits[_mm_extract_epi32( index, 2 )];
+        out[i + 3] = bits[_mm_extract_epi32( index, 3 )];
+
+        x = _mm_add_epi32( x, advanceX );
+        y = _mm_add_epi32( y, advanceY );
+    }
+
+    sampleNearestScalar( bits, wordsPerLine, posX + i * stepX, posY + i * stepY, stepX, stepY, out + i, count - i );
+}
+
+MARBLE_TARGET( "avx2" )
+static void sampleNearestAVX2( const uint *bits, int wordsPerLine,
+                               int posX, int posY, int stepX, int stepY,
+                               uint *out, int count )
+{
+    const __m256i lane = _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 );
+    const __m256i lineWords = _mm256_set1_epi32( wordsPerLine );
+    const __m256i advanceX = _mm256_set1_epi32( 8 * stepX );
+    const __m256i advanceY = _mm256_set1_epi32( 8 * stepY );
+    __m256i x = _mm256_add_epi32( _mm256_set1_epi32( posX ), _mm256_mullo_epi32( lane, _mm256_set1_epi32( stepX ) ) );
+    __m256i y = _mm256_add_epi32( _mm256_set1_epi32( posY ), _mm256_mullo_epi32( lane, _mm256_set1_epi32( stepY ) ) );
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8 ) {
+        const __m256i index = _mm256_add_epi32( _mm256_mullo_epi32( _mm256_srai_epi32( y, 7 ), lineWords ),
+                                                _mm256_srai_epi32( x, 7 ) );
+        const __m256i pixels = _mm256_i32gather_epi32( reinterpret_cast<const int *>( bits ), index, 4 );
+        _mm256_storeu_si256( reinterpret_cast<__m256i *>( out + i ), pixels );
+
+        x = _mm256_add_epi32( x, advanceX );
+        y = _mm256_add_epi32( y, advanceY );
+    }
+
+    sampleNearestScalar( bits, wordsPerLine, posX + i * stepX, posY + i * stepY, stepX, stepY, out + i, count - i );
+}
+
+#endif
+
+void sampleNearest( const uint *bits, int wordsPerLine,
+                    int posX, int posY, int stepX, int stepY,
+                    uint *out, int count )
+{
+#ifdef MARBLE_SCANLINE_KERNELS_X86
+    switch ( instructionSet() ) {
+    case AVX2:
+        sampleNearestAVX2( bits, wordsPerLine, posX, posY, stepX, stepY, out, count );
+        return;
+    case SSE41:
+        sampleNearestSSE41( bits, wordsPerLine, posX, posY, stepX, stepY, out, count );
+        return;
+    case Scalar:
+        break;
+    }
+#endif
+
+    sampleNearestScalar( bits, wordsPerLine, posX, posY, stepX, stepY, out, count );
+}
+
+// Bilinear sampling is done in single precision. The vector versions
+// compute the positions as posX + k * stepX like the scalar one, so all
+// instruction sets agree with each other.
+
+static void sampleBilinearScalar( const uint *bits, int wordsPerLine, int width, int height,
+                                  float posX, float posY, float stepX, float stepY,
+                                  int first, uint *out, int count )
+{
+    for ( int k = first; k < first + count; ++k ) {
+        const float x = posX + float( k ) * stepX;
+        const float y = posY + float( k ) * stepY;
+        const int ix = qMin( int( x ), width - 1 );
+        const int iy = qMin( int( y ), height - 1 );
+        const float fx = x - ix;
+        const float fy = y - iy;
+        const int ix1 = qMin( ix + 1, width - 1 );
+        const int iy1 = qMin( iy + 1, height - 1 );
+
+        const uint *const top = bits + iy * wordsPerLine;
+        const uint *const bottom = bits + iy1 * wordsPerLine;
+        const QRgb topLeft = top[ix];
+        const QRgb topRight = top[ix1];
+        const QRgb bottomLeft = bottom[ix];
+        const QRgb bottomRight = bottom[ix1];
+
+        const float left_red   = ( 1.0f - fy ) * qRed  ( topLeft  ) + fy * qRed  ( bottomLeft  );
+        const float left_green = ( 1.0f - fy ) * qGreen( topLeft  ) + fy * qGreen( bottomLeft  );
+        const float left_blue  = ( 1.0f - fy ) * qBlue ( topLeft  ) + fy * qBlue ( bottomLeft  );
+        const float right_red   = ( 1.0f - fy ) * qRed  ( topRight ) + fy * qRed  ( bottomRight );
+        const float right_green = ( 1.0f - fy ) * qGreen( topRight ) + fy * qGreen( bottomRight );
+        const float right_blue  = ( 1.0f - fy ) * qBlue ( topRight ) + fy * qBlue ( bottomRight );
+
+        *out = qRgb( int( ( 1.0f - fx ) * left_red   + fx * right_red   ),
+                     int( ( 1.0f - fx ) * left_green + fx * right_green ),
+                     int( ( 1.0f - fx ) * left_blue  + fx * right_blue  ) );
+        ++out;
+    }
+}
+
+#ifdef MARBLE_SCANLINE_KERNELS_X86
+
+MARBLE_TARGET( "sse4.1" )
+static inline __m128i blendSSE41( __m128i topLeft, __m128i topRight, __m128i bottomLeft, __m128i bottomRight,
+                                  __m128 fx, __m128 fy )
+{
+    const __m128 one = _mm_set1_ps( 1.0f );
+    const __m128 gx = _mm_sub_ps( one, fx );
+    const __m128 gy = _mm_sub_ps( one, fy );
+    const __m128 left = _mm_add_ps( _mm_mul_ps( gy, _mm_cvtepi32_ps( topLeft ) ),
+                                    _mm_mul_ps( fy, _mm_cvtepi32_ps( bottomLeft ) ) );
+    const __m128 right = _mm_add_ps( _mm_mul_ps( gy, _mm_cvtepi32_ps( topRight ) ),
+                                     _mm_mul_ps( fy, _mm_cvtepi32_ps( bottomRight ) ) );
+    return _mm_cvttps_epi32( _mm_add_ps( _mm_mul_ps( gx, left ), _mm_mul_ps( fx, right ) ) );
+}
+
+MARBLE_TARGET( "sse4.1" )
+static void sampleBilinearSSE41( const uint *bits, int wordsPerLine, int width, int height,
+                                 float posX, float posY, float stepX, float stepY,
+                                 uint *out, int count )
+{
+    const __m128 lane = _mm_setr_ps( 0.0f, 1.0f, 2.0f, 3.0f );
+    const __m128i lineWords = _mm_set1_epi32( wordsPerLine );
+    const __m128i maxX = _mm_set1_epi32( width - 1 );
+    const __m128i maxY = _mm_set1_epi32( height - 1 );
+    const __m128i oneI = _mm_set1_epi32( 1 );
+    const __m128i mask = _mm_set1_epi32( 0xff );
+    const __m128i alpha = _mm_set1_epi32( int( 0xff000000 ) );
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4 ) {
+        const __m128 k = _mm_add_ps( lane, _mm_set1_ps( float( i ) ) );
+        const __m128 x = _mm_add_ps( _mm_set1_ps( posX ), _mm_mul_ps( k, _mm_set1_ps( stepX ) ) );
+        const __m128 y = _mm_add_ps( _mm_set1_ps( posY ), _mm_mul_ps( k, _mm_set1_ps( stepY ) ) );
+        const __m128i ix = _mm_min_epi32( _mm_cvttps_epi32( x ), maxX );
+        const __m128i iy = _mm_min_epi32( _mm_cvttps_epi32( y ), maxY );
+        const __m128 fx = _mm_sub_ps( x, _mm_cvtepi32_ps( ix ) );
+        const __m128 fy = _mm_sub_ps( y, _mm_cvtepi32_ps( iy ) );
+        const __m128i ix1 = _mm_min_epi32( _mm_add_epi32( ix, oneI ), maxX );
+        const __m128i iy1 = _mm_min_epi32( _mm_add_epi32( iy, oneI ), maxY );
+
+        const __m128i top = _mm_mullo_epi32( iy, lineWords );
+        const __m128i bottom = _mm_mullo_epi32( iy1, lineWords );
+
+        int topLeftIndex[4], topRightIndex[4], bottomLeftIndex[4], bottomRightIndex[4];
+        _mm_storeu_si128( reinterpret_cast<__m128i *>( topLeftIndex ), _mm_add_epi32( top, ix ) );
+        _mm_storeu_si128( reinterpret_cast<__m128i *>( topRightIndex ), _mm_add_epi32( top, ix1 ) );
+        _mm_storeu_si128( reinterpret_cast<__m128i *>( bottomLeftIndex ), _mm_add_epi32( bottom, ix ) );
+        _mm_storeu_si128( reinterpret_cast<__m128i *>( bottomRightIndex ), _mm_add_epi32( bottom, ix1 ) );
+
+        const __m128i topLeft = _mm_setr_epi32( bits[topLeftIndex[0]], bits[topLeftIndex[1]],
+                                                bits[topLeftIndex[2]], bits[topLeftIndex[3]] );
+        const __m128i topRight = _mm_setr_epi32( bits[topRightIndex[0]], bits[topRightIndex[1]],
+                                                 bits[topRightIndex[2]], bits[topRightIndex[3]] );
+        const __m128i bottomLeft = _mm_setr_epi32( bits[bottomLeftIndex[0]], bits[bottomLeftIndex[1]],
+                                                   bits[bottomLeftIndex[2]], bits[bottomLeftIndex[3]] );
+        const __m128i bottomRight = _mm_setr_epi32( bits[bottomRightIndex[0]], bits[bottomRightIndex[1]],
+                                                    bits[bottomRightIndex[2]], bits[bottomRightIndex[3]] );
+
+        const __m128i red = blendSSE41( _mm_and_si128( _mm_srli_epi32( topLeft, 16 ), mask ),
+                                        _mm_and_si128( _mm_srli_epi32( topRight, 16 ), mask ),
+                                        _mm_and_si128( _mm_srli_epi32( bottomLeft, 16 ), mask ),
+                                        _mm_and_si128( _mm_srli_epi32( bottomRight, 16 ), mask ), fx, fy );
+        const __m128i green = blendSSE41( _mm_and_si128( _mm_srli_epi32( topLeft, 8 ), mask ),
+                                          _mm_and_si128( _mm_srli_epi32( topRight, 8 ), mask ),
+                                          _mm_and_si128( _mm_srli_epi32( bottomLeft, 8 ), mask ),
+                                          _mm_and_si128( _mm_srli_epi32( bottomRight, 8 ), mask ), fx, fy );
+        const __m128i blue = blendSSE41( _mm_and_si128( topLeft, mask ),
+                                         _mm_and_si128( topRight, mask ),
+                                         _mm_and_si128( bottomLeft, mask ),
+                                         _mm_and_si128( bottomRight, mask ), fx, fy );
+
+        const __m128i result = _mm_or_si128( _mm_or_si128( alpha, _mm_slli_epi32( red, 16 ) ),
+                                             _mm_or_si128( _mm_slli_epi32( green, 8 ), blue ) );
+        _mm_storeu_si128( reinterpret_cast<__m128i *>( out + i ), result );
+    }
+
+    sampleBilinearScalar( bits, wordsPerLine, width, height, posX, posY, stepX, stepY, i, out + i, count - i );
+}
+
+MARBLE_TARGET( "avx2" )
+static inline __m256i blendAVX2( __m256i topLeft, __m256i topRight, __m256i bottomLeft, __m256i bottomRight,
+                                 __m256 fx, __m256 fy )
+{
+    const __m256 one = _mm256_set1_ps( 1.0f );
+    const __m256 gx = _mm256_sub_ps( one, fx );
+    const __m256 gy = _mm256_sub_ps( one, fy );
+    const __m256 left = _mm256_add_ps( _mm256_mul_ps( gy, _mm256_cvtepi32_ps( topLeft ) ),
+                                       _mm256_mul_ps( fy, _mm256_cvtepi32_ps( bottomLeft ) ) );
+    const __m256 right = _mm256_add_ps( _mm256_mul_ps( gy, _mm256_cvtepi32_ps( topRight ) ),
+                                        _mm256_mul_ps( fy, _mm256_cvtepi32_ps( bottomRight ) ) );
+    return _mm256_cvttps_epi32( _mm256_add_ps( _mm256_mul_ps( gx, left ), _mm256_mul_ps( fx, right ) ) );
+}
+
+MARBLE_TARGET( "avx2" )
+static void sampleBilinearAVX2( const uint *bits, int wordsPerLine, int width, int height,
+                                float posX, float posY, float stepX, float stepY,
+                                uint *out, int count )
+{
+    const int *const data = reinterpret_cast<const int *>( bits );
+    const __m256 lane = _mm256_setr_ps( 0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f );
+    const __m256i lineWords = _mm256_set1_epi32( wordsPerLine );
+    const __m256i maxX = _mm256_set1_epi32( width - 1 );
+    const __m256i maxY = _mm256_set1_epi32( height - 1 );
+    const __m256i oneI = _mm256_set1_epi32( 1 );
+    const __m256i mask = _mm256_set1_epi32( 0xff );
+    const __m256i alpha = _mm256_set1_epi32( int( 0xff000000 ) );
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8 ) {
+        const __m256 k = _mm256_add_ps( lane, _mm256_set1_ps( float( i ) ) );
+        const __m256 x = _mm256_add_ps( _mm256_set1_ps( posX ), _mm256_mul_ps( k, _mm256_set1_ps( stepX ) ) );
+        const __m256 y = _mm256_add_ps( _mm256_set1_ps( posY ), _mm256_mul_ps( k, _mm256_set1_ps( stepY ) ) );
+        const __m256i ix = _mm256_min_epi32( _mm256_cvttps_epi32( x ), maxX );
+        const __m256i iy = _mm256_min_epi32( _mm256_cvttps_epi32( y ), maxY );
+        const __m256 fx = _mm256_sub_ps( x, _mm256_cvtepi32_ps( ix ) );
+        const __m256 fy = _mm256_sub_ps( y, _mm256_cvtepi32_ps( iy ) );
+        const __m256i ix1 = _mm256_min_epi32( _mm256_add_epi32( ix, oneI ), maxX );
+        const __m256i iy1 = _mm256_min_epi32( _mm256_add_epi32( iy, oneI ), maxY );
+
+        const __m256i top = _mm256_mullo_epi32( iy, lineWords );
+        const __m256i bottom = _mm256_mullo_epi32( iy1, lineWords );
+
+        const __m256i topLeft = _mm256_i32gather_epi32( data, _mm256_add_epi32( top, ix ), 4 );
+        const __m256i topRight = _mm256_i32gather_epi32( data, _mm256_add_epi32( top, ix1 ), 4 );
+        const __m256i bottomLeft = _mm256_i32gather_epi32( data, _mm256_add_epi32( bottom, ix ), 4 );
+        const __m256i bottomRight = _mm256_i32gather_epi32( data, _mm256_add_epi32( bottom, ix1 ), 4 );
+
+        const __m256i red = blendAVX2( _mm256_and_si256( _mm256_srli_epi32( topLeft, 16 ), mask ),
+                                       _mm256_and_si256( _mm256_srli_epi32( topRight, 16 ), mask ),
+                                       _mm256_and_si256( _mm256_srli_epi32( bottomLeft, 16 ), mask ),
+                                       _mm256_and_si256( _mm256_srli_epi32( bottomRight, 16 ), mask ), fx, fy );
+        const __m256i green = blendAVX2( _mm256_and_si256( _mm256_srli_epi32( topLeft, 8 ), mask ),
+                                         _mm256_and_si256( _mm256_srli_epi32( topRight, 8 ), mask ),
+                                         _mm256_and_si256( _mm256_srli_epi32( bottomLeft, 8 ), mask ),
+                                         _mm256_and_si256( _mm256_srli_epi32( bottomRight, 8 ), mask ), fx, fy );
+        const __m256i blue = blendAVX2( _mm256_and_si256( topLeft, mask ),
+                                        _mm256_and_si256( topRight, mask ),
+                                        _mm256_and_si256( bottomLeft, mask ),
+                                        _mm256_and_si256( bottomRight, mask ), fx, fy );
+
+        const __m256i result = _mm256_or_si256( _mm256_or_si256( alpha, _mm256_slli_epi32( red, 16 ) ),
+                                                _mm256_or_si256( _mm256_slli_epi32( green, 8 ), blue ) );
+        _mm256_storeu_si256( reinterpret_cast<__m256i *>( out + i ), result );
+    }
+
+    sampleBilinearScalar( bits, wordsPerLine, width, height, posX, posY, stepX, stepY, i, out + i, count - i );
+}
+
+#endif
+
+void sampleBilinear( const uint *bits, int wordsPerLine, int width, int height,
+                     qreal posX, qreal posY, qreal stepX, qreal stepY,
+                     uint *out, int count )
+{
+#ifdef MARBLE_SCANLINE_KERNELS_X86
+    switch ( instructionSet() ) {
+    case AVX2:
+        sampleBilinearAVX2( bits, wordsPerLine, width, height, posX, posY, stepX, stepY, out, count );
+        return;
+    case SSE41:
+        sampleBilinearSSE41( bits, wordsPerLine, width, height, posX, posY, stepX, stepY, out, count );
+        return;
+    case Scalar:
+        break;
+    }
+#endif
+
+    sampleBilinearScalar( bits, wordsPerLine, width, height, posX, posY, stepX, stepY, 0, out, count );
+}
+
+}
+
+}
@@ -0,0 +1,86 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#ifndef MARBLE_SCANLINEKERNELS_H
+#define MARBLE_SCANLINEKERNELS_H
+
+#include "Quaternion.h"
+#include "marble_export.h"
+
+namespace Marble
+{
+
+/**
+ * @short Vectorized inner loops of the scanline texture mappers.
+ *
+ * Each kernel processes a run of pixels of a scanline at once. The kernels
+ * are implemented for AVX2, SSE4.1 and plain C++; the fastest variant that
+ * is supported by the CPU is selected at runtime.
+ *
+ * sphericalToLonLat() and sampleNearest() produce bit-identical results for
+ * all instruction sets, sampleBilinear() may differ by rounding.
+ */
+namespace ScanlineKernels
+{
+    enum InstructionSet {
+        Scalar,
+        SSE41,
+        AVX2
+    };
+
+    /**
+     * Returns the best instruction set supported by the CPU.
+     */
+    MARBLE_EXPORT InstructionSet supportedInstructionSet();
+
+    /**
+     * Returns the instruction set currently used by the kernels.
+     */
+    MARBLE_EXPORT InstructionSet instructionSet();
+
+    /**
+     * Restricts the kernels to @p instructionSet. Instruction sets not
+     * supported by the CPU fall back to the best supported one.
+     */
+    MARBLE_EXPORT void setInstructionSet( InstructionSet instructionSet );
+
+    /**
+     * Converts @p count points (qx[i], qy, sqrt(qr - qx[i]^2)) on the unit
+     * sphere to geographic coordinates after rotating them by
+     * @p planetAxisMatrix, as Quaternion::rotateAroundAxis() followed by
+     * Quaternion::getSpherical() does.
+     */
+    MARBLE_EXPORT void sphericalToLonLat( const matrix &planetAxisMatrix, qreal qy, qreal qr,
+                                          const qreal *qx, int count, qreal *lon, qreal *lat );
+
+    /**
+     * Writes @p count pixels of the 32 bit image @p bits sampled along a line
+     * in 25.7 fixed point coordinates, starting at (@p posX, @p posY) and
+     * advancing by (@p stepX, @p stepY) per pixel. All positions must be
+     * inside the image.
+     */
+    MARBLE_EXPORT void sampleNearest( const uint *bits, int wordsPerLine,
+                                      int posX, int posY, int stepX, int stepY,
+                                      uint *out, int count );
+
+    /**
+     * Writes @p count bilinearly interpolated opaque pixels of the 32 bit
+     * image @p bits of size @p width x @p height sampled along a line starting
+     * at (@p posX, @p posY) and advancing by (@p stepX, @p stepY) per pixel.
+     * All positions must be inside the image.
+     */
+    MARBLE_EXPORT void sampleBilinear( const uint *bits, int wordsPerLine, int width, int height,
+                                       qreal posX, qreal posY, qreal stepX, qreal stepY,
+                                       uint *out, int count );
+}
+
+}
+
+#endif
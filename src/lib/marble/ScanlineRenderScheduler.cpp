@@ -0,0 +1,222 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include "ScanlineRenderScheduler.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+
+namespace Marble
+{
+
+// The number of chunks per thread, more chunks balance the load better
+// but increase the scheduling overhead
+const int CHUNKS_PER_THREAD = 16;
+
+struct ScanlineRenderScheduler::Queue
+{
+    Queue() : next( 0 ), end( 0 ) {}
+
+    QMutex mutex;
+    int next;
+    int end;
+};
+
+class ScanlineRenderScheduler::Worker : public QRunnable
+{
+public:
+    Worker( ScanlineRenderScheduler *scheduler, int index );
+
+    virtual void run();
+
+private:
+    ScanlineRenderScheduler *const m_scheduler;
+    const int m_index;
+};
+
+ScanlineRenderScheduler::Worker::Worker( ScanlineRenderScheduler *scheduler, int index )
+    : m_scheduler( scheduler ),
+      m_index( index )
+{
+}
+
+void ScanlineRenderScheduler::Worker::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    Job *const job = m_scheduler->m_jobs.at( m_index );
+    int chunk;
+    while ( m_scheduler->takeChunk( m_index, chunk ) ) {
+        m_scheduler->renderChunk( job, chunk );
+    }
+
+    // each worker writes its own entry only, waitForDone() reads them later
+    m_scheduler->m_busyTime[m_index] = timer.nsecsElapsed();
+}
+
+ScanlineRenderScheduler::Job::~Job()
+{
+}
+
+ScanlineRenderScheduler::ScanlineRenderScheduler()
+    : m_threadPool(),
+      m_stealCount( 0 ),
+      m_yTop( 0 ),
+      m_yBottom( 0 ),
+      m_chunkRows( 1 ),
+      m_chunkCount( 0 ),
+      m_utilization( 1.0 ),
+      m_lastStealCount( 0 )
+{
+}
+
+ScanlineRenderScheduler::~ScanlineRenderScheduler()
+{
+    waitForDone();
+    qDeleteAll( m_queues );
+}
+
+int ScanlineRenderScheduler::threadCount() const
+{
+    return m_threadPool.maxThreadCount();
+}
+
+void ScanlineRenderScheduler::start( const QVector<Job *> &jobs, int yTop, int yBottom, int rowAlignment )
+{
+    Q_ASSERT( m_jobs.isEmpty() && "waitForDone() must be called before the next frame" );
+    Q_ASSERT( rowAlignment > 0 );
+
+    m_frameTimer.start();
+    m_jobs = jobs;
+    m_stealCount.store( 0 );
+
+    const int workerCount = m_jobs.size();
+    const int rows = qMax( 0, yBottom - yTop );
+    if ( workerCount == 0 || rows == 0 ) {
+        m_chunkCount = 0;
+        return;
+    }
+
+    m_yTop = yTop;
+    m_yBottom = yBottom;
+    m_chunkRows = qMax( 1, rows / ( workerCount * CHUNKS_PER_THREAD ) );
+    m_chunkRows = ( ( m_chunkRows + rowAlignment - 1 ) / rowAlignment ) * rowAlignment;
+    m_chunkCount = ( rows + m_chunkRows - 1 ) / m_chunkRows;
+
+    while ( m_queues.size() < workerCount ) {
+        m_queues.append( new Queue );
+    }
+    m_busyTime.fill( 0, workerCount );
+
+    // every worker starts with a contiguous range of chunks
+    for ( int i = 0; i < workerCount; ++i ) {
+        m_queues[i]->next = i * m_chunkCount / workerCount;
+        m_queues[i]->end = ( i + 1 ) * m_chunkCount / workerCount;
+    }
+
+    for ( int i = 0; i < workerCount; ++i ) {
+        m_threadPool.start( new Worker( this, i ) );
+    }
+}
+
+void ScanlineRenderScheduler::waitForDone()
+{
+    if ( m_jobs.isEmpty() ) {
+        return;
+    }
+
+    m_threadPool.waitForDone();
+
+    const qint64 frameTime = m_frameTimer.nsecsElapsed();
+    qint64 busyTime = 0;
+    for ( int i = 0; i < m_jobs.size() && m_chunkCount > 0; ++i ) {
+        busyTime += m_busyTime[i];
+    }
+
+    m_utilization = ( frameTime > 0 && m_chunkCount > 0 ) ? qreal( busyTime ) / ( qreal( frameTime ) * m_jobs.size() )
+                                                          : 1.0;
+    m_lastStealCount = m_stealCount.load();
+
+    qDeleteAll( m_jobs );
+    m_jobs.clear();
+}
+
+qreal ScanlineRenderScheduler::utilization() const
+{
+    return m_utilization;
+}
+
+int ScanlineRenderScheduler::stealCount() const
+{
+    return m_lastStealCount;
+}
+
+QString ScanlineRenderScheduler::runtimeTrace() const
+{
+    return QStringLiteral( "Rows: %1 chunks, %2 steals, %3% utilization " )
+            .arg( m_chunkCount )
+            .arg( m_lastStealCount )
+            .arg( qRound( 100 * m_utilization ) );
+}
+
+bool ScanlineRenderScheduler::takeChunk( int worker, int &chunk )
+{
+    Queue *const own = m_queues.at( worker );
+
+    {
+        QMutexLocker locker( &own->mutex );
+        if ( own->next < own->end ) {
+            chunk = own->next++;
+            return true;
+        }
+    }
+
+    const int workerCount = m_jobs.size();
+    for ( int i = 1; i < workerCount; ++i ) {
+        Queue *const victim = m_queues.at( ( worker + i ) % workerCount );
+
+        int first;
+        int last;
+        {
+            QMutexLocker locker( &victim->mutex );
+            const int remaining = victim->end - victim->next;
+            if ( remaining <= 0 ) {
+                continue;
+            }
+
+            // steal the back half, so both threads keep working on adjacent rows
+            first = victim->end - ( remaining + 1 ) / 2;
+            last = victim->end;
+            victim->end = first;
+        }
+
+        m_stealCount.ref();
+
+        QMutexLocker locker( &own->mutex );
+        own->next = first + 1;
+        own->end = last;
+        chunk = first;
+        return true;
+    }
+
+    return false;
+}
+
+void ScanlineRenderScheduler::renderChunk( Job *job, int chunk )
+{
+    const int yTop = m_yTop + chunk * m_chunkRows;
+    const int yBottom = qMin( m_yBottom, yTop + m_chunkRows );
+
+    job->renderRows( yTop, yBottom );
+}
+
+}
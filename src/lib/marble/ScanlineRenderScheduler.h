@@ -0,0 +1,108 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#ifndef MARBLE_SCANLINERENDERSCHEDULER_H
+#define MARBLE_SCANLINERENDERSCHEDULER_H
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+
+namespace Marble
+{
+
+/**
+ * @short Distributes the rows of a scanline texture mapper among threads.
+ *
+ * The rows to render are split into small chunks. Each thread starts on its
+ * own contiguous range of chunks, so it mostly stays on the same tiles, and
+ * steals half of the remaining chunks of another thread once its own range
+ * is done. This keeps all threads busy even though rows near the horizon or
+ * the poles are much more expensive than others.
+ */
+class ScanlineRenderScheduler
+{
+ public:
+    /**
+     * Renders rows of the canvas. Each job is used by a single thread only.
+     */
+    class Job
+    {
+     public:
+        virtual ~Job();
+
+        /**
+         * Renders the rows [@p yTop, @p yBottom) of the canvas.
+         */
+        virtual void renderRows( int yTop, int yBottom ) = 0;
+    };
+
+    ScanlineRenderScheduler();
+    ~ScanlineRenderScheduler();
+
+    /**
+     * Returns the number of jobs start() should be called with.
+     */
+    int threadCount() const;
+
+    /**
+     * Starts rendering the rows [@p yTop, @p yBottom) with @p jobs, each of
+     * them running in a thread of its own. Chunks start at multiples of
+     * @p rowAlignment rows below @p yTop. Takes ownership of the jobs.
+     */
+    void start( const QVector<Job *> &jobs, int yTop, int yBottom, int rowAlignment = 1 );
+
+    /**
+     * Waits until all rows are rendered and deletes the jobs.
+     */
+    void waitForDone();
+
+    /**
+     * Returns the share of the time the threads spent rendering rows
+     * during the last frame.
+     */
+    qreal utilization() const;
+
+    /**
+     * Returns the number of chunks stolen from other threads during the
+     * last frame.
+     */
+    int stealCount() const;
+
+    QString runtimeTrace() const;
+
+ private:
+    Q_DISABLE_COPY( ScanlineRenderScheduler )
+
+    class Worker;
+    struct Queue;
+
+    bool takeChunk( int worker, int &chunk );
+    void renderChunk( Job *job, int chunk );
+
+    QThreadPool m_threadPool;
+    QVector<Queue *> m_queues;
+    QVector<Job *> m_jobs;
+    QVector<qint64> m_busyTime;
+    QElapsedTimer m_frameTimer;
+    QAtomicInt m_stealCount;
+    int m_yTop;
+    int m_yBottom;
+    int m_chunkRows;
+    int m_chunkCount;
+    qreal m_utilization;
+    int m_lastStealCount;
+};
+
+}
+
+#endif
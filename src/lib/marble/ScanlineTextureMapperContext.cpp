@@ -14,6 +14,7 @@
 #include <QImage>
 
 #include "MarbleDebug.h"
+#include "ScanlineKernels.h"
 #include "StackedTile.h"
 #include "StackedTileLoader.h"
 #include "TileId.h"
@@ -22,7 +23,37 @@
 
 using namespace Marble;
 
-ScanlineTextureMapperContext::ScanlineTextureMapperContext( StackedTileLoader * const tileLoader, int tileLevel )
+ScanlineTextureMapperContext::Statistics::Statistics()
+    : m_tileSwitches( 0 ),
+      m_tileLoads( 0 )
+{
+}
+
+void ScanlineTextureMapperContext::Statistics::reset()
+{
+    m_tileSwitches.store( 0 );
+    m_tileLoads.store( 0 );
+}
+
+int ScanlineTextureMapperContext::Statistics::tileSwitches() const
+{
+    return m_tileSwitches.load();
+}
+
+int ScanlineTextureMapperContext::Statistics::tileLoads() const
+{
+    return m_tileLoads.load();
+}
+
+QString ScanlineTextureMapperContext::Statistics::runtimeTrace() const
+{
+    return QStringLiteral( "Tiles: %1 switches, %2 lookups " )
+            .arg( tileSwitches() )
+            .arg( tileLoads() );
+}
+
+ScanlineTextureMapperContext::ScanlineTextureMapperContext( StackedTileLoader * const tileLoader, int tileLevel,
+                                                            Statistics *statistics )
     : m_tileLoader( tileLoader ),
       m_textureProjection(tileLoader->tileProjectionType()),  // cache texture projection
       m_tileSize( tileLoader->tileSize() ),  // cache tile size
@@ -39,8 +70,28 @@ ScanlineTextureMapperContext::ScanlineTextureMapperContext( StackedTileLoader *
       m_prevLat( 0.0 ),
       m_prevLon( 0.0 ),
       m_prevPixelX( 0.0 ),
-      m_prevPixelY( 0.0 )
+      m_prevPixelY( 0.0 ),
+      m_statistics( statistics ),
+      m_tileSwitches( 0 ),
+      m_tileLoads( 0 ),
+      m_rowLat( 4 * M_PI ),     // no valid latitude
+      m_rowPixelY( 0.0 ),
+      m_interpolationStep( 1 ),
+      m_interpolationStepInverse( 1.0 )
 {
+    for ( int i = 0; i < TileGridSize * TileGridSize; ++i ) {
+        m_tileGrid[i].tileCol = -1;
+        m_tileGrid[i].tileRow = -1;
+        m_tileGrid[i].tile = 0;
+    }
+}
+
+ScanlineTextureMapperContext::~ScanlineTextureMapperContext()
+{
+    if ( m_statistics ) {
+        m_statistics->m_tileSwitches.fetchAndAddRelaxed( m_tileSwitches );
+        m_statistics->m_tileLoads.fetchAndAddRelaxed( m_tileLoads );
+    }
 }
 
 void ScanlineTextureMapperContext::pixelValueF( const qreal lon, const qreal lat,
@@ -54,7 +105,7 @@ void ScanlineTextureMapperContext::pixelValueF( const qreal lon, const qreal lat
     // coordinate on the current tile.
 
     m_prevPixelX = rad2PixelX( lon );
-    m_prevPixelY = rad2PixelY( lat );
+    m_prevPixelY = rowRad2PixelY( lat );
 
     qreal posX = m_toTileCoordinatesLon + m_prevPixelX;
     qreal posY = m_toTileCoordinatesLat + m_prevPixelY;
@@ -92,7 +143,7 @@ void ScanlineTextureMapperContext::pixelValue( const qreal lon, const qreal lat,
     // coordinate on the current tile.
 
     m_prevPixelX = rad2PixelX( lon );
-    m_prevPixelY = rad2PixelY( lat );
+    m_prevPixelY = rowRad2PixelY( lat );
     int iPosX = (int)( m_toTileCoordinatesLon + m_prevPixelX );
     int iPosY = (int)( m_toTileCoordinatesLat + m_prevPixelY );
 
@@ -140,11 +191,11 @@ void ScanlineTextureMapperContext::pixelValueApproxF( const qreal lon, const qre
     // As long as the distance is smaller than 180 deg we can assume that 
     // we didn't cross the dateline.
 
-    const qreal nInverse = 1.0 / (qreal)(n);
+    const qreal nInverse = inverseInterpolationStep( n );
 
     if ( fabs(stepLon) < M_PI ) {
         const qreal itStepLon = ( rad2PixelX( lon ) - m_prevPixelX ) * nInverse;
-        const qreal itStepLat = ( rad2PixelY( lat ) - m_prevPixelY ) * nInverse;
+        const qreal itStepLat = ( rowRad2PixelY( lat ) - m_prevPixelY ) * nInverse;
 
         // To improve speed we unroll 
         // AbstractScanlineTextureMapper::pixelValue(...) here and 
@@ -167,7 +218,19 @@ void ScanlineTextureMapperContext::pixelValueApproxF( const qreal lon, const qre
 
         const bool alwaysCheckTileRange =
                 isOutOfTileRangeF( itLon, itLat, itStepLon, itStepLat, n );
-        
+
+        // Let the vectorized kernel interpolate all pixels if they are on
+        // the current 32 bit tile
+        if ( !alwaysCheckTileRange && m_tile->depth() == 32
+             && ScanlineKernels::instructionSet() != ScanlineKernels::Scalar ) {
+            const QImage *const image = m_tile->resultImage();
+            ScanlineKernels::sampleBilinear( reinterpret_cast<const uint *>( image->constBits() ),
+                                             image->bytesPerLine() / 4, image->width(), image->height(),
+                                             itLon + itStepLon, itLat + itStepLat, itStepLon, itStepLat,
+                                             scanLine, n - 1 );
+            return;
+        }
+
         for ( int j=1; j < n; ++j ) {
             qreal posX = itLon + itStepLon * j;
             qreal posY = itLat + itStepLat * j;
@@ -278,11 +341,11 @@ void ScanlineTextureMapperContext::pixelValueApprox( const qreal lon, const qrea
     // As long as the distance is smaller than 180 deg we can assume that 
     // we didn't cross the dateline.
 
-    const qreal nInverse = 1.0 / (qreal)(n);
+    const qreal nInverse = inverseInterpolationStep( n );
 
     if ( fabs(stepLon) < M_PI ) {
         const int itStepLon = (int)( ( rad2PixelX( lon ) - m_prevPixelX ) * nInverse * 128.0 );
-        const int itStepLat = (int)( ( rad2PixelY( lat ) - m_prevPixelY ) * nInverse * 128.0 );
+        const int itStepLat = (int)( ( rowRad2PixelY( lat ) - m_prevPixelY ) * nInverse * 128.0 );
 
         // To improve speed we unroll 
         // AbstractScanlineTextureMapper::pixelValue(...) here and 
@@ -297,7 +360,14 @@ void ScanlineTextureMapperContext::pixelValueApprox( const qreal lon, const qrea
         const bool alwaysCheckTileRange =
                 isOutOfTileRange( itLon, itLat, itStepLon, itStepLat, n );
                                   
-        if ( !alwaysCheckTileRange ) {
+        if ( !alwaysCheckTileRange && m_tile->depth() == 32 ) {
+            const QImage *const image = m_tile->resultImage();
+            ScanlineKernels::sampleNearest( reinterpret_cast<const uint *>( image->constBits() ),
+                                            image->bytesPerLine() / 4,
+                                            itLon + itStepLon, itLat + itStepLat, itStepLon, itStepLat,
+                                            scanLine, n - 1 );
+        }
+        else if ( !alwaysCheckTileRange ) {
             int iPosXf = itLon;
             int iPosYf = itLat;
             for ( int j = 1; j < n; ++j ) {
@@ -426,6 +496,56 @@ QImage::Format ScanlineTextureMapperContext::optimalCanvasImageFormat( const Vie
     return imageFormat;
 }
 
+void ScanlineTextureMapperContext::scrollCanvas( QImage *canvasImage, int dx, int dy )
+{
+    const int width = canvasImage->width();
+    const int height = canvasImage->height();
+    if ( qAbs( dx ) >= width || qAbs( dy ) >= height ) {
+        return;
+    }
+
+    const int pixelByteSize = canvasImage->depth() / 8;
+    const int rowBytes = ( width - qAbs( dx ) ) * pixelByteSize;
+    const int srcX = ( dx < 0 ) ? -dx : 0;
+    const int dstX = ( dx > 0 ) ? dx : 0;
+
+    // Process the rows in the direction that doesn't overwrite rows which
+    // still need to be moved
+    if ( dy > 0 ) {
+        for ( int y = height - 1; y >= dy; --y ) {
+            memmove( canvasImage->scanLine( y ) + dstX * pixelByteSize,
+                     canvasImage->constScanLine( y - dy ) + srcX * pixelByteSize,
+                     rowBytes );
+        }
+    }
+    else {
+        for ( int y = 0; y < height + dy; ++y ) {
+            memmove( canvasImage->scanLine( y ) + dstX * pixelByteSize,
+                     canvasImage->constScanLine( y - dy ) + srcX * pixelByteSize,
+                     rowBytes );
+        }
+    }
+}
+
+void ScanlineTextureMapperContext::clearRows( QImage *canvasImage, int yBegin, int yEnd )
+{
+    if ( yBegin >= yEnd ) {
+        return;
+    }
+
+    QRgb * const itClearBegin = (QRgb*)( canvasImage->scanLine( yBegin ) );
+    QRgb * const itClearEnd = (QRgb*)( canvasImage->scanLine( yEnd - 1 ) ) + canvasImage->width();
+
+    for ( QRgb * it = itClearBegin; it < itClearEnd; ++it ) {
+        *(it) = 0;
+    }
+}
+
+
+const StackedTile *ScanlineTextureMapperContext::loadTile( int tileCol, int tileRow )
+{
+    return m_tileLoader->loadTile( TileId( 0, m_tileLevel, tileCol, tileRow ) );
+}
 
 void ScanlineTextureMapperContext::nextTile( int &posX, int &posY )
 {
@@ -450,7 +570,7 @@ void ScanlineTextureMapperContext::nextTile( int &posX, int &posY )
     const int tileCol = lon / m_tileSize.width();
     const int tileRow = lat / m_tileSize.height();
 
-    m_tile = m_tileLoader->loadTile( TileId( 0, m_tileLevel, tileCol, tileRow ) );
+    m_tile = tileAt( tileCol, tileRow );
 
     // Update position variables:
     // m_tilePosX/Y stores the position of the tiles in 
@@ -489,7 +609,7 @@ void ScanlineTextureMapperContext::nextTile( qreal &posX, qreal &posY )
     const int tileCol = lon / m_tileSize.width();
     const int tileRow = lat / m_tileSize.height();
 
-    m_tile = m_tileLoader->loadTile( TileId( 0, m_tileLevel, tileCol, tileRow ) );
+    m_tile = tileAt( tileCol, tileRow );
 
     // Update position variables:
     // m_tilePosX/Y stores the position of the tiles in 
@@ -12,8 +12,10 @@
 #ifndef MARBLE_SCANLINETEXTUREMAPPERCONTEXT_H
 #define MARBLE_SCANLINETEXTUREMAPPERCONTEXT_H
 
+#include <QAtomicInt>
 #include <QSize>
 #include <QImage>
+#include <QString>
 
 #include "GeoSceneTileDataset.h"
 #include "MarbleMath.h"
@@ -30,7 +32,33 @@ class ViewportParams;
 class ScanlineTextureMapperContext
 {
 public:
-    ScanlineTextureMapperContext( StackedTileLoader * const tileLoader, int tileLevel );
+    /**
+     * Counts the tile switches of all contexts used to map a frame.
+     */
+    class Statistics
+    {
+    public:
+        Statistics();
+
+        void reset();
+
+        /// the number of times the mapping moved on to another tile
+        int tileSwitches() const;
+        /// the number of tiles requested from the tile loader
+        int tileLoads() const;
+
+        QString runtimeTrace() const;
+
+    private:
+        friend class ScanlineTextureMapperContext;
+
+        QAtomicInt m_tileSwitches;
+        QAtomicInt m_tileLoads;
+    };
+
+    ScanlineTextureMapperContext( StackedTileLoader * const tileLoader, int tileLevel,
+                                  Statistics *statistics = 0 );
+    ~ScanlineTextureMapperContext();
 
     void pixelValueF( const qreal lon, const qreal lat,
                       QRgb* const scanLine );
@@ -46,10 +74,23 @@ public:
 
     static QImage::Format optimalCanvasImageFormat( const ViewportParams *viewport );
 
+    /**
+     * Moves the content of @p canvasImage by (@p dx, @p dy) pixels. The
+     * exposed parts keep their previous content and need to be mapped again.
+     */
+    static void scrollCanvas( QImage *canvasImage, int dx, int dy );
+
+    /**
+     * Clears the rows [@p yBegin, @p yEnd) of @p canvasImage.
+     */
+    static void clearRows( QImage *canvasImage, int yBegin, int yEnd );
+
     int globalWidth() const;
     int globalHeight() const;
 
 private:
+    Q_DISABLE_COPY( ScanlineTextureMapperContext )
+
     // method for fast integer calculation
     void nextTile( int& posx, int& posy );
 
@@ -61,6 +102,17 @@ private:
     qreal rad2PixelX( const qreal lon ) const;
     qreal rad2PixelY( const qreal lat ) const;
 
+    // Same as rad2PixelY(), but remembers the result for the current
+    // scanline, where the latitude usually stays the same
+    qreal rowRad2PixelY( const qreal lat );
+
+    // Returns the tile at the given position of the current tile level
+    const StackedTile *tileAt( int tileCol, int tileRow );
+    const StackedTile *loadTile( int tileCol, int tileRow );
+
+    // Returns 1 / n, computed once per interpolation step
+    qreal inverseInterpolationStep( int n );
+
     // Checks whether the pixelValueApprox method will make use of more than
     // one tile
     bool isOutOfTileRange( const int itLon, const int itLat,
@@ -103,6 +155,32 @@ private:
     qreal  m_prevLon;
     qreal  m_prevPixelX;
     qreal  m_prevPixelY;
+
+    // Direct mapped grid of the tiles used during this frame, so moving
+    // on to another tile doesn't need to hash a TileId in the tile loader.
+    // The tiles stay valid until StackedTileLoader::cleanupTilehash().
+    struct TileGridEntry
+    {
+        int tileCol;
+        int tileRow;
+        const StackedTile *tile;
+    };
+
+    enum { TileGridSize = 32 };
+
+    TileGridEntry m_tileGrid[TileGridSize * TileGridSize];
+
+    Statistics *const m_statistics;
+    int m_tileSwitches;
+    int m_tileLoads;
+
+    // Per scanline lookup of the texture row
+    qreal  m_rowLat;
+    qreal  m_rowPixelY;
+
+    // Interpolation step and its inverse
+    int    m_interpolationStep;
+    qreal  m_interpolationStepInverse;
 };
 
 inline int ScanlineTextureMapperContext::globalWidth() const
@@ -115,6 +193,41 @@ inline int ScanlineTextureMapperContext::globalHeight() const
     return m_globalHeight;
 }
 
+inline qreal ScanlineTextureMapperContext::rowRad2PixelY( const qreal lat )
+{
+    if ( lat != m_rowLat ) {
+        m_rowLat = lat;
+        m_rowPixelY = rad2PixelY( lat );
+    }
+
+    return m_rowPixelY;
+}
+
+inline const StackedTile *ScanlineTextureMapperContext::tileAt( int tileCol, int tileRow )
+{
+    ++m_tileSwitches;
+
+    TileGridEntry &entry = m_tileGrid[ ( tileRow % TileGridSize ) * TileGridSize + tileCol % TileGridSize ];
+    if ( entry.tileCol != tileCol || entry.tileRow != tileRow ) {
+        entry.tileCol = tileCol;
+        entry.tileRow = tileRow;
+        entry.tile = loadTile( tileCol, tileRow );
+        ++m_tileLoads;
+    }
+
+    return entry.tile;
+}
+
+inline qreal ScanlineTextureMapperContext::inverseInterpolationStep( int n )
+{
+    if ( n != m_interpolationStep ) {
+        m_interpolationStep = n;
+        m_interpolationStepInverse = 1.0 / (qreal)( n );
+    }
+
+    return m_interpolationStepInverse;
+}
+
 inline qreal ScanlineTextureMapperContext::rad2PixelX( const qreal lon ) const
 {
     return lon * m_normGlobalWidth;
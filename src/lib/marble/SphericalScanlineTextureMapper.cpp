@@ -15,7 +15,7 @@
 #include <cmath>
 
 #include <qmath.h>
-#include <QRunnable>
+#include <QVector>
 
 #include "MarbleGlobal.h"
 #include "GeoPainter.h"
@@ -23,6 +23,7 @@
 #include "GeoDataDocument.h"
 #include "MarbleDebug.h"
 #include "Quaternion.h"
+#include "ScanlineKernels.h"
 #include "ScanlineTextureMapperContext.h"
 #include "StackedTileLoader.h"
 #include "StackedTile.h"
@@ -33,31 +34,41 @@
 
 using namespace Marble;
 
-class SphericalScanlineTextureMapper::RenderJob : public QRunnable
+class SphericalScanlineTextureMapper::RenderJob : public ScanlineRenderScheduler::Job
 {
 public:
-    RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, int yTop, int yBottom );
+    RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality,
+               ScanlineTextureMapperContext::Statistics *statistics );
 
-    virtual void run();
+    virtual void renderRows( int yTop, int yBottom );
 
 private:
-    StackedTileLoader *const m_tileLoader;
-    const int m_tileLevel;
     QImage *const m_canvasImage;
     const ViewportParams *const m_viewport;
     const MapQuality m_mapQuality;
-    int const m_yTop;
-    int const m_yBottom;
+    ScanlineTextureMapperContext m_context;
+
+    // The pixels of a scanline whose position gets evaluated exactly, and
+    // whether the pixels in front of them get interpolated. The positions
+    // are converted to lon/lat in one go by the vectorized kernel.
+    QVector<int>   m_evalX;
+    QVector<bool>  m_evalInterpolate;
+    QVector<qreal> m_evalQx;
+    QVector<qreal> m_evalLon;
+    QVector<qreal> m_evalLat;
 };
 
-SphericalScanlineTextureMapper::RenderJob::RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, int yTop, int yBottom )
-    : m_tileLoader( tileLoader ),
-      m_tileLevel( tileLevel ),
-      m_canvasImage( canvasImage ),
+SphericalScanlineTextureMapper::RenderJob::RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality,
+                                                      ScanlineTextureMapperContext::Statistics *statistics )
+    : m_canvasImage( canvasImage ),
       m_viewport( viewport ),
       m_mapQuality( mapQuality ),
-      m_yTop( yTop ),
-      m_yBottom( yBottom )
+      m_context( tileLoader, tileLevel, statistics ),
+      m_evalX( canvasImage->width() + 1 ),
+      m_evalInterpolate( canvasImage->width() + 1 ),
+      m_evalQx( canvasImage->width() + 1 ),
+      m_evalLon( canvasImage->width() + 1 ),
+      m_evalLat( canvasImage->width() + 1 )
 {
 }
 
@@ -65,7 +76,7 @@ SphericalScanlineTextureMapper::SphericalScanlineTextureMapper( StackedTileLoade
     : TextureMapperInterface()
     , m_tileLoader( tileLoader )
     , m_radius( 0 )
-    , m_threadPool()
+    , m_scheduler()
 {
 }
 
@@ -108,10 +119,16 @@ void SphericalScanlineTextureMapper::mapTexture( GeoPainter *painter,
     painter->drawImage( rect, m_canvasImage, rect );
 }
 
+QString SphericalScanlineTextureMapper::runtimeTrace() const
+{
+    return m_scheduler.runtimeTrace() + m_statistics.runtimeTrace();
+}
+
 void SphericalScanlineTextureMapper::mapTexture( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality )
 {
     // Reset backend
     m_tileLoader->resetTilehash();
+    m_statistics.reset();
 
     // Initialize needed constants:
 
@@ -126,21 +143,19 @@ void SphericalScanlineTextureMapper::mapTexture( const ViewportParams *viewport,
     const int yBottom = ( yTop == 0 ) ? imageHeight - skip
                                       : yTop + radius + radius - skip;
 
-    const int numThreads = m_threadPool.maxThreadCount();
-    const int yStep = qCeil(qreal( yBottom - yTop ) / qreal(numThreads));
-    for ( int i = 0; i < numThreads; ++i ) {
-        const int yStart = yTop +  i      * yStep;
-        const int yEnd   = qMin(yBottom, yTop + (i + 1) * yStep);
-        QRunnable *const job = new RenderJob( m_tileLoader, tileZoomLevel, &m_canvasImage, viewport, mapQuality, yStart, yEnd );
-        m_threadPool.start( job );
+    QVector<ScanlineRenderScheduler::Job *> jobs;
+    for ( int i = 0; i < m_scheduler.threadCount(); ++i ) {
+        jobs << new RenderJob( m_tileLoader, tileZoomLevel, &m_canvasImage, viewport, mapQuality, &m_statistics );
     }
 
-    m_threadPool.waitForDone();
+    // keep pairs of interlaced rows together
+    m_scheduler.start( jobs, yTop, yBottom, skip + 1 );
+    m_scheduler.waitForDone();
 
     m_tileLoader->cleanupTilehash();
 }
 
-void SphericalScanlineTextureMapper::RenderJob::run()
+void SphericalScanlineTextureMapper::RenderJob::renderRows( int yTop, int yBottom )
 {
     const int imageHeight = m_canvasImage->height();
     const int imageWidth  = m_canvasImage->width();
@@ -165,14 +180,8 @@ void SphericalScanlineTextureMapper::RenderJob::run()
     matrix  planetAxisMatrix;
     m_viewport->planetAxis().toMatrix( planetAxisMatrix );
 
-    // initialize needed variables that are modified during texture mapping:
-
-    ScanlineTextureMapperContext context( m_tileLoader, m_tileLevel );
-    qreal  lon = 0.0;
-    qreal  lat = 0.0;
-
     // Scanline based algorithm to texture map a sphere
-    for ( int y = m_yTop; y < m_yBottom ; ++y ) {
+    for ( int y = yTop; y < yBottom ; ++y ) {
 
         // Evaluate coordinates for the 3D position vector of the current pixel
         const qreal qy = inverseRadius * (qreal)( imageHeight / 2 - y );
@@ -217,6 +226,7 @@ void SphericalScanlineTextureMapper::RenderJob::run()
         }
 
         int ncount = 0;
+        int evalCount = 0;
 
         for ( int x = xLeft; x < xRight; ++x ) {
             // Prepare for interpolation
@@ -246,25 +256,29 @@ void SphericalScanlineTextureMapper::RenderJob::run()
 
             // Evaluate more coordinates for the 3D position vector of
             // the current pixel.
-            const qreal qx = (qreal)( x - imageWidth / 2 ) * inverseRadius;
-            const qreal qr2z = qr - qx * qx;
-            const qreal qz = ( qr2z > 0.0 ) ? sqrt( qr2z ) : 0.0;
+            m_evalX[evalCount] = x;
+            m_evalInterpolate[evalCount] = interpolate;
+            m_evalQx[evalCount] = (qreal)( x - imageWidth / 2 ) * inverseRadius;
+            ++evalCount;
+        }
 
-            // Create Quaternion from vector coordinates and rotate it
-            // around globe axis
-            Quaternion qpos( 0.0, qx, qy, qz );
-            qpos.rotateAroundAxis( planetAxisMatrix );
+        // Rotate the 3D position vectors around the globe axis and convert
+        // them to lon/lat
+        ScanlineKernels::sphericalToLonLat( planetAxisMatrix, qy, qr, m_evalQx.constData(), evalCount,
+                                            m_evalLon.data(), m_evalLat.data() );
 
-            qpos.getSpherical( lon, lat );
+        for ( int i = 0; i < evalCount; ++i ) {
+            const qreal lon = m_evalLon[i];
+            const qreal lat = m_evalLat[i];
 //            mDebug() << QString("lon: %1 lat: %2").arg(lon).arg(lat);
             // Approx for n-1 out of n pixels within the boundary of
             // xIpLeft to xIpRight
 
-            if ( interpolate ) {
+            if ( m_evalInterpolate[i] ) {
                 if (highQuality)
-                    context.pixelValueApproxF( lon, lat, scanLine, n );
+                    m_context.pixelValueApproxF( lon, lat, scanLine, n );
                 else
-                    context.pixelValueApprox( lon, lat, scanLine, n );
+                    m_context.pixelValueApprox( lon, lat, scanLine, n );
 
                 scanLine += ( n - 1 );
             }
@@ -276,18 +290,18 @@ void SphericalScanlineTextureMapper::RenderJob::run()
 //          rendering around north pole:
 
 //            if ( !crossingPoleArea )
-            if ( x < imageWidth ) {
+            if ( m_evalX[i] < imageWidth ) {
                 if ( highQuality )
-                    context.pixelValueF( lon, lat, scanLine );
+                    m_context.pixelValueF( lon, lat, scanLine );
                 else
-                    context.pixelValue( lon, lat, scanLine );
+                    m_context.pixelValue( lon, lat, scanLine );
             }
 
             ++scanLine;
         }
 
         // copy scanline to improve performance
-        if ( interlaced && y + 1 < m_yBottom ) { 
+        if ( interlaced && y + 1 < yBottom ) { 
 
             const int pixelByteSize = m_canvasImage->bytesPerLine() / imageWidth;
 
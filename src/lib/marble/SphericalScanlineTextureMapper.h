@@ -14,10 +14,11 @@
 
 
 #include "TextureMapperInterface.h"
+#include "ScanlineRenderScheduler.h"
+#include "ScanlineTextureMapperContext.h"
 
 #include "MarbleGlobal.h"
 
-#include <QThreadPool>
 #include <QImage>
 
 
@@ -47,6 +48,8 @@ class SphericalScanlineTextureMapper : public TextureMapperInterface
                              const QRect &dirtyRect,
                              TextureColorizer *texColorizer );
 
+    virtual QString runtimeTrace() const;
+
  private:
     void mapTexture( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality );
 
@@ -55,7 +58,8 @@ class SphericalScanlineTextureMapper : public TextureMapperInterface
     StackedTileLoader *const m_tileLoader;
     int m_radius;
     QImage m_canvasImage;
-    QThreadPool m_threadPool;
+    ScanlineRenderScheduler m_scheduler;
+    ScanlineTextureMapperContext::Statistics m_statistics;
 };
 
 }
@@ -24,37 +24,386 @@
 
 #include "StackedTileLoader.h"
 
+#include "CompactStackedTile.h"
 #include "MarbleDebug.h"
 #include "MergedLayerDecorator.h"
 #include "StackedTile.h"
+#include "TextureTile.h"
+#include "TileCompositionJob.h"
+#include "TileCompressionJob.h"
 #include "TileLoader.h"
 #include "TileLoaderHelper.h"
 #include "MarbleGlobal.h"
 
-#include <QCache>
 #include <QHash>
 #include <QReadWriteLock>
 #include <QImage>
+#include <QPair>
+#include <QRect>
+#include <QSet>
+#include <QThreadPool>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <algorithm>
+#include <climits>
 
 
 namespace Marble
 {
 
+// Weights for choosing the cached tiles to evict: one frame without use
+// counts like this fraction of a tile distance from the viewport center ...
+const qreal EVICTION_AGE_WEIGHT = 0.1;
+// ... and a tile at the neighbouring tile level counts like this many tiles
+const qreal EVICTION_LEVEL_WEIGHT = 4.0;
+
 class StackedTileLoaderPrivate
 {
 public:
+    // A cached tile is kept either as it is or compacted. Tiles to be
+    // compacted are kept as they are until their compression job finished,
+    // and count towards the cache size with their uncompressed size meanwhile.
+    struct CacheEntry
+    {
+        StackedTile *tile;
+        CompactStackedTile *compactTile;
+        quint64 lastUsed;
+        quint64 serial;
+        bool compressing;
+    };
+
     explicit StackedTileLoaderPrivate( MergedLayerDecorator *mergedLayerDecorator )
-        : m_layerDecorator( mergedLayerDecorator )
+        : m_layerDecorator( mergedLayerDecorator ),
+          m_cacheLimit( 20000 * 1024 ), // Cache size measured in bytes
+          m_cacheSize( 0 ),
+          m_cacheCompression( NoTileCacheCompression ),
+          m_frame( 0 ),
+          m_viewLevel( -1 ),
+          m_viewCenterX( 0 ),
+          m_viewCenterY( 0 ),
+          m_prefetchLevel( -1 ),
+          m_cacheHits( 0 ),
+          m_cacheMisses( 0 ),
+          m_evictions( 0 ),
+          m_compositionGeneration( 0 ),
+          m_cacheSerial( 0 )
     {
-        m_tileCache.setMaxCost( 20000 * 1024 ); // Cache size measured in bytes
+        // compression is not urgent, leave the other cores to rendering
+        m_compressionPool.setMaxThreadCount( 1 );
     }
 
+    void insertIntoCache( StackedTileLoader *q, const TileId &id, StackedTile *tile );
+    bool takeFromCache( const TileId &id, CacheEntry *entry );
+    void removeFromCache( const TileId &id );
+    void clearCache();
+    void trimCache();
+    qreal evictionScore( const TileId &id, const CacheEntry &entry ) const;
+    static quint64 byteCount( const CacheEntry &entry );
+    static void deleteTile( const CacheEntry &entry );
+
+    void updateViewport();
+    void prefetchTiles();
+    void prefetchTile( int level, int x, int y );
+
+    void startComposition( StackedTileLoader *q, const TileId &stackedTileId );
+    QVector<QSharedPointer<TextureTile> > latestTextureTiles( const TileId &stackedTileId, const StackedTile *displayedTile ) const;
+
     MergedLayerDecorator *const m_layerDecorator;
     QHash <TileId, StackedTile*>  m_tilesOnDisplay;
-    QCache <TileId, StackedTile>  m_tileCache;
+    QHash <TileId, CacheEntry>  m_tileCache;
+    quint64 m_cacheLimit;
+    quint64 m_cacheSize;
+    TileCacheCompression m_cacheCompression;
+    quint64 m_frame;
+
+    // tile level and center (in tiles of that level) of the last frame
+    int m_viewLevel;
+    qreal m_viewCenterX;
+    qreal m_viewCenterY;
+    QRect m_viewRect;
+
+    int m_prefetchLevel;
+    QRect m_prefetchRect;
+
+    quint64 m_cacheHits;
+    quint64 m_cacheMisses;
+    quint64 m_evictions;
+
     QReadWriteLock m_cacheLock;
+
+    // stacked tiles being blended by some thread in loadTile(), the other
+    // threads wait for them instead of blending them once more
+    QSet<TileId> m_tilesInComposition;
+    QWaitCondition m_compositionFinished;
+
+    // Updated tiles get blended in the background. Further updates of a tile
+    // that is being composed are collected until the composition finished.
+    QThreadPool m_compositionPool;
+    QSet<TileCompositionJob *> m_compositionJobs;
+    QHash<TileId, QVector<QSharedPointer<TextureTile> > > m_tilesInUpdate;
+    QHash<TileId, QVector<QSharedPointer<TextureTile> > > m_pendingUpdates;
+    int m_compositionGeneration;
+
+    // cached tiles get compressed in the background
+    QThreadPool m_compressionPool;
+    QSet<TileCompressionJob *> m_compressionJobs;
+    quint64 m_cacheSerial;
 };
 
+void StackedTileLoaderPrivate::insertIntoCache( StackedTileLoader *q, const TileId &id, StackedTile *tile )
+{
+    const CacheEntry entry = { tile, 0, m_frame, ++m_cacheSerial, m_cacheCompression != NoTileCacheCompression };
+
+    if ( byteCount( entry ) > m_cacheLimit ) {
+        // the cache is too small to store the tile at all
+        deleteTile( entry );
+        ++m_evictions;
+        return;
+    }
+
+    m_tileCache.insert( id, entry );
+    m_cacheSize += byteCount( entry );
+
+    if ( entry.compressing ) {
+        TileCompressionJob *const job = new TileCompressionJob( id, *tile->resultImage(), tile->tiles(),
+                                                                m_cacheCompression, entry.serial );
+        QObject::connect( job, SIGNAL(tileCompressed(TileCompressionJob*)),
+                          q, SLOT(updateCompressedTile(TileCompressionJob*)), Qt::QueuedConnection );
+        m_compressionJobs.insert( job );
+        m_compressionPool.start( job );
+    }
+}
+
+bool StackedTileLoaderPrivate::takeFromCache( const TileId &id, CacheEntry *entry )
+{
+    QHash<TileId, CacheEntry>::iterator it = m_tileCache.find( id );
+    if ( it == m_tileCache.end() ) {
+        return false;
+    }
+
+    *entry = it.value();
+    m_cacheSize -= byteCount( *entry );
+    m_tileCache.erase( it );
+
+    return true;
+}
+
+void StackedTileLoaderPrivate::removeFromCache( const TileId &id )
+{
+    CacheEntry entry;
+    if ( takeFromCache( id, &entry ) ) {
+        deleteTile( entry );
+    }
+}
+
+void StackedTileLoaderPrivate::clearCache()
+{
+    foreach ( const CacheEntry &entry, m_tileCache ) {
+        deleteTile( entry );
+    }
+    m_tileCache.clear();
+    m_cacheSize = 0;
+}
+
+void StackedTileLoaderPrivate::trimCache()
+{
+    if ( m_cacheSize <= m_cacheLimit ) {
+        return;
+    }
+
+    typedef QPair<qreal, TileId> Candidate;
+    QVector<Candidate> candidates;
+    candidates.reserve( m_tileCache.size() );
+
+    QHash<TileId, CacheEntry>::const_iterator it = m_tileCache.constBegin();
+    QHash<TileId, CacheEntry>::const_iterator const end = m_tileCache.constEnd();
+    for (; it != end; ++it ) {
+        // tiles being compressed may be evicted as well, their job's result gets discarded
+        candidates.append( Candidate( evictionScore( it.key(), it.value() ), it.key() ) );
+    }
+
+    // evict the tiles with the highest score first
+    std::sort( candidates.begin(), candidates.end(),
+               []( const Candidate &a, const Candidate &b ) { return a.first > b.first; } );
+
+    for ( int i = 0; i < candidates.size() && m_cacheSize > m_cacheLimit; ++i ) {
+        removeFromCache( candidates.at( i ).second );
+        ++m_evictions;
+    }
+}
+
+qreal StackedTileLoaderPrivate::evictionScore( const TileId &id, const CacheEntry &entry ) const
+{
+    const qreal age = EVICTION_AGE_WEIGHT * ( m_frame - entry.lastUsed );
+    if ( m_viewLevel < 0 ) {
+        return age;
+    }
+
+    // distance from the viewport center, measured in tiles of the current level
+    const int levelDelta = id.zoomLevel() - m_viewLevel;
+    const qreal scale = levelDelta >= 0 ? qreal( 1 << levelDelta ) : 1.0 / qreal( 1 << -levelDelta );
+    const int columns = m_layerDecorator->tileColumnCount( id.zoomLevel() );
+
+    qreal dx = qAbs( ( id.x() + 0.5 ) / scale - m_viewCenterX );
+    dx = qMin( dx, columns / scale - dx );  // the globe wraps around in x direction
+    const qreal dy = qAbs( ( id.y() + 0.5 ) / scale - m_viewCenterY );
+
+    return age + qMax( dx, dy ) + EVICTION_LEVEL_WEIGHT * qAbs( levelDelta );
+}
+
+quint64 StackedTileLoaderPrivate::byteCount( const CacheEntry &entry )
+{
+    return entry.tile ? entry.tile->byteCount() : entry.compactTile->byteCount();
+}
+
+void StackedTileLoaderPrivate::deleteTile( const CacheEntry &entry )
+{
+    delete entry.tile;
+    delete entry.compactTile;
+}
+
+void StackedTileLoaderPrivate::updateViewport()
+{
+    if ( m_tilesOnDisplay.isEmpty() ) {
+        return;
+    }
+
+    // the current level is the one with the most tiles on display
+    QHash<int, int> levelCount;
+    foreach ( const TileId &id, m_tilesOnDisplay.keys() ) {
+        ++levelCount[id.zoomLevel()];
+    }
+
+    int level = -1;
+    int count = 0;
+    QHash<int, int>::const_iterator it = levelCount.constBegin();
+    for (; it != levelCount.constEnd(); ++it ) {
+        if ( it.value() > count ) {
+            level = it.key();
+            count = it.value();
+        }
+    }
+
+    const int columns = m_layerDecorator->tileColumnCount( level );
+    QVector<int> xs;
+    int minY = INT_MAX;
+    int maxY = INT_MIN;
+    foreach ( const TileId &id, m_tilesOnDisplay.keys() ) {
+        if ( id.zoomLevel() == level ) {
+            xs.append( id.x() );
+            minY = qMin( minY, id.y() );
+            maxY = qMax( maxY, id.y() );
+        }
+    }
+
+    // find the largest gap between visible columns, the visible range is its complement
+    std::sort( xs.begin(), xs.end() );
+    int minX = xs.first();
+    int maxX = xs.last();
+    int largestGap = columns - ( maxX - minX );
+    for ( int i = 1; i < xs.size(); ++i ) {
+        const int gap = xs.at( i ) - xs.at( i - 1 );
+        if ( gap > largestGap ) {
+            largestGap = gap;
+            minX = xs.at( i );
+            maxX = xs.at( i - 1 ) + columns;
+        }
+    }
+
+    m_viewLevel = level;
+    m_viewRect = QRect( QPoint( minX, minY ), QPoint( maxX, maxY ) );
+    m_viewCenterX = m_viewRect.left() + m_viewRect.width() / 2.0;
+    m_viewCenterY = m_viewRect.top() + m_viewRect.height() / 2.0;
+    if ( m_viewCenterX >= columns ) {
+        m_viewCenterX -= columns;
+    }
+}
+
+void StackedTileLoaderPrivate::prefetchTiles()
+{
+    if ( m_viewLevel < 0 || ( m_viewLevel == m_prefetchLevel && m_viewRect == m_prefetchRect ) ) {
+        return;
+    }
+
+    m_prefetchLevel = m_viewLevel;
+    m_prefetchRect = m_viewRect;
+
+    // a ring of neighbouring tiles around the visible ones
+    const QRect ring = m_viewRect.adjusted( -1, -1, 1, 1 );
+    for ( int x = ring.left(); x <= ring.right(); ++x ) {
+        for ( int y = ring.top(); y <= ring.bottom(); ++y ) {
+            if ( !m_viewRect.contains( x, y ) ) {
+                prefetchTile( m_viewLevel, x, y );
+            }
+        }
+    }
+
+    // the previous level covering the ring, for zooming out
+    if ( m_viewLevel > 0 ) {
+        for ( int x = ring.left() >> 1; x <= ring.right() >> 1; ++x ) {
+            for ( int y = ring.top() >> 1; y <= ring.bottom() >> 1; ++y ) {
+                prefetchTile( m_viewLevel - 1, x, y );
+            }
+        }
+    }
+
+    // the next level around the center, for zooming in
+    if ( m_viewLevel < m_layerDecorator->maximumTileLevel() ) {
+        const int centerX = int( m_viewCenterX );
+        const int centerY = int( m_viewCenterY );
+        for ( int x = 2 * ( centerX - 1 ); x < 2 * ( centerX + 2 ); ++x ) {
+            for ( int y = 2 * ( centerY - 1 ); y < 2 * ( centerY + 2 ); ++y ) {
+                prefetchTile( m_viewLevel + 1, x, y );
+            }
+        }
+    }
+}
+
+void StackedTileLoaderPrivate::prefetchTile( int level, int x, int y )
+{
+    const int columns = m_layerDecorator->tileColumnCount( level );
+    const int rows = m_layerDecorator->tileRowCount( level );
+    if ( y < 0 || y >= rows ) {
+        return;
+    }
+
+    const TileId id( 0, level, ( ( x % columns ) + columns ) % columns, y );
+    if ( m_tilesOnDisplay.contains( id ) || m_tileCache.contains( id ) ) {
+        return;
+    }
+
+    m_layerDecorator->prefetchStackedTile( id );
+}
+
+void StackedTileLoaderPrivate::startComposition( StackedTileLoader *q, const TileId &stackedTileId )
+{
+    const QVector<QSharedPointer<TextureTile> > tiles = m_pendingUpdates.take( stackedTileId );
+    m_tilesInUpdate.insert( stackedTileId, tiles );
+
+    TileCompositionJob *const job = new TileCompositionJob( m_layerDecorator, stackedTileId, tiles,
+                                                            m_layerDecorator->compositionState( stackedTileId ),
+                                                            m_compositionGeneration );
+    QObject::connect( job, SIGNAL(tileComposed(TileCompositionJob*)),
+                      q, SLOT(updateComposedTile(TileCompositionJob*)), Qt::QueuedConnection );
+    m_compositionJobs.insert( job );
+    m_compositionPool.start( job );
+}
+
+QVector<QSharedPointer<TextureTile> > StackedTileLoaderPrivate::latestTextureTiles( const TileId &stackedTileId, const StackedTile *displayedTile ) const
+{
+    // build upon the updates not displayed yet
+    if ( m_pendingUpdates.contains( stackedTileId ) ) {
+        return m_pendingUpdates.value( stackedTileId );
+    }
+
+    if ( m_tilesInUpdate.contains( stackedTileId ) ) {
+        return m_tilesInUpdate.value( stackedTileId );
+    }
+
+    return displayedTile->tiles();
+}
+
 StackedTileLoader::StackedTileLoader( MergedLayerDecorator *mergedLayerDecorator, QObject *parent )
     : QObject( parent ),
       d( new StackedTileLoaderPrivate( mergedLayerDecorator ) )
@@ -63,7 +412,13 @@ StackedTileLoader::StackedTileLoader( MergedLayerDecorator *mergedLayerDecorator
 
 StackedTileLoader::~StackedTileLoader()
 {
+    d->m_compositionPool.waitForDone();
+    qDeleteAll( d->m_compositionJobs );
+    d->m_compressionPool.clear();
+    d->m_compressionPool.waitForDone();
+    qDeleteAll( d->m_compressionJobs );
     qDeleteAll( d->m_tilesOnDisplay );
+    d->clearCache();
     delete d;
 }
 
@@ -102,17 +457,20 @@ void StackedTileLoader::cleanupTilehash()
     // Make sure that tiles which haven't been used during the last
     // rendering of the map at all get removed from the tile hash.
 
+    ++d->m_frame;
+
     QHashIterator<TileId, StackedTile*> it( d->m_tilesOnDisplay );
     while ( it.hasNext() ) {
         it.next();
         if ( !it.value()->used() ) {
-            // If insert call result is false then the cache is too small to store the tile
-            // but the item will get deleted nevertheless and the pointer we have
-            // doesn't get set to zero (so don't delete it in this case or it will crash!)
-            d->m_tileCache.insert( it.key(), it.value(), it.value()->byteCount() );
+            d->insertIntoCache( this, it.key(), it.value() );
             d->m_tilesOnDisplay.remove( it.key() );
         }
     }
+
+    d->updateViewport();
+    d->trimCache();
+    d->prefetchTiles();
 }
 
 const StackedTile* StackedTileLoader::loadTile( TileId const & stackedTileId )
@@ -129,17 +487,29 @@ const StackedTile* StackedTileLoader::loadTile( TileId const & stackedTileId )
 
     d->m_cacheLock.lockForWrite();
 
-    // has another thread loaded our tile due to a race condition?
-    stackedTile = d->m_tilesOnDisplay.value( stackedTileId, 0 );
-    if ( stackedTile ) {
-        Q_ASSERT( stackedTile->used() && "other thread should have marked tile as used" );
-        d->m_cacheLock.unlock();
-        return stackedTile;
+    // has another thread loaded our tile due to a race condition or is it
+    // being blended by another thread right now?
+    while ( true ) {
+        stackedTile = d->m_tilesOnDisplay.value( stackedTileId, 0 );
+        if ( stackedTile ) {
+            Q_ASSERT( stackedTile->used() && "other thread should have marked tile as used" );
+            d->m_cacheLock.unlock();
+            return stackedTile;
+        }
+
+        if ( !d->m_tilesInComposition.contains( stackedTileId ) ) {
+            break;
+        }
+
+        d->m_compositionFinished.wait( &d->m_cacheLock );
     }
 
     // the tile was not in the hash so check if it is in the cache
-    stackedTile = d->m_tileCache.take( stackedTileId );
-    if ( stackedTile ) {
+    StackedTileLoaderPrivate::CacheEntry entry;
+    const bool cached = d->takeFromCache( stackedTileId, &entry );
+    if ( cached && entry.tile ) {
+        ++d->m_cacheHits;
+        stackedTile = entry.tile;
         Q_ASSERT( !stackedTile->used() && "tiles in m_tileCache are invisible and should thus be marked as unused" );
         stackedTile->setUsed( true );
         d->m_tilesOnDisplay[ stackedTileId ] = stackedTile;
@@ -149,24 +519,48 @@ const StackedTile* StackedTileLoader::loadTile( TileId const & stackedTileId )
 
     // tile (valid) has not been found in hash or cache, so load it from disk
     // and place it in the hash from where it will get transferred to the cache
+    QVector<QSharedPointer<TextureTile> > tiles;
+    QSharedPointer<const MergedLayerDecorator::CompositionState> compositionState;
+    if ( cached ) {
+        ++d->m_cacheHits;
+    } else {
+        mDebug() << "load tile from disk:" << stackedTileId;
+        ++d->m_cacheMisses;
 
-    mDebug() << "load tile from disk:" << stackedTileId;
+        tiles = d->m_layerDecorator->loadTextureTiles( stackedTileId );
+        // taken under the lock, loading ground overlay icons is not thread-safe
+        compositionState = d->m_layerDecorator->compositionState( stackedTileId );
+    }
 
-    stackedTile = d->m_layerDecorator->loadTile( stackedTileId );
+    d->m_tilesInComposition.insert( stackedTileId );
+    d->m_cacheLock.unlock();
+
+    // blending and expanding are expensive, let other threads go on with other tiles meanwhile
+    if ( cached ) {
+        stackedTile = entry.compactTile->toStackedTile();
+        delete entry.compactTile;
+    } else {
+        stackedTile = d->m_layerDecorator->composeTile( tiles, compositionState );
+    }
     Q_ASSERT( stackedTile );
     stackedTile->setUsed( true );
 
+    d->m_cacheLock.lockForWrite();
+    d->m_tilesInComposition.remove( stackedTileId );
     d->m_tilesOnDisplay[ stackedTileId ] = stackedTile;
+    d->m_compositionFinished.wakeAll();
     d->m_cacheLock.unlock();
 
-    emit tileLoaded( stackedTileId );
+    if ( !cached ) {
+        emit tileLoaded( stackedTileId );
+    }
 
     return stackedTile;
 }
 
 quint64 StackedTileLoader::volatileCacheLimit() const
 {
-    return d->m_tileCache.maxCost() / 1024;
+    return d->m_cacheLimit / 1024;
 }
 
 QList<TileId> StackedTileLoader::visibleTiles() const
@@ -182,18 +576,123 @@ int StackedTileLoader::tileCount() const
 void StackedTileLoader::setVolatileCacheLimit( quint64 kiloBytes )
 {
     mDebug() << QString("Setting tile cache to %1 kilobytes.").arg( kiloBytes );
-    d->m_tileCache.setMaxCost( kiloBytes * 1024 );
+    d->m_cacheLimit = kiloBytes * 1024;
+    d->trimCache();
+}
+
+TileCacheCompression StackedTileLoader::cacheCompression() const
+{
+    return d->m_cacheCompression;
+}
+
+void StackedTileLoader::setCacheCompression( TileCacheCompression compression )
+{
+    // tiles already cached keep their form until they are used again
+    d->m_cacheCompression = compression;
+}
+
+quint64 StackedTileLoader::cacheHits() const
+{
+    return d->m_cacheHits;
+}
+
+quint64 StackedTileLoader::cacheMisses() const
+{
+    return d->m_cacheMisses;
+}
+
+quint64 StackedTileLoader::cacheEvictions() const
+{
+    return d->m_evictions;
 }
 
 void StackedTileLoader::updateTile( TileId const &tileId, QImage const &tileImage )
 {
     const TileId stackedTileId( 0, tileId.zoomLevel(), tileId.x(), tileId.y() );
 
-    StackedTile * displayedTile = d->m_tilesOnDisplay.take( stackedTileId );
+    const StackedTile *const displayedTile = d->m_tilesOnDisplay.value( stackedTileId, 0 );
     if ( displayedTile ) {
         Q_ASSERT( !d->m_tileCache.contains( stackedTileId ) );
 
-        StackedTile *const stackedTile = d->m_layerDecorator->updateTile( *displayedTile, tileId, tileImage );
+        const QVector<QSharedPointer<TextureTile> > tiles = d->latestTextureTiles( stackedTileId, displayedTile );
+        d->m_pendingUpdates.insert( stackedTileId, d->m_layerDecorator->updateTextureTiles( tiles, tileId, tileImage ) );
+
+        if ( !d->m_tilesInUpdate.contains( stackedTileId ) ) {
+            d->startComposition( this, stackedTileId );
+        }
+    } else {
+        d->removeFromCache( stackedTileId );
+    }
+}
+
+void StackedTileLoader::reblendVisibleTiles()
+{
+    // the cached tiles get loaded again when needed
+    d->clearCache();
+
+    QHash<TileId, QVector<QSharedPointer<TextureTile> > > tiles;
+    QHash<TileId, StackedTile*>::const_iterator it = d->m_tilesOnDisplay.constBegin();
+    QHash<TileId, StackedTile*>::const_iterator const end = d->m_tilesOnDisplay.constEnd();
+    for (; it != end; ++it ) {
+        tiles.insert( it.key(), d->latestTextureTiles( it.key(), it.value() ) );
+    }
+
+    // running compositions would still use the previous blending
+    ++d->m_compositionGeneration;
+    d->m_tilesInUpdate.clear();
+    d->m_pendingUpdates = tiles;
+
+    foreach ( const TileId &stackedTileId, tiles.keys() ) {
+        d->startComposition( this, stackedTileId );
+    }
+}
+
+void StackedTileLoader::updateCompressedTile( TileCompressionJob *job )
+{
+    d->m_compressionJobs.remove( job );
+    CompactStackedTile *const compactTile = job->takeResult();
+    const TileId stackedTileId = job->stackedTileId();
+    const quint64 serial = job->serial();
+    delete job;
+
+    QWriteLocker locker( &d->m_cacheLock );
+
+    // the tile may have been used, evicted or updated meanwhile
+    QHash<TileId, StackedTileLoaderPrivate::CacheEntry>::iterator it = d->m_tileCache.find( stackedTileId );
+    if ( it == d->m_tileCache.end() || it->serial != serial ) {
+        delete compactTile;
+        return;
+    }
+
+    Q_ASSERT( it->compressing );
+    d->m_cacheSize -= StackedTileLoaderPrivate::byteCount( *it );
+    delete it->tile;
+    it->tile = 0;
+    it->compactTile = compactTile;
+    it->compressing = false;
+    d->m_cacheSize += StackedTileLoaderPrivate::byteCount( *it );
+
+    d->trimCache();
+}
+
+void StackedTileLoader::updateComposedTile( TileCompositionJob *job )
+{
+    d->m_compositionJobs.remove( job );
+    StackedTile *stackedTile = job->takeResult();
+    const TileId stackedTileId = job->stackedTileId();
+    const bool obsolete = job->generation() != d->m_compositionGeneration;
+    delete job;
+
+    if ( obsolete ) {
+        // the tiles were cleared while the job was running
+        delete stackedTile;
+        return;
+    }
+
+    d->m_tilesInUpdate.remove( stackedTileId );
+
+    StackedTile *displayedTile = d->m_tilesOnDisplay.take( stackedTileId );
+    if ( displayedTile ) {
         stackedTile->setUsed( true );
         d->m_tilesOnDisplay.insert( stackedTileId, stackedTile );
 
@@ -201,8 +700,16 @@ void StackedTileLoader::updateTile( TileId const &tileId, QImage const &tileImag
         displayedTile = 0;
 
         emit tileLoaded( stackedTileId );
+        emit tileUpdated( stackedTileId );
+
+        if ( d->m_pendingUpdates.contains( stackedTileId ) ) {
+            d->startComposition( this, stackedTileId );
+        }
     } else {
-        d->m_tileCache.remove( stackedTileId );
+        // the tile went out of sight meanwhile, so it gets loaded again when needed
+        delete stackedTile;
+        d->removeFromCache( stackedTileId );
+        d->m_pendingUpdates.remove( stackedTileId );
     }
 }
 
@@ -214,6 +721,13 @@ RenderState StackedTileLoader::renderState() const
     for (; it != end; ++it ) {
         renderState.addChild( d->m_layerDecorator->renderState( it.key() ) );
     }
+
+    QString const cacheTemplate = "Tile Cache: %1 hits, %2 misses, %3 evictions, %4 of %5 kB";
+    renderState.addChild( RenderState( cacheTemplate.arg( d->m_cacheHits )
+                                       .arg( d->m_cacheMisses )
+                                       .arg( d->m_evictions )
+                                       .arg( d->m_cacheSize / 1024 )
+                                       .arg( d->m_cacheLimit / 1024 ) ) );
     return renderState;
 }
 
@@ -223,7 +737,14 @@ void StackedTileLoader::clear()
 
     qDeleteAll( d->m_tilesOnDisplay );
     d->m_tilesOnDisplay.clear();
-    d->m_tileCache.clear(); // clear the tile cache in physical memory
+    d->clearCache(); // clear the tile cache in physical memory
+    ++d->m_compositionGeneration; // running compositions are obsolete now
+    d->m_tilesInUpdate.clear();
+    d->m_pendingUpdates.clear();
+    d->m_prefetchLevel = -1;
+    d->m_cacheHits = 0;
+    d->m_cacheMisses = 0;
+    d->m_evictions = 0;
 
     emit cleared();
 }
@@ -28,6 +28,7 @@
 #include <QObject>
 
 #include "GeoSceneTextureTileDataset.h"
+#include "MarbleGlobal.h"
 #include "RenderState.h"
 
 class QImage;
@@ -39,6 +40,8 @@ namespace Marble
 
 class MergedLayerDecorator;
 class StackedTile;
+class TileCompositionJob;
+class TileCompressionJob;
 class TileId;
 
 class StackedTileLoaderPrivate;
@@ -121,6 +124,39 @@ class StackedTileLoader : public QObject
          */
         void setVolatileCacheLimit( quint64 kiloBytes );
 
+        /**
+         * @brief Returns how tiles are kept in the volatile cache.
+         */
+        TileCacheCompression cacheCompression() const;
+
+        /**
+         * @brief Sets how tiles are kept in the volatile cache.
+         *
+         * Compressed tiles take a fraction of the memory, so many more of them
+         * fit into the cache, but they have to be expanded once they are
+         * displayed again.
+         */
+        void setCacheCompression( TileCacheCompression compression );
+
+        /**
+         * @brief Returns the number of tiles found in the volatile cache.
+         */
+        quint64 cacheHits() const;
+
+        /**
+         * @brief Returns the number of tiles that had to be loaded from disk.
+         */
+        quint64 cacheMisses() const;
+
+        /**
+         * @brief Returns the number of tiles evicted from the volatile cache.
+         *
+         * The cache is limited by bytes. When it is full, tiles far away from
+         * the current view, tiles of other zoom levels and tiles not used for
+         * many frames are evicted first.
+         */
+        quint64 cacheEvictions() const;
+
         /**
          * Effectively triggers a reload of all tiles that are currently in use
          * and clears the tile cache in physical memory.
@@ -128,6 +164,16 @@ class StackedTileLoader : public QObject
         void clear();
 
         /**
+         * Blends the tiles being displayed again from their texture tiles
+         * in the background, e.g. because the sun moved, and drops the
+         * cached tiles. tileUpdated() is emitted for each reblended tile.
+         */
+        void reblendVisibleTiles();
+
+        /**
+         * Replaces the texture tile @p tileId of the stacked tile being
+         * displayed by @p tileImage. The stacked tile is blended again in
+         * the background and tileUpdated() is emitted once it is done.
          */
         void updateTile(TileId const & tileId, QImage const &tileImage );
 
@@ -135,8 +181,19 @@ class StackedTileLoader : public QObject
 
     Q_SIGNALS:
         void tileLoaded( TileId const &tileId );
+
+        /**
+         * Emitted when a stacked tile being displayed was replaced because
+         * of updateTile() or reblendVisibleTiles().
+         */
+        void tileUpdated( TileId const &tileId );
+
         void cleared();
 
+    private Q_SLOTS:
+        void updateComposedTile( TileCompositionJob *job );
+        void updateCompressedTile( TileCompressionJob *job );
+
     private:
         Q_DISABLE_COPY( StackedTileLoader )
 
@@ -26,6 +26,7 @@
 #include <QApplication>
 #include <QFont>
 #include <QImage>
+#include <QMutex>
 #include <QDate>
 #include <QSet>
 #include <QScreen>
@@ -86,6 +87,10 @@ public:
     QFont m_defaultFont;
     GeoDataStyle::Ptr m_defaultStyle[GeoDataPlacemark::LastIndex];
     bool m_defaultStyleInitialized;
+    // styles get created by worker threads, too; the mutex guards the
+    // initialization and the default font and label color it reads, the
+    // initialized presets are read-only
+    mutable QMutex m_defaultStyleMutex;
 
     /**
      * @brief s_visualCategories contains osm tag mappings to GeoDataVisualCategories
@@ -829,6 +834,17 @@ void StyleBuilder::Private::initializeDefaultStyles()
     tmp = m_defaultStyle[GeoDataPlacemark::LargeNationCapital]->labelStyle().font();
     tmp.setUnderline( true );
     m_defaultStyle[GeoDataPlacemark::LargeNationCapital]->labelStyle().setFont( tmp );
+
+    // The preset styles are shared by all threads creating graphics items.
+    // Their images get loaded on first use, which writes to the style, so
+    // load them right away to leave the presets read-only from now on.
+    for (int i = 0; i < GeoDataPlacemark::LastIndex; ++i) {
+        if (m_defaultStyle[i]) {
+            m_defaultStyle[i]->iconStyle().icon();
+            m_defaultStyle[i]->iconStyle().scaledIcon();
+            m_defaultStyle[i]->polyStyle().textureImage();
+        }
+    }
 }
 
 QString StyleBuilder::Private::createPaintLayerItem(const QString &itemType, GeoDataPlacemark::GeoDataVisualCategory visualCategory, const QString &subType)
@@ -1170,24 +1186,28 @@ StyleBuilder::~StyleBuilder()
 
 QFont StyleBuilder::defaultFont() const
 {
+    QMutexLocker locker(&d->m_defaultStyleMutex);
     return d->m_defaultFont;
 }
 
 void StyleBuilder::setDefaultFont( const QFont& font )
 {
+    QMutexLocker locker(&d->m_defaultStyleMutex);
     d->m_defaultFont = font;
-    reset();
+    d->m_defaultStyleInitialized = false;
 }
 
 QColor StyleBuilder::defaultLabelColor() const
 {
+    QMutexLocker locker(&d->m_defaultStyleMutex);
     return d->m_defaultLabelColor;
 }
 
 void StyleBuilder::setDefaultLabelColor( const QColor& color )
 {
+    QMutexLocker locker(&d->m_defaultStyleMutex);
     d->m_defaultLabelColor = color;
-    reset();
+    d->m_defaultStyleInitialized = false;
 }
 
 GeoDataStyle::ConstPtr StyleBuilder::createStyle(const StyleParameters &parameters) const
@@ -1423,6 +1443,7 @@ GeoDataStyle::ConstPtr StyleBuilder::createStyle(const StyleParameters &paramete
 
 GeoDataStyle::ConstPtr StyleBuilder::Private::presetStyle(GeoDataPlacemark::GeoDataVisualCategory visualCategory) const
 {
+    QMutexLocker locker(&m_defaultStyleMutex);
     if (!m_defaultStyleInitialized) {
         const_cast<StyleBuilder::Private *>(this)->initializeDefaultStyles(); // const cast due to lazy initialization
     }
@@ -1566,6 +1587,7 @@ QStringList StyleBuilder::renderOrder() const
 
 void StyleBuilder::reset()
 {
+    QMutexLocker locker(&d->m_defaultStyleMutex);
     d->m_defaultStyleInitialized = false;
 }
 
@@ -1582,7 +1604,10 @@ int StyleBuilder::maximumZoomLevel() const
 QString StyleBuilder::visualCategoryName(GeoDataPlacemark::GeoDataVisualCategory category)
 {
     static QHash<GeoDataPlacemark::GeoDataVisualCategory, QString> visualCategoryNames;
+    static QMutex visualCategoryNamesMutex;
 
+    // graphics items get created by worker threads, too
+    QMutexLocker locker(&visualCategoryNamesMutex);
     if (visualCategoryNames.isEmpty()) {
         visualCategoryNames[GeoDataPlacemark::GeoDataPlacemark::None] = "None";
         visualCategoryNames[GeoDataPlacemark::GeoDataPlacemark::Default] = "Default";
@@ -1879,7 +1904,7 @@ QString StyleBuilder::visualCategoryName(GeoDataPlacemark::GeoDataVisualCategory
     }
 
     Q_ASSERT(visualCategoryNames.contains(category));
-    return visualCategoryNames[category];
+    return visualCategoryNames.value(category);
 }
 
 QHash<StyleBuilder::OsmTag, GeoDataPlacemark::GeoDataVisualCategory>::const_iterator StyleBuilder::begin()
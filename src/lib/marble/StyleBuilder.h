@@ -51,6 +51,10 @@ public:
     QColor defaultLabelColor() const;
     void setDefaultLabelColor( const QColor& color );
 
+    /**
+     * @brief Returns the style of the placemark given in @p parameters.
+     * This method and minimumZoomLevel() may also be called from worker threads.
+     */
     GeoDataStyle::ConstPtr createStyle(const StyleParameters &parameters) const;
 
     /**
@@ -0,0 +1,107 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include "SunShadingMask.h"
+
+#include "MarbleGlobal.h"
+#include "SunLocator.h"
+
+#include <QMutexLocker>
+
+#include <cmath>
+
+namespace Marble
+{
+
+// The size of the lookup texture. The twilight zone is several degrees
+// wide, so a resolution of about 0.35 degrees keeps the interpolation error
+// below one brightness step.
+const int MASK_WIDTH = 1024;
+const int MASK_HEIGHT = 513;
+
+SunShadingMask::SunShadingMask( const SunLocator *sunLocator )
+    : m_sunLocator( sunLocator ),
+      m_sunLon( 0.0 ),
+      m_sunLat( 0.0 )
+{
+}
+
+void SunShadingMask::invalidate()
+{
+    QMutexLocker locker( &m_mutex );
+    m_data.clear();
+}
+
+QVector<uchar> SunShadingMask::upToDateData() const
+{
+    QMutexLocker locker( &m_mutex );
+
+    const qreal sunLon = m_sunLocator->getLon();
+    const qreal sunLat = m_sunLocator->getLat();
+    if ( !m_data.isEmpty() && sunLon == m_sunLon && sunLat == m_sunLat ) {
+        return m_data;
+    }
+
+    QVector<uchar> data( MASK_WIDTH * MASK_HEIGHT );
+    for ( int j = 0; j < MASK_HEIGHT; ++j ) {
+        // the same parameters the per pixel shading used to pass
+        const qreal lat = -M_PI * j / ( MASK_HEIGHT - 1 ) - 0.5 * M_PI;
+        const qreal a = sin( ( lat + DEG2RAD * sunLat ) / 2.0 );
+        const qreal c = cos( lat ) * cos( -DEG2RAD * sunLat );
+
+        uchar *const row = data.data() + j * MASK_WIDTH;
+        for ( int i = 0; i < MASK_WIDTH; ++i ) {
+            const qreal lon = 2 * M_PI * i / MASK_WIDTH;
+            row[i] = qRound( 255 * m_sunLocator->shading( lon, a, c ) );
+        }
+    }
+
+    m_data = data;
+    m_sunLon = sunLon;
+    m_sunLat = sunLat;
+
+    return m_data;
+}
+
+void SunShadingMask::brightnessRow( qreal x, qreal xStep, qreal y, int count, uchar *brightness ) const
+{
+    // keeps the mask alive even if another thread replaces it meanwhile
+    const QVector<uchar> data = upToDateData();
+
+    // interpolate with 8 bit weights, the position along the row keeps 32
+    // fractional bits so the steps don't vanish for the highest tile levels
+    const qreal posY = qBound<qreal>( 0.0, y, 1.0 ) * ( MASK_HEIGHT - 1 );
+    const int row = qMin( int( posY ), MASK_HEIGHT - 2 );
+    const int weightY = int( ( posY - row ) * 256 );
+    const uchar *const top = data.constData() + row * MASK_WIDTH;
+    const uchar *const bottom = top + MASK_WIDTH;
+
+    const qreal fixedPointScale = MASK_WIDTH * 4294967296.0;
+    const qint64 maskWidth = qint64( MASK_WIDTH ) << 32;
+    qint64 posX = qint64( ( x - floor( x ) ) * fixedPointScale ) % maskWidth;
+    const qint64 stepX = qint64( xStep * fixedPointScale ) % maskWidth;
+
+    for ( int i = 0; i < count; ++i ) {
+        const int left = int( posX >> 32 );
+        const int right = ( left + 1 ) % MASK_WIDTH;
+        const int weightX = int( ( posX >> 24 ) & 0xff );
+
+        const int upper = top[left] * ( 256 - weightX ) + top[right] * weightX;
+        const int lower = bottom[left] * ( 256 - weightX ) + bottom[right] * weightX;
+        brightness[i] = uchar( ( upper * ( 256 - weightY ) + lower * weightY + ( 1 << 15 ) ) >> 16 );
+
+        posX += stepX;
+        if ( posX >= maskWidth ) {
+            posX -= maskWidth;
+        }
+    }
+}
+
+}
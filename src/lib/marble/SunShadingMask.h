@@ -0,0 +1,67 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#ifndef MARBLE_SUNSHADINGMASK_H
+#define MARBLE_SUNSHADINGMASK_H
+
+#include <QMutex>
+#include <QVector>
+#include <QtGlobal>
+
+namespace Marble
+{
+
+class SunLocator;
+
+/**
+ * @short Brightness of the planet's surface for the current sun position.
+ *
+ * The brightness is computed once per sun position into a small
+ * equirectangular lookup texture and interpolated from there, instead of
+ * evaluating SunLocator::shading() for every pixel of every tile.
+ *
+ * The mask follows the sun position on its own. All methods may be called
+ * from any thread.
+ */
+class SunShadingMask
+{
+ public:
+    explicit SunShadingMask( const SunLocator *sunLocator );
+
+    /**
+     * Recomputes the mask the next time it is used, e.g. because the
+     * twilight zone changed along with the planet.
+     */
+    void invalidate();
+
+    /**
+     * Writes the brightness of @p count points along a row of a texture
+     * covering the whole planet, from 0 (night) to 255 (day). @p x, @p xStep
+     * and @p y are relative to the size of the texture, so ( 0, 0 ) is the
+     * top left and ( 1, 1 ) the bottom right corner.
+     */
+    void brightnessRow( qreal x, qreal xStep, qreal y, int count, uchar *brightness ) const;
+
+ private:
+    Q_DISABLE_COPY( SunShadingMask )
+
+    QVector<uchar> upToDateData() const;
+
+    const SunLocator *const m_sunLocator;
+
+    mutable QMutex m_mutex;
+    mutable QVector<uchar> m_data;
+    mutable qreal m_sunLon;
+    mutable qreal m_sunLat;
+};
+
+}
+
+#endif
@@ -27,3 +27,13 @@ void TextureMapperInterface::setRepaintNeeded()
 {
     m_repaintNeeded = true;
 }
+
+void TextureMapperInterface::setCenterChanged()
+{
+    setRepaintNeeded();
+}
+
+QString TextureMapperInterface::runtimeTrace() const
+{
+    return QString();
+}
@@ -12,6 +12,8 @@
 #ifndef MARBLE_TEXTUREMAPPERINTERFACE_H
 #define MARBLE_TEXTUREMAPPERINTERFACE_H
 
+#include <QString>
+
 class QRect;
 
 namespace Marble
@@ -36,6 +38,18 @@ public:
 
     void setRepaintNeeded();
 
+    /**
+     * Notifies the mapper that the center of the viewport moved. Mappers
+     * that can reuse the previously mapped canvas detect the movement
+     * themselves, all others just repaint.
+     */
+    virtual void setCenterChanged();
+
+    /**
+     * Returns statistics about the last mapped frame for the runtime trace.
+     */
+    virtual QString runtimeTrace() const;
+
 protected:
     bool m_repaintNeeded;
 };
@@ -21,6 +21,7 @@
 #define MARBLE_TILE_H
 
 #include "TileId.h"
+#include "marble_export.h"
 
 namespace Marble
 {
@@ -50,7 +51,7 @@ namespace Marble
     expiration time which will trigger a reload of the tile data.
 */
 
-class Tile
+class MARBLE_EXPORT Tile
 {
  public:
     explicit Tile( TileId const & tileId );
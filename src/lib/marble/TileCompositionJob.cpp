@@ -0,0 +1,64 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include "TileCompositionJob.h"
+
+#include "StackedTile.h"
+#include "TextureTile.h"
+
+namespace Marble
+{
+
+TileCompositionJob::TileCompositionJob( const MergedLayerDecorator *layerDecorator, const TileId &stackedTileId,
+                                        const QVector<QSharedPointer<TextureTile> > &tiles,
+                                        const QSharedPointer<const MergedLayerDecorator::CompositionState> &state, int generation ) :
+    m_layerDecorator( layerDecorator ),
+    m_stackedTileId( stackedTileId ),
+    m_tiles( tiles ),
+    m_state( state ),
+    m_generation( generation ),
+    m_result( 0 )
+{
+    setAutoDelete( false );
+}
+
+TileCompositionJob::~TileCompositionJob()
+{
+    delete m_result;
+}
+
+void TileCompositionJob::run()
+{
+    m_result = m_layerDecorator->composeTile( m_tiles, m_state );
+
+    emit tileComposed( this );
+}
+
+TileId TileCompositionJob::stackedTileId() const
+{
+    return m_stackedTileId;
+}
+
+int TileCompositionJob::generation() const
+{
+    return m_generation;
+}
+
+StackedTile *TileCompositionJob::takeResult()
+{
+    StackedTile *const result = m_result;
+    m_result = 0;
+
+    return result;
+}
+
+}
+
+#include "moc_TileCompositionJob.cpp"
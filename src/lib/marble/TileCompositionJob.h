@@ -0,0 +1,78 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#ifndef MARBLE_TILECOMPOSITIONJOB_H
+#define MARBLE_TILECOMPOSITIONJOB_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QSharedPointer>
+#include <QVector>
+
+#include "MergedLayerDecorator.h"
+#include "TileId.h"
+
+namespace Marble
+{
+
+class StackedTile;
+class TextureTile;
+
+/**
+ * @short Blends the texture tiles of a stacked tile off the GUI thread.
+ *
+ * The job blends according to the composition state of the layer decorator
+ * at the time the job got created. It is meant to be run by a QThreadPool
+ * which must not delete it.
+ * Once the stacked tile is composed, the job reports itself through the
+ * tileComposed() signal, which gets delivered to the receiver's thread by a
+ * queued connection. The receiver takes the result and deletes the job.
+ */
+class TileCompositionJob : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    TileCompositionJob( const MergedLayerDecorator *layerDecorator, const TileId &stackedTileId,
+                        const QVector<QSharedPointer<TextureTile> > &tiles,
+                        const QSharedPointer<const MergedLayerDecorator::CompositionState> &state, int generation );
+    ~TileCompositionJob();
+
+    void run();
+
+    TileId stackedTileId() const;
+
+    /**
+     * Returns the value passed to the constructor, which allows to discard
+     * results that became obsolete while the job was running.
+     */
+    int generation() const;
+
+    /**
+     * Returns the composed stacked tile and passes its ownership to the
+     * caller. Returns 0 before the job has run or if it was taken before.
+     */
+    StackedTile *takeResult();
+
+Q_SIGNALS:
+    void tileComposed( TileCompositionJob *job );
+
+private:
+    const MergedLayerDecorator *const m_layerDecorator;
+    const TileId m_stackedTileId;
+    const QVector<QSharedPointer<TextureTile> > m_tiles;
+    const QSharedPointer<const MergedLayerDecorator::CompositionState> m_state;
+    const int m_generation;
+    StackedTile *m_result;
+};
+
+}
+
+#endif
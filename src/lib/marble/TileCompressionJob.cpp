@@ -0,0 +1,64 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include "TileCompressionJob.h"
+
+#include "CompactStackedTile.h"
+#include "TextureTile.h"
+
+namespace Marble
+{
+
+TileCompressionJob::TileCompressionJob( const TileId &stackedTileId, const QImage &resultImage,
+                                        const QVector<QSharedPointer<TextureTile> > &tiles,
+                                        TileCacheCompression compression, quint64 serial ) :
+    m_stackedTileId( stackedTileId ),
+    m_resultImage( resultImage ),
+    m_tiles( tiles ),
+    m_compression( compression ),
+    m_serial( serial ),
+    m_result( 0 )
+{
+    setAutoDelete( false );
+}
+
+TileCompressionJob::~TileCompressionJob()
+{
+    delete m_result;
+}
+
+void TileCompressionJob::run()
+{
+    m_result = new CompactStackedTile( m_stackedTileId, m_resultImage, m_tiles, m_compression );
+
+    emit tileCompressed( this );
+}
+
+TileId TileCompressionJob::stackedTileId() const
+{
+    return m_stackedTileId;
+}
+
+quint64 TileCompressionJob::serial() const
+{
+    return m_serial;
+}
+
+CompactStackedTile *TileCompressionJob::takeResult()
+{
+    CompactStackedTile *const result = m_result;
+    m_result = 0;
+
+    return result;
+}
+
+}
+
+#include "moc_TileCompressionJob.cpp"
@@ -0,0 +1,78 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#ifndef MARBLE_TILECOMPRESSIONJOB_H
+#define MARBLE_TILECOMPRESSIONJOB_H
+
+#include <QImage>
+#include <QObject>
+#include <QRunnable>
+#include <QSharedPointer>
+#include <QVector>
+
+#include "MarbleGlobal.h"
+#include "TileId.h"
+
+namespace Marble
+{
+
+class CompactStackedTile;
+class TextureTile;
+
+/**
+ * @short Compresses a cached stacked tile off the GUI thread.
+ *
+ * The job works on shared copies of the images, so the stacked tile may be
+ * deleted meanwhile. It is meant to be run by a QThreadPool which must not
+ * delete it. Once done, the job reports itself through the tileCompressed()
+ * signal, which gets delivered to the receiver's thread by a queued
+ * connection. The receiver takes the result and deletes the job.
+ */
+class TileCompressionJob : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    TileCompressionJob( const TileId &stackedTileId, const QImage &resultImage,
+                        const QVector<QSharedPointer<TextureTile> > &tiles,
+                        TileCacheCompression compression, quint64 serial );
+    ~TileCompressionJob();
+
+    void run();
+
+    TileId stackedTileId() const;
+
+    /**
+     * Returns the value passed to the constructor, which identifies the cache
+     * entry the job was started for.
+     */
+    quint64 serial() const;
+
+    /**
+     * Returns the compressed tile and passes its ownership to the caller.
+     * Returns 0 before the job has run or if it was taken before.
+     */
+    CompactStackedTile *takeResult();
+
+Q_SIGNALS:
+    void tileCompressed( TileCompressionJob *job );
+
+private:
+    const TileId m_stackedTileId;
+    const QImage m_resultImage;
+    const QVector<QSharedPointer<TextureTile> > m_tiles;
+    const TileCacheCompression m_compression;
+    const quint64 m_serial;
+    CompactStackedTile *m_result;
+};
+
+}
+
+#endif
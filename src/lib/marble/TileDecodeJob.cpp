@@ -0,0 +1,40 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include "TileDecodeJob.h"
+
+#include <QImage>
+
+namespace Marble
+{
+
+TileDecodeJob::TileDecodeJob( const TileId &id, const QString &fileName ) :
+    m_id( id ),
+    m_fileName( fileName )
+{
+}
+
+TileDecodeJob::TileDecodeJob( const TileId &id, const QByteArray &data ) :
+    m_id( id ),
+    m_data( data )
+{
+}
+
+void TileDecodeJob::run()
+{
+    // an invalid image is reported as well, so the loader can forget about the pending decode
+    const QImage image = m_data.isEmpty() ? QImage( m_fileName ) : QImage::fromData( m_data );
+
+    emit tileDecoded( m_id, image );
+}
+
+}
+
+#include "moc_TileDecodeJob.cpp"
@@ -0,0 +1,58 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#ifndef MARBLE_TILEDECODEJOB_H
+#define MARBLE_TILEDECODEJOB_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QRunnable>
+#include <QString>
+
+#include "TileId.h"
+
+class QImage;
+
+namespace Marble
+{
+
+/**
+ * @short Reads and decodes a single texture tile image off the GUI thread.
+ *
+ * The job is meant to be run by a QThreadPool. Once the image file has been
+ * decoded the result is handed back through the tileDecoded() signal, which
+ * gets delivered to the receiver's thread by a queued connection.
+ */
+class TileDecodeJob : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    TileDecodeJob( const TileId &id, const QString &fileName );
+
+    /**
+     * Decodes the encoded image @p data, e.g. a tile stored in a TilePackArchive.
+     */
+    TileDecodeJob( const TileId &id, const QByteArray &data );
+
+    void run();
+
+Q_SIGNALS:
+    void tileDecoded( const TileId &id, const QImage &image );
+
+private:
+    const TileId m_id;
+    const QString m_fileName;
+    const QByteArray m_data;
+};
+
+}
+
+#endif
@@ -35,8 +35,10 @@
 #include "HttpDownloadManager.h"
 #include "MarbleDebug.h"
 #include "MarbleDirs.h"
+#include "TileDecodeJob.h"
 #include "TileId.h"
 #include "TileLoaderHelper.h"
+#include "TilePackArchive.h"
 #include "ParseRunnerPlugin.h"
 #include "ParsingRunner.h"
 
@@ -45,10 +47,36 @@ Q_DECLARE_METATYPE( Marble::DownloadUsage )
 namespace Marble
 {
 
+// Returns the tile pack archive that would hold the tile, if the theme's
+// local cache has been converted to packed storage
+static TilePackArchive *tilePackArchive( GeoSceneTileDataset const *tileData, TileId const &tileId,
+                                         TilePackArchive::Key &key )
+{
+    QString const fileName = tileData->relativeTileFileName( tileId );
+    QString const localFileName = QFileInfo( fileName ).isAbsolute() ? fileName
+                                                                     : MarbleDirs::localPath() + QLatin1Char('/') + fileName;
+    QString directory;
+    if ( !TilePackArchive::parseFileName( localFileName, directory, key ) ) {
+        return 0;
+    }
+
+    return TilePackArchive::find( directory );
+}
+
+static QByteArray packedTileData( GeoSceneTileDataset const *tileData, TileId const &tileId )
+{
+    TilePackArchive::Key key;
+    TilePackArchive const *const archive = tilePackArchive( tileData, tileId, key );
+    return archive ? archive->tileData( key ) : QByteArray();
+}
+
 TileLoader::TileLoader(HttpDownloadManager * const downloadManager, const PluginManager *pluginManager) :
-    m_pluginManager(pluginManager)
+    m_pluginManager(pluginManager),
+    m_decodeInBackground( false )
 {
     qRegisterMetaType<DownloadUsage>( "DownloadUsage" );
+    qRegisterMetaType<TileId>( "TileId" );
+    m_decodedTiles.setMaxCost( 8192 * 1024 ); // Cache size measured in bytes
     connect( this, SIGNAL(downloadTile(QUrl,QString,QString,DownloadUsage)),
              downloadManager, SLOT(addJob(QUrl,QString,QString,DownloadUsage)));
     connect( downloadManager, SIGNAL(downloadComplete(QString,QString)),
@@ -59,7 +87,8 @@ TileLoader::TileLoader(HttpDownloadManager * const downloadManager, const Plugin
 
 TileLoader::~TileLoader()
 {
-    // nothing to do
+    m_decodePool.clear();
+    m_decodePool.waitForDone();
 }
 
 // If the tile image file is locally available:
@@ -81,7 +110,23 @@ QImage TileLoader::loadTileImage( GeoSceneTextureTileDataset const *textureLayer
             triggerDownload( textureLayer, tileId, usage );
         }
 
-        QImage const image( fileName );
+        if ( m_decodeInBackground ) {
+            m_decodeMutex.lock();
+            const QImage *const decoded = m_decodedTiles.object( tileId );
+            const QImage image = decoded ? *decoded : QImage();
+            m_decodeMutex.unlock();
+            if ( !image.isNull() ) {
+                return image;
+            }
+
+            // hand the file over to the decode pool and show a scaled
+            // lower level tile until the real image arrives
+            decodeTile( textureLayer, tileId, usage, fileName, packedTileData( textureLayer, tileId ) );
+            return scaledLowerLevelTile( textureLayer, tileId );
+        }
+
+        QByteArray const packedData = packedTileData( textureLayer, tileId );
+        QImage const image = packedData.isEmpty() ? QImage( fileName ) : QImage::fromData( packedData );
         if ( !image.isNull() ) {
             // file is there, so create and return a tile object in any case
             return image;
@@ -188,7 +233,9 @@ bool TileLoader::baseTilesAvailable( GeoSceneTileDataset const & tileData )
         for ( int row = 0; result && row < levelZeroRows; ++row ) {
             const TileId id( 0, 0, column, row );
             const QString tilepath = tileFileName( &tileData, id );
-            result &= QFile::exists( tilepath );
+            TilePackArchive::Key key;
+            const TilePackArchive *const archive = tilePackArchive( &tileData, id, key );
+            result &= QFile::exists( tilepath ) || ( archive && archive->contains( key ) );
             if (!result) {
                 mDebug() << "Base tile " << tileData.relativeTileFileName( id ) << " is missing for source dir " << tileData.sourceDir();
             }
@@ -198,15 +245,39 @@ bool TileLoader::baseTilesAvailable( GeoSceneTileDataset const & tileData )
     return result;
 }
 
+void TileLoader::setDecodeInBackground( bool enabled )
+{
+    m_decodeInBackground = enabled;
+}
+
+bool TileLoader::decodeInBackground() const
+{
+    return m_decodeInBackground;
+}
+
+bool TileLoader::isDecoding( const TileId &tileId ) const
+{
+    QMutexLocker locker( &m_decodeMutex );
+    return m_pendingDecodes.contains( tileId );
+}
+
 TileLoader::TileStatus TileLoader::tileStatus( GeoSceneTileDataset const *tileData, const TileId &tileId )
 {
-    QString const fileName = tileFileName( tileData, tileId );
-    QFileInfo fileInfo( fileName );
-    if ( !fileInfo.exists() ) {
-        return Missing;
+    QDateTime lastModified;
+
+    TilePackArchive::Key key;
+    const TilePackArchive *const archive = tilePackArchive( tileData, tileId, key );
+    if ( archive && archive->contains( key ) ) {
+        lastModified = archive->lastModified( key );
+    } else {
+        QString const fileName = tileFileName( tileData, tileId );
+        QFileInfo fileInfo( fileName );
+        if ( !fileInfo.exists() ) {
+            return Missing;
+        }
+        lastModified = fileInfo.lastModified();
     }
 
-    const QDateTime lastModified = fileInfo.lastModified();
     const int expireSecs = tileData->expire();
     const bool isExpired = lastModified.secsTo( QDateTime::currentDateTime() ) >= expireSecs;
     return isExpired ? Expired : Available;
@@ -230,6 +301,10 @@ void TileLoader::updateTile( QByteArray const & data, QString const & idStr )
         if ( tileImage.isNull() )
             return;
 
+        m_decodeMutex.lock();
+        m_decodedTiles.remove( id );
+        m_decodeMutex.unlock();
+
         emit tileCompleted( id, tileImage );
     }
 }
@@ -254,6 +329,32 @@ void TileLoader::updateTile(const QString &fileName, const QString &idStr)
     }
 }
 
+void TileLoader::updateDecodedTile( const TileId &tileId, const QImage &tileImage )
+{
+    if ( tileImage.isNull() ) {
+        mDebug() << "Failed to decode tile" << tileId;
+
+        // the scaled lower level tile stays in place until the tile is downloaded again
+        m_decodeMutex.lock();
+        const PendingDecode pending = m_pendingDecodes.value( tileId );
+        m_decodeMutex.unlock();
+        if ( pending.textureData ) {
+            triggerDownload( pending.textureData, tileId, pending.usage );
+        }
+    } else {
+        m_decodeMutex.lock();
+        m_decodedTiles.insert( tileId, new QImage( tileImage ), tileImage.byteCount() );
+        m_decodeMutex.unlock();
+
+        // the tile is still marked as pending while notifying, so receivers can
+        // tell that the image was read locally rather than downloaded
+        emit tileCompleted( tileId, tileImage );
+    }
+
+    QMutexLocker locker( &m_decodeMutex );
+    m_pendingDecodes.remove( tileId );
+}
+
 QString TileLoader::tileFileName( GeoSceneTileDataset const * tileData, TileId const & tileId )
 {
     QString const fileName = tileData->relativeTileFileName( tileId );
@@ -277,6 +378,24 @@ void TileLoader::triggerDownload( GeoSceneTileDataset const *tileData, TileId co
     emit downloadTile( sourceUrl, destFileName, idStr, usage );
 }
 
+void TileLoader::decodeTile( GeoSceneTextureTileDataset const *textureData, TileId const &tileId, DownloadUsage const usage,
+                             QString const &fileName, QByteArray const &packedData )
+{
+    QMutexLocker locker( &m_decodeMutex );
+    if ( m_pendingDecodes.contains( tileId ) ) {
+        return;
+    }
+    const PendingDecode pending = { textureData, usage };
+    m_pendingDecodes.insert( tileId, pending );
+    locker.unlock();
+
+    TileDecodeJob *const job = packedData.isEmpty() ? new TileDecodeJob( tileId, fileName )
+                                                    : new TileDecodeJob( tileId, packedData );
+    connect( job, SIGNAL(tileDecoded(TileId,QImage)),
+             this, SLOT(updateDecodedTile(TileId,QImage)), Qt::QueuedConnection );
+    m_decodePool.start( job );
+}
+
 QImage TileLoader::scaledLowerLevelTile( const GeoSceneTextureTileDataset * textureData, TileId const & id )
 {
     mDebug() << Q_FUNC_INFO << id;
@@ -290,9 +409,32 @@ QImage TileLoader::scaledLowerLevelTile( const GeoSceneTextureTileDataset * text
 
         TileId const replacementTileId( id.mapThemeIdHash(), level,
                                         id.x() >> deltaLevel, id.y() >> deltaLevel );
-        QString const fileName = tileFileName( textureData, replacementTileId );
-        mDebug() << "TileLoader::scaledLowerLevelTile" << "trying" << fileName;
-        QImage toScale = QFile::exists(fileName) ? QImage(fileName) : QImage();
+        QImage toScale;
+        if ( m_decodeInBackground ) {
+            // only use images that have been decoded already, except for the
+            // base level which is needed as the placeholder of last resort
+            QMutexLocker locker( &m_decodeMutex );
+            const QImage *const decoded = m_decodedTiles.object( replacementTileId );
+            if ( decoded ) {
+                toScale = *decoded;
+            }
+        }
+
+        if ( toScale.isNull() && ( !m_decodeInBackground || level == 0 ) ) {
+            QByteArray const packedData = packedTileData( textureData, replacementTileId );
+            if ( !packedData.isEmpty() ) {
+                toScale = QImage::fromData( packedData );
+            } else {
+                QString const fileName = tileFileName( textureData, replacementTileId );
+                mDebug() << "TileLoader::scaledLowerLevelTile" << "trying" << fileName;
+                toScale = QFile::exists(fileName) ? QImage(fileName) : QImage();
+            }
+
+            if ( m_decodeInBackground && !toScale.isNull() ) {
+                QMutexLocker locker( &m_decodeMutex );
+                m_decodedTiles.insert( replacementTileId, new QImage( toScale ), toScale.byteCount() );
+            }
+        }
 
         if ( level == 0 && toScale.isNull() ) {
             mDebug() << "No level zero tile installed in map theme dir. Falling back to a transparent image for now.";
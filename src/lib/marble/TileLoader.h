@@ -21,18 +21,22 @@
 #define MARBLE_TILELOADER_H
 
 #include <QObject>
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QThreadPool>
 
 #include "PluginManager.h"
 #include "MarbleGlobal.h"
+#include "TileId.h"
 
 class QByteArray;
-class QImage;
 class QUrl;
 class QString;
 
 namespace Marble
 {
-class TileId;
 class HttpDownloadManager;
 class GeoDataDocument;
 class GeoSceneTileDataset;
@@ -73,9 +77,26 @@ class TileLoader: public QObject
       */
     static TileStatus tileStatus( GeoSceneTileDataset const *tileData, const TileId &tileId );
 
+    /**
+     * Sets whether locally available texture tiles are decoded on a worker pool.
+     *
+     * If enabled, loadTileImage() returns a scaled placeholder from a lower level
+     * right away and delivers the real image later through tileCompleted().
+     * Disabled by default, i.e. images are decoded in the calling thread.
+     */
+    void setDecodeInBackground( bool enabled );
+    bool decodeInBackground() const;
+
+    /**
+     * Returns whether the image of the tile @p tileId is currently being decoded
+     * in the background.
+     */
+    bool isDecoding( const TileId &tileId ) const;
+
  private Q_SLOTS:
     void updateTile( QByteArray const & imageData, QString const & tileId );
     void updateTile( QString const & fileName, QString const & idStr );
+    void updateDecodedTile( const TileId &tileId, const QImage &tileImage );
 
  Q_SIGNALS:
     void downloadTile( QUrl const & sourceUrl, QString const & destinationFileName,
@@ -88,11 +109,26 @@ class TileLoader: public QObject
  private:
     static QString tileFileName( GeoSceneTileDataset const * tileData, TileId const & );
     void triggerDownload( GeoSceneTileDataset const *tileData, TileId const &, DownloadUsage const );
-    static QImage scaledLowerLevelTile( GeoSceneTextureTileDataset const * textureData, TileId const & );
+    QImage scaledLowerLevelTile( GeoSceneTextureTileDataset const * textureData, TileId const & );
+    void decodeTile( GeoSceneTextureTileDataset const *textureData, TileId const &tileId, DownloadUsage const usage,
+                     QString const &fileName, QByteArray const &packedData );
     GeoDataDocument* openVectorFile(const QString &filename) const;
 
     // For vectorTile parsing
     PluginManager const * m_pluginManager;
+
+    // For decoding texture tiles in the background
+    bool m_decodeInBackground;
+    QThreadPool m_decodePool;
+    mutable QMutex m_decodeMutex;
+    // the tiles being decoded, with what is needed to download them again
+    // should the local copy turn out to be corrupt
+    struct PendingDecode {
+        GeoSceneTextureTileDataset const *textureData;
+        DownloadUsage usage;
+    };
+    QHash<TileId, PendingDecode> m_pendingDecodes;
+    QCache<TileId, QImage> m_decodedTiles;
 };
 
 }
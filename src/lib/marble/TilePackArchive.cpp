@@ -0,0 +1,769 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include "TilePackArchive.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutexLocker>
+#include <QPair>
+#include <QStringList>
+#include <QtConcurrentRun>
+
+#include "MarbleDebug.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Marble
+{
+
+namespace
+{
+    const char indexMagic[4] = { 'M', 'T', 'P', 'I' };
+    const quint32 indexVersion = 1;
+    const quint32 initialCapacity = 4096;              // must be a power of two
+    const qint64 maximumPackFileSize = 512 * 1024 * 1024;
+    const qint64 minimumUnreferencedSize = 16 * 1024 * 1024; // before compacting after insertion
+    const qint64 missingArchiveInterval = 10000;             // ms until a directory is looked at again
+
+    QMutex s_archivesMutex;
+    QHash<QString, TilePackArchive *> s_archives;
+    QHash<QString, qint64> s_missingArchives;
+}
+
+// The on-disk structures are stored in native byte order, archives are
+// local caches and not meant to be copied between machines.
+struct TilePackArchive::IndexHeader
+{
+    char magic[4];
+    quint32 version;
+    quint32 capacity;
+    quint32 count;
+    quint32 packCount;
+    quint32 firstPack;  // the pack files are numbered consecutively from here
+    quint32 reserved[2];
+};
+
+struct TilePackArchive::IndexEntry
+{
+    quint32 level;      // level + 1, zero marks an empty slot
+    quint32 x;
+    quint32 y;
+    quint32 pack;
+    quint64 offset;
+    quint32 size;
+    quint32 timestamp;  // seconds since epoch, UTC
+};
+
+struct TilePackArchive::PackFile
+{
+    PackFile() : file( 0 ), map( 0 ), mappedSize( 0 ) {}
+
+    QFile *file;
+    uchar *map;
+    qint64 mappedSize;
+};
+
+static inline quint32 hashKey( const TilePackArchive::Key &key )
+{
+    quint64 hash = ( quint64( key.level ) << 58 ) ^ ( quint64( key.x ) << 29 ) ^ quint64( key.y );
+    // finalizer of splitmix64, spreads the tile coordinates across all bits
+    hash = ( hash ^ ( hash >> 30 ) ) * Q_UINT64_C( 0xbf58476d1ce4e5b9 );
+    hash = ( hash ^ ( hash >> 27 ) ) * Q_UINT64_C( 0x94d049bb133111eb );
+    return quint32( hash ^ ( hash >> 31 ) );
+}
+
+TilePackArchive::TilePackArchive( const QString &directory ) :
+    m_directory( directory ),
+    m_indexFile( 0 ),
+    m_index( 0 ),
+    m_packSize( 0 ),
+    m_dataSize( 0 ),
+    m_compactionScheduled( false )
+{
+}
+
+TilePackArchive::~TilePackArchive()
+{
+    foreach ( PackFile *pack, m_packFiles ) {
+        delete pack->file;
+        delete pack;
+    }
+    delete m_indexFile;
+}
+
+TilePackArchive *TilePackArchive::find( const QString &directory )
+{
+    const QString path = QDir::cleanPath( directory );
+
+    QMutexLocker locker( &s_archivesMutex );
+    QHash<QString, TilePackArchive *>::const_iterator it = s_archives.constFind( path );
+    if ( it != s_archives.constEnd() ) {
+        return it.value();
+    }
+
+    // remember missing archives for a while, so callers don't hit the disk for every tile
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QHash<QString, qint64>::const_iterator missing = s_missingArchives.constFind( path );
+    if ( missing != s_missingArchives.constEnd() && now - missing.value() < missingArchiveInterval ) {
+        return 0;
+    }
+
+    if ( QFile::exists( path + QLatin1String( "/tiles.idx" ) ) || QFile::exists( path + QLatin1String( "/tiles.idx.old" ) ) ) {
+        TilePackArchive *archive = new TilePackArchive( path );
+        if ( archive->open( false ) ) {
+            s_missingArchives.remove( path );
+            s_archives.insert( path, archive );
+            return archive;
+        }
+
+        mDebug() << "Failed to open tile pack archive" << path << archive->lastErrorMessage();
+        delete archive;
+    }
+
+    s_missingArchives.insert( path, now );
+    return 0;
+}
+
+TilePackArchive *TilePackArchive::create( const QString &directory )
+{
+    const QString path = QDir::cleanPath( directory );
+
+    QMutexLocker locker( &s_archivesMutex );
+    TilePackArchive *archive = s_archives.value( path, 0 );
+    if ( archive ) {
+        return archive;
+    }
+
+    archive = new TilePackArchive( path );
+    if ( !archive->open( true ) ) {
+        mDebug() << "Failed to create tile pack archive" << path << archive->lastErrorMessage();
+        delete archive;
+        return 0;
+    }
+
+    s_missingArchives.remove( path );
+    s_archives.insert( path, archive );
+    return archive;
+}
+
+bool TilePackArchive::parseFileName( const QString &fileName, QString &directory, Key &key )
+{
+    const QStringList components = QDir::cleanPath( fileName ).split( QLatin1Char( '/' ) );
+    if ( components.size() < 4 ) {
+        return false;
+    }
+
+    const int size = components.size();
+    const QString &levelName = components.at( size - 3 );
+    const QString &directoryName = components.at( size - 2 );
+    const QString baseName = components.at( size - 1 ).section( QLatin1Char( '.' ), 0, 0 );
+
+    bool ok = false;
+    const uint level = levelName.toUInt( &ok );
+    if ( !ok ) {
+        return false;
+    }
+
+    const uint column = directoryName.toUInt( &ok );
+    if ( !ok ) {
+        return false;
+    }
+
+    // Marble layout: <level>/<y>/<y>_<x>.<ext>, otherwise <level>/<x>/<y>.<ext>
+    const int separator = baseName.indexOf( QLatin1Char( '_' ) );
+    if ( separator >= 0 ) {
+        key.x = baseName.mid( separator + 1 ).toUInt( &ok );
+        key.y = column;
+    } else {
+        key.x = column;
+        key.y = baseName.toUInt( &ok );
+    }
+    if ( !ok ) {
+        return false;
+    }
+
+    key.level = level;
+    directory = QStringList( components.mid( 0, size - 3 ) ).join( QLatin1Char( '/' ) );
+    return true;
+}
+
+QString TilePackArchive::directory() const
+{
+    return m_directory;
+}
+
+int TilePackArchive::count() const
+{
+    QReadLocker locker( &m_lock );
+    return reinterpret_cast<const IndexHeader *>( m_index )->count;
+}
+
+qint64 TilePackArchive::size() const
+{
+    QReadLocker locker( &m_lock );
+    return m_packSize;
+}
+
+bool TilePackArchive::contains( const Key &key ) const
+{
+    QReadLocker locker( &m_lock );
+    return findEntry( key ) != 0;
+}
+
+QByteArray TilePackArchive::tileData( const Key &key ) const
+{
+    QReadLocker locker( &m_lock );
+
+    const IndexEntry *const entry = findEntry( key );
+    const PackFile *const pack = entry ? packFile( entry->pack ) : 0;
+    if ( !pack ) {
+        return QByteArray();
+    }
+
+    if ( pack->map && qint64( entry->offset + entry->size ) <= pack->mappedSize ) {
+        return QByteArray( reinterpret_cast<const char *>( pack->map + entry->offset ), entry->size );
+    }
+
+    // appended after the pack file was mapped
+    QMutexLocker readLocker( &m_readMutex );
+    if ( !pack->file->seek( entry->offset ) ) {
+        return QByteArray();
+    }
+    return pack->file->read( entry->size );
+}
+
+QDateTime TilePackArchive::lastModified( const Key &key ) const
+{
+    QReadLocker locker( &m_lock );
+
+    const IndexEntry *const entry = findEntry( key );
+    if ( !entry ) {
+        return QDateTime();
+    }
+
+    return QDateTime::fromMSecsSinceEpoch( qint64( entry->timestamp ) * 1000, Qt::UTC );
+}
+
+bool TilePackArchive::insertTile( const Key &key, const QByteArray &data, const QDateTime &lastModified )
+{
+    QMutexLocker writeLocker( &m_writeMutex );
+    QWriteLocker locker( &m_lock );
+
+    IndexHeader *header = reinterpret_cast<IndexHeader *>( m_index );
+    if ( 4 * ( header->count + 1 ) > 3 * header->capacity ) {
+        if ( !growIndex() ) {
+            return false;
+        }
+        header = reinterpret_cast<IndexHeader *>( m_index );
+    }
+
+    if ( m_packFiles.isEmpty() || m_packFiles.last()->file->size() + data.size() > maximumPackFileSize ) {
+        PackFile *const pack = openPackFile( header->firstPack + m_packFiles.size() );
+        if ( !pack ) {
+            return false;
+        }
+        m_packFiles.append( pack );
+        header->packCount = m_packFiles.size();
+    }
+    const quint32 packNumber = header->firstPack + m_packFiles.size() - 1;
+
+    QFile *const file = m_packFiles.last()->file;
+    QMutexLocker readLocker( &m_readMutex );
+    const qint64 offset = file->size();
+    if ( !file->seek( offset ) || file->write( data ) != data.size() || !file->flush() ) {
+        m_errorMessage = file->fileName() + QLatin1String( ": " ) + file->errorString();
+        return false;
+    }
+    readLocker.unlock();
+    m_packSize += data.size();
+    m_dataSize += data.size();
+
+    const QDateTime timestamp = lastModified.isValid() ? lastModified : QDateTime::currentDateTimeUtc();
+
+    IndexEntry *const entries = reinterpret_cast<IndexEntry *>( m_index + sizeof( IndexHeader ) );
+    IndexEntry *const entry = findSlot( entries, header->capacity, key );
+    if ( entry->level == 0 ) {
+        ++header->count;
+    } else {
+        m_dataSize -= entry->size;
+    }
+    entry->level = key.level + 1;
+    entry->x = key.x;
+    entry->y = key.y;
+    entry->pack = packNumber;
+    entry->offset = offset;
+    entry->size = data.size();
+    entry->timestamp = quint32( timestamp.toMSecsSinceEpoch() / 1000 );
+
+    // re-downloaded tiles would let the pack files grow without bounds otherwise
+    if ( !m_compactionScheduled && needsCompaction() ) {
+        m_compactionScheduled = true;
+        QtConcurrent::run( this, &TilePackArchive::compactInBackground );
+    }
+
+    return true;
+}
+
+qint64 TilePackArchive::removeTiles( int minimumLevel )
+{
+    QMutexLocker writeLocker( &m_writeMutex );
+
+    const IndexHeader *const header = reinterpret_cast<const IndexHeader *>( m_index );
+    const IndexEntry *const entries = reinterpret_cast<const IndexEntry *>( m_index + sizeof( IndexHeader ) );
+
+    QVector<IndexEntry> kept;
+    for ( quint32 i = 0; i < header->capacity; ++i ) {
+        if ( entries[i].level != 0 && int( entries[i].level - 1 ) < minimumLevel ) {
+            kept.append( entries[i] );
+        }
+    }
+
+    const qint64 packSize = m_packSize;
+    QWriteLocker locker( &m_lock );
+    replaceEntries( kept );
+    locker.unlock();
+    compact();
+
+    return packSize - m_packSize;
+}
+
+qint64 TilePackArchive::removeOldestTiles( qint64 bytes, int minimumLevel )
+{
+    QMutexLocker writeLocker( &m_writeMutex );
+
+    const IndexHeader *const header = reinterpret_cast<const IndexHeader *>( m_index );
+    const IndexEntry *const entries = reinterpret_cast<const IndexEntry *>( m_index + sizeof( IndexHeader ) );
+
+    QVector<IndexEntry> kept;
+    QVector<const IndexEntry *> removable;
+    for ( quint32 i = 0; i < header->capacity; ++i ) {
+        if ( entries[i].level == 0 ) {
+            continue;
+        }
+        if ( int( entries[i].level - 1 ) >= minimumLevel ) {
+            removable.append( &entries[i] );
+        } else {
+            kept.append( entries[i] );
+        }
+    }
+
+    std::sort( removable.begin(), removable.end(), []( const IndexEntry *entry1, const IndexEntry *entry2 ) {
+        return entry1->timestamp < entry2->timestamp;
+    } );
+    qint64 removedBytes = 0;
+    foreach ( const IndexEntry *entry, removable ) {
+        if ( removedBytes < bytes ) {
+            removedBytes += entry->size;
+        } else {
+            kept.append( *entry );
+        }
+    }
+
+    const qint64 packSize = m_packSize;
+    QWriteLocker locker( &m_lock );
+    replaceEntries( kept );
+    locker.unlock();
+    compact();
+
+    return packSize - m_packSize;
+}
+
+QString TilePackArchive::lastErrorMessage() const
+{
+    return m_errorMessage;
+}
+
+bool TilePackArchive::open( bool createIfMissing )
+{
+    if ( createIfMissing && !QDir( m_directory ).exists() ) {
+        QDir::root().mkpath( m_directory );
+    }
+
+    // growIndex() was interrupted between moving the old index aside and
+    // moving the new one in place
+    if ( !QFile::exists( indexFileName() ) && QFile::exists( backupIndexFileName() ) ) {
+        QFile::rename( backupIndexFileName(), indexFileName() );
+    }
+
+    m_indexFile = new QFile( indexFileName() );
+    const bool exists = m_indexFile->exists();
+    if ( !exists && !createIfMissing ) {
+        m_errorMessage = indexFileName() + QLatin1String( ": missing" );
+        return false;
+    }
+
+    if ( !m_indexFile->open( QIODevice::ReadWrite ) ) {
+        m_errorMessage = indexFileName() + QLatin1String( ": " ) + m_indexFile->errorString();
+        return false;
+    }
+
+    if ( !exists || m_indexFile->size() == 0 ) {
+        const qint64 size = sizeof( IndexHeader ) + initialCapacity * sizeof( IndexEntry );
+        if ( !m_indexFile->resize( size ) ) {
+            m_errorMessage = indexFileName() + QLatin1String( ": " ) + m_indexFile->errorString();
+            return false;
+        }
+        if ( !mapIndex() ) {
+            return false;
+        }
+        memset( m_index, 0, size );
+        IndexHeader *const header = reinterpret_cast<IndexHeader *>( m_index );
+        memcpy( header->magic, indexMagic, sizeof( indexMagic ) );
+        header->version = indexVersion;
+        header->capacity = initialCapacity;
+        removeStalePackFiles();
+        return true;
+    }
+
+    if ( !mapIndex() ) {
+        return false;
+    }
+
+    const IndexHeader *const header = reinterpret_cast<const IndexHeader *>( m_index );
+    if ( memcmp( header->magic, indexMagic, sizeof( indexMagic ) ) != 0 || header->version != indexVersion
+         || m_indexFile->size() != qint64( sizeof( IndexHeader ) + header->capacity * sizeof( IndexEntry ) ) ) {
+        m_errorMessage = indexFileName() + QLatin1String( ": invalid tile index" );
+        return false;
+    }
+
+    for ( quint32 i = 0; i < header->packCount; ++i ) {
+        PackFile *const pack = openPackFile( header->firstPack + i );
+        if ( !pack ) {
+            return false;
+        }
+        m_packFiles.append( pack );
+        m_packSize += pack->file->size();
+    }
+    removeStalePackFiles();
+
+    const IndexEntry *const entries = reinterpret_cast<const IndexEntry *>( m_index + sizeof( IndexHeader ) );
+    for ( quint32 i = 0; i < header->capacity; ++i ) {
+        if ( entries[i].level != 0 ) {
+            m_dataSize += entries[i].size;
+        }
+    }
+
+    return true;
+}
+
+bool TilePackArchive::mapIndex()
+{
+    m_index = m_indexFile->map( 0, m_indexFile->size() );
+    if ( !m_index ) {
+        m_errorMessage = indexFileName() + QLatin1String( ": " ) + m_indexFile->errorString();
+        return false;
+    }
+
+    return true;
+}
+
+bool TilePackArchive::growIndex()
+{
+    const IndexHeader *const oldHeader = reinterpret_cast<const IndexHeader *>( m_index );
+    const IndexEntry *const oldEntries = reinterpret_cast<const IndexEntry *>( m_index + sizeof( IndexHeader ) );
+    const quint32 capacity = 2 * oldHeader->capacity;
+
+    const QString newFileName = indexFileName() + QLatin1String( ".new" );
+    QFile *const newFile = new QFile( newFileName );
+    const qint64 size = sizeof( IndexHeader ) + capacity * sizeof( IndexEntry );
+    uchar *newIndex = 0;
+    if ( newFile->open( QIODevice::ReadWrite | QIODevice::Truncate ) && newFile->resize( size ) ) {
+        newIndex = newFile->map( 0, size );
+    }
+    if ( !newIndex ) {
+        m_errorMessage = newFileName + QLatin1String( ": " ) + newFile->errorString();
+        delete newFile;
+        QFile::remove( newFileName );
+        return false;
+    }
+
+    memset( newIndex, 0, size );
+    memcpy( newIndex, m_index, sizeof( IndexHeader ) );
+    reinterpret_cast<IndexHeader *>( newIndex )->capacity = capacity;
+
+    IndexEntry *const newEntries = reinterpret_cast<IndexEntry *>( newIndex + sizeof( IndexHeader ) );
+    for ( quint32 i = 0; i < oldHeader->capacity; ++i ) {
+        if ( oldEntries[i].level != 0 ) {
+            const Key key = { oldEntries[i].level - 1, oldEntries[i].x, oldEntries[i].y };
+            *findSlot( newEntries, capacity, key ) = oldEntries[i];
+        }
+    }
+
+    newFile->unmap( newIndex );
+    newFile->close();
+    delete newFile;
+
+    // the old index stays in use until the new one is in place
+    QFile::remove( backupIndexFileName() );
+    if ( !QFile::rename( indexFileName(), backupIndexFileName() ) ) {
+        m_errorMessage = indexFileName() + QLatin1String( ": cannot replace tile index" );
+        QFile::remove( newFileName );
+        return false;
+    }
+    if ( !QFile::rename( newFileName, indexFileName() ) ) {
+        m_errorMessage = newFileName + QLatin1String( ": cannot replace tile index" );
+        QFile::rename( backupIndexFileName(), indexFileName() );
+        QFile::remove( newFileName );
+        return false;
+    }
+
+    QFile *const indexFile = new QFile( indexFileName() );
+    uchar *const index = indexFile->open( QIODevice::ReadWrite ) ? indexFile->map( 0, size ) : 0;
+    if ( !index ) {
+        m_errorMessage = indexFileName() + QLatin1String( ": " ) + indexFile->errorString();
+        delete indexFile;
+        QFile::remove( indexFileName() );
+        QFile::rename( backupIndexFileName(), indexFileName() );
+        return false;
+    }
+
+    m_indexFile->unmap( m_index );
+    m_indexFile->close();
+    delete m_indexFile;
+    m_indexFile = indexFile;
+    m_index = index;
+    QFile::remove( backupIndexFileName() );
+
+    return true;
+}
+
+TilePackArchive::PackFile *TilePackArchive::openPackFile( quint32 number )
+{
+    PackFile *const pack = new PackFile;
+    pack->file = new QFile( packFileName( number ) );
+    if ( !pack->file->open( QIODevice::ReadWrite ) ) {
+        m_errorMessage = pack->file->fileName() + QLatin1String( ": " ) + pack->file->errorString();
+        delete pack->file;
+        delete pack;
+        return 0;
+    }
+
+    // The mapping covers the data present at this point. It stays valid while
+    // data gets appended, newer tiles are read through the file instead.
+    pack->mappedSize = pack->file->size();
+    if ( pack->mappedSize > 0 ) {
+        pack->map = pack->file->map( 0, pack->mappedSize );
+        if ( !pack->map ) {
+            pack->mappedSize = 0;
+        }
+    }
+
+    return pack;
+}
+
+const TilePackArchive::PackFile *TilePackArchive::packFile( quint32 number ) const
+{
+    const quint32 firstPack = reinterpret_cast<const IndexHeader *>( m_index )->firstPack;
+    if ( number < firstPack || number - firstPack >= quint32( m_packFiles.size() ) ) {
+        return 0;
+    }
+
+    return m_packFiles.at( number - firstPack );
+}
+
+void TilePackArchive::removeStalePackFiles()
+{
+    // left behind by an interrupted compaction
+    const IndexHeader *const header = reinterpret_cast<const IndexHeader *>( m_index );
+    QDirIterator it( m_directory, QStringList() << QStringLiteral( "tiles-*.pack" ), QDir::Files );
+    while ( it.hasNext() ) {
+        it.next();
+        bool ok = false;
+        const quint32 number = it.fileName().mid( 6 ).section( QLatin1Char( '.' ), 0, 0 ).toUInt( &ok );
+        if ( ok && ( number < header->firstPack || number - header->firstPack >= header->packCount ) ) {
+            QFile::remove( it.filePath() );
+        }
+    }
+}
+
+void TilePackArchive::replaceEntries( const QVector<IndexEntry> &kept )
+{
+    IndexHeader *const header = reinterpret_cast<IndexHeader *>( m_index );
+    IndexEntry *const entries = reinterpret_cast<IndexEntry *>( m_index + sizeof( IndexHeader ) );
+
+    // open addressing doesn't allow holes, so the table is filled anew
+    memset( entries, 0, header->capacity * sizeof( IndexEntry ) );
+    m_dataSize = 0;
+    foreach ( const IndexEntry &entry, kept ) {
+        const Key key = { entry.level - 1, entry.x, entry.y };
+        *findSlot( entries, header->capacity, key ) = entry;
+        m_dataSize += entry.size;
+    }
+    header->count = kept.size();
+}
+
+bool TilePackArchive::needsCompaction() const
+{
+    const qint64 unreferencedSize = m_packSize - m_dataSize;
+    return unreferencedSize > minimumUnreferencedSize && unreferencedSize > m_dataSize;
+}
+
+void TilePackArchive::compactInBackground()
+{
+    QMutexLocker writeLocker( &m_writeMutex );
+    m_compactionScheduled = false;
+
+    // removing tiles may have compacted the pack files meanwhile
+    if ( needsCompaction() && !compact() ) {
+        mDebug() << "Failed to compact tile pack archive" << m_directory << m_errorMessage;
+    }
+}
+
+bool TilePackArchive::compact()
+{
+    // Only changes to the archive are excluded by m_writeMutex while the tiles
+    // get copied, readers are locked out once the index gets updated.
+    IndexHeader *const header = reinterpret_cast<IndexHeader *>( m_index );
+    IndexEntry *const entries = reinterpret_cast<IndexEntry *>( m_index + sizeof( IndexHeader ) );
+
+    // copy the tiles in the order of the old pack files to read them sequentially
+    QVector<IndexEntry *> tiles;
+    tiles.reserve( header->count );
+    for ( quint32 i = 0; i < header->capacity; ++i ) {
+        if ( entries[i].level != 0 && packFile( entries[i].pack ) ) {
+            tiles.append( &entries[i] );
+        }
+    }
+    std::sort( tiles.begin(), tiles.end(), []( const IndexEntry *entry1, const IndexEntry *entry2 ) {
+        return entry1->pack < entry2->pack || ( entry1->pack == entry2->pack && entry1->offset < entry2->offset );
+    } );
+
+    // The remaining tiles are written to pack files numbered after the current
+    // ones. The index is only pointed to them once all data is written.
+    const quint32 firstPack = header->firstPack + m_packFiles.size();
+    QVector<PackFile *> packFiles;
+    QVector<QPair<quint32, quint64> > locations;
+    locations.reserve( tiles.size() );
+    qint64 packSize = 0;
+    bool ok = true;
+    foreach ( const IndexEntry *entry, tiles ) {
+        const PackFile *const pack = packFile( entry->pack );
+        QByteArray data;
+        if ( pack->map && qint64( entry->offset + entry->size ) <= pack->mappedSize ) {
+            data = QByteArray::fromRawData( reinterpret_cast<const char *>( pack->map + entry->offset ), entry->size );
+        } else {
+            QMutexLocker readLocker( &m_readMutex );
+            if ( pack->file->seek( entry->offset ) ) {
+                data = pack->file->read( entry->size );
+            }
+        }
+
+        if ( packFiles.isEmpty() || packFiles.last()->file->size() + data.size() > maximumPackFileSize ) {
+            QFile::remove( packFileName( firstPack + packFiles.size() ) );
+            PackFile *const newPack = openPackFile( firstPack + packFiles.size() );
+            if ( !newPack ) {
+                ok = false;
+                break;
+            }
+            packFiles.append( newPack );
+        }
+
+        QFile *const file = packFiles.last()->file;
+        const qint64 offset = file->size();
+        if ( data.size() != int( entry->size ) || file->write( data ) != data.size() ) {
+            m_errorMessage = file->fileName() + QLatin1String( ": " ) + file->errorString();
+            ok = false;
+            break;
+        }
+        locations.append( qMakePair( firstPack + packFiles.size() - 1, quint64( offset ) ) );
+        packSize += data.size();
+    }
+
+    foreach ( PackFile *pack, packFiles ) {
+        ok = pack->file->flush() && ok;
+    }
+
+    if ( !ok ) {
+        foreach ( PackFile *pack, packFiles ) {
+            const QString fileName = pack->file->fileName();
+            delete pack->file;
+            delete pack;
+            QFile::remove( fileName );
+        }
+        return false;
+    }
+
+    QWriteLocker locker( &m_lock );
+    for ( int i = 0; i < tiles.size(); ++i ) {
+        tiles[i]->pack = locations.at( i ).first;
+        tiles[i]->offset = locations.at( i ).second;
+    }
+    header->firstPack = firstPack;
+    header->packCount = packFiles.size();
+
+    // tileData() hands out copies, so nothing refers to the old mappings anymore
+    foreach ( PackFile *pack, m_packFiles ) {
+        const QString fileName = pack->file->fileName();
+        delete pack->file;
+        delete pack;
+        QFile::remove( fileName );
+    }
+    m_packFiles.clear();
+
+    foreach ( PackFile *pack, packFiles ) {
+        pack->mappedSize = pack->file->size();
+        pack->map = pack->mappedSize > 0 ? pack->file->map( 0, pack->mappedSize ) : 0;
+        if ( !pack->map ) {
+            pack->mappedSize = 0;
+        }
+        m_packFiles.append( pack );
+    }
+    m_packSize = packSize;
+
+    return true;
+}
+
+QString TilePackArchive::indexFileName() const
+{
+    return m_directory + QLatin1String( "/tiles.idx" );
+}
+
+QString TilePackArchive::backupIndexFileName() const
+{
+    return m_directory + QLatin1String( "/tiles.idx.old" );
+}
+
+QString TilePackArchive::packFileName( quint32 number ) const
+{
+    return m_directory + QString( "/tiles-%1.pack" ).arg( number );
+}
+
+const TilePackArchive::IndexEntry *TilePackArchive::findEntry( const Key &key ) const
+{
+    if ( !m_index ) {
+        return 0;
+    }
+
+    const IndexHeader *const header = reinterpret_cast<const IndexHeader *>( m_index );
+    IndexEntry *const entries = reinterpret_cast<IndexEntry *>( m_index + sizeof( IndexHeader ) );
+    const IndexEntry *const entry = findSlot( entries, header->capacity, key );
+
+    return entry->level != 0 ? entry : 0;
+}
+
+TilePackArchive::IndexEntry *TilePackArchive::findSlot( IndexEntry *entries, quint32 capacity, const Key &key ) const
+{
+    // linear probing, the load factor is kept below 3/4 so there always is an empty slot
+    const quint32 mask = capacity - 1;
+    for ( quint32 slot = hashKey( key ) & mask; ; slot = ( slot + 1 ) & mask ) {
+        IndexEntry *const entry = &entries[slot];
+        if ( entry->level == 0 ||
+             ( entry->level == key.level + 1 && entry->x == key.x && entry->y == key.y ) ) {
+            return entry;
+        }
+    }
+}
+
+}
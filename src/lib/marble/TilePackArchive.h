@@ -0,0 +1,171 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#ifndef MARBLE_TILEPACKARCHIVE_H
+#define MARBLE_TILEPACKARCHIVE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QString>
+#include <QVector>
+
+#include "marble_export.h"
+
+class QFile;
+
+namespace Marble
+{
+
+/**
+ * @short Storage of many tiles in a few large append-only pack files.
+ *
+ * A tile pack archive replaces the level/x/y directory structure of a map
+ * theme's tile cache. The tile data is appended to pack files named
+ * tiles-<n>.pack and located through tiles.idx, an open addressing hash table
+ * keyed by (level, x, y) that is memory mapped and therefore usable right
+ * away without scanning the cache on startup. Pack files are memory mapped as
+ * well, so tileData() usually reads the tile without a system call.
+ *
+ * Keys are derived from the relative tile file names of the storage layout
+ * by parseFileName(). This yields (level, x, y) for the Marble and the
+ * OpenStreetMap layout, the TileMapService layout keeps its row numbering.
+ *
+ * Replaced and removed tiles leave unreferenced data in the pack files until
+ * they get compacted, which rewrites the remaining tiles into new pack files
+ * and removes the old ones.
+ *
+ * Archives are shared per directory and stay open until the application
+ * quits. All methods are thread-safe. Changes to the archive are serialized
+ * by a mutex, readers are only locked out while the index gets updated, not
+ * while a compaction copies the tiles.
+ */
+class MARBLE_EXPORT TilePackArchive
+{
+ public:
+    struct Key
+    {
+        quint32 level;
+        quint32 x;
+        quint32 y;
+    };
+
+    /**
+     * Returns the archive stored in @p directory or 0 if the directory does
+     * not contain an archive. Directories without an archive are looked at
+     * again after a few seconds only.
+     */
+    static TilePackArchive *find( const QString &directory );
+
+    /**
+     * Returns the archive stored in @p directory, creating an empty one if
+     * the directory does not contain an archive yet. Returns 0 on errors.
+     */
+    static TilePackArchive *create( const QString &directory );
+
+    /**
+     * Splits a tile file name of the form <directory>/<level>/<a>/<b>.<ext>
+     * into the directory of the archive and the key of the tile.
+     */
+    static bool parseFileName( const QString &fileName, QString &directory, Key &key );
+
+    QString directory() const;
+
+    /**
+     * Returns the number of tiles stored in the archive.
+     */
+    int count() const;
+
+    /**
+     * Returns the size of the pack files in bytes, which includes data not
+     * referenced anymore until the pack files are compacted.
+     */
+    qint64 size() const;
+
+    bool contains( const Key &key ) const;
+
+    /**
+     * Returns the data of the tile @p key or an empty byte array if the
+     * archive does not contain the tile. The returned data is a copy, so
+     * the pack files can be compacted meanwhile.
+     */
+    QByteArray tileData( const Key &key ) const;
+
+    /**
+     * Returns the time the tile @p key was stored in the archive.
+     */
+    QDateTime lastModified( const Key &key ) const;
+
+    /**
+     * Appends @p data to the current pack file and points the index entry of
+     * @p key to it. Data stored for the key before is left unreferenced. Once
+     * most of the data is unreferenced, the pack files get compacted by a
+     * job of the global thread pool.
+     */
+    bool insertTile( const Key &key, const QByteArray &data, const QDateTime &lastModified = QDateTime() );
+
+    /**
+     * Removes all tiles of level @p minimumLevel and above and compacts the
+     * pack files. Returns the number of bytes the pack files shrank by.
+     */
+    qint64 removeTiles( int minimumLevel );
+
+    /**
+     * Removes the least recently stored tiles of level @p minimumLevel and
+     * above until their data amounts to at least @p bytes, and compacts the
+     * pack files. Returns the number of bytes the pack files shrank by.
+     */
+    qint64 removeOldestTiles( qint64 bytes, int minimumLevel );
+
+    QString lastErrorMessage() const;
+
+ private:
+    struct IndexHeader;
+    struct IndexEntry;
+    struct PackFile;
+
+    explicit TilePackArchive( const QString &directory );
+    ~TilePackArchive();
+    Q_DISABLE_COPY( TilePackArchive )
+
+    bool open( bool createIfMissing );
+    bool mapIndex();
+    bool growIndex();
+    PackFile *openPackFile( quint32 number );
+    const PackFile *packFile( quint32 number ) const;
+    void removeStalePackFiles();
+    void replaceEntries( const QVector<IndexEntry> &entries );
+    bool needsCompaction() const;
+    void compactInBackground();
+    bool compact();
+    QString indexFileName() const;
+    QString backupIndexFileName() const;
+    QString packFileName( quint32 number ) const;
+
+    const IndexEntry *findEntry( const Key &key ) const;
+    IndexEntry *findSlot( IndexEntry *entries, quint32 capacity, const Key &key ) const;
+
+    const QString m_directory;
+    mutable QReadWriteLock m_lock;
+    QMutex m_writeMutex;
+    mutable QMutex m_readMutex;
+    QFile *m_indexFile;
+    uchar *m_index;
+    QVector<PackFile *> m_packFiles;
+    qint64 m_packSize;
+    qint64 m_dataSize;
+    bool m_compactionScheduled;
+    QString m_errorMessage;
+};
+
+}
+
+#endif
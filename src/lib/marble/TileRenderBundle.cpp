@@ -0,0 +1,140 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include "TileRenderBundle.h"
+
+#include "GeoDataContainer.h"
+#include "GeoDataDocument.h"
+#include "GeoDataLinearRing.h"
+#include "GeoDataMultiGeometry.h"
+#include "GeoDataMultiTrack.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataPolygon.h"
+#include "GeoDataTrack.h"
+#include "GeoDataTypes.h"
+#include "GeoGraphicsItem.h"
+#include "GeoLineStringGraphicsItem.h"
+#include "GeoPolygonGraphicsItem.h"
+#include "GeoTrackGraphicsItem.h"
+#include "StyleBuilder.h"
+
+namespace Marble
+{
+
+TileRenderBundle::TileRenderBundle( const GeoDataDocument *document, const StyleBuilder *styleBuilder, int tileLevel ) :
+    m_document( document ),
+    m_styleBuilder( styleBuilder ),
+    m_tileLevel( tileLevel )
+{
+    if ( m_document && m_styleBuilder ) {
+        createItems( m_document );
+    }
+}
+
+TileRenderBundle::~TileRenderBundle()
+{
+    qDeleteAll( m_items );
+}
+
+const GeoDataDocument *TileRenderBundle::document() const
+{
+    return m_document;
+}
+
+GeoGraphicsItem *TileRenderBundle::takeItem( const GeoDataGeometry *geometry )
+{
+    return m_items.take( geometry );
+}
+
+int TileRenderBundle::size() const
+{
+    return m_items.size();
+}
+
+GeoGraphicsItem *TileRenderBundle::createItem( const GeoDataPlacemark *placemark, const GeoDataGeometry *geometry,
+                                               const StyleBuilder *styleBuilder )
+{
+    GeoGraphicsItem *item = 0;
+    if ( geometry->nodeType() == GeoDataTypes::GeoDataLineStringType ) {
+        const GeoDataLineString *line = static_cast<const GeoDataLineString*>( geometry );
+        item = new GeoLineStringGraphicsItem( placemark, line );
+    } else if ( geometry->nodeType() == GeoDataTypes::GeoDataLinearRingType ) {
+        const GeoDataLinearRing *ring = static_cast<const GeoDataLinearRing*>( geometry );
+        item = GeoPolygonGraphicsItem::createGraphicsItem( placemark, ring );
+    } else if ( geometry->nodeType() == GeoDataTypes::GeoDataPolygonType ) {
+        const GeoDataPolygon *poly = static_cast<const GeoDataPolygon*>( geometry );
+        item = GeoPolygonGraphicsItem::createGraphicsItem( placemark, poly );
+        if ( item->zValue() == 0 ) {
+            item->setZValue( poly->renderOrder() );
+        }
+    } else if ( geometry->nodeType() == GeoDataTypes::GeoDataTrackType ) {
+        const GeoDataTrack *track = static_cast<const GeoDataTrack*>( geometry );
+        item = new GeoTrackGraphicsItem( placemark, track );
+    }
+
+    if ( !item ) {
+        return 0;
+    }
+
+    item->setStyleBuilder( styleBuilder );
+    item->setVisible( placemark->isGloballyVisible() );
+    item->setMinZoomLevel( styleBuilder->minimumZoomLevel( *placemark ) );
+    return item;
+}
+
+void TileRenderBundle::createItems( const GeoDataFeature *feature )
+{
+    if ( feature->nodeType() == GeoDataTypes::GeoDataPlacemarkType ) {
+        const GeoDataPlacemark *placemark = static_cast<const GeoDataPlacemark*>( feature );
+        if ( placemark->geometry() ) {
+            createItems( placemark, placemark->geometry() );
+        }
+    } else if ( feature->nodeType() == GeoDataTypes::GeoDataDocumentType
+                || feature->nodeType() == GeoDataTypes::GeoDataFolderType ) {
+        const GeoDataContainer *container = static_cast<const GeoDataContainer*>( feature );
+        for ( int row = 0; row < container->size(); ++row ) {
+            createItems( container->child( row ) );
+        }
+    }
+}
+
+void TileRenderBundle::createItems( const GeoDataPlacemark *placemark, const GeoDataGeometry *geometry )
+{
+    if ( geometry->nodeType() == GeoDataTypes::GeoDataMultiGeometryType ) {
+        const GeoDataMultiGeometry *multigeo = static_cast<const GeoDataMultiGeometry*>( geometry );
+        for ( int row = 0; row < multigeo->size(); ++row ) {
+            createItems( placemark, multigeo->child( row ) );
+        }
+        return;
+    }
+
+    if ( geometry->nodeType() == GeoDataTypes::GeoDataMultiTrackType ) {
+        const GeoDataMultiTrack *multitrack = static_cast<const GeoDataMultiTrack*>( geometry );
+        for ( int row = 0; row < multitrack->size(); ++row ) {
+            createItems( placemark, multitrack->child( row ) );
+        }
+        return;
+    }
+
+    GeoGraphicsItem *item = createItem( placemark, geometry, m_styleBuilder );
+    if ( !item ) {
+        return;
+    }
+
+    // resolve the style and the bounding box now, so the first frame showing
+    // the tile does not have to
+    item->setRenderContext( RenderContext( m_tileLevel ) );
+    item->style();
+    item->latLonAltBox();
+
+    m_items.insert( geometry, item );
+}
+
+}
@@ -0,0 +1,81 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#ifndef MARBLE_TILERENDERBUNDLE_H
+#define MARBLE_TILERENDERBUNDLE_H
+
+#include <QHash>
+
+#include "marble_export.h"
+
+namespace Marble
+{
+
+class GeoDataDocument;
+class GeoDataFeature;
+class GeoDataGeometry;
+class GeoDataPlacemark;
+class GeoGraphicsItem;
+class StyleBuilder;
+
+/**
+ * @short The graphics items of a document, ready to paint.
+ *
+ * A bundle gets created by the worker thread which loaded the document,
+ * before the document is shared with any other thread. It creates the
+ * graphics items of all geometries, resolves their styles and calculates
+ * their bounding boxes. GeometryLayer then takes the prepared items instead
+ * of doing all that on the GUI thread.
+ */
+class MARBLE_EXPORT TileRenderBundle
+{
+ public:
+    /**
+     * Creates the graphics items of @p document with the styles for @p tileLevel.
+     */
+    TileRenderBundle( const GeoDataDocument *document, const StyleBuilder *styleBuilder, int tileLevel );
+
+    /**
+     * Deletes the items which were not taken.
+     */
+    ~TileRenderBundle();
+
+    const GeoDataDocument *document() const;
+
+    /**
+     * Removes the item of @p geometry from the bundle and returns it, or 0 if
+     * there is none. The caller takes ownership of the item.
+     */
+    GeoGraphicsItem *takeItem( const GeoDataGeometry *geometry );
+
+    int size() const;
+
+    /**
+     * Creates the graphics item for @p geometry of @p placemark. Returns 0 for
+     * multi geometries and geometries which are not painted by items.
+     */
+    static GeoGraphicsItem *createItem( const GeoDataPlacemark *placemark, const GeoDataGeometry *geometry,
+                                        const StyleBuilder *styleBuilder );
+
+ private:
+    Q_DISABLE_COPY( TileRenderBundle )
+
+    void createItems( const GeoDataFeature *feature );
+    void createItems( const GeoDataPlacemark *placemark, const GeoDataGeometry *geometry );
+
+    const GeoDataDocument *const m_document;
+    const StyleBuilder *const m_styleBuilder;
+    const int m_tileLevel;
+    QHash<const GeoDataGeometry *, GeoGraphicsItem *> m_items;
+};
+
+}
+
+#endif
@@ -22,15 +22,17 @@
 #include "MarbleMath.h"
 #include "TileId.h"
 #include "TileLoader.h"
+#include "TileRenderBundle.h"
 
 #include <qmath.h>
 #include <QThreadPool>
 
 namespace Marble {
 
-TileRunner::TileRunner( TileLoader *loader, const GeoSceneVectorTileDataset *texture, const TileId &id ) :
+TileRunner::TileRunner( TileLoader *loader, const GeoSceneVectorTileDataset *texture, const StyleBuilder *styleBuilder, const TileId &id ) :
     m_loader( loader ),
     m_texture( texture ),
+    m_styleBuilder( styleBuilder ),
     m_id( id )
 {
 }
@@ -39,7 +41,10 @@ void TileRunner::run()
 {
     GeoDataDocument *const document = m_loader->loadTileVectorData( m_texture, m_id, DownloadBrowse );
 
-    emit documentLoaded( m_id, document );
+    // The document is not shared with any other thread yet, so styling it here is safe.
+    TileRenderBundle *const bundle = document ? new TileRenderBundle( document, m_styleBuilder, m_id.zoomLevel() ) : 0;
+
+    emit documentLoaded( m_id, document, bundle );
 }
 
 VectorTileModel::CacheDocument::CacheDocument(GeoDataDocument *doc, VectorTileModel *vectorTileModel, const GeoDataLatLonBox &boundingBox) :
@@ -55,20 +60,33 @@ VectorTileModel::CacheDocument::~CacheDocument()
     m_vectorTileModel->removeTile(m_document);
 }
 
-VectorTileModel::VectorTileModel( TileLoader *loader, const GeoSceneVectorTileDataset *layer, GeoDataTreeModel *treeModel, QThreadPool *threadPool ) :
+VectorTileModel::VectorTileModel( TileLoader *loader, const GeoSceneVectorTileDataset *layer, GeoDataTreeModel *treeModel,
+                                  QThreadPool *threadPool, const StyleBuilder *styleBuilder ) :
     m_loader( loader ),
     m_layer( layer ),
     m_treeModel( treeModel ),
     m_threadPool( threadPool ),
+    m_styleBuilder( styleBuilder ),
     m_tileLoadLevel( -1 ),
     m_tileZoomLevel(-1),
     m_deleteDocumentsLater(false)
 {
-    connect(this, SIGNAL(tileAdded(GeoDataDocument*)), treeModel, SLOT(addDocument(GeoDataDocument*)) );
-    connect(this, SIGNAL(tileRemoved(GeoDataDocument*)), treeModel, SLOT(removeDocument(GeoDataDocument*)) );
+    // Tiles arrive and leave in bursts while panning. Collect them until
+    // control returns to the event loop, so that the tree model and its
+    // proxies see one insertion and few removals instead of one per tile.
+    m_commitTimer.setSingleShot( true );
+    m_commitTimer.setInterval( 0 );
+    connect( &m_commitTimer, SIGNAL(timeout()), this, SLOT(commitTiles()) );
+
     connect(treeModel, SIGNAL(removed(GeoDataObject*)), this, SLOT(cleanupTile(GeoDataObject*)) );
 }
 
+VectorTileModel::~VectorTileModel()
+{
+    m_documents.clear();
+    commitTiles();
+}
+
 void VectorTileModel::setViewport( const GeoDataLatLonBox &latLonBox, int radius )
 {
     // choose the smaller dimension for selecting the tile level, leading to higher-resolution results
@@ -165,7 +183,17 @@ QString VectorTileModel::name() const
 
 void VectorTileModel::removeTile(GeoDataDocument *document)
 {
-    emit tileRemoved(document);
+    const int pendingIndex = m_addedDocuments.indexOf( document );
+    if ( pendingIndex >= 0 ) {
+        // the tile never made it into the tree model
+        m_addedDocuments.remove( pendingIndex );
+        m_renderBundles.remove( document );
+        cleanupTile( document );
+        return;
+    }
+
+    m_removedDocuments << document;
+    m_commitTimer.start();
 }
 
 int VectorTileModel::tileZoomLevel() const
@@ -178,14 +206,18 @@ int VectorTileModel::cachedDocuments() const
     return m_documents.size();
 }
 
-void VectorTileModel::updateTile( const TileId &id, GeoDataDocument *document )
+void VectorTileModel::updateTile( const TileId &id, GeoDataDocument *document, TileRenderBundle *bundle )
 {
+    QSharedPointer<TileRenderBundle> renderBundle( bundle );
+
     m_pendingDocuments.removeAll(id);
     if (!document) {
         return;
     }
 
     if ( m_tileLoadLevel != id.zoomLevel() ) {
+        // the items of the bundle refer to the document, so they have to go first
+        renderBundle.clear();
         delete document;
         return;
     }
@@ -202,7 +234,11 @@ void VectorTileModel::updateTile( const TileId &id, GeoDataDocument *document )
     GeoDataLatLonBox boundingBox;
     m_layer->tileProjection()->geoCoordinates(id, boundingBox);
     m_documents[id] = QSharedPointer<CacheDocument>(new CacheDocument(document, this, boundingBox));
-    emit tileAdded(document);
+    m_addedDocuments << document;
+    if ( renderBundle ) {
+        m_renderBundles.insert( document, renderBundle );
+    }
+    m_commitTimer.start();
 }
 
 void VectorTileModel::clear()
@@ -219,14 +255,37 @@ void VectorTileModel::queryTiles( int tileZoomLevel,
            const TileId tileId = TileId( 0, tileZoomLevel, x, y );
            if ( !m_documents.contains( tileId ) && !m_pendingDocuments.contains( tileId ) ) {
                m_pendingDocuments << tileId;
-               TileRunner *job = new TileRunner( m_loader, m_layer, tileId );
-               connect( job, SIGNAL(documentLoaded(TileId,GeoDataDocument*)), this, SLOT(updateTile(TileId,GeoDataDocument*)) );
+               TileRunner *job = new TileRunner( m_loader, m_layer, m_styleBuilder, tileId );
+               connect( job, SIGNAL(documentLoaded(TileId,GeoDataDocument*,TileRenderBundle*)),
+                        this, SLOT(updateTile(TileId,GeoDataDocument*,TileRenderBundle*)) );
                m_threadPool->start( job );
            }
         }
     }
 }
 
+void VectorTileModel::commitTiles()
+{
+    m_commitTimer.stop();
+
+    // the tree model calls back into cleanupTile(), so take the pending
+    // changes before passing them on
+    QVector<GeoDataDocument*> removedDocuments;
+    removedDocuments.swap( m_removedDocuments );
+    m_treeModel->removeDocuments( removedDocuments );
+
+    QVector<GeoDataDocument*> addedDocuments;
+    addedDocuments.swap( m_addedDocuments );
+    foreach ( GeoDataDocument *document, addedDocuments ) {
+        const QSharedPointer<TileRenderBundle> bundle = m_renderBundles.value( document );
+        if ( bundle ) {
+            emit renderBundleReady( bundle );
+        }
+    }
+    m_renderBundles.clear();
+    m_treeModel->addDocuments( addedDocuments );
+}
+
 void VectorTileModel::cleanupTile(GeoDataObject *object)
 {
     if (object->nodeType() == GeoDataTypes::GeoDataDocumentType) {
@@ -15,7 +15,11 @@
 #include <QObject>
 #include <QRunnable>
 
+#include <QHash>
 #include <QMap>
+#include <QSharedPointer>
+#include <QTimer>
+#include <QVector>
 
 #include "TileId.h"
 #include "GeoDataLatLonBox.h"
@@ -29,22 +33,29 @@ class GeoDataDocument;
 class GeoDataTreeModel;
 class GeoSceneVectorTileDataset;
 class GeoDataObject;
+class StyleBuilder;
 class TileLoader;
+class TileRenderBundle;
 
 class TileRunner : public QObject, public QRunnable
 {
     Q_OBJECT
 
 public:
-    TileRunner( TileLoader *loader, const GeoSceneVectorTileDataset *texture, const TileId &id );
+    TileRunner( TileLoader *loader, const GeoSceneVectorTileDataset *texture, const StyleBuilder *styleBuilder, const TileId &id );
     void run();
 
 Q_SIGNALS:
-    void documentLoaded( const TileId &id, GeoDataDocument *document );
+    /**
+     * Emitted from the worker thread with the loaded @p document and the
+     * graphics items prepared for it. The receiver takes ownership of both.
+     */
+    void documentLoaded( const TileId &id, GeoDataDocument *document, TileRenderBundle *bundle );
 
 private:
     TileLoader *const m_loader;
     const GeoSceneVectorTileDataset *const m_texture;
+    const StyleBuilder *const m_styleBuilder;
     const TileId m_id;
 };
 
@@ -53,7 +64,10 @@ class VectorTileModel : public QObject
     Q_OBJECT
 
 public:
-    explicit VectorTileModel( TileLoader *loader, const GeoSceneVectorTileDataset *layer, GeoDataTreeModel *treeModel, QThreadPool *threadPool );
+    explicit VectorTileModel( TileLoader *loader, const GeoSceneVectorTileDataset *layer, GeoDataTreeModel *treeModel,
+                              QThreadPool *threadPool, const StyleBuilder *styleBuilder );
+
+    ~VectorTileModel();
 
     void setViewport( const GeoDataLatLonBox &bbox, int radius );
 
@@ -66,18 +80,28 @@ public:
     int cachedDocuments() const;
 
 public Q_SLOTS:
-    void updateTile( const TileId &id, GeoDataDocument *document );
+    void updateTile( const TileId &id, GeoDataDocument *document, TileRenderBundle *bundle = 0 );
 
     void clear();
 
 Q_SIGNALS:
     void tileCompleted( const TileId &tileId );
-    void tileAdded(GeoDataDocument *document);
-    void tileRemoved(GeoDataDocument *document);
+
+    /**
+     * Emitted right before the document of @p bundle gets added to the tree
+     * model, so that its prepared graphics items can be picked up.
+     */
+    void renderBundleReady( const QSharedPointer<Marble::TileRenderBundle> &bundle );
 
 private Q_SLOTS:
     void cleanupTile(GeoDataObject* feature);
 
+    /**
+     * Passes the tiles added and removed since the last call to the tree model
+     * in one batch each.
+     */
+    void commitTiles();
+
 private:
     void removeTilesOutOfView(const GeoDataLatLonBox &boundingBox);
     void queryTiles( int tileZoomLevel, unsigned int minX, unsigned int minY, unsigned int maxX, unsigned int maxY );
@@ -103,12 +127,17 @@ private:
     const GeoSceneVectorTileDataset *const m_layer;
     GeoDataTreeModel *const m_treeModel;
     QThreadPool *const m_threadPool;
+    const StyleBuilder *const m_styleBuilder;
     int m_tileLoadLevel;
     int m_tileZoomLevel;
     QList<TileId> m_pendingDocuments;
     QList<GeoDataDocument*> m_garbageQueue;
     QMap<TileId, QSharedPointer<CacheDocument> > m_documents;
     bool m_deleteDocumentsLater;
+    QVector<GeoDataDocument*> m_addedDocuments;
+    QVector<GeoDataDocument*> m_removedDocuments;
+    QHash<GeoDataDocument*, QSharedPointer<TileRenderBundle> > m_renderBundles;
+    QTimer m_commitTimer;
 };
 
 }
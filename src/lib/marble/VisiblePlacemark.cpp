@@ -18,7 +18,6 @@
 #include "GeoDataStyle.h"
 #include "GeoDataIconStyle.h"
 #include "GeoDataLabelStyle.h"
-#include "PlacemarkLayer.h"
 
 #include <QApplication>
 #include <QPainter>
@@ -33,10 +32,10 @@ VisiblePlacemark::VisiblePlacemark( const GeoDataPlacemark *placemark, const Geo
 {
     const RemoteIconLoader *remoteLoader = style->iconStyle().remoteIconLoader();
     QObject::connect( remoteLoader, SIGNAL(iconReady()),
-                     this, SLOT(setSymbolPixmap()) );
+                     this, SLOT(updateSymbol()) );
 
-    drawLabelPixmap();
-    setSymbolPixmap();
+    updateLabelKey();
+    updateSymbol();
 }
 
 const GeoDataPlacemark* VisiblePlacemark::placemark() const
@@ -44,9 +43,14 @@ const GeoDataPlacemark* VisiblePlacemark::placemark() const
     return m_placemark;
 }
 
-const QPixmap& VisiblePlacemark::symbolPixmap() const
+const QImage& VisiblePlacemark::symbolImage() const
 {
-    return m_symbolPixmap;
+    return m_symbolImage;
+}
+
+const QString& VisiblePlacemark::symbolKey() const
+{
+    return m_symbolKey;
 }
 
 bool VisiblePlacemark::selected() const
@@ -57,7 +61,7 @@ bool VisiblePlacemark::selected() const
 void VisiblePlacemark::setSelected( bool selected )
 {
     m_selected = selected;
-    drawLabelPixmap();
+    updateLabelKey();
 }
 
 const QPoint& VisiblePlacemark::symbolPosition() const
@@ -105,15 +109,17 @@ void VisiblePlacemark::setSymbolPosition( const QPoint& position )
     m_symbolPosition = position;
 }
 
-const QPixmap& VisiblePlacemark::labelPixmap() const
+const QString& VisiblePlacemark::labelKey() const
 {
-    return m_labelPixmap;
+    return m_labelKey;
 }
 
-void VisiblePlacemark::setSymbolPixmap()
+void VisiblePlacemark::updateSymbol()
 {
     if (m_style) {
-        m_symbolPixmap = QPixmap::fromImage(m_style->iconStyle().scaledIcon() );
+        m_symbolImage = m_style->iconStyle().scaledIcon();
+        // images share their cache key as long as they share their data
+        m_symbolKey = QLatin1Char('S') + QString::number( m_symbolImage.cacheKey() );
         emit updateNeeded();
     }
     else {
@@ -134,8 +140,8 @@ void VisiblePlacemark::setLabelRect( const QRectF& labelRect )
 void VisiblePlacemark::setStyle(const GeoDataStyle::ConstPtr &style)
 {
     m_style = style;
-    drawLabelPixmap();
-    setSymbolPixmap();
+    updateLabelKey();
+    updateSymbol();
 }
 
 GeoDataStyle::ConstPtr VisiblePlacemark::style() const
@@ -143,24 +149,42 @@ GeoDataStyle::ConstPtr VisiblePlacemark::style() const
     return m_style;
 }
 
-void VisiblePlacemark::drawLabelPixmap()
+VisiblePlacemark::LabelStyle VisiblePlacemark::labelStyle() const
+{
+    if ( m_selected ) {
+        return Selected;
+    } else if ( m_style->labelStyle().glow() ) {
+        return Glow;
+    }
+
+    return Normal;
+}
+
+void VisiblePlacemark::updateLabelKey()
 {
-    QString labelName = m_placemark->displayName();
+    const QString labelName = m_placemark->displayName();
     if ( labelName.isEmpty() || m_style->labelStyle().color() == QColor(Qt::transparent) ) {
-        m_labelPixmap = QPixmap();
+        m_labelKey.clear();
         return;
     }
 
-    QFont  labelFont  = m_style->labelStyle().scaledFont();
-    QColor labelColor = m_style->labelStyle().color();
+    m_labelKey = QLatin1Char('L') + QString::number( labelStyle() )
+               + QLatin1Char(':') + m_style->labelStyle().color().name( QColor::HexArgb )
+               + QLatin1Char(':') + m_style->labelStyle().scaledFont().key()
+               + QLatin1Char(':') + QString::number( m_style->labelStyle().glow() )
+               + QLatin1Char(':') + labelName;
+}
 
-    LabelStyle labelStyle = Normal;
-    if ( m_selected ) {
-        labelStyle = Selected;
-    } else if ( m_style->labelStyle().glow() ) {
-        labelStyle = Glow;
+QImage VisiblePlacemark::labelImage() const
+{
+    if ( m_labelKey.isEmpty() ) {
+        return QImage();
     }
 
+    const QString labelName = m_placemark->displayName();
+    QFont  labelFont  = m_style->labelStyle().scaledFont();
+    QColor labelColor = m_style->labelStyle().color();
+
     int textHeight = QFontMetrics( labelFont ).height();
 
     int textWidth;
@@ -172,29 +196,17 @@ void VisiblePlacemark::drawLabelPixmap()
         textWidth = ( QFontMetrics( labelFont ).width( labelName ) );
     }
 
+    QImage image( QSize( textWidth, textHeight ),
+                  QImage::Format_ARGB32_Premultiplied );
+    image.fill( 0 );
 
-    // Due to some XOrg bug this requires a workaround via
-    // QImage in some cases (at least with Qt 4.2).
-    if ( !PlacemarkLayer::m_useXWorkaround ) {
-        m_labelPixmap = QPixmap( QSize( textWidth, textHeight ) );
-        m_labelPixmap.fill( Qt::transparent );
-
-        QPainter labelPainter( &m_labelPixmap );
-
-        drawLabelText( labelPainter, labelName, labelFont, labelStyle, labelColor );
-    } else {
-        QImage image( QSize( textWidth, textHeight ),
-                      QImage::Format_ARGB32_Premultiplied );
-        image.fill( 0 );
-
-        QPainter labelPainter( &image );
+    QPainter labelPainter( &image );
 
-        drawLabelText( labelPainter, labelName, labelFont, labelStyle, labelColor );
+    drawLabelText( labelPainter, labelName, labelFont, labelStyle(), labelColor );
 
-        labelPainter.end();
+    labelPainter.end();
 
-        m_labelPixmap = QPixmap::fromImage( image );
-    }
+    return image;
 }
 
 void VisiblePlacemark::drawLabelText(QPainter &labelPainter, const QString &text,
@@ -16,13 +16,16 @@
 #ifndef MARBLE_VISIBLEPLACEMARK_H
 #define MARBLE_VISIBLEPLACEMARK_H
 
+#include <QImage>
 #include <QObject>
-#include <QPixmap>
 #include <QPoint>
 #include <QRectF>
+#include <QString>
 
 #include <GeoDataStyle.h>
 
+#include "marble_export.h"
+
 namespace Marble
 {
 
@@ -36,7 +39,7 @@ static const qreal s_labelOutlineWidth = 2.5;
  * This class is used by PlacemarkLayout to pass the visible place marks
  * to the PlacemarkPainter.
  */
-class VisiblePlacemark : public QObject
+class MARBLE_EXPORT VisiblePlacemark : public QObject
 {
  Q_OBJECT
 
@@ -50,9 +53,15 @@ class VisiblePlacemark : public QObject
     const GeoDataPlacemark* placemark() const;
 
     /**
-     * Returns the pixmap of the place mark symbol.
+     * Returns the image of the place mark symbol.
+     */
+    const QImage& symbolImage() const;
+
+    /**
+     * Returns a key that identifies the symbol image, shared by all place
+     * marks with the same symbol.
      */
-    const QPixmap& symbolPixmap() const;
+    const QString& symbolKey() const;
 
     /**
      * Returns the state of the place mark.
@@ -80,9 +89,15 @@ class VisiblePlacemark : public QObject
     void setSymbolPosition( const QPoint& position );
 
     /**
-     * Returns the pixmap of the place mark name label.
+     * Renders the image of the place mark name label.
+     */
+    QImage labelImage() const;
+
+    /**
+     * Returns a key that identifies the label image, shared by all place
+     * marks whose labels look the same. It is empty if there is no label.
      */
-    const QPixmap& labelPixmap() const;
+    const QString& labelKey() const;
 
     /**
      * Returns the area covered by the place mark name label on the map.
@@ -108,21 +123,23 @@ Q_SIGNALS:
     void updateNeeded();
 
 private Q_SLOTS:
-    void setSymbolPixmap();
+    void updateSymbol();
 
  private:
     static void drawLabelText( QPainter &labelPainter, const QString &text, const QFont &labelFont, LabelStyle labelStyle, const QColor &color );
-    void drawLabelPixmap();
+    LabelStyle labelStyle() const;
+    void updateLabelKey();
 
     const GeoDataPlacemark *m_placemark;
 
     // View stuff
     QPoint      m_symbolPosition; // position of the placemark's symbol
     bool        m_selected;       // state of the placemark
-    QPixmap     m_labelPixmap;    // the text label (most often name)
+    QString     m_labelKey;       // identifies the look of the text label (most often name)
     QRectF      m_labelRect;      // bounding box of label
 
-    mutable QPixmap     m_symbolPixmap; // cached value
+    QImage      m_symbolImage;
+    QString     m_symbolKey;
     GeoDataStyle::ConstPtr m_style;
 };
 
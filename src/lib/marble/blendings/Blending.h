@@ -16,13 +16,15 @@
 #ifndef MARBLE_BLENDING_H
 #define MARBLE_BLENDING_H
 
+#include "marble_export.h"
+
 class QImage;
 
 namespace Marble
 {
 class TextureTile;
 
-class Blending
+class MARBLE_EXPORT Blending
 {
  public:
     virtual ~Blending();
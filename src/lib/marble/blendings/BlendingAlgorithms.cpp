@@ -20,11 +20,62 @@
 #include <cmath>
 
 #include <QImage>
+#include <QMutexLocker>
 #include <QPainter>
 
 namespace Marble
 {
 
+// The row kernels below work on plain arrays of pixels without any calls
+// per pixel, so the compiler can vectorize them. The bottom row is
+// premultiplied, the top row is not. Both get blended by their colors and
+// the result is opaque, so it doesn't need to be premultiplied again.
+
+static void grayscaleRow( QRgb *bottom, QRgb const *top, int count )
+{
+    for ( int i = 0; i < count; ++i ) {
+        int const gray = qGray( top[i] );
+        bottom[i] = qRgb( gray, gray, gray );
+    }
+}
+
+static void lookupRow( QRgb *bottom, QRgb const *top, int count, uchar const *table )
+{
+    for ( int i = 0; i < count; ++i ) {
+        QRgb const bottomPixel = qUnpremultiply( bottom[i] );
+        QRgb const topPixel = top[i];
+        bottom[i] = qRgb( table[( qRed( bottomPixel ) << 8 ) | qRed( topPixel )],
+                          table[( qGreen( bottomPixel ) << 8 ) | qGreen( topPixel )],
+                          table[( qBlue( bottomPixel ) << 8 ) | qBlue( topPixel )] );
+    }
+}
+
+static void cloudsRow( QRgb *bottom, QRgb const *top, int count )
+{
+    for ( int i = 0; i < count; ++i ) {
+        qreal const c = qRed( top[i] ) / 255.0;
+        QRgb const bottomPixel = qUnpremultiply( bottom[i] );
+        int const bottomRed = qRed( bottomPixel );
+        int const bottomGreen = qGreen( bottomPixel );
+        int const bottomBlue = qBlue( bottomPixel );
+        bottom[i] = qRgb(( int )( bottomRed + ( 255 - bottomRed ) * c ),
+                         ( int )( bottomGreen + ( 255 - bottomGreen ) * c ),
+                         ( int )( bottomBlue + ( 255 - bottomBlue ) * c ));
+    }
+}
+
+// Returns @p image with 32 bit pixels that are not premultiplied
+static QImage argb32Image( QImage const &image )
+{
+    switch ( image.format() ) {
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32:
+        return image;
+    default:
+        return image.convertToFormat( QImage::Format_ARGB32 );
+    }
+}
+
 void OverpaintBlending::blend( QImage * const bottom, TextureTile const * const top ) const
 {
     Q_ASSERT( bottom );
@@ -45,23 +96,25 @@ void GrayscaleBlending::blend( QImage * const bottom, TextureTile const * const
     Q_ASSERT( top->image() );
     Q_ASSERT( bottom->size() == top->image()->size() );
     Q_ASSERT( bottom->format() == QImage::Format_ARGB32_Premultiplied );
-    QImage const topImagePremult = top->image()->convertToFormat( QImage::Format_ARGB32_Premultiplied );
+    QImage const topImage32 = argb32Image( *top->image() );
 
     // Draw a grayscale version of the bottom image
     int const width = bottom->width();
     int const height = bottom->height();
 
     for ( int y = 0; y < height; ++y ) {
-        for ( int x = 0; x < width; ++x ) {
-            QRgb const topPixel = topImagePremult.pixel( x, y );
-            int const gray = qGray( topPixel );
-            QRgb const grayPixel = qRgb( gray, gray, gray );
-            bottom->setPixel( x, y,grayPixel );
-        }
+        QRgb *const bottomLine = reinterpret_cast<QRgb *>( bottom->scanLine( y ) );
+        QRgb const *const topLine = reinterpret_cast<QRgb const *>( topImage32.constScanLine( y ) );
+        grayscaleRow( bottomLine, topLine, width );
     }
 
 }
 
+IndependentChannelBlending::IndependentChannelBlending()
+    : m_lookupTableReady( 0 )
+{
+}
+
 // pre-conditions:
 // - bottom and top image have the same size
 // - bottom image format is ARGB32_Premultiplied
@@ -75,22 +128,34 @@ void IndependentChannelBlending::blend( QImage * const bottom,
 
     int const width = bottom->width();
     int const height = bottom->height();
-    QImage const topImagePremult = topImage->convertToFormat( QImage::Format_ARGB32_Premultiplied );
+    QImage const topImage32 = argb32Image( *topImage );
+    uchar const *const table = lookupTable();
     for ( int y = 0; y < height; ++y ) {
-        for ( int x = 0; x < width; ++x ) {
-            QRgb const bottomPixel = bottom->pixel( x, y );
-            QRgb const topPixel = topImagePremult.pixel( x, y );
-            qreal const resultRed = blendChannel( qRed( bottomPixel ) / 255.0,
-                                                  qRed( topPixel ) / 255.0 );
-            qreal const resultGreen = blendChannel( qGreen( bottomPixel ) / 255.0,
-                                                    qGreen( topPixel ) / 255.0 );
-            qreal const resultBlue = blendChannel( qBlue( bottomPixel ) / 255.0,
-                                                   qBlue( topPixel ) / 255.0 );
-            bottom->setPixel( x, y, qRgb( resultRed * 255.0,
-                                          resultGreen * 255.0,
-                                          resultBlue * 255.0 ));
+        QRgb *const bottomLine = reinterpret_cast<QRgb *>( bottom->scanLine( y ) );
+        QRgb const *const topLine = reinterpret_cast<QRgb const *>( topImage32.constScanLine( y ) );
+        lookupRow( bottomLine, topLine, width, table );
+    }
+}
+
+uchar const *IndependentChannelBlending::lookupTable() const
+{
+    // blend() may run on several threads at once
+    if ( !m_lookupTableReady.loadAcquire() ) {
+        QMutexLocker locker( &m_lookupTableMutex );
+        if ( !m_lookupTableReady.load() ) {
+            m_lookupTable.resize( 256 * 256 );
+            for ( int bottom = 0; bottom < 256; ++bottom ) {
+                for ( int top = 0; top < 256; ++top ) {
+                    // same conversion as qRgb() applies to the blended intensity
+                    int const result = blendChannel( bottom / 255.0, top / 255.0 ) * 255.0;
+                    m_lookupTable[( bottom << 8 ) | top] = uchar( result & 0xff );
+                }
+            }
+            m_lookupTableReady.storeRelease( 1 );
         }
     }
+
+    return m_lookupTable.constData();
 }
 
 
@@ -327,17 +392,18 @@ void CloudsBlending::blend( QImage * const bottom, TextureTile const * const top
     Q_ASSERT( bottom->size() == topImage->size() );
     int const width = bottom->width();
     int const height = bottom->height();
+
+    // The rows are processed as 32 bit pixels, RGB32 pixels are opaque and
+    // therefore premultiplied already
+    QImage const topImage32 = argb32Image( *topImage );
+    if ( bottom->format() != QImage::Format_RGB32 && bottom->format() != QImage::Format_ARGB32_Premultiplied ) {
+        *bottom = bottom->convertToFormat( QImage::Format_ARGB32_Premultiplied );
+    }
+
     for ( int y = 0; y < height; ++y ) {
-        for ( int x = 0; x < width; ++x ) {
-            qreal const c = qRed( topImage->pixel( x, y )) / 255.0;
-            QRgb const bottomPixel = bottom->pixel( x, y );
-            int const bottomRed = qRed( bottomPixel );
-            int const bottomGreen = qGreen( bottomPixel );
-            int const bottomBlue = qBlue( bottomPixel );
-            bottom->setPixel( x, y, qRgb(( int )( bottomRed + ( 255 - bottomRed ) * c ),
-                                         ( int )( bottomGreen + ( 255 - bottomGreen ) * c ),
-                                         ( int )( bottomBlue + ( 255 - bottomBlue ) * c )));
-        }
+        QRgb *const bottomLine = reinterpret_cast<QRgb *>( bottom->scanLine( y ) );
+        QRgb const *const topLine = reinterpret_cast<QRgb const *>( topImage32.constScanLine( y ) );
+        cloudsRow( bottomLine, topLine, width );
     }
 }
 
@@ -16,9 +16,13 @@
 #ifndef MARBLE_BLENDING_ALGORITHMS_H
 #define MARBLE_BLENDING_ALGORITHMS_H
 
+#include <QAtomicInt>
+#include <QMutex>
 #include <QtGlobal>
+#include <QVector>
 
 #include "Blending.h"
+#include "marble_export.h"
 
 namespace Marble
 {
@@ -29,23 +33,33 @@ class OverpaintBlending: public Blending
     virtual void blend( QImage * const bottom, TextureTile const * const top ) const;
 };
 
-class IndependentChannelBlending: public Blending
+class MARBLE_EXPORT IndependentChannelBlending: public Blending
 {
  public:
+    IndependentChannelBlending();
     virtual void blend( QImage * const bottom, TextureTile const * const top ) const;
  private:
+    // Returns the blended 8 bit intensities of all pairs of bottom and top
+    // intensities, indexed by ( bottom << 8 ) | top. As the table is built
+    // once, blending a row only needs three lookups per pixel.
+    const uchar *lookupTable() const;
+
     // bottomColorIntensity: intensity of one color channel (of one pixel) of the bottom image
     // topColorIntensity: intensity of one color channel (of one pixel) of the top image
     // return: intensity of the color channel (of a given pixel) of the result image
     // all color intensity values are in the range 0..1
     virtual qreal blendChannel( qreal const bottomColorIntensity,
                                 qreal const topColorIntensity ) const = 0;
+
+    mutable QVector<uchar> m_lookupTable;
+    mutable QAtomicInt m_lookupTableReady;
+    mutable QMutex m_lookupTableMutex;
 };
 
 
 // Neutral blendings
 
-class AllanonBlending: public IndependentChannelBlending
+class MARBLE_EXPORT AllanonBlending: public IndependentChannelBlending
 {
     virtual qreal blendChannel( qreal const bottomColorIntensity,
                                 qreal const topColorIntensity ) const;
@@ -241,13 +255,13 @@ class HalfDifferenceBlending: public IndependentChannelBlending
 
 // Special purpose blendings
 
-class CloudsBlending: public Blending
+class MARBLE_EXPORT CloudsBlending: public Blending
 {
  public:
     virtual void blend( QImage * const bottom, TextureTile const * const top ) const;
 };
 
-class GrayscaleBlending: public Blending
+class MARBLE_EXPORT GrayscaleBlending: public Blending
 {
  public:
     virtual void blend( QImage * const bottom, TextureTile const * const top ) const;
@@ -39,8 +39,8 @@ Blending const * BlendingFactory::findBlending( QString const & name ) const
     return result;
 }
 
-BlendingFactory::BlendingFactory( const SunLocator *sunLocator )
-    : m_sunLightBlending( new SunLightBlending( sunLocator ) )
+BlendingFactory::BlendingFactory( const SunLocator *sunLocator, const SunShadingMask *sunShadingMask )
+    : m_sunLightBlending( new SunLightBlending( sunLocator, sunShadingMask ) )
 {
     m_blendings.insert( "OverpaintBlending", new OverpaintBlending );
 
@@ -25,11 +25,12 @@ namespace Marble
 class Blending;
 class SunLightBlending;
 class SunLocator;
+class SunShadingMask;
 
 class BlendingFactory
 {
  public:
-    explicit BlendingFactory( const SunLocator *sunLocator );
+    BlendingFactory( const SunLocator *sunLocator, const SunShadingMask *sunShadingMask );
     ~BlendingFactory();
 
     void setLevelZeroLayout( int levelZeroColumns, int levelZeroRows );
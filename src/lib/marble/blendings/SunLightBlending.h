@@ -24,19 +24,20 @@ namespace Marble
 {
 
 class SunLocator;
+class SunShadingMask;
 
 class SunLightBlending: public Blending
 {
  public:
-    explicit SunLightBlending( const SunLocator * sunLocator );
+    SunLightBlending( const SunLocator * sunLocator, const SunShadingMask *shadingMask );
     virtual ~SunLightBlending();
     virtual void blend( QImage * const bottom, TextureTile const * const top ) const;
 
     void setLevelZeroLayout( int levelZeroColumns, int levelZeroRows );
 
  private:
-    static int maxDivisor( int maximum, int fullLength );
     const SunLocator * const m_sunLocator;
+    const SunShadingMask * const m_shadingMask;
     int m_levelZeroColumns;
     int m_levelZeroRows;
 };
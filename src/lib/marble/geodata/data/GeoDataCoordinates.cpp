@@ -36,43 +36,50 @@ const qreal GeoDataCoordinatesPrivate::sm_eccentricitySquared = 6.69437999013e-0
 const qreal GeoDataCoordinatesPrivate::sm_utmScaleFactor = 0.9996;
 GeoDataCoordinates::Notation GeoDataCoordinates::s_notation = GeoDataCoordinates::DMS;
 
-const GeoDataCoordinates GeoDataCoordinates::null = GeoDataCoordinates( 0, 0, 0 ); // don't use default constructor!
-
 GeoDataCoordinates::GeoDataCoordinates( qreal _lon, qreal _lat, qreal _alt, GeoDataCoordinates::Unit unit, int _detail )
-  : d( new GeoDataCoordinatesPrivate( _lon, _lat, _alt, unit, _detail ) )
+  : m_altitude( _alt ),
+    m_detail( _detail ),
+    m_valid( true ),
+    m_hasQuaternion( false )
 {
-    d->ref.ref();
+    switch( unit ){
+    default:
+    case Radian:
+        m_lon = _lon;
+        m_lat = _lat;
+        break;
+    case Degree:
+        m_lon = _lon * DEG2RAD;
+        m_lat = _lat * DEG2RAD;
+        break;
+    }
 }
 
-/* simply copy the d pointer
-* it will be replaced in the detach function instead
-*/
 GeoDataCoordinates::GeoDataCoordinates( const GeoDataCoordinates& other )
-  : d( other.d )
+  : m_lon( other.m_lon ),
+    m_lat( other.m_lat ),
+    m_altitude( other.m_altitude ),
+    m_detail( other.m_detail ),
+    m_valid( other.m_valid ),
+    m_hasQuaternion( other.m_hasQuaternion ),
+    m_quaternion( other.m_quaternion )
 {
-    d->ref.ref();
 }
 
-/* simply copy null's d pointer
- * it will be replaced in the detach function
+/* default constructed coordinates are invalid until they get modified
  */
 GeoDataCoordinates::GeoDataCoordinates()
-  : d( null.d )
+  : m_lon( 0 ),
+    m_lat( 0 ),
+    m_altitude( 0 ),
+    m_detail( 0 ),
+    m_valid( false ),
+    m_hasQuaternion( false )
 {
-    d->ref.ref();
 }
 
-/*
- * only delete the private d pointer if the number of references is 0
- * remember that all copies share the same d pointer!
- */
 GeoDataCoordinates::~GeoDataCoordinates()
 {
-    delete d->m_q;
-    d->m_q = 0;
-
-    if (!d->ref.deref())
-        delete d;
 #ifdef DEBUG_GEODATA
 //    mDebug() << "delete coordinates";
 #endif
@@ -80,84 +87,62 @@ GeoDataCoordinates::~GeoDataCoordinates()
 
 bool GeoDataCoordinates::isValid() const
 {
-    return d != null.d;
-}
-
-/*
- * if only one copy exists, return
- * else make a new private d pointer object and assign the values of the current
- * one to it
- * at the end, if the number of references thus reaches 0 delete it
- * this state shouldn't happen, but if it does, we have to clean up behind us.
- */
-void GeoDataCoordinates::detach()
-{    
-    if(d->ref.load() == 1) {
-        delete d->m_q;
-        d->m_q = 0;
-
-        return;
-    }
-
-    GeoDataCoordinatesPrivate *new_d = new GeoDataCoordinatesPrivate( *d );
-
-    if (!d->ref.deref())
-        delete d;
-
-    d = new_d;
-    d->ref.ref();
+    return m_valid;
 }
 
 /*
- * call detach() at the start of all non-static, non-const functions
+ * all non-static, non-const functions make the coordinates valid
  */
 void GeoDataCoordinates::set( qreal _lon, qreal _lat, qreal _alt, GeoDataCoordinates::Unit unit )
 {
-    detach();
-    d->m_altitude = _alt;
+    m_valid = true;
+    m_hasQuaternion = false;
+    m_altitude = _alt;
     switch( unit ){
     default:
     case Radian:
-        d->m_lon = _lon;
-        d->m_lat = _lat;
+        m_lon = _lon;
+        m_lat = _lat;
         break;
     case Degree:
-        d->m_lon = _lon * DEG2RAD;
-        d->m_lat = _lat * DEG2RAD;
+        m_lon = _lon * DEG2RAD;
+        m_lat = _lat * DEG2RAD;
         break;
     }
 }
 
 /*
- * call detach() at the start of all non-static, non-const functions
+ * all non-static, non-const functions make the coordinates valid
  */
 void GeoDataCoordinates::setLongitude( qreal _lon, GeoDataCoordinates::Unit unit )
 {
-    detach();
+    m_valid = true;
+    m_hasQuaternion = false;
     switch( unit ){
     default:
     case Radian:
-        d->m_lon = _lon;
+        m_lon = _lon;
         break;
     case Degree:
-        d->m_lon = _lon * DEG2RAD;
+        m_lon = _lon * DEG2RAD;
         break;
     }
 }
 
 
 /*
- * call detach() at the start of all non-static, non-const functions
+ * all non-static, non-const functions make the coordinates valid
  */
 void GeoDataCoordinates::setLatitude( qreal _lat, GeoDataCoordinates::Unit unit )
 {
-    detach();
+    m_valid = true;
+    m_hasQuaternion = false;
     switch( unit ){
     case Radian:
-        d->m_lat = _lat;
+        m_lat = _lat;
         break;
     case Degree:
-        d->m_lat = _lat * DEG2RAD;
+        m_lat = _lat * DEG2RAD;
         break;
     }
 }
@@ -169,12 +154,12 @@ void GeoDataCoordinates::geoCoordinates( qreal& lon, qreal& lat,
     {
     default:
     case Radian:
-            lon = d->m_lon;
-            lat = d->m_lat;
+            lon = m_lon;
+            lat = m_lat;
         break;
     case Degree:
-            lon = d->m_lon * RAD2DEG;
-            lat = d->m_lat * RAD2DEG;
+            lon = m_lon * RAD2DEG;
+            lat = m_lat * RAD2DEG;
         break;
     }
 }
@@ -183,7 +168,7 @@ void GeoDataCoordinates::geoCoordinates( qreal& lon, qreal& lat, qreal& alt,
                                          GeoDataCoordinates::Unit unit ) const
 {
     geoCoordinates( lon, lat, unit );
-    alt = d->m_altitude;
+    alt = m_altitude;
 }
 
 qreal GeoDataCoordinates::longitude( GeoDataCoordinates::Unit unit ) const
@@ -192,15 +177,15 @@ qreal GeoDataCoordinates::longitude( GeoDataCoordinates::Unit unit ) const
     {
     default:
     case Radian:
-        return d->m_lon;
+        return m_lon;
     case Degree:
-        return d->m_lon * RAD2DEG;
+        return m_lon * RAD2DEG;
     }
 }
 
 qreal GeoDataCoordinates::longitude() const
 {
-    return d->m_lon;
+    return m_lon;
 }
 
 qreal GeoDataCoordinates::latitude( GeoDataCoordinates::Unit unit ) const
@@ -209,15 +194,15 @@ qreal GeoDataCoordinates::latitude( GeoDataCoordinates::Unit unit ) const
     {
     default:
     case Radian:
-        return d->m_lat;
+        return m_lat;
     case Degree:
-        return d->m_lat * RAD2DEG;
+        return m_lat * RAD2DEG;
     }
 }
 
 qreal GeoDataCoordinates::latitude() const
 {
-    return d->m_lat;
+    return m_lat;
 }
 
 //static
@@ -388,22 +373,22 @@ QString GeoDataCoordinates::toString( GeoDataCoordinates::Notation notation, int
         QString coordString;
 
         if( notation == GeoDataCoordinates::UTM ){
-            int zoneNumber = GeoDataCoordinatesPrivate::lonLatToZone(d->m_lon, d->m_lat);
+            int zoneNumber = GeoDataCoordinatesPrivate::lonLatToZone(m_lon, m_lat);
 
             // Handle lack of UTM zone number in the poles
             const QString zoneString = (zoneNumber > 0) ? QString::number(zoneNumber) : QString();
 
-            QString bandString = GeoDataCoordinatesPrivate::lonLatToLatitudeBand(d->m_lon, d->m_lat);
+            QString bandString = GeoDataCoordinatesPrivate::lonLatToLatitudeBand(m_lon, m_lat);
 
-            QString eastingString  = QString::number(GeoDataCoordinatesPrivate::lonLatToEasting(d->m_lon, d->m_lat), 'f', 2);
-            QString northingString = QString::number(GeoDataCoordinatesPrivate::lonLatToNorthing(d->m_lon, d->m_lat), 'f', 2);
+            QString eastingString  = QString::number(GeoDataCoordinatesPrivate::lonLatToEasting(m_lon, m_lat), 'f', 2);
+            QString northingString = QString::number(GeoDataCoordinatesPrivate::lonLatToNorthing(m_lon, m_lat), 'f', 2);
 
             return QString("%1%2 %3 m E, %4 m N").arg(zoneString).arg(bandString).arg(eastingString).arg(northingString);
         }
         else{
-            coordString = lonToString( d->m_lon, notation, Radian, precision )
+            coordString = lonToString( m_lon, notation, Radian, precision )
                         + QLatin1String(", ")
-                        + latToString( d->m_lat, notation, Radian, precision );
+                        + latToString( m_lat, notation, Radian, precision );
         }
 
         return coordString;
@@ -571,7 +556,7 @@ QString GeoDataCoordinates::lonToString( qreal lon, GeoDataCoordinates::Notation
 
 QString GeoDataCoordinates::lonToString() const
 {
-    return GeoDataCoordinates::lonToString( d->m_lon , s_notation );
+    return GeoDataCoordinates::lonToString( m_lon , s_notation );
 }
 
 QString GeoDataCoordinates::latToString( qreal lat, GeoDataCoordinates::Notation notation,
@@ -687,55 +672,57 @@ QString GeoDataCoordinates::latToString( qreal lat, GeoDataCoordinates::Notation
 
 QString GeoDataCoordinates::latToString() const
 {
-    return GeoDataCoordinates::latToString( d->m_lat, s_notation );
+    return GeoDataCoordinates::latToString( m_lat, s_notation );
 }
 
 bool GeoDataCoordinates::operator==( const GeoDataCoordinates &rhs ) const
 {
-    return *d == *rhs.d;
+    // do not compare the m_detail member as it does not really belong to
+    // GeoDataCoordinates and should be removed
+    return m_lon == rhs.m_lon && m_lat == rhs.m_lat && m_altitude == rhs.m_altitude;
 }
 
 bool GeoDataCoordinates::operator!=( const GeoDataCoordinates &rhs ) const
 {
-    return *d != *rhs.d;
+    return ! (*this == rhs);
 }
 
 void GeoDataCoordinates::setAltitude( const qreal altitude )
 {
-    detach();
-    d->m_altitude = altitude;
+    m_valid = true;
+    m_altitude = altitude;
 }
 
 qreal GeoDataCoordinates::altitude() const
 {
-    return d->m_altitude;
+    return m_altitude;
 }
 
 int GeoDataCoordinates::utmZone() const{
-    return GeoDataCoordinatesPrivate::lonLatToZone(d->m_lon, d->m_lat);
+    return GeoDataCoordinatesPrivate::lonLatToZone(m_lon, m_lat);
 }
 
 qreal GeoDataCoordinates::utmEasting() const{
-    return GeoDataCoordinatesPrivate::lonLatToEasting(d->m_lon, d->m_lat);
+    return GeoDataCoordinatesPrivate::lonLatToEasting(m_lon, m_lat);
 }
 
 QString GeoDataCoordinates::utmLatitudeBand() const{
-    return GeoDataCoordinatesPrivate::lonLatToLatitudeBand(d->m_lon, d->m_lat);
+    return GeoDataCoordinatesPrivate::lonLatToLatitudeBand(m_lon, m_lat);
 }
 
 qreal GeoDataCoordinates::utmNorthing() const{
-    return GeoDataCoordinatesPrivate::lonLatToNorthing(d->m_lon, d->m_lat);
+    return GeoDataCoordinatesPrivate::lonLatToNorthing(m_lon, m_lat);
 }
 
 quint8 GeoDataCoordinates::detail() const
 {
-    return d->m_detail;
+    return m_detail;
 }
 
 void GeoDataCoordinates::setDetail(quint8 detail)
 {
-    detach();
-    d->m_detail = detail;
+    m_valid = true;
+    m_detail = detail;
 }
 
 GeoDataCoordinates GeoDataCoordinates::rotateAround( const GeoDataCoordinates &axis, qreal angle, Unit unit ) const
@@ -758,29 +745,29 @@ qreal GeoDataCoordinates::bearing( const GeoDataCoordinates &other, Unit unit, B
         return offset + other.bearing( *this, unit, InitialBearing );
     }
 
-    qreal const delta = other.d->m_lon - d->m_lon;
-    double const bearing = atan2( sin ( delta ) * cos ( other.d->m_lat ),
-                 cos( d->m_lat ) * sin( other.d->m_lat ) - sin( d->m_lat ) * cos( other.d->m_lat ) * cos ( delta ) );
+    qreal const delta = other.m_lon - m_lon;
+    double const bearing = atan2( sin ( delta ) * cos ( other.m_lat ),
+                 cos( m_lat ) * sin( other.m_lat ) - sin( m_lat ) * cos( other.m_lat ) * cos ( delta ) );
     return unit == Radian ? bearing : bearing * RAD2DEG;
 }
 
 GeoDataCoordinates GeoDataCoordinates::moveByBearing( qreal bearing, qreal distance ) const
 {
-    qreal newLat = asin( sin(d->m_lat) * cos(distance) +
-                         cos(d->m_lat) * sin(distance) * cos(bearing) );
-    qreal newLon = d->m_lon + atan2( sin(bearing) * sin(distance) * cos(d->m_lat),
-                                     cos(distance) - sin(d->m_lat) * sin(newLat) );
+    qreal newLat = asin( sin(m_lat) * cos(distance) +
+                         cos(m_lat) * sin(distance) * cos(bearing) );
+    qreal newLon = m_lon + atan2( sin(bearing) * sin(distance) * cos(m_lat),
+                                     cos(distance) - sin(m_lat) * sin(newLat) );
 
     return GeoDataCoordinates( newLon, newLat );
 }
 
-const Quaternion& GeoDataCoordinates::quaternion() const
+const Quaternion &GeoDataCoordinates::quaternion() const
 {
-    if (d->m_q == 0) {
-        d->m_q = new Quaternion();
-        *d->m_q = Quaternion::fromSpherical( d->m_lon , d->m_lat );
+    if ( !m_hasQuaternion ) {
+        m_quaternion = Quaternion::fromSpherical( m_lon , m_lat );
+        m_hasQuaternion = true;
     }
-    return *d->m_q;
+    return m_quaternion;
 }
 
 GeoDataCoordinates GeoDataCoordinates::interpolate( const GeoDataCoordinates &target, double t_ ) const
@@ -789,7 +776,7 @@ GeoDataCoordinates GeoDataCoordinates::interpolate( const GeoDataCoordinates &ta
     Quaternion const quat = Quaternion::slerp( quaternion(), target.quaternion(), t );
     qreal lon, lat;
     quat.getSpherical( lon, lat );
-    double const alt = (1.0-t) * d->m_altitude + t * target.d->m_altitude;
+    double const alt = (1.0-t) * m_altitude + t * target.m_altitude;
     return GeoDataCoordinates( lon, lat, alt );
 }
 
@@ -804,7 +791,7 @@ GeoDataCoordinates GeoDataCoordinates::interpolate( const GeoDataCoordinates &be
     qreal lon, lat;
     c.getSpherical( lon, lat );
     // @todo spline interpolation of altitude?
-    double const alt = (1.0-t) * d->m_altitude + t * target.d->m_altitude;
+    double const alt = (1.0-t) * m_altitude + t * target.m_altitude;
     return GeoDataCoordinates( lon, lat, alt );
 }
 
@@ -813,20 +800,20 @@ bool GeoDataCoordinates::isPole( Pole pole ) const
     // Evaluate the most likely case first:
     // The case where we haven't hit the pole and where our latitude is normalized
     // to the range of 90 deg S ... 90 deg N
-    if ( fabs( (qreal) 2.0 * d->m_lat ) < M_PI ) {
+    if ( fabs( (qreal) 2.0 * m_lat ) < M_PI ) {
         return false;
     }
     else {
-        if ( fabs( (qreal) 2.0 * d->m_lat ) == M_PI ) {
+        if ( fabs( (qreal) 2.0 * m_lat ) == M_PI ) {
             // Ok, we have hit a pole. Now let's check whether it's the one we've asked for:
             if ( pole == AnyPole ){
                 return true;
             }
             else {
-                if ( pole == NorthPole && 2.0 * d->m_lat == +M_PI ) {
+                if ( pole == NorthPole && 2.0 * m_lat == +M_PI ) {
                     return true;
                 }
-                if ( pole == SouthPole && 2.0 * d->m_lat == -M_PI ) {
+                if ( pole == SouthPole && 2.0 * m_lat == -M_PI ) {
                     return true;
                 }
                 return false;
@@ -842,7 +829,7 @@ bool GeoDataCoordinates::isPole( Pole pole ) const
             // Only as a last resort we cover the unlikely case where
             // the latitude is not normalized to the range of 
             // 90 deg S ... 90 deg N
-            if ( fabs( (qreal) 2.0 * normalizeLat( d->m_lat ) ) < M_PI  ) {
+            if ( fabs( (qreal) 2.0 * normalizeLat( m_lat ) ) < M_PI  ) {
                 return false;
             }
             else {
@@ -851,10 +838,10 @@ bool GeoDataCoordinates::isPole( Pole pole ) const
                     return true;
                 }
                 else {
-                    if ( pole == NorthPole && 2.0 * d->m_lat == +M_PI ) {
+                    if ( pole == NorthPole && 2.0 * m_lat == +M_PI ) {
                         return true;
                     }
-                    if ( pole == SouthPole && 2.0 * d->m_lat == -M_PI ) {
+                    if ( pole == SouthPole && 2.0 * m_lat == -M_PI ) {
                         return true;
                     }
                     return false;
@@ -866,24 +853,30 @@ bool GeoDataCoordinates::isPole( Pole pole ) const
 
 GeoDataCoordinates& GeoDataCoordinates::operator=( const GeoDataCoordinates &other )
 {
-    qAtomicAssign(d, other.d);
+    m_lon = other.m_lon;
+    m_lat = other.m_lat;
+    m_altitude = other.m_altitude;
+    m_detail = other.m_detail;
+    m_valid = other.m_valid;
+    m_hasQuaternion = other.m_hasQuaternion;
+    m_quaternion = other.m_quaternion;
     return *this;
 }
 
 void GeoDataCoordinates::pack( QDataStream& stream ) const
 {
-    stream << d->m_lon;
-    stream << d->m_lat;
-    stream << d->m_altitude;
+    stream << m_lon;
+    stream << m_lat;
+    stream << m_altitude;
 }
 
 void GeoDataCoordinates::unpack( QDataStream& stream )
 {
-    // call detach even though it shouldn't be needed - one never knows
-    detach();
-    stream >> d->m_lon;
-    stream >> d->m_lat;
-    stream >> d->m_altitude;
+    m_valid = true;
+    m_hasQuaternion = false;
+    stream >> m_lon;
+    stream >> m_lat;
+    stream >> m_altitude;
 }
 
 Quaternion GeoDataCoordinatesPrivate::basePoint( const Quaternion &q1, const Quaternion &q2, const Quaternion &q3 )
@@ -28,6 +28,7 @@
 
 #include "geodata_export.h"
 #include "MarbleGlobal.h"
+#include "Quaternion.h"
 
 class QString;
 
@@ -36,9 +37,6 @@ namespace Marble
 
 const qreal TWOPI = 2 * M_PI;
 
-class GeoDataCoordinatesPrivate;
-class Quaternion;
-
 /**
  * @short A 3d point representation
  *
@@ -418,12 +416,19 @@ class GEODATA_EXPORT GeoDataCoordinates
     void unpack(QDataStream &stream);
 
  private:
-    void detach();
-
-    GeoDataCoordinatesPrivate *d;
+    // The coordinates are stored inline rather than in an implicitly shared
+    // private, so containers like the nodes of GeoDataLineString keep them
+    // in contiguous memory without one heap allocation per node.
+    qreal m_lon;
+    qreal m_lat;
+    qreal m_altitude;     // in meters above sea level
+    quint8 m_detail;
+    bool m_valid;
+    // computed on first use, the projections ask for it on every repaint
+    mutable bool m_hasQuaternion;
+    mutable Quaternion m_quaternion;
 
     static GeoDataCoordinates::Notation s_notation;
-    static const GeoDataCoordinates null;
 };
 
 uint qHash(const GeoDataCoordinates& coordinates );
@@ -431,6 +436,8 @@ uint qHash(const GeoDataCoordinates& coordinates );
 
 }
 
+Q_DECLARE_TYPEINFO( Marble::GeoDataCoordinates, Q_MOVABLE_TYPE );
+
 Q_DECLARE_METATYPE( Marble::GeoDataCoordinates )
 
 #endif
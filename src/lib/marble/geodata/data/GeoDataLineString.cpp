@@ -18,6 +18,7 @@
 #include "Quaternion.h"
 #include "MarbleDebug.h"
 
+#include <QAtomicInteger>
 #include <QDataStream>
 
 
@@ -210,19 +211,33 @@ qreal GeoDataLineStringPrivate::resolutionForLevel(int level) const {
 
 void GeoDataLineStringPrivate::optimize (GeoDataLineString& lineString) const
 {
+    const int size = lineString.size();
 
-    QVector<GeoDataCoordinates>::iterator itCoords = lineString.begin();
-    QVector<GeoDataCoordinates>::const_iterator itEnd = lineString.constEnd();
-
-    if (lineString.size() < 2) return;
+    if (size < 2) return;
 
     // Calculate the least non-zero detail-level by checking the bounding box
     quint8 startLevel = levelForResolution( ( lineString.latLonAltBox().width() + lineString.latLonAltBox().height() ) / 2 );
 
     quint8 currentLevel = startLevel;
     quint8 maxLevel = startLevel;
-    GeoDataCoordinates currentCoords;
-    lineString.first().setDetail(startLevel);
+
+    QVector<GeoDataCoordinates>::iterator itBegin = lineString.begin();
+    itBegin->setDetail(startLevel);
+
+    // Nodes are compared by the chord between their unit vectors, which grows
+    // monotonically with their great circle distance. That way the passes
+    // below get along without any trigonometric calls.
+    QVector<qreal> unitX( size );
+    QVector<qreal> unitY( size );
+    QVector<qreal> unitZ( size );
+    for ( int i = 0; i < size; ++i ) {
+        const qreal lon = itBegin[i].longitude();
+        const qreal lat = itBegin[i].latitude();
+        const qreal cosLat = cos( lat );
+        unitX[i] = cosLat * cos( lon );
+        unitY[i] = cosLat * sin( lon );
+        unitZ[i] = sin( lat );
+    }
 
     // Iterate through the linestring to assign different detail levels to the nodes.
     // In general the first and last node should have the start level assigned as
@@ -238,33 +253,91 @@ void GeoDataLineStringPrivate::optimize (GeoDataLineString& lineString) const
     // current level until all nodes have a non-zero detail level assigned.
 
     while ( currentLevel  < 16 && currentLevel <= maxLevel + 1 ) {
-        itCoords = lineString.begin();
+        // chord length belonging to the resolution of the next level
+        const qreal chord = 2.0 * sin( 0.5 * resolutionForLevel( currentLevel + 1 ) );
+        const qreal squaredChord = chord * chord;
 
-        currentCoords = *itCoords;
-        ++itCoords;
+        int current = 0;
 
-        for( ; itCoords != itEnd; ++itCoords) {
-            if (itCoords->detail() != 0 && itCoords->detail() < currentLevel) continue;
+        for ( int i = 1; i < size; ++i ) {
+            GeoDataCoordinates &coords = itBegin[i];
+            if (coords.detail() != 0 && coords.detail() < currentLevel) continue;
 
-            if ( currentLevel == startLevel && (itCoords->longitude() == -M_PI || itCoords->longitude() == M_PI
-                || itCoords->latitude() < -89 * DEG2RAD || itCoords->latitude() > 89 * DEG2RAD)) {
-                itCoords->setDetail(startLevel);
-                currentCoords = *itCoords;
+            if ( currentLevel == startLevel && (coords.longitude() == -M_PI || coords.longitude() == M_PI
+                || coords.latitude() < -89 * DEG2RAD || coords.latitude() > 89 * DEG2RAD)) {
+                coords.setDetail(startLevel);
+                current = i;
                 maxLevel = currentLevel;
                 continue;
             }
-            if (distanceSphere( currentCoords, *itCoords ) < resolutionForLevel(currentLevel + 1)) {
-                itCoords->setDetail(currentLevel + 1);
+
+            const qreal dx = unitX[i] - unitX[current];
+            const qreal dy = unitY[i] - unitY[current];
+            const qreal dz = unitZ[i] - unitZ[current];
+            if ( dx * dx + dy * dy + dz * dz < squaredChord ) {
+                coords.setDetail(currentLevel + 1);
             }
             else {
-                itCoords->setDetail(currentLevel);
-                currentCoords = *itCoords;
+                coords.setDetail(currentLevel);
+                current = i;
                 maxLevel = currentLevel;
             }
         }
         ++currentLevel;
     }
-    lineString.last().setDetail(startLevel);
+    itBegin[size - 1].setDetail(startLevel);
+}
+
+void GeoDataLineStringPrivate::updateLevelIndex() const
+{
+    static const int levelCount = 18;
+
+    m_levelNodes.clear();
+    m_dirtyLevels = false;
+
+    const int size = m_vector.size();
+
+    // Only optimized line strings have a non-zero detail value at the first node.
+    if ( size < 2 || m_vector.first().detail() == 0 ) {
+        return;
+    }
+
+    int nodesAtLevel[levelCount] = { 0 };
+    for ( int i = 0; i < size; ++i ) {
+        ++nodesAtLevel[qMin<int>( m_vector.at( i ).detail(), levelCount - 1 )];
+    }
+
+    // Index the coarse levels only: Once half of the nodes get drawn anyway,
+    // walking all of them is as cheap, and the index never holds more
+    // entries than the line string has nodes.
+    int lastLevel = -1;
+    int nodes = 0;
+    int entries = 0;
+    for ( int level = 0; level < levelCount; ++level ) {
+        nodes += nodesAtLevel[level];
+        if ( nodes > size / 2 || entries + nodes > size ) {
+            break;
+        }
+        entries += nodes;
+        lastLevel = level;
+    }
+
+    if ( lastLevel < 0 ) {
+        return;
+    }
+
+    m_levelNodes.resize( lastLevel + 1 );
+    nodes = 0;
+    for ( int level = 0; level <= lastLevel; ++level ) {
+        nodes += nodesAtLevel[level];
+        m_levelNodes[level].reserve( nodes );
+    }
+
+    for ( int i = 0; i < size; ++i ) {
+        for ( int level = m_vector.at( i ).detail(); level <= lastLevel; ++level ) {
+            m_levelNodes[level].append( i );
+        }
+    }
 }
 
 bool GeoDataLineString::isEmpty() const
@@ -286,6 +359,8 @@ GeoDataCoordinates& GeoDataLineString::at( int pos )
     Q_D(GeoDataLineString);
     d->m_dirtyRange = true;
     d->m_dirtyBox = true;
+    d->m_dirtyLevels = true;
+    d->m_changeCount = GeoDataLineStringPrivate::nextChangeCount();
     return d->m_vector[pos];
 }
 
@@ -302,6 +377,8 @@ GeoDataCoordinates& GeoDataLineString::operator[]( int pos )
     Q_D(GeoDataLineString);
     d->m_dirtyRange = true;
     d->m_dirtyBox = true;
+    d->m_dirtyLevels = true;
+    d->m_changeCount = GeoDataLineStringPrivate::nextChangeCount();
     return d->m_vector[pos];
 }
 
@@ -318,6 +395,8 @@ GeoDataCoordinates& GeoDataLineString::last()
     Q_D(GeoDataLineString);
     d->m_dirtyRange = true;
     d->m_dirtyBox = true;
+    d->m_dirtyLevels = true;
+    d->m_changeCount = GeoDataLineStringPrivate::nextChangeCount();
     return d->m_vector.last();
 }
 
@@ -326,6 +405,8 @@ GeoDataCoordinates& GeoDataLineString::first()
     GeoDataGeometry::detach();
 
     Q_D(GeoDataLineString);
+    d->m_dirtyLevels = true;
+    d->m_changeCount = GeoDataLineStringPrivate::nextChangeCount();
     return d->m_vector.first();
 }
 
@@ -346,6 +427,8 @@ QVector<GeoDataCoordinates>::Iterator GeoDataLineString::begin()
     GeoDataGeometry::detach();
 
     Q_D(GeoDataLineString);
+    d->m_dirtyLevels = true;
+    d->m_changeCount = GeoDataLineStringPrivate::nextChangeCount();
     return d->m_vector.begin();
 }
 
@@ -360,6 +443,8 @@ QVector<GeoDataCoordinates>::Iterator GeoDataLineString::end()
     GeoDataGeometry::detach();
 
     Q_D(GeoDataLineString);
+    d->m_dirtyLevels = true;
+    d->m_changeCount = GeoDataLineStringPrivate::nextChangeCount();
     return d->m_vector.end();
 }
 
@@ -390,6 +475,8 @@ void GeoDataLineString::insert( int index, const GeoDataCoordinates& value )
     d->m_rangeCorrected = 0;
     d->m_dirtyRange = true;
     d->m_dirtyBox = true;
+    d->m_dirtyLevels = true;
+    d->m_changeCount = GeoDataLineStringPrivate::nextChangeCount();
     d->m_vector.insert( index, value );
 }
 
@@ -402,6 +489,8 @@ void GeoDataLineString::append ( const GeoDataCoordinates& value )
     d->m_rangeCorrected = 0;
     d->m_dirtyRange = true;
     d->m_dirtyBox = true;
+    d->m_dirtyLevels = true;
+    d->m_changeCount = GeoDataLineStringPrivate::nextChangeCount();
     d->m_vector.append( value );
 }
 
@@ -414,6 +503,8 @@ void GeoDataLineString::append(const QVector<GeoDataCoordinates>& values)
     d->m_rangeCorrected = 0;
     d->m_dirtyRange = true;
     d->m_dirtyBox = true;
+    d->m_dirtyLevels = true;
+    d->m_changeCount = GeoDataLineStringPrivate::nextChangeCount();
 
 #if QT_VERSION >= 0x050500
     d->m_vector.append(values);
@@ -434,6 +525,8 @@ GeoDataLineString& GeoDataLineString::operator << ( const GeoDataCoordinates& va
     d->m_rangeCorrected = 0;
     d->m_dirtyRange = true;
     d->m_dirtyBox = true;
+    d->m_dirtyLevels = true;
+    d->m_changeCount = GeoDataLineStringPrivate::nextChangeCount();
     d->m_vector.append( value );
     return *this;
 }
@@ -447,6 +540,8 @@ GeoDataLineString& GeoDataLineString::operator << ( const GeoDataLineString& val
     d->m_rangeCorrected = 0;
     d->m_dirtyRange = true;
     d->m_dirtyBox = true;
+    d->m_dirtyLevels = true;
+    d->m_changeCount = GeoDataLineStringPrivate::nextChangeCount();
 
     QVector<GeoDataCoordinates>::const_iterator itCoords = value.constBegin();
     QVector<GeoDataCoordinates>::const_iterator itEnd = value.constEnd();
@@ -499,6 +594,8 @@ void GeoDataLineString::clear()
     d->m_rangeCorrected = 0;
     d->m_dirtyRange = true;
     d->m_dirtyBox = true;
+    d->m_dirtyLevels = true;
+    d->m_changeCount = GeoDataLineStringPrivate::nextChangeCount();
 
     d->m_vector.clear();
 }
@@ -531,6 +628,7 @@ void GeoDataLineString::setTessellate( bool tessellate )
         d->m_tessellationFlags ^= Tessellate;
         d->m_tessellationFlags ^= RespectLatitudeCircle;
     }
+    d->m_changeCount = GeoDataLineStringPrivate::nextChangeCount();
 }
 
 TessellationFlags GeoDataLineString::tessellationFlags() const
@@ -545,6 +643,7 @@ void GeoDataLineString::setTessellationFlags( TessellationFlags f )
 
     Q_D(GeoDataLineString);
     d->m_tessellationFlags = f;
+    d->m_changeCount = GeoDataLineStringPrivate::nextChangeCount();
 }
 
 void GeoDataLineString::reverse()
@@ -556,6 +655,8 @@ void GeoDataLineString::reverse()
     d->m_rangeCorrected = 0;
     d->m_dirtyRange = true;
     d->m_dirtyBox = true;
+    d->m_dirtyLevels = true;
+    d->m_changeCount = GeoDataLineStringPrivate::nextChangeCount();
     std::reverse(begin(), end());
 }
 
@@ -844,6 +945,8 @@ QVector<GeoDataCoordinates>::Iterator GeoDataLineString::erase ( QVector<GeoData
     d->m_rangeCorrected = 0;
     d->m_dirtyRange = true;
     d->m_dirtyBox = true;
+    d->m_dirtyLevels = true;
+    d->m_changeCount = GeoDataLineStringPrivate::nextChangeCount();
     return d->m_vector.erase( pos );
 }
 
@@ -857,6 +960,8 @@ QVector<GeoDataCoordinates>::Iterator GeoDataLineString::erase ( QVector<GeoData
     d->m_rangeCorrected = 0;
     d->m_dirtyRange = true;
     d->m_dirtyBox = true;
+    d->m_dirtyLevels = true;
+    d->m_changeCount = GeoDataLineStringPrivate::nextChangeCount();
     return d->m_vector.erase( begin, end );
 }
 
@@ -867,24 +972,65 @@ void GeoDataLineString::remove ( int i )
     Q_D(GeoDataLineString);
     d->m_dirtyRange = true;
     d->m_dirtyBox = true;
+    d->m_dirtyLevels = true;
+    d->m_changeCount = GeoDataLineStringPrivate::nextChangeCount();
     d->m_vector.remove( i );
 }
 
+void GeoDataLineString::reserve( int size )
+{
+    GeoDataGeometry::detach();
+
+    Q_D(GeoDataLineString);
+    d->m_vector.reserve( size );
+}
+
 GeoDataLineString GeoDataLineString::optimized () const
 {
     Q_D(const GeoDataLineString);
 
+    // Build the level index right away rather than on the first paint
     if( isClosed() ) {
         GeoDataLinearRing linearRing(*this);
         d->optimize(linearRing);
+        static_cast<const GeoDataLineString &>( linearRing ).d_func()->updateLevelIndex();
         return linearRing;
     } else {
         GeoDataLineString lineString(*this);
         d->optimize(lineString);
+        lineString.d_func()->updateLevelIndex();
         return lineString;
     }
 }
 
+bool GeoDataLineString::nodesForDetail( int level, QVector<int> &indices ) const
+{
+    Q_D(const GeoDataLineString);
+
+    if ( d->m_dirtyLevels ) {
+        d->updateLevelIndex();
+    }
+
+    if ( level < 0 || level >= d->m_levelNodes.size() ) {
+        return false;
+    }
+
+    indices = d->m_levelNodes.at( level );
+    return true;
+}
+
+quint32 GeoDataLineStringPrivate::nextChangeCount()
+{
+    static QAtomicInteger<quint32> changeCount;
+    return changeCount.fetchAndAddRelaxed( 1 ) + 1;
+}
+
+quint32 GeoDataLineString::changeCount() const
+{
+    Q_D(const GeoDataLineString);
+    return d->m_changeCount;
+}
+
 void GeoDataLineString::pack( QDataStream& stream ) const
 {
     Q_D(const GeoDataLineString);
@@ -919,6 +1065,8 @@ void GeoDataLineString::unpack( QDataStream& stream )
     stream >> tessellationFlags;
 
     d->m_tessellationFlags = (TessellationFlags)(tessellationFlags);
+    d->m_dirtyLevels = true;
+    d->m_changeCount = GeoDataLineStringPrivate::nextChangeCount();
 
     d->m_vector.reserve(d->m_vector.size() + size);
 
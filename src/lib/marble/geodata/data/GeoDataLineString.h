@@ -45,7 +45,7 @@ class GeoDataLineStringPrivate;
 
     A GeoDataLineString consists of several (geodetic) nodes which are each
     connected through line segments. The nodes are stored as GeoDataCoordinates
-    objects.
+    objects, which are plain values kept next to each other in memory.
 
     The API which provides access to the nodes is similar to the API of
     QVector.
@@ -362,11 +362,41 @@ class GEODATA_EXPORT GeoDataLineString : public GeoDataGeometry
 */
     void remove ( int i );
 
+
+/*!
+    \brief Allocates memory for at least \a size nodes.
+
+    Parsers which know the number of nodes in advance should call this
+    before appending them, so the nodes get stored without reallocations.
+*/
+    void reserve( int size );
+
     /*!
         \brief Returns a linestring with detail values assigned to each node.
     */
     GeoDataLineString optimized() const;
 
+    /*!
+        \brief Provides the indices of the nodes with a detail value up to \a level.
+
+        The index is built once for optimized() line strings and spares
+        renderers at low zoom levels from visiting every node. Returns false
+        if there is no index for \a level, e.g. because most nodes are drawn
+        at that level anyway; all nodes need to be checked then.
+    */
+    bool nodesForDetail( int level, QVector<int> &indices ) const;
+
+    /*!
+        \brief Returns a number which changes whenever the nodes or the
+        tessellation flags may have been modified.
+
+        Every non-const accessor bumps it, including the ones handing out
+        references or iterators to the nodes, as the nodes may get modified
+        through those in place. Caches of data derived from the line string
+        compare it to find out whether they are stale.
+    */
+    quint32 changeCount() const;
+
     // Serialization
 /*!
     \brief Serialize the LineString to a stream.
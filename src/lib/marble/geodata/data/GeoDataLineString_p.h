@@ -27,14 +27,18 @@ class GeoDataLineStringPrivate : public GeoDataGeometryPrivate
            m_dirtyBox( true ),
            m_tessellationFlags( f ),
            m_previousResolution( -1 ),
-           m_level( -1 )
+           m_level( -1 ),
+           m_dirtyLevels( true ),
+           m_changeCount( nextChangeCount() )
     {
     }
 
     GeoDataLineStringPrivate()
          : m_rangeCorrected( 0 ),
            m_dirtyRange( true ),
-           m_dirtyBox( true )
+           m_dirtyBox( true ),
+           m_dirtyLevels( true ),
+           m_changeCount( nextChangeCount() )
     {
     }
 
@@ -51,6 +55,9 @@ class GeoDataLineStringPrivate : public GeoDataGeometryPrivate
         m_dirtyRange = true;
         m_dirtyBox = other.m_dirtyBox;
         m_tessellationFlags = other.m_tessellationFlags;
+        m_levelNodes = other.m_levelNodes;
+        m_dirtyLevels = other.m_dirtyLevels;
+        m_changeCount = nextChangeCount();
         return *this;
     }
 
@@ -90,6 +97,14 @@ class GeoDataLineStringPrivate : public GeoDataGeometryPrivate
     quint8 levelForResolution(qreal resolution) const;
     qreal resolutionForLevel(int level) const;
     void optimize(GeoDataLineString& lineString) const;
+    void updateLevelIndex() const;
+
+    /**
+     * Returns a change count no line string had before. Line strings share
+     * one counter, so that assigning one line string to another one never
+     * makes the latter report a change count it had before.
+     */
+    static quint32 nextChangeCount();
 
     QVector<GeoDataCoordinates> m_vector;
 
@@ -103,6 +118,14 @@ class GeoDataLineStringPrivate : public GeoDataGeometryPrivate
     mutable qreal  m_previousResolution;
     mutable quint8 m_level;
 
+    // m_levelNodes[level] holds the indices of the nodes with a detail value
+    // up to level, for the coarse levels of optimized line strings only
+    mutable QVector<QVector<int> > m_levelNodes;
+    mutable bool                   m_dirtyLevels;
+
+    // renewed by every call that may modify the nodes or the tessellation
+    quint32 m_changeCount;
+
 };
 
 } // namespace Marble
@@ -25,8 +25,7 @@ namespace Marble
 {
 namespace dgml
 {
-static GeoTagHandlerRegistrar registrar( GeoParser::QualifiedName( dgmlTag_Blending,
-                                                                       dgmlTag_nameSpace20 ),
+static GeoTagHandlerRegistrar registrar( dgmlTag_Blending, dgmlTag_nameSpace20,
                                          new DgmlBlendingTagHandler );
 
 GeoNode* DgmlBlendingTagHandler::parse( GeoParser& parser ) const
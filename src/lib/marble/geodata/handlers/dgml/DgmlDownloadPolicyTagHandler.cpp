@@ -29,8 +29,7 @@ namespace Marble
 {
 namespace dgml
 {
-static GeoTagHandlerRegistrar handler( GeoParser::QualifiedName( dgmlTag_DownloadPolicy,
-                                                                     dgmlTag_nameSpace20 ),
+static GeoTagHandlerRegistrar handler( dgmlTag_DownloadPolicy, dgmlTag_nameSpace20,
                                        new DgmlDownloadPolicyTagHandler );
 
 // Error handling:
@@ -21,8 +21,10 @@
 
 #include "KmlCoordinatesTagHandler.h"
 
+#include <QLocale>
 #include <QStringList>
 #include <QRegExp>
+#include <QVector>
 
 #include "MarbleDebug.h"
 #include "KmlElementDictionary.h"
@@ -48,9 +50,224 @@ static const bool kmlStrictSpecs = false;
 
 // We can't use KML_DEFINE_TAG_HANDLER_GX22 because the name of the tag ("coord")
 // and the TagHandler ("KmlcoordinatesTagHandler") don't match
-static GeoTagHandlerRegistrar s_handlercoordkmlTag_nameSpaceGx22(GeoParser::QualifiedName(QLatin1String(kmlTag_coord), QLatin1String(kmlTag_nameSpaceGx22)),
+static GeoTagHandlerRegistrar s_handlercoordkmlTag_nameSpaceGx22(kmlTag_coord, kmlTag_nameSpaceGx22,
                                                                  new KmlcoordinatesTagHandler());
 
+/**
+ * Converts @p size characters at @p data into a double like QString::toDouble() does.
+ *
+ * Plain decimal numbers with up to 15 significant digits are converted directly:
+ * such a mantissa and all powers of ten up to 1e22 are exact doubles, so a single
+ * multiplication or division yields the correctly rounded result. Anything else
+ * is left to QLocale.
+ */
+static double parseNumber( const QChar *data, int size )
+{
+    static const double powersOfTen[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    static const int maximumDigits = 15;
+    static const int maximumExponent = 22;
+
+    int i = 0;
+    bool negative = false;
+    if ( i < size && ( data[i] == QLatin1Char( '-' ) || data[i] == QLatin1Char( '+' ) ) ) {
+        negative = data[i] == QLatin1Char( '-' );
+        ++i;
+    }
+
+    quint64 mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool hasDigits = false;
+    bool isFraction = false;
+    for ( ; i < size; ++i ) {
+        const ushort c = data[i].unicode();
+        if ( c == '.' && !isFraction ) {
+            isFraction = true;
+            continue;
+        }
+        if ( c < '0' || c > '9' ) {
+            break;
+        }
+        hasDigits = true;
+        // leading zeros are not significant
+        if ( mantissa != 0 || c != '0' ) {
+            if ( ++digits > maximumDigits ) {
+                return QLocale::c().toDouble( QString::fromRawData( data, size ) );
+            }
+            mantissa = 10 * mantissa + ( c - '0' );
+        }
+        if ( isFraction ) {
+            --exponent;
+        }
+    }
+
+    if ( hasDigits && i < size && ( data[i] == QLatin1Char( 'e' ) || data[i] == QLatin1Char( 'E' ) ) ) {
+        ++i;
+        bool negativeExponent = false;
+        if ( i < size && ( data[i] == QLatin1Char( '-' ) || data[i] == QLatin1Char( '+' ) ) ) {
+            negativeExponent = data[i] == QLatin1Char( '-' );
+            ++i;
+        }
+        int value = 0;
+        const int first = i;
+        for ( ; i < size && data[i].unicode() >= '0' && data[i].unicode() <= '9' && value < 1000; ++i ) {
+            value = 10 * value + ( data[i].unicode() - '0' );
+        }
+        if ( i == first ) {
+            hasDigits = false;
+        }
+        exponent += negativeExponent ? -value : value;
+    }
+
+    if ( !hasDigits || i != size || exponent < -maximumExponent || exponent > maximumExponent ) {
+        return QLocale::c().toDouble( QString::fromRawData( data, size ) );
+    }
+
+    double value = mantissa;
+    value = exponent < 0 ? value / powersOfTen[-exponent] : value * powersOfTen[exponent];
+    return negative ? -value : value;
+}
+
+/**
+ * Splits the text of a coordinates element into tuples while it is read.
+ *
+ * Tuples are separated by whitespace and their numbers by commas. Unless the
+ * specification is followed strictly, whitespace around commas is ignored.
+ * The numbers are converted right from the reader's buffer; only a number
+ * split across two pieces of text gets copied.
+ */
+class CoordinatesScanner
+{
+public:
+    CoordinatesScanner() :
+        m_fieldCount( 0 ),
+        m_hasValue( false ),
+        m_value( 0.0 ),
+        m_numberStart( -1 ),
+        m_tupleStarted( false ),
+        m_afterComma( false ),
+        m_tupleEnded( false )
+    {
+    }
+
+    void scan( const QStringRef &text )
+    {
+        const QChar *const data = text.unicode();
+        const int size = text.size();
+        for ( int i = 0; i < size; ++i ) {
+            const QChar c = data[i];
+            if ( c == QLatin1Char( ',' ) ) {
+                endNumber( data, i );
+                if ( kmlStrictSpecs && m_tupleEnded ) {
+                    endTuple( size, i );
+                }
+                appendField();
+                m_tupleStarted = true;
+                m_afterComma = true;
+                m_tupleEnded = false;
+            } else if ( c.isSpace() ) {
+                endNumber( data, i );
+                if ( m_tupleStarted && ( kmlStrictSpecs || !m_afterComma ) ) {
+                    m_tupleEnded = true;
+                }
+            } else {
+                if ( m_tupleEnded ) {
+                    endTuple( size, i );
+                }
+                if ( m_numberStart < 0 ) {
+                    m_numberStart = i;
+                }
+                m_tupleStarted = true;
+                m_afterComma = false;
+            }
+        }
+
+        // keep the start of a number continued by the next piece of text
+        if ( m_numberStart >= 0 ) {
+            m_carry.append( data + m_numberStart, size - m_numberStart );
+            m_numberStart = -1;
+        }
+    }
+
+    void finish()
+    {
+        endNumber( 0, 0 );
+        if ( m_tupleStarted ) {
+            endTuple( 0, 0 );
+        }
+    }
+
+    const QVector<GeoDataCoordinates> &coordinates() const
+    {
+        return m_coordinates;
+    }
+
+private:
+    void endNumber( const QChar *data, int end )
+    {
+        if ( m_carry.isEmpty() ) {
+            if ( m_numberStart < 0 ) {
+                return;
+            }
+            m_value = parseNumber( data + m_numberStart, end - m_numberStart );
+        } else {
+            if ( m_numberStart >= 0 ) {
+                m_carry.append( data + m_numberStart, end - m_numberStart );
+            }
+            m_value = parseNumber( m_carry.constData(), m_carry.size() );
+            m_carry.clear();
+        }
+        m_hasValue = true;
+        m_numberStart = -1;
+    }
+
+    void appendField()
+    {
+        if ( m_fieldCount < 3 ) {
+            m_fields[m_fieldCount] = m_hasValue ? m_value : 0.0;
+        }
+        ++m_fieldCount;
+        m_hasValue = false;
+    }
+
+    void endTuple( int size, int position )
+    {
+        appendField();
+
+        GeoDataCoordinates coord;
+        if ( m_fieldCount == 2 ) {
+            coord.set( DEG2RAD * m_fields[0], DEG2RAD * m_fields[1] );
+        } else if ( m_fieldCount == 3 ) {
+            coord.set( DEG2RAD * m_fields[0], DEG2RAD * m_fields[1], m_fields[2] );
+        }
+
+        // the first tuple tells roughly how many will follow
+        if ( m_coordinates.isEmpty() && position > 0 ) {
+            m_coordinates.reserve( 1 + size / position );
+        }
+        m_coordinates.append( coord );
+
+        m_fieldCount = 0;
+        m_tupleStarted = false;
+        m_afterComma = false;
+        m_tupleEnded = false;
+    }
+
+    double m_fields[3];
+    int m_fieldCount;
+    bool m_hasValue;
+    double m_value;
+    int m_numberStart;
+    QString m_carry;
+    bool m_tupleStarted;
+    bool m_afterComma;
+    bool m_tupleEnded;
+    QVector<GeoDataCoordinates> m_coordinates;
+};
+
 GeoNode* KmlcoordinatesTagHandler::parse( GeoParser& parser ) const
 {
     Q_ASSERT(parser.isStartElement()
@@ -64,77 +281,34 @@ GeoNode* KmlcoordinatesTagHandler::parse( GeoParser& parser ) const
      || parentItem.represents( kmlTag_MultiGeometry )
      || parentItem.represents( kmlTag_LinearRing )
      || parentItem.represents( kmlTag_LatLonQuad ) ) {
-        QStringList  coordinatesLines;// = parser.readElementText().trimmed().split( QRegExp("\\s"), QString::SkipEmptyParts );
-        // Splitting using the "\\s" regexp is slow, split manually instead.
-        QString text = parser.readElementText().trimmed();
-
-        if ( !kmlStrictSpecs ) {
-            // Removing spaces before and after commas
-            for ( int i = 1; i < text.size() - 1; ++i ) {
-                if (text[i] == QLatin1Char(',')) {
-                    // Before
-                    int l = i - 1;
-                    while ( l > 0 && text[l].isSpace() ) {
-                        --l;
-                    }
-
-                    // After
-                    int r = i + 1;
-                    while ( r < text.size() && text[r].isSpace() ) {
-                        ++r;
-                    }
-
-                    text.remove(l + 1, r - l - 1).insert(l + 1, QLatin1Char(','));
-                }
+        // Scan the text pieces as the reader delivers them instead of
+        // copying the whole element text with readElementText().
+        CoordinatesScanner scanner;
+        while ( !parser.atEnd() ) {
+            parser.readNext();
+            if ( parser.isCharacters() ) {
+                scanner.scan( parser.text() );
+            } else if ( parser.isEndElement() ) {
+                break;
+            } else if ( parser.isStartElement() ) {
+                parser.skipCurrentElement();
             }
         }
+        scanner.finish();
 
-        int index = 0;
-        bool inside = true;
-        int const size = text.size();
-        for ( int i=0; i<size; ++i ) {
-            if ( text[i].isSpace() ) {
-                if ( inside ) {
-                    coordinatesLines.append( text.mid( index, i-index ) );
-                    inside = false;
-                }
-                index = i+1;
-            } else {
-                inside = true;
+        const QVector<GeoDataCoordinates> &coordinates = scanner.coordinates();
+        if ( parentItem.represents( kmlTag_LineString ) ) {
+            parentItem.nodeAs<GeoDataLineString>()->append( coordinates );
+        } else if ( parentItem.represents( kmlTag_LinearRing ) ) {
+            parentItem.nodeAs<GeoDataLinearRing>()->append( coordinates );
+        } else if ( parentItem.represents( kmlTag_Point ) && parentItem.is<GeoDataFeature>() ) {
+            if ( !coordinates.isEmpty() ) {
+                parentItem.nodeAs<GeoDataPlacemark>()->setCoordinate( coordinates.last() );
             }
-        }
-        coordinatesLines.append( text.mid( index ) );
-        int coordinatesIndex = 0;
-        Q_FOREACH( const QString& line, coordinatesLines ) {
-            const QStringList coordinates = line.trimmed().split(QLatin1Char(','));
-            if ( parentItem.represents( kmlTag_Point ) && parentItem.is<GeoDataFeature>() ) {
-                GeoDataCoordinates coord;
-                if ( coordinates.size() == 2 ) {
-                    coord.set( coordinates.at( 0 ).toDouble(),
-                              coordinates.at( 1 ).toDouble(), 0.0, GeoDataCoordinates::Degree );
-                } else if( coordinates.size() == 3 ) {
-                    coord.set( coordinates.at( 0 ).toDouble(),
-                               coordinates.at( 1 ).toDouble(),
-                               coordinates.at( 2 ).toDouble(),
-                               GeoDataCoordinates::Degree );
-                }
-                parentItem.nodeAs<GeoDataPlacemark>()->setCoordinate( coord );
-            } else {
-                GeoDataCoordinates coord;
-                if ( coordinates.size() == 2 ) {
-                    coord.set( DEG2RAD * coordinates.at( 0 ).toDouble(),
-                              DEG2RAD * coordinates.at( 1 ).toDouble() );
-                } else if( coordinates.size() == 3 ) {
-                    coord.set( DEG2RAD * coordinates.at( 0 ).toDouble(),
-                              DEG2RAD * coordinates.at( 1 ).toDouble(),
-                              coordinates.at( 2 ).toDouble() );
-                }
-
-                if ( parentItem.represents( kmlTag_LineString ) ) {
-                    parentItem.nodeAs<GeoDataLineString>()->append( coord );
-                } else if ( parentItem.represents( kmlTag_LinearRing ) ) {
-                    parentItem.nodeAs<GeoDataLinearRing>()->append( coord );
-                } else if ( parentItem.represents( kmlTag_MultiGeometry ) ) {
+        } else {
+            int coordinatesIndex = 0;
+            foreach ( const GeoDataCoordinates &coord, coordinates ) {
+                if ( parentItem.represents( kmlTag_MultiGeometry ) ) {
                     GeoDataPoint *point = new GeoDataPoint( coord );
                     parentItem.nodeAs<GeoDataMultiGeometry>()->append( point );
                 } else if ( parentItem.represents( kmlTag_Model) ) {
@@ -166,9 +340,9 @@ GeoNode* KmlcoordinatesTagHandler::parse( GeoParser& parser ) const
                 } else {
                     // raise warning as coordinates out of valid parents found
                 }
-            }
 
-            ++coordinatesIndex;
+                ++coordinatesIndex;
+            }
         }
     }
 
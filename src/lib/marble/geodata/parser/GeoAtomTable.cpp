@@ -0,0 +1,119 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include "GeoAtomTable.h"
+
+#include <QHash>
+#include <QVector>
+
+namespace Marble
+{
+
+struct GeoAtomTableData
+{
+    GeoAtomTableData()
+    {
+        // keeps GeoAtomTable::Unknown away from real names
+        names.append( QString() );
+    }
+
+    QVector<QString> names;
+    // hashes of the names, as computed by qHash(QStringRef)
+    QMultiHash<uint, GeoAtomTable::Atom> atomsByHash;
+    QHash<const char *, GeoAtomTable::Atom> atomsByAddress;
+};
+
+static GeoAtomTableData *s_atomTable = 0;
+
+const GeoAtomTable::Atom GeoAtomTable::Unknown;
+
+static GeoAtomTableData *atomTable()
+{
+    if ( !s_atomTable ) {
+        s_atomTable = new GeoAtomTableData;
+    }
+
+    return s_atomTable;
+}
+
+GeoAtomTable::Atom GeoAtomTable::intern( const char *name )
+{
+    GeoAtomTableData *const table = atomTable();
+
+    const QHash<const char *, Atom>::const_iterator it = table->atomsByAddress.constFind( name );
+    if ( it != table->atomsByAddress.constEnd() ) {
+        return it.value();
+    }
+
+    const Atom result = intern( QString::fromLatin1( name ) );
+    table->atomsByAddress.insert( name, result );
+    return result;
+}
+
+GeoAtomTable::Atom GeoAtomTable::intern( const QString &name )
+{
+    const Atom existing = atom( QStringRef( &name ) );
+    if ( existing != Unknown ) {
+        return existing;
+    }
+
+    GeoAtomTableData *const table = atomTable();
+    const Atom result = table->names.size();
+    table->names.append( name );
+    table->atomsByHash.insert( qHash( QStringRef( &name ) ), result );
+    return result;
+}
+
+void GeoAtomTable::forget( const char *name )
+{
+    atomTable()->atomsByAddress.remove( name );
+}
+
+GeoAtomTable::Atom GeoAtomTable::atom( const char *name )
+{
+    const GeoAtomTableData *const table = atomTable();
+
+    const QHash<const char *, Atom>::const_iterator it = table->atomsByAddress.constFind( name );
+    if ( it != table->atomsByAddress.constEnd() ) {
+        return it.value();
+    }
+
+    // a string which was not used for interning, compare its contents
+    const QString string = QString::fromLatin1( name );
+    return atom( QStringRef( &string ) );
+}
+
+GeoAtomTable::Atom GeoAtomTable::atom( const QStringRef &name )
+{
+    const GeoAtomTableData *const table = atomTable();
+
+    const uint hash = qHash( name );
+    QMultiHash<uint, Atom>::const_iterator it = table->atomsByHash.constFind( hash );
+    for ( ; it != table->atomsByHash.constEnd() && it.key() == hash; ++it ) {
+        if ( table->names.at( it.value() ) == name ) {
+            return it.value();
+        }
+    }
+
+    return Unknown;
+}
+
+QString GeoAtomTable::name( Atom atom )
+{
+    const GeoAtomTableData *const table = atomTable();
+
+    if ( atom <= Unknown || atom >= table->names.size() ) {
+        return QString();
+    }
+
+    return table->names.at( atom );
+}
+
+}
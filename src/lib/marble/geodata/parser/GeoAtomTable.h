@@ -0,0 +1,67 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#ifndef MARBLE_GEOATOMTABLE_H
+#define MARBLE_GEOATOMTABLE_H
+
+#include <QString>
+#include <QStringRef>
+
+#include "geodata_export.h"
+
+namespace Marble
+{
+
+/**
+ * @brief Maps tag and namespace names to small integers.
+ *
+ * Names get interned when tag handlers are registered, so while parsing an
+ * element name is looked up without allocating a string, and comparing two
+ * names is comparing two integers.
+ *
+ * Like the registration of tag handlers, interning is not thread safe; it is
+ * meant to happen while the library or a plugin is loaded. Looking up atoms is
+ * safe from any thread.
+ */
+class GEODATA_EXPORT GeoAtomTable
+{
+ public:
+    typedef int Atom;
+
+    /**
+     * The atom of any name which was not interned.
+     */
+    static const Atom Unknown = 0;
+
+    /**
+     * Returns the atom of @p name, adding it to the table if needed. Later
+     * lookups of the same address are answered without looking at the string.
+     */
+    static Atom intern( const char *name );
+    static Atom intern( const QString &name );
+
+    /**
+     * Stops looking up @p name by its address, for example because the
+     * library holding it gets unloaded. The name itself stays interned.
+     */
+    static void forget( const char *name );
+
+    /**
+     * Returns the atom of @p name, or Unknown.
+     */
+    static Atom atom( const char *name );
+    static Atom atom( const QStringRef &name );
+
+    static QString name( Atom atom );
+};
+
+}
+
+#endif
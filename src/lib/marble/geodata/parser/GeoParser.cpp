@@ -143,14 +143,19 @@ void GeoParser::parseDocument()
     }
 
     bool processChildren = true;
-    QualifiedName qName( name().toString(), namespaceUri().toString() );
+    // Look the names up without copying them, handlers are known by interned names only
+    const GeoAtomTable::Atom tagName = GeoAtomTable::atom( name() );
+    const GeoAtomTable::Atom nameSpace = GeoAtomTable::atom( namespaceUri() );
 
     if( tokenType() == QXmlStreamReader::Invalid )
         raiseWarning( QString( "%1: %2" ).arg( error() ).arg( errorString() ) );
 
-    GeoStackItem stackItem( qName, 0 );
+    GeoStackItem stackItem( tagName, nameSpace, 0 );
+    if ( tagName == GeoAtomTable::Unknown || nameSpace == GeoAtomTable::Unknown ) {
+        stackItem.m_unknownName = QualifiedName( name().toString(), namespaceUri().toString() );
+    }
 
-    if ( const GeoTagHandler* handler = GeoTagHandler::recognizes( qName )) {
+    if ( const GeoTagHandler* handler = GeoTagHandler::recognizes( tagName, nameSpace )) {
         stackItem.assignNode( handler->parse( *this ));
         processChildren = !isEndElement();
     }
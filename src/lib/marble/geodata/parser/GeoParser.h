@@ -27,6 +27,7 @@
 #include <QXmlStreamReader>
 
 #include "geodata_export.h"
+#include "GeoAtomTable.h"
 
 namespace Marble
 {
@@ -98,23 +99,39 @@ class GeoStackItem
 {
  public:
     GeoStackItem()
-        : m_qualifiedName(),
+        : m_tagName( GeoAtomTable::Unknown ),
+          m_nameSpace( GeoAtomTable::Unknown ),
           m_node( 0 )
     {
     }
 
     GeoStackItem( const GeoParser::QualifiedName& qualifiedName, GeoNode* node )
-        : m_qualifiedName( qualifiedName ),
+        : m_tagName( GeoAtomTable::atom( QStringRef( &qualifiedName.first ) ) ),
+          m_nameSpace( GeoAtomTable::atom( QStringRef( &qualifiedName.second ) ) ),
           m_node( node )
     {
+        if ( m_tagName == GeoAtomTable::Unknown || m_nameSpace == GeoAtomTable::Unknown ) {
+            m_unknownName = qualifiedName;
+        }
     }
 
-    // Fast path for tag handlers
+    GeoStackItem( GeoAtomTable::Atom tagName, GeoAtomTable::Atom nameSpace, GeoNode* node )
+        : m_tagName( tagName ),
+          m_nameSpace( nameSpace ),
+          m_node( node )
+    {
+    }
+
+    // Fast path for tag handlers: only elements with a registered tag
+    // handler get a node, so their names are interned.
     bool represents( const char* tagName ) const
     {
-        return m_node && tagName == m_qualifiedName.first;
+        return m_node && m_tagName == GeoAtomTable::atom( tagName );
     }
 
+    GeoAtomTable::Atom tagName() const { return m_tagName; }
+    GeoAtomTable::Atom nameSpace() const { return m_nameSpace; }
+
     // Helper for tag handlers. Does NOT guard against miscasting. Use with care.
     template<class T>
     T* nodeAs()
@@ -129,13 +146,23 @@ class GeoStackItem
         return 0 != dynamic_cast<T*>(m_node);
     }
 
-    GeoParser::QualifiedName qualifiedName() const { return m_qualifiedName; }
+    GeoParser::QualifiedName qualifiedName() const
+    {
+        if ( m_tagName == GeoAtomTable::Unknown || m_nameSpace == GeoAtomTable::Unknown ) {
+            return m_unknownName;
+        }
+        return GeoParser::QualifiedName( GeoAtomTable::name( m_tagName ), GeoAtomTable::name( m_nameSpace ) );
+    }
+
     GeoNode* associatedNode() const { return m_node; }
 
 private:
     friend class GeoParser;
     void assignNode( GeoNode* node ) { m_node = node; }
-    GeoParser::QualifiedName m_qualifiedName;
+    GeoAtomTable::Atom m_tagName;
+    GeoAtomTable::Atom m_nameSpace;
+    // the names of elements nobody registered a tag handler for
+    GeoParser::QualifiedName m_unknownName;
     GeoNode* m_node;
 };
 
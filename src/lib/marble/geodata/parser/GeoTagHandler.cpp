@@ -52,36 +52,36 @@ GeoTagHandler::TagHash* GeoTagHandler::tagHandlerHash()
     return s_tagHandlerHash;
 }
 
-void GeoTagHandler::registerHandler(const GeoParser::QualifiedName& qName, const GeoTagHandler* handler)
+void GeoTagHandler::registerHandler(GeoAtomTable::Atom tagName, GeoAtomTable::Atom nameSpace, const GeoTagHandler* handler)
 {
     TagHash* hash = tagHandlerHash();
+    const AtomPair qName(tagName, nameSpace);
 
     Q_ASSERT(!hash->contains(qName));
     hash->insert(qName, handler);
     Q_ASSERT(hash->contains(qName));
 
 #if DUMP_TAG_HANDLER_REGISTRATION > 0
-    mDebug() << "[GeoTagHandler] -> Recognizing" << qName.first << "tag with namespace" << qName.second;
+    mDebug() << "[GeoTagHandler] -> Recognizing" << GeoAtomTable::name(tagName) << "tag with namespace" << GeoAtomTable::name(nameSpace);
 #endif
 }
 
-void GeoTagHandler::unregisterHandler(const GeoParser::QualifiedName& qName)
+void GeoTagHandler::unregisterHandler(GeoAtomTable::Atom tagName, GeoAtomTable::Atom nameSpace)
 {
     TagHash* hash = tagHandlerHash();
+    const AtomPair qName(tagName, nameSpace);
 
     Q_ASSERT(hash->contains(qName));
     hash->remove(qName);
     Q_ASSERT(!hash->contains(qName));
 }
 
-const GeoTagHandler* GeoTagHandler::recognizes(const GeoParser::QualifiedName& qName)
+const GeoTagHandler* GeoTagHandler::recognizes(GeoAtomTable::Atom tagName, GeoAtomTable::Atom nameSpace)
 {
-    TagHash* hash = tagHandlerHash();
-
-    if (!hash->contains(qName))
+    if (tagName == GeoAtomTable::Unknown || nameSpace == GeoAtomTable::Unknown)
         return 0;
 
-    return (*hash)[qName];
+    return tagHandlerHash()->value(AtomPair(tagName, nameSpace), 0);
 }
 
 }
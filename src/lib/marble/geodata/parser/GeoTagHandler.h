@@ -55,15 +55,16 @@ private:
 
 private: // Only our registrar is allowed to register tag handlers.
     friend struct GeoTagHandlerRegistrar;
-    static void registerHandler(const GeoParser::QualifiedName&, const GeoTagHandler*);
-    static void unregisterHandler(const GeoParser::QualifiedName&);
+    static void registerHandler(GeoAtomTable::Atom tagName, GeoAtomTable::Atom nameSpace, const GeoTagHandler*);
+    static void unregisterHandler(GeoAtomTable::Atom tagName, GeoAtomTable::Atom nameSpace);
 
 private: // Only our parser is allowed to access tag handlers.
     friend class GeoParser;
-    static const GeoTagHandler* recognizes(const GeoParser::QualifiedName&);
+    static const GeoTagHandler* recognizes(GeoAtomTable::Atom tagName, GeoAtomTable::Atom nameSpace);
 
 private:
-    typedef QHash<GeoParser::QualifiedName, const GeoTagHandler*> TagHash;
+    typedef QPair<GeoAtomTable::Atom, GeoAtomTable::Atom> AtomPair; // Tag Name & Namespace atoms
+    typedef QHash<AtomPair, const GeoTagHandler*> TagHash;
 
     static TagHash* tagHandlerHash();
     static TagHash* s_tagHandlerHash;
@@ -74,23 +75,47 @@ struct GeoTagHandlerRegistrar
 {
 public:
     GeoTagHandlerRegistrar(const GeoParser::QualifiedName& name, const GeoTagHandler* handler)
-        :m_name( name )
+        : m_tagNameAddress( 0 ),
+          m_nameSpaceAddress( 0 ),
+          m_tagName( GeoAtomTable::intern( name.first ) ),
+          m_nameSpace( GeoAtomTable::intern( name.second ) )
     {
-        GeoTagHandler::registerHandler(name, handler);
+        GeoTagHandler::registerHandler(m_tagName, m_nameSpace, handler);
+    }
+
+    /**
+     * Prefer this one: tag handlers passing the same @p tagName address to
+     * GeoStackItem::represents() get their answer without any string comparison.
+     */
+    GeoTagHandlerRegistrar(const char* tagName, const char* nameSpace, const GeoTagHandler* handler)
+        : m_tagNameAddress( tagName ),
+          m_nameSpaceAddress( nameSpace ),
+          m_tagName( GeoAtomTable::intern( tagName ) ),
+          m_nameSpace( GeoAtomTable::intern( nameSpace ) )
+    {
+        GeoTagHandler::registerHandler(m_tagName, m_nameSpace, handler);
     }
 
     ~GeoTagHandlerRegistrar()
     {
-        GeoTagHandler::unregisterHandler(m_name);
+        GeoTagHandler::unregisterHandler(m_tagName, m_nameSpace);
+        // the names may live in a plugin which is about to be unloaded
+        if ( m_tagNameAddress ) {
+            GeoAtomTable::forget( m_tagNameAddress );
+            GeoAtomTable::forget( m_nameSpaceAddress );
+        }
     }
 
 private:
-    GeoParser::QualifiedName m_name;
+    const char* m_tagNameAddress;
+    const char* m_nameSpaceAddress;
+    GeoAtomTable::Atom m_tagName;
+    GeoAtomTable::Atom m_nameSpace;
 };
 
 // Macros to ease registering new handlers
 #define GEODATA_DEFINE_TAG_HANDLER(Module, UpperCaseModule, Name, NameSpace) \
-    static GeoTagHandlerRegistrar s_handler##Name##NameSpace(GeoParser::QualifiedName(QLatin1String(Module##Tag_##Name), QLatin1String(NameSpace)), \
+    static GeoTagHandlerRegistrar s_handler##Name##NameSpace(Module##Tag_##Name, NameSpace, \
                                                              new UpperCaseModule##Name##TagHandler());
 
 }
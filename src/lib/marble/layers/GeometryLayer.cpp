@@ -45,6 +45,9 @@
 #include "GeoPhotoGraphicsItem.h"
 #include "ScreenOverlayGraphicsItem.h"
 #include "TileId.h"
+#include "TileRenderBundle.h"
+#include "LabelGrid.h"
+#include "ProjectedGeometryCache.h"
 #include "MarbleGraphicsItem.h"
 #include "MarblePlacemarkModel.h"
 #include "GeoDataTreeModel.h"
@@ -73,16 +76,26 @@ public:
     const QAbstractItemModel *const m_model;
     const StyleBuilder *const m_styleBuilder;
     GeoGraphicsScene m_scene;
+    ProjectedGeometryCache m_projectedGeometryCache;
+    LabelGrid m_labelGrid;
+    // reused for each frame to avoid reallocations
+    QVector<GeoGraphicsItem*> m_visibleItems;
     QString m_runtimeTrace;
     QList<ScreenOverlayGraphicsItem*> m_items;
 
     QMap<qint64,OsmQueue> m_osmWayItems;
     QMap<qint64,OsmQueue> m_osmRelationItems;
+
+    // prepared items of documents about to be added to the model
+    QHash<const GeoDataDocument*, QSharedPointer<TileRenderBundle> > m_renderBundles;
+    // the bundle of the document currently being added, if any
+    TileRenderBundle *m_renderBundle;
 };
 
 GeometryLayerPrivate::GeometryLayerPrivate(const QAbstractItemModel *model, const StyleBuilder *styleBuilder) :
     m_model(model),
-    m_styleBuilder(styleBuilder)
+    m_styleBuilder(styleBuilder),
+    m_renderBundle(0)
 {
 }
 
@@ -125,9 +138,15 @@ bool GeometryLayer::render( GeoPainter *painter, ViewportParams *viewport,
     Q_UNUSED( layer )
 
     painter->save();
+    d->m_projectedGeometryCache.resetStatistics();
+    painter->setProjectedGeometryCache( &d->m_projectedGeometryCache );
+    d->m_labelGrid.reset( viewport->size() );
+    painter->setLabelGrid( &d->m_labelGrid );
 
     const int maxZoomLevel = qMin<int>(qMax<int>(qLn(viewport->radius()*4/256)/qLn(2.0), 1), d->m_styleBuilder->maximumZoomLevel());
-    QList<GeoGraphicsItem*> items = d->m_scene.items( viewport->viewLatLonAltBox(), maxZoomLevel );
+    QVector<GeoGraphicsItem*> &items = d->m_visibleItems;
+    items.resize( 0 );
+    d->m_scene.items( viewport->viewLatLonAltBox(), maxZoomLevel, items );
 
     typedef QPair<QString, GeoGraphicsItem*> LayerItem;
     QList<LayerItem> defaultLayer;
@@ -173,11 +192,14 @@ bool GeometryLayer::render( GeoPainter *painter, ViewportParams *viewport,
         item->paintEvent( painter, viewport );
     }
 
+    painter->setLabelGrid( 0 );
+    painter->setProjectedGeometryCache( 0 );
     painter->restore();
-    d->m_runtimeTrace = QStringLiteral("Geometries: %1 Drawn: %2 Zoom: %3")
+    d->m_runtimeTrace = QStringLiteral("Geometries: %1 Drawn: %2 Zoom: %3 %4")
                 .arg( items.size() )
                 .arg( paintedItems )
-                .arg( maxZoomLevel );
+                .arg( maxZoomLevel )
+                .arg( d->m_projectedGeometryCache.runtimeTrace() );
     return true;
 }
 
@@ -213,13 +235,7 @@ void GeometryLayerPrivate::createGraphicsItems( const GeoDataObject *object )
 
 void GeometryLayerPrivate::createGraphicsItemFromGeometry(const GeoDataGeometry* object, const GeoDataPlacemark *placemark , bool avoidOsmDuplicates)
 {
-    GeoGraphicsItem *item = 0;
-    if ( object->nodeType() == GeoDataTypes::GeoDataLineStringType )
-    {
-        const GeoDataLineString* line = static_cast<const GeoDataLineString*>( object );
-        item = new GeoLineStringGraphicsItem( placemark, line );
-    }
-    else if ( object->nodeType() == GeoDataTypes::GeoDataLinearRingType )
+    if ( object->nodeType() == GeoDataTypes::GeoDataLinearRingType )
     {
         if (avoidOsmDuplicates && placemark->hasOsmData()){
             qint64 const osmId = placemark->osmData().id();
@@ -230,9 +246,6 @@ void GeometryLayerPrivate::createGraphicsItemFromGeometry(const GeoDataGeometry*
                 }
             }
         }
-
-        const GeoDataLinearRing *ring = static_cast<const GeoDataLinearRing*>( object );
-        item = GeoPolygonGraphicsItem::createGraphicsItem(placemark, ring);
     }
     else if ( object->nodeType() == GeoDataTypes::GeoDataPolygonType )
     {
@@ -245,12 +258,6 @@ void GeometryLayerPrivate::createGraphicsItemFromGeometry(const GeoDataGeometry*
                 }
             }
         }
-
-        const GeoDataPolygon *poly = static_cast<const GeoDataPolygon*>( object );
-        item = GeoPolygonGraphicsItem::createGraphicsItem(placemark, poly);
-        if (item->zValue() == 0) {
-             item->setZValue(poly->renderOrder());
-        }
     }
     else if ( object->nodeType() == GeoDataTypes::GeoDataMultiGeometryType  )
     {
@@ -260,6 +267,7 @@ void GeometryLayerPrivate::createGraphicsItemFromGeometry(const GeoDataGeometry*
         {
             createGraphicsItemFromGeometry( multigeo->child( row ), placemark, true );
         }
+        return;
     }
     else if ( object->nodeType() == GeoDataTypes::GeoDataMultiTrackType  )
     {
@@ -269,17 +277,15 @@ void GeometryLayerPrivate::createGraphicsItemFromGeometry(const GeoDataGeometry*
         {
             createGraphicsItemFromGeometry( multitrack->child( row ), placemark, true );
         }
+        return;
     }
-    else if ( object->nodeType() == GeoDataTypes::GeoDataTrackType )
-    {
-        const GeoDataTrack *track = static_cast<const GeoDataTrack*>( object );
-        item = new GeoTrackGraphicsItem( placemark, track );
+
+    GeoGraphicsItem *item = m_renderBundle ? m_renderBundle->takeItem( object ) : 0;
+    if ( !item ) {
+        item = TileRenderBundle::createItem( placemark, object, m_styleBuilder );
     }
     if ( !item )
         return;
-    item->setStyleBuilder(m_styleBuilder);
-    item->setVisible( placemark->isGloballyVisible() );
-    item->setMinZoomLevel(m_styleBuilder->minimumZoomLevel(*placemark));
     m_scene.addItem( item );
 }
 
@@ -360,8 +366,13 @@ void GeometryLayer::addPlacemarks( const QModelIndex& parent, int first, int las
         Q_ASSERT( index.isValid() );
         const GeoDataObject *object = qvariant_cast<GeoDataObject*>(index.data( MarblePlacemarkModel::ObjectPointerRole ) );
         Q_ASSERT( object );
+        const QSharedPointer<TileRenderBundle> bundle = d->m_renderBundles.take( dynamic_cast<const GeoDataDocument*>( object ) );
+        d->m_renderBundle = bundle.data();
         d->createGraphicsItems( object );
+        d->m_renderBundle = 0;
     }
+    // bundles whose documents were not added are of no use anymore
+    d->m_renderBundles.clear();
     emit repaintNeeded();
 
 }
@@ -369,6 +380,8 @@ void GeometryLayer::addPlacemarks( const QModelIndex& parent, int first, int las
 void GeometryLayer::removePlacemarks( const QModelIndex& parent, int first, int last )
 {
     Q_ASSERT( last < d->m_model->rowCount( parent ) );
+    // the cache identifies geometries by their address, which may get reused
+    d->m_projectedGeometryCache.clear();
     bool isRepaintNeeded = false;
     for( int i=first; i<=last; ++i ) {
         QModelIndex index = d->m_model->index( i, 0, parent );
@@ -386,8 +399,14 @@ void GeometryLayer::removePlacemarks( const QModelIndex& parent, int first, int
 
 }
 
+void GeometryLayer::addRenderBundle( const QSharedPointer<TileRenderBundle> &bundle )
+{
+    d->m_renderBundles.insert( bundle->document(), bundle );
+}
+
 void GeometryLayer::resetCacheData()
 {
+    d->m_projectedGeometryCache.clear();
     d->m_scene.clear();
     qDeleteAll( d->m_items );
     d->m_items.clear();
@@ -14,6 +14,7 @@
 #define MARBLE_GEOMETRYLAYER_H
 
 #include <QObject>
+#include <QSharedPointer>
 #include "LayerInterface.h"
 #include "GeoDataCoordinates.h"
 
@@ -27,6 +28,7 @@ class GeoPainter;
 class GeoDataFeature;
 class GeoDataPlacemark;
 class StyleBuilder;
+class TileRenderBundle;
 class ViewportParams;
 
 class GeometryLayerPrivate;
@@ -57,6 +59,12 @@ public Q_SLOTS:
     void removePlacemarks( const QModelIndex& index, int first, int last );
     void resetCacheData();
 
+    /**
+     * Keeps the graphics items prepared in @p bundle until its document gets
+     * added to the model, so they don't have to be created again.
+     */
+    void addRenderBundle( const QSharedPointer<Marble::TileRenderBundle> &bundle );
+
     /**
      * Finds all placemarks that contain the clicked point.
      *
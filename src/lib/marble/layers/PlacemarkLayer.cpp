@@ -26,8 +26,6 @@
 
 using namespace Marble;
 
-bool PlacemarkLayer::m_useXWorkaround = false;
-
 PlacemarkLayer::PlacemarkLayer(QAbstractItemModel *placemarkModel,
                                 QItemSelectionModel *selectionModel,
                                 MarbleClock *clock, const StyleBuilder *styleBuilder,
@@ -35,9 +33,6 @@ PlacemarkLayer::PlacemarkLayer(QAbstractItemModel *placemarkModel,
     QObject( parent ),
     m_layout( placemarkModel, selectionModel, clock, styleBuilder )
 {
-    m_useXWorkaround = testXBug();
-    mDebug() << "Use workaround: " << ( m_useXWorkaround ? "1" : "0" );
-
     connect( &m_layout, SIGNAL(repaintNeeded()), SIGNAL(repaintNeeded()) );
 }
 
@@ -66,14 +61,14 @@ bool PlacemarkLayer::render( GeoPainter *geoPainter, ViewportParams *viewport,
     QVector<VisiblePlacemark*>::const_iterator visit = visiblePlacemarks.constEnd();
     QVector<VisiblePlacemark*>::const_iterator itEnd = visiblePlacemarks.constBegin();
 
-    QPainter *const painter = geoPainter;
+    m_atlas.begin( geoPainter );
 
     while ( visit != itEnd ) {
         --visit;
 
         VisiblePlacemark *const mark = *visit;
 
-        QRect labelRect( mark->labelRect().toRect() );
+        QPointF labelPos( mark->labelRect().toRect().topLeft() );
         QPoint symbolPos( mark->symbolPosition() );
 
         // when the map is such zoomed out that a given place
@@ -86,21 +81,33 @@ bool PlacemarkLayer::render( GeoPainter *geoPainter, ViewportParams *viewport,
                  i <= viewport->width();
                  i += 4 * viewport->radius() )
             {
-                labelRect.moveLeft(i - symbolX + textX );
+                labelPos.setX(i - symbolX + textX );
                 symbolPos.setX( i );
 
-                painter->drawPixmap( symbolPos, mark->symbolPixmap() );
-                painter->drawPixmap( labelRect, mark->labelPixmap() );
+                drawPlacemark( mark, symbolPos, labelPos );
             }
         } else { // simple case, one draw per placemark
-            painter->drawPixmap( symbolPos, mark->symbolPixmap() );
-            painter->drawPixmap( labelRect, mark->labelPixmap() );
+            drawPlacemark( mark, symbolPos, labelPos );
         }
     }
 
+    m_atlas.end();
+
     return true;
 }
 
+void PlacemarkLayer::drawPlacemark( const VisiblePlacemark *mark, const QPoint &symbolPos, const QPointF &labelPos )
+{
+    // the images only get rendered when they are not in the atlas yet
+    if ( !mark->symbolImage().isNull() && !m_atlas.draw( mark->symbolKey(), symbolPos ) ) {
+        m_atlas.draw( mark->symbolKey(), symbolPos, mark->symbolImage() );
+    }
+
+    if ( !mark->labelKey().isEmpty() && !mark->labelRect().isEmpty() && !m_atlas.draw( mark->labelKey(), labelPos ) ) {
+        m_atlas.draw( mark->labelKey(), labelPos, mark->labelImage() );
+    }
+}
+
 RenderState PlacemarkLayer::renderState() const
 {
     return RenderState(QStringLiteral("Placemarks"));
@@ -108,7 +115,10 @@ RenderState PlacemarkLayer::renderState() const
 
 QString PlacemarkLayer::runtimeTrace() const
 {
-    return m_layout.runtimeTrace();
+    return QStringLiteral("%1 Atlas: %2 pages %3 batches")
+            .arg( m_layout.runtimeTrace() )
+            .arg( m_atlas.pageCount() )
+            .arg( m_atlas.batchCount() );
 }
 
 QVector<const GeoDataFeature *> PlacemarkLayer::whichPlacemarkAt( const QPoint &pos )
@@ -116,6 +126,11 @@ QVector<const GeoDataFeature *> PlacemarkLayer::whichPlacemarkAt( const QPoint &
     return m_layout.whichPlacemarkAt( pos );
 }
 
+void PlacemarkLayer::setViewContext( ViewContext viewContext )
+{
+    m_layout.setViewContext( viewContext );
+}
+
 void PlacemarkLayer::setShowPlaces( bool show )
 {
     m_layout.setShowPlaces( show );
@@ -157,41 +172,5 @@ void PlacemarkLayer::requestStyleReset()
 }
 
 
-// Test if there a bug in the X server which makes 
-// text fully transparent if it gets written on 
-// QPixmaps that were initialized by filling them 
-// with Qt::transparent
-
-bool PlacemarkLayer::testXBug()
-{
-    QString  testchar( "K" );
-    QFont    font( "Sans Serif", 10 );
-
-    int fontheight = QFontMetrics( font ).height();
-    int fontwidth  = QFontMetrics( font ).width(testchar);
-    int fontascent = QFontMetrics( font ).ascent();
-
-    QPixmap  pixmap( fontwidth, fontheight );
-    pixmap.fill( Qt::transparent );
-
-    QPainter textpainter;
-    textpainter.begin( &pixmap );
-    textpainter.setPen( QColor( 0, 0, 0, 255 ) );
-    textpainter.setFont( font );
-    textpainter.drawText( 0, fontascent, testchar );
-    textpainter.end();
-
-    QImage image = pixmap.toImage();
-
-    for ( int x = 0; x < fontwidth; ++x ) {
-        for ( int y = 0; y < fontheight; ++y ) {
-            if ( qAlpha( image.pixel( x, y ) ) > 0 )
-                return false;
-        }
-    }
-
-    return true;
-}
-
 #include "moc_PlacemarkLayer.cpp"
 
@@ -23,6 +23,7 @@
 
 #include <QVector>
 
+#include "ImageAtlas.h"
 #include "PlacemarkLayout.h"
 
 class QAbstractItemModel;
@@ -37,6 +38,7 @@ class GeoSceneLayer;
 class MarbleClock;
 class ViewportParams;
 class StyleBuilder;
+class VisiblePlacemark;
 
 class PlacemarkLayer : public QObject, public LayerInterface
 {
@@ -76,7 +78,8 @@ class PlacemarkLayer : public QObject, public LayerInterface
      */
     QVector<const GeoDataFeature *> whichPlacemarkAt( const QPoint &pos );
 
-    static bool m_useXWorkaround;  // Indicates need for an X windows workaround.
+    void setViewContext( ViewContext viewContext );
+
  public Q_SLOTS:
    // earth
    void setShowPlaces( bool show );
@@ -95,9 +98,11 @@ class PlacemarkLayer : public QObject, public LayerInterface
    void repaintNeeded();
 
  private:
-    static bool testXBug();
+    void drawPlacemark( const VisiblePlacemark *mark, const QPoint &symbolPos, const QPointF &labelPos );
 
     PlacemarkLayout m_layout;
+    // symbols and labels of the placemarks, shared between frames
+    ImageAtlas m_atlas;
 };
 
 }
@@ -41,6 +41,8 @@ namespace Marble
 {
 
 const int REPAINT_SCHEDULING_INTERVAL = 1000;
+const int DECODED_TILE_REPAINT_INTERVAL = 40;
+const int UPDATED_TILE_REPAINT_INTERVAL = 40;
 
 class Q_DECL_HIDDEN TextureLayer::Private
 {
@@ -51,9 +53,11 @@ public:
              QAbstractItemModel *groundOverlayModel,
              TextureLayer *parent );
 
-    void requestDelayedRepaint();
+    void requestDelayedRepaint( int interval = REPAINT_SCHEDULING_INTERVAL );
+    void repaintUpdatedTile();
     void updateTextureLayers();
     void updateTile( const TileId &tileId, const QImage &tileImage );
+    void updateSunShading();
 
     void addGroundOverlays( const QModelIndex& parent, int first, int last );
     void removeGroundOverlays( const QModelIndex& parent, int first, int last );
@@ -102,6 +106,8 @@ TextureLayer::Private::Private( HttpDownloadManager *downloadManager,
     , m_textureLayerSettings( 0 )
     , m_repaintTimer()
 {
+    m_loader.setDecodeInBackground( true );
+
     m_groundOverlayModel.setSourceModel( groundOverlayModel );
     m_groundOverlayModel.setDynamicSortFilter( true );
     m_groundOverlayModel.setSortRole ( MarblePlacemarkModel::PopularityIndexRole );
@@ -119,20 +125,29 @@ TextureLayer::Private::Private( HttpDownloadManager *downloadManager,
     connect( &m_groundOverlayModel, SIGNAL(modelReset()),
              m_parent,              SLOT(resetGroundOverlaysCache()) );
 
+    connect( &m_tileLoader, SIGNAL(tileUpdated(TileId)),
+             m_parent,      SLOT(repaintUpdatedTile()) );
+
     updateGroundOverlays();
 }
 
-void TextureLayer::Private::requestDelayedRepaint()
+void TextureLayer::Private::requestDelayedRepaint( int interval )
 {
     if ( m_texmapper ) {
         m_texmapper->setRepaintNeeded();
     }
 
-    if ( !m_repaintTimer.isActive() ) {
-        m_repaintTimer.start();
+    if ( !m_repaintTimer.isActive() || m_repaintTimer.remainingTime() > interval ) {
+        m_repaintTimer.start( interval );
     }
 }
 
+void TextureLayer::Private::repaintUpdatedTile()
+{
+    // the tile has been blended already, so it is shown as soon as possible
+    requestDelayedRepaint( UPDATED_TILE_REPAINT_INTERVAL );
+}
+
 void TextureLayer::Private::updateTextureLayers()
 {
     QVector<GeoSceneTextureTileDataset const *> result;
@@ -167,7 +182,19 @@ void TextureLayer::Private::updateTile( const TileId &tileId, const QImage &tile
 
     m_tileLoader.updateTile( tileId, tileImage );
 
-    requestDelayedRepaint();
+    // tiles read from the local disk cache don't need to wait for further downloads
+    if ( m_loader.isDecoding( tileId ) ) {
+        requestDelayedRepaint( DECODED_TILE_REPAINT_INTERVAL );
+    } else {
+        requestDelayedRepaint();
+    }
+}
+
+void TextureLayer::Private::updateSunShading()
+{
+    // only the tiles being displayed need to be blended again right away
+    m_layerDecorator.updateSunShading();
+    m_tileLoader.reblendVisibleTiles();
 }
 
 bool TextureLayer::Private::drawOrderLessThan( const GeoDataGroundOverlay* o1, const GeoDataGroundOverlay* o2 )
@@ -323,7 +350,7 @@ bool TextureLayer::render( GeoPainter *painter, ViewportParams *viewport,
          d->m_centerCoordinates.latitude() != viewport->centerLatitude() ) {
         d->m_centerCoordinates.setLongitude( viewport->centerLongitude() );
         d->m_centerCoordinates.setLatitude( viewport->centerLatitude() );
-        d->m_texmapper->setRepaintNeeded();
+        d->m_texmapper->setCenterChanged();
     }
 
     // choose the smaller dimension for selecting the tile level, leading to higher-resolution results
@@ -350,7 +377,12 @@ bool TextureLayer::render( GeoPainter *painter, ViewportParams *viewport,
     const QRect dirtyRect = QRect( QPoint( 0, 0), viewport->size() );
     d->m_texmapper->mapTexture( painter, viewport, d->m_tileZoomLevel, dirtyRect, d->m_texcolorizer );
     d->m_renderState.addChild( d->m_tileLoader.renderState() );
-    d->m_runtimeTrace = QStringLiteral("Texture Cache: %1 ").arg(d->m_tileLoader.tileCount());
+    d->m_runtimeTrace = QStringLiteral("Texture Cache: %1 (%2 hits, %3 misses, %4 evicted) ")
+                            .arg(d->m_tileLoader.tileCount())
+                            .arg(d->m_tileLoader.cacheHits())
+                            .arg(d->m_tileLoader.cacheMisses())
+                            .arg(d->m_tileLoader.cacheEvictions())
+                        + d->m_texmapper->runtimeTrace();
     return true;
 }
 
@@ -369,11 +401,11 @@ void TextureLayer::setShowRelief( bool show )
 void TextureLayer::setShowSunShading( bool show )
 {
     disconnect( d->m_sunLocator, SIGNAL(positionChanged(qreal,qreal)),
-                this, SLOT(reset()) );
+                this, SLOT(updateSunShading()) );
 
     if ( show ) {
         connect( d->m_sunLocator, SIGNAL(positionChanged(qreal,qreal)),
-                 this,       SLOT(reset()) );
+                 this,       SLOT(updateSunShading()) );
     }
 
     d->m_layerDecorator.setShowSunShading( show );
@@ -445,6 +477,11 @@ void TextureLayer::setVolatileCacheLimit( quint64 kilobytes )
     d->m_tileLoader.setVolatileCacheLimit( kilobytes );
 }
 
+void TextureLayer::setTileCacheCompression( TileCacheCompression compression )
+{
+    d->m_tileLoader.setCacheCompression( compression );
+}
+
 void TextureLayer::reset()
 {
     mDebug() << Q_FUNC_INFO;
@@ -519,6 +556,11 @@ qint64 TextureLayer::volatileCacheLimit() const
     return d->m_tileLoader.volatileCacheLimit();
 }
 
+TileCacheCompression TextureLayer::tileCacheCompression() const
+{
+    return d->m_tileLoader.cacheCompression();
+}
+
 int TextureLayer::preferredRadiusCeil( int radius ) const
 {
     if (!d->m_layerDecorator.hasTextureLayer()) {
@@ -86,6 +86,8 @@ class MARBLE_EXPORT TextureLayer : public QObject, public LayerInterface
 
     qint64 volatileCacheLimit() const;
 
+    TileCacheCompression tileCacheCompression() const;
+
     int preferredRadiusCeil( int radius ) const;
     int preferredRadiusFloor( int radius ) const;
 
@@ -118,6 +120,8 @@ public Q_SLOTS:
 
     void setVolatileCacheLimit( quint64 kilobytes );
 
+    void setTileCacheCompression( TileCacheCompression compression );
+
     void reset();
 
     void reload();
@@ -130,8 +134,10 @@ public Q_SLOTS:
 
  private:
     Q_PRIVATE_SLOT( d, void requestDelayedRepaint() )
+    Q_PRIVATE_SLOT( d, void repaintUpdatedTile() )
     Q_PRIVATE_SLOT( d, void updateTextureLayers() )
     Q_PRIVATE_SLOT( d, void updateTile( const TileId &tileId, const QImage &tileImage ) )
+    Q_PRIVATE_SLOT( d, void updateSunShading() )
     Q_PRIVATE_SLOT( d, void addGroundOverlays( const QModelIndex& parent, int first, int last ) )
     Q_PRIVATE_SLOT( d, void removeGroundOverlays( const QModelIndex& parent, int first, int last ) )
     Q_PRIVATE_SLOT( d, void resetGroundOverlaysCache() )
@@ -23,6 +23,7 @@
 #include "GeoSceneVectorTileDataset.h"
 #include "MarbleDebug.h"
 #include "TileLoader.h"
+#include "TileRenderBundle.h"
 #include "ViewportParams.h"
 #include "RenderState.h"
 #include "GeoDataDocument.h"
@@ -38,7 +39,8 @@ public:
     Private(HttpDownloadManager *downloadManager,
             const PluginManager *pluginManager,
             VectorTileLayer *parent,
-            GeoDataTreeModel *treeModel);
+            GeoDataTreeModel *treeModel,
+            const StyleBuilder *styleBuilder);
 
     ~Private();
 
@@ -54,6 +56,7 @@ public:
 
     // TreeModel for displaying GeoDataDocuments
     GeoDataTreeModel *const m_treeModel;
+    const StyleBuilder *const m_styleBuilder;
 
     QThreadPool m_threadPool; // a shared thread pool for all layers to keep CPU usage sane
 };
@@ -61,13 +64,15 @@ public:
 VectorTileLayer::Private::Private(HttpDownloadManager *downloadManager,
                                   const PluginManager *pluginManager,
                                   VectorTileLayer *parent,
-                                  GeoDataTreeModel *treeModel) :
+                                  GeoDataTreeModel *treeModel,
+                                  const StyleBuilder *styleBuilder) :
     m_parent( parent ),
     m_loader( downloadManager, pluginManager ),
     m_texmappers(),
     m_activeTexmappers(),
     m_textureLayerSettings( 0 ),
-    m_treeModel( treeModel )
+    m_treeModel( treeModel ),
+    m_styleBuilder( styleBuilder )
 {
     m_threadPool.setMaxThreadCount( 1 );
 }
@@ -108,12 +113,14 @@ void VectorTileLayer::Private::updateTextureLayers()
 
 VectorTileLayer::VectorTileLayer(HttpDownloadManager *downloadManager,
                                  const PluginManager *pluginManager,
-                                 GeoDataTreeModel *treeModel )
+                                 GeoDataTreeModel *treeModel,
+                                 const StyleBuilder *styleBuilder )
     : QObject()
-    , d( new Private( downloadManager, pluginManager, this, treeModel ) )
+    , d( new Private( downloadManager, pluginManager, this, treeModel, styleBuilder ) )
 {
     qRegisterMetaType<TileId>( "TileId" );
     qRegisterMetaType<GeoDataDocument*>( "GeoDataDocument*" );
+    qRegisterMetaType<TileRenderBundle*>( "TileRenderBundle*" );
 
     connect(&d->m_loader, SIGNAL(tileCompleted(TileId, GeoDataDocument*)), this, SLOT(updateTile(TileId, GeoDataDocument*)));
 }
@@ -186,7 +193,10 @@ void VectorTileLayer::setMapTheme( const QVector<const GeoSceneVectorTileDataset
     d->m_activeTexmappers.clear();
 
     foreach ( const GeoSceneVectorTileDataset *layer, textures ) {
-        d->m_texmappers << new VectorTileModel( &d->m_loader, layer, d->m_treeModel, &d->m_threadPool );
+        VectorTileModel *mapper = new VectorTileModel( &d->m_loader, layer, d->m_treeModel, &d->m_threadPool, d->m_styleBuilder );
+        connect( mapper, SIGNAL(renderBundleReady(QSharedPointer<Marble::TileRenderBundle>)),
+                 this,   SIGNAL(renderBundleReady(QSharedPointer<Marble::TileRenderBundle>)) );
+        d->m_texmappers << mapper;
     }
 
     d->m_textureLayerSettings = textureLayerSettings;
@@ -16,6 +16,7 @@
 
 #include "LayerInterface.h"
 #include <QObject>
+#include <QSharedPointer>
 
 #include "MarbleGlobal.h"
 
@@ -29,8 +30,10 @@ class GeoSceneVectorTileDataset;
 class GeoDataTreeModel;
 class PluginManager;
 class HttpDownloadManager;
+class StyleBuilder;
 class ViewportParams;
 class TileId;
+class TileRenderBundle;
 
 class VectorTileLayer : public QObject, public LayerInterface
 {
@@ -39,7 +42,8 @@ class VectorTileLayer : public QObject, public LayerInterface
  public:
     VectorTileLayer( HttpDownloadManager *downloadManager,
                   const PluginManager *pluginManager,
-                  GeoDataTreeModel *treeModel);
+                  GeoDataTreeModel *treeModel,
+                  const StyleBuilder *styleBuilder);
 
     ~VectorTileLayer();
 
@@ -58,6 +62,12 @@ class VectorTileLayer : public QObject, public LayerInterface
 Q_SIGNALS:
     void tileLevelChanged(int tileLevel);
 
+    /**
+     * Emitted for each tile loaded with graphics items prepared on a worker
+     * thread, right before the tile is added to the tree model.
+     */
+    void renderBundleReady(const QSharedPointer<Marble::TileRenderBundle> &bundle);
+
  public Q_SLOTS:
     void setMapTheme( const QVector<const GeoSceneVectorTileDataset *> &textures, const GeoSceneGroup *textureLayerSettings );
 
@@ -174,6 +174,122 @@ bool AbstractProjection::screenCoordinates( const GeoDataCoordinates &geopoint,
     return screenCoordinates( geopoint, viewport, x, y, globeHidesPoint );
 }
 
+void AbstractProjection::screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                                            int count,
+                                            const ViewportParams *viewport,
+                                            QPointF *points, bool *globeHidesPoints ) const
+{
+    Q_D( const AbstractProjection );
+    d->screenCoordinates( lon, lat, altitude, count, viewport, points, globeHidesPoints );
+}
+
+void AbstractProjectionPrivate::screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                                                   int count,
+                                                   const ViewportParams *viewport,
+                                                   QPointF *points, bool *globeHidesPoints ) const
+{
+    Q_Q( const AbstractProjection );
+
+    for ( int i = 0; i < count; ++i ) {
+        const GeoDataCoordinates coordinates( lon[i], lat[i], altitude ? altitude[i] : 0.0 );
+
+        qreal x = 0;
+        qreal y = 0;
+        q->screenCoordinates( coordinates, viewport, x, y, globeHidesPoints[i] );
+        points[i] = QPointF( x, y );
+    }
+}
+
+void AbstractProjectionPrivate::projectLineStringNodes( const GeoDataLineString &lineString,
+                                                        const ViewportParams *viewport,
+                                                        QVector<const GeoDataCoordinates *> &nodes,
+                                                        QVector<QPointF> &points,
+                                                        QVector<bool> &globeHidesPoints,
+                                                        bool &closingNode ) const
+{
+    Q_Q( const AbstractProjection );
+
+    nodes.clear();
+    closingNode = false;
+
+    if ( lineString.isEmpty() ) {
+        points.clear();
+        globeHidesPoints.clear();
+        return;
+    }
+
+    GeoDataLineString::ConstIterator itCoords = lineString.constBegin();
+    GeoDataLineString::ConstIterator itPreviousCoords = lineString.constBegin();
+
+    GeoDataLineString::ConstIterator itBegin = lineString.constBegin();
+    GeoDataLineString::ConstIterator itEnd = lineString.constEnd();
+
+    bool processingLastNode = false;
+
+    const bool isLong = lineString.size() > 10;
+    const int maximumDetail = levelForResolution(viewport->angularResolution());
+    // The first node of optimized linestrings has a non-zero detail value.
+    const bool hasDetail = itBegin->detail() != 0;
+
+    QVector<int> levelNodes;
+    const bool indexed = hasDetail && lineString.nodesForDetail( maximumDetail, levelNodes );
+    if ( indexed ) {
+        // Low zoom levels only touch the nodes which get drawn
+        nodes.reserve( levelNodes.size() + 1 );
+        foreach ( int index, levelNodes ) {
+            nodes.append( &lineString.at( index ) );
+        }
+
+        // Linear rings get closed by their first node
+        if ( lineString.isClosed() && !levelNodes.isEmpty() && levelNodes.first() == 0 ) {
+            nodes.append( &*itBegin );
+            closingNode = true;
+        }
+    }
+    else {
+        nodes.reserve( lineString.size() + 1 );
+    }
+
+    // Linear rings process the first node once more after the last node
+    while ( !indexed && itCoords != itEnd )
+    {
+        // Optimization for line strings with a big amount of nodes
+        bool skipNode = (hasDetail ? itCoords->detail() > maximumDetail
+                : itCoords != itBegin && isLong && !processingLastNode &&
+                !viewport->resolves( *itPreviousCoords, *itCoords ) );
+
+        if ( !skipNode ) {
+            nodes.append( &*itCoords );
+            closingNode = processingLastNode;
+            itPreviousCoords = itCoords;
+        }
+
+        if ( processingLastNode ) {
+            break;
+        }
+        ++itCoords;
+
+        if ( itCoords == itEnd  && lineString.isClosed() ) {
+            itCoords = itBegin;
+            processingLastNode = true;
+        }
+    }
+
+    const int count = nodes.size();
+    QVector<qreal> lon( count );
+    QVector<qreal> lat( count );
+    QVector<qreal> altitude( count );
+    for ( int i = 0; i < count; ++i ) {
+        nodes.at( i )->geoCoordinates( lon[i], lat[i] );
+        altitude[i] = nodes.at( i )->altitude();
+    }
+
+    points.resize( count );
+    globeHidesPoints.resize( count );
+    screenCoordinates( lon.constData(), lat.constData(), altitude.constData(), count,
+                       viewport, points.data(), globeHidesPoints.data() );
+}
+
 GeoDataLatLonAltBox AbstractProjection::latLonAltBox( const QRect& screenRect,
                                                       const ViewportParams *viewport ) const
 {
@@ -28,6 +28,7 @@
 
 class QIcon;
 class QPainterPath;
+class QPointF;
 class QPolygonF;
 class QRect;
 class QString;
@@ -227,6 +228,30 @@ class MARBLE_EXPORT AbstractProjection
                             const ViewportParams *viewport,
                             QVector<QPolygonF*> &polygons ) const = 0;
 
+    /**
+     * @brief Get the screen coordinates of many geographical coordinates at once.
+     *
+     * Projects the @p count points given by @p lon, @p lat and @p altitude in
+     * one go, which is much faster than projecting each point on its own.
+     * The positions match the ones screenCoordinates() returns for a single
+     * point. Unlike there the points are not checked against the viewport.
+     *
+     * @param lon    the longitudes of the points in radians
+     * @param lat    the latitudes of the points in radians
+     * @param altitude the altitudes of the points in meters, or 0 if all points are at ground level
+     * @param count  the number of points
+     * @param viewport the viewport parameters
+     * @param points the screen positions are returned through this array; the
+     *               positions of points hidden by the globe are undefined
+     * @param globeHidesPoints whether each point gets hidden on the far side of the earth
+     *
+     * @see ViewportParams
+     */
+    void screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                            int count,
+                            const ViewportParams *viewport,
+                            QPointF *points, bool *globeHidesPoints ) const;
+
     /**
      * @brief Get the earth coordinates corresponding to a pixel in the map.
      * @param x      the x coordinate of the pixel
@@ -11,11 +11,17 @@
 #ifndef MARBLE_ABSTRACTPROJECTIONPRIVATE_H
 #define MARBLE_ABSTRACTPROJECTIONPRIVATE_H
 
+#include <QPointF>
+#include <QVector>
+
 
 namespace Marble
 {
 
 class AbstractProjection;
+class GeoDataCoordinates;
+class GeoDataLineString;
+class ViewportParams;
 
 class AbstractProjectionPrivate
 {
@@ -26,6 +32,29 @@ class AbstractProjectionPrivate
 
     int levelForResolution(qreal resolution) const;
 
+    /**
+     * Implements the batch version of AbstractProjection::screenCoordinates()
+     * by projecting each point on its own. Projections with a faster batch
+     * implementation override this, which keeps the public call non-virtual.
+     */
+    virtual void screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                                    int count,
+                                    const ViewportParams *viewport,
+                                    QPointF *points, bool *globeHidesPoints ) const;
+
+    /**
+     * Collects the nodes of @p lineString which are not skipped at the
+     * resolution of @p viewport into @p nodes, in the order they make up
+     * the polygon, and projects all of them in one batch. Linear rings end
+     * with their first node once more, in which case @p closingNode is set.
+     */
+    void projectLineStringNodes( const GeoDataLineString &lineString,
+                                 const ViewportParams *viewport,
+                                 QVector<const GeoDataCoordinates *> &nodes,
+                                 QVector<QPointF> &points,
+                                 QVector<bool> &globeHidesPoints,
+                                 bool &closingNode ) const;
+
     qreal  m_maxLat;
     qreal  m_minLat;
     mutable qreal  m_previousResolution;
@@ -75,6 +75,11 @@ class AzimuthalEquidistantProjection : public AzimuthalProjection
                             const QSizeF& size,
                             bool &globeHidesPoint ) const;
 
+    void screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                            int count,
+                            const ViewportParams *viewport,
+                            QPointF *points, bool *globeHidesPoints ) const;
+
     using AbstractProjection::screenCoordinates;
 
     /**
@@ -281,82 +281,56 @@ bool CylindricalProjectionPrivate::lineStringToPolygon( const GeoDataLineString
 
     polygons.append( new QPolygonF );
 
-    GeoDataLineString::ConstIterator itCoords = lineString.constBegin();
-    GeoDataLineString::ConstIterator itPreviousCoords = lineString.constBegin();
+    // Project all nodes in one batch up front, linear rings end with
+    // their first node once more to close the path
+    QVector<const GeoDataCoordinates *> nodes;
+    QVector<QPointF> points;
+    QVector<bool> globeHidesPoints;
+    bool closingNode = false;
+    projectLineStringNodes( lineString, viewport, nodes, points, globeHidesPoints, closingNode );
 
-    GeoDataLineString::ConstIterator itBegin = lineString.constBegin();
-    GeoDataLineString::ConstIterator itEnd = lineString.constEnd();
-
-    bool processingLastNode = false;
-
-    // We use a while loop to be able to cover linestrings as well as linear rings:
-    // Linear rings require to tessellate the path from the last node to the first node
-    // which isn't really convenient to achieve with a for loop ...
-
-    const bool isLong = lineString.size() > 10;
-    const int maximumDetail = levelForResolution(viewport->angularResolution());
-    // The first node of optimized linestrings has a non-zero detail value.
-    const bool hasDetail = itBegin->detail() != 0;
+    const GeoDataCoordinates *const firstCoords = lineString.isEmpty() ? 0 : &lineString.first();
+    const GeoDataCoordinates *previousCoords = firstCoords;
 
     bool isStraight = lineString.latLonAltBox().height() == 0 || lineString.latLonAltBox().width() == 0;
 
-    while ( itCoords != itEnd )
+    for ( int i = 0; i < nodes.size(); ++i )
     {
-        // Optimization for line strings with a big amount of nodes
-        bool skipNode = (hasDetail ? itCoords->detail() > maximumDetail
-                : itCoords != itBegin && isLong && !processingLastNode &&
-                !viewport->resolves( *itPreviousCoords, *itCoords ) );
-
-        if ( !skipNode ) {
-
-
-            Q_Q( const CylindricalProjection );
-
-            q->screenCoordinates( *itCoords, viewport, x, y );
-
-            // Initializing variables that store the values of the previous iteration
-            if ( !processingLastNode && itCoords == itBegin ) {
-                itPreviousCoords = itCoords;
-                previousX = x;
-                previousY = y;
-            }
+        const GeoDataCoordinates *const coords = nodes.at( i );
+        const bool processingLastNode = closingNode && i == nodes.size() - 1;
 
-            // This if-clause contains the section that tessellates the line
-            // segments of a linestring. If you are about to learn how the code of
-            // this class works you can safely ignore this section for a start.
+        x = points.at( i ).x();
+        y = points.at( i ).y();
 
-            if ( lineString.tessellate() && !isStraight) {
-
-                mirrorCount = tessellateLineSegment( *itPreviousCoords, previousX, previousY,
-                                           *itCoords, x, y,
-                                           polygons, viewport,
-                                           f, mirrorCount, distance );
-            }
-
-            else {
-                // special case for polys which cross dateline but have no Tesselation Flag
-                // the expected rendering is a screen coordinates straight line between
-                // points, but in projections with repeatX things are not smooth
-                mirrorCount = crossDateLine( *itPreviousCoords, *itCoords, x, y, polygons, mirrorCount, distance );
-            }
-
-            itPreviousCoords = itCoords;
+        // Initializing variables that store the values of the previous iteration
+        if ( !processingLastNode && coords == firstCoords ) {
+            previousCoords = coords;
             previousX = x;
             previousY = y;
         }
 
-        // Here we modify the condition to be able to process the
-        // first node after the last node in a LinearRing.
+        // This if-clause contains the section that tessellates the line
+        // segments of a linestring. If you are about to learn how the code of
+        // this class works you can safely ignore this section for a start.
+
+        if ( lineString.tessellate() && !isStraight) {
 
-        if ( processingLastNode ) {
-            break;
+            mirrorCount = tessellateLineSegment( *previousCoords, previousX, previousY,
+                                       *coords, x, y,
+                                       polygons, viewport,
+                                       f, mirrorCount, distance );
         }
-        ++itCoords;
 
-        if ( itCoords == itEnd  && lineString.isClosed() ) {
-            itCoords = itBegin;
-            processingLastNode = true;
+        else {
+            // special case for polys which cross dateline but have no Tesselation Flag
+            // the expected rendering is a screen coordinates straight line between
+            // points, but in projections with repeatX things are not smooth
+            mirrorCount = crossDateLine( *previousCoords, *coords, x, y, polygons, mirrorCount, distance );
         }
+
+        previousCoords = coords;
+        previousX = x;
+        previousY = y;
     }
 
     GeoDataLatLonAltBox box = lineString.latLonAltBox();
@@ -12,6 +12,7 @@
 
 // Local
 #include "EquirectProjection.h"
+#include "CylindricalProjection_p.h"
 
 // Marble
 #include "ViewportParams.h"
@@ -21,11 +22,29 @@
 
 #include <QIcon>
 
+namespace Marble
+{
+
+class EquirectProjectionPrivate : public CylindricalProjectionPrivate
+{
+  public:
+    explicit EquirectProjectionPrivate( EquirectProjection * parent );
+
+    void screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                            int count,
+                            const ViewportParams *viewport,
+                            QPointF *points, bool *globeHidesPoints ) const;
+
+    Q_DECLARE_PUBLIC( EquirectProjection )
+};
+
+}
+
 using namespace Marble;
 
 
 EquirectProjection::EquirectProjection()
-    : CylindricalProjection()
+    : CylindricalProjection( new EquirectProjectionPrivate( this ) )
 {
     setMinLat( minValidLat() );
     setMaxLat( maxValidLat() );
@@ -35,6 +54,20 @@ EquirectProjection::~EquirectProjection()
 {
 }
 
+EquirectProjectionPrivate::EquirectProjectionPrivate( EquirectProjection * parent )
+        : CylindricalProjectionPrivate( parent )
+{
+}
+
+void EquirectProjectionPrivate::screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                                                   int count,
+                                                   const ViewportParams *viewport,
+                                                   QPointF *points, bool *globeHidesPoints ) const
+{
+    Q_Q( const EquirectProjection );
+    q->screenCoordinates( lon, lat, altitude, count, viewport, points, globeHidesPoints );
+}
+
 QString EquirectProjection::name() const
 {
     return QObject::tr( "Flat Map" );
@@ -92,6 +125,26 @@ bool EquirectProjection::screenCoordinates( const GeoDataCoordinates &geopoint,
                   || ( 0 <= x + 4 * radius && x + 4 * radius < width ) ) );
 }
 
+void EquirectProjection::screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                                            int count,
+                                            const ViewportParams *viewport,
+                                            QPointF *points, bool *globeHidesPoints ) const
+{
+    const qreal rad2Pixel = 2.0 * viewport->radius() / M_PI;
+
+    const qreal centerLon = viewport->centerLongitude();
+    const qreal centerLat = viewport->centerLatitude();
+
+    const qreal centerX = (qreal)(viewport->width())  / 2.0;
+    const qreal centerY = (qreal)(viewport->height()) / 2.0;
+
+    for ( int i = 0; i < count; ++i ) {
+        points[i] = QPointF( centerX + rad2Pixel * ( lon[i] - centerLon ),
+                             centerY - rad2Pixel * ( lat[i] - centerLat ) );
+        globeHidesPoints[i] = false;
+    }
+}
+
 bool EquirectProjection::screenCoordinates( const GeoDataCoordinates &coordinates,
                                             const ViewportParams *viewport,
                                             qreal *x, qreal &y,
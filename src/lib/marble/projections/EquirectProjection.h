@@ -84,6 +84,11 @@ class EquirectProjection : public CylindricalProjection
                             const QSizeF& size,
                             bool &globeHidesPoint ) const;
 
+    void screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                            int count,
+                            const ViewportParams *viewport,
+                            QPointF *points, bool *globeHidesPoints ) const;
+
     using CylindricalProjection::screenCoordinates;
 
     /**
@@ -35,6 +35,11 @@ class GnomonicProjectionPrivate : public AzimuthalProjectionPrivate
   public:
     explicit GnomonicProjectionPrivate( GnomonicProjection * parent );
 
+    void screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                            int count,
+                            const ViewportParams *viewport,
+                            QPointF *points, bool *globeHidesPoints ) const;
+
     Q_DECLARE_PUBLIC( GnomonicProjection )
 };
 
@@ -62,6 +67,15 @@ GnomonicProjectionPrivate::GnomonicProjectionPrivate( GnomonicProjection * paren
 {
 }
 
+void GnomonicProjectionPrivate::screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                                                   int count,
+                                                   const ViewportParams *viewport,
+                                                   QPointF *points, bool *globeHidesPoints ) const
+{
+    Q_Q( const GnomonicProjection );
+    q->screenCoordinates( lon, lat, altitude, count, viewport, points, globeHidesPoints );
+}
+
 QString GnomonicProjection::name() const
 {
     return QObject::tr( "Gnomonic" );
@@ -125,6 +139,41 @@ bool GnomonicProjection::screenCoordinates( const GeoDataCoordinates &coordinate
     return true;
 }
 
+void GnomonicProjection::screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                                            int count,
+                                            const ViewportParams *viewport,
+                                            QPointF *points, bool *globeHidesPoints ) const
+{
+    Q_UNUSED( altitude );
+
+    const qreal lambdaPrime = viewport->centerLongitude();
+    const qreal phi1 = viewport->centerLatitude();
+    const qreal sinPhi1 = qSin( phi1 );
+    const qreal cosPhi1 = qCos( phi1 );
+
+    const int scale = viewport->radius() / 2;
+    const qint64  radius  = clippingRadius() * viewport->radius();
+    const int halfWidth = viewport->width() / 2;
+    const int halfHeight = viewport->height() / 2;
+
+    for ( int i = 0; i < count; ++i ) {
+        const qreal phi = lat[i];
+        const qreal deltaLambda = lon[i] - lambdaPrime;
+        const qreal sinPhi = qSin( phi );
+        const qreal cosPhi = qCos( phi );
+        const qreal cosDeltaLambda = qCos( deltaLambda );
+
+        const qreal cosC = sinPhi1 * sinPhi + cosPhi1 * cosPhi * cosDeltaLambda;
+
+        const qreal x = ( cosPhi * qSin( deltaLambda ) ) / cosC * scale;
+        const qreal y = ( cosPhi1 * sinPhi - sinPhi1 * cosPhi * cosDeltaLambda ) / cosC * scale;
+
+        // points behind the globe and outside of the clipping radius are hidden
+        globeHidesPoints[i] = cosC <= 0 || x * x + y * y > radius * radius;
+        points[i] = QPointF( x + halfWidth, halfHeight - y );
+    }
+}
+
 bool GnomonicProjection::screenCoordinates( const GeoDataCoordinates &coordinates,
                                              const ViewportParams *viewport,
                                              qreal *x, qreal &y,
@@ -12,6 +12,7 @@
 
 // Local
 #include "MercatorProjection.h"
+#include "CylindricalProjection_p.h"
 
 #include "MarbleDebug.h"
 
@@ -25,10 +26,28 @@
 
 #include <QIcon>
 
+namespace Marble
+{
+
+class MercatorProjectionPrivate : public CylindricalProjectionPrivate
+{
+  public:
+    explicit MercatorProjectionPrivate( MercatorProjection * parent );
+
+    void screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                            int count,
+                            const ViewportParams *viewport,
+                            QPointF *points, bool *globeHidesPoints ) const;
+
+    Q_DECLARE_PUBLIC( MercatorProjection )
+};
+
+}
+
 using namespace Marble;
 
 MercatorProjection::MercatorProjection()
-    : CylindricalProjection()
+    : CylindricalProjection( new MercatorProjectionPrivate( this ) )
 {
     setMinLat( minValidLat() );
     setMaxLat( maxValidLat() );
@@ -38,6 +57,20 @@ MercatorProjection::~MercatorProjection()
 {
 }
 
+MercatorProjectionPrivate::MercatorProjectionPrivate( MercatorProjection * parent )
+        : CylindricalProjectionPrivate( parent )
+{
+}
+
+void MercatorProjectionPrivate::screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                                                   int count,
+                                                   const ViewportParams *viewport,
+                                                   QPointF *points, bool *globeHidesPoints ) const
+{
+    Q_Q( const MercatorProjection );
+    q->screenCoordinates( lon, lat, altitude, count, viewport, points, globeHidesPoints );
+}
+
 QString MercatorProjection::name() const
 {
     return QObject::tr( "Mercator" );
@@ -113,6 +146,33 @@ bool MercatorProjection::screenCoordinates( const GeoDataCoordinates &geopoint,
                   || ( 0 <= x + 4 * radius && x + 4 * radius < width ) ) );
 }
 
+void MercatorProjection::screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                                            int count,
+                                            const ViewportParams *viewport,
+                                            QPointF *points, bool *globeHidesPoints ) const
+{
+    const qreal minLatitude = minLat();
+    const qreal maxLatitude = maxLat();
+
+    const int radius = viewport->radius();
+    const qreal width = (qreal)(viewport->width());
+    const qreal height = (qreal)(viewport->height());
+
+    const qreal rad2Pixel = 2 * radius / M_PI;
+
+    const qreal centerLon = viewport->centerLongitude();
+    const qreal centerY = gdInv( viewport->centerLatitude() );
+
+    for ( int i = 0; i < count; ++i ) {
+        // points beyond the valid latitudes get moved onto their border
+        const qreal latitude = qBound( minLatitude, lat[i], maxLatitude );
+
+        points[i] = QPointF( width  / 2 + rad2Pixel * ( lon[i] - centerLon ),
+                             height / 2 - rad2Pixel * ( gdInv( latitude ) - centerY ) );
+        globeHidesPoints[i] = false;
+    }
+}
+
 bool MercatorProjection::screenCoordinates( const GeoDataCoordinates &coordinates,
                                             const ViewportParams *viewport,
                                             qreal *x, qreal &y, int &pointRepeatNum,
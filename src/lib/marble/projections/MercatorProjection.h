@@ -83,6 +83,11 @@ class MercatorProjection : public CylindricalProjection
                             const QSizeF& size,
                             bool &globeHidesPoint ) const;
 
+    void screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                            int count,
+                            const ViewportParams *viewport,
+                            QPointF *points, bool *globeHidesPoints ) const;
+
     using CylindricalProjection::screenCoordinates;
 
    /**
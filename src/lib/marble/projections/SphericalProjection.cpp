@@ -38,6 +38,11 @@ class SphericalProjectionPrivate : public AzimuthalProjectionPrivate
 
     explicit SphericalProjectionPrivate( SphericalProjection * parent );
 
+    void screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                            int count,
+                            const ViewportParams *viewport,
+                            QPointF *points, bool *globeHidesPoints ) const;
+
     Q_DECLARE_PUBLIC( SphericalProjection )
 };
 
@@ -64,6 +69,15 @@ SphericalProjectionPrivate::SphericalProjectionPrivate( SphericalProjection * pa
 {
 }
 
+void SphericalProjectionPrivate::screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                                                    int count,
+                                                    const ViewportParams *viewport,
+                                                    QPointF *points, bool *globeHidesPoints ) const
+{
+    Q_Q( const SphericalProjection );
+    q->screenCoordinates( lon, lat, altitude, count, viewport, points, globeHidesPoints );
+}
+
 QString SphericalProjection::name() const
 {
     return QObject::tr( "Globe" );
@@ -129,6 +143,43 @@ bool SphericalProjection::screenCoordinates( const GeoDataCoordinates &coordinat
     return true;
 }
 
+void SphericalProjection::screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                                             int count,
+                                             const ViewportParams *viewport,
+                                             QPointF *points, bool *globeHidesPoints ) const
+{
+    const matrix &planetAxisMatrix = viewport->planetAxisMatrix();
+    const qreal radius = viewport->radius();
+    const qreal width = viewport->width();
+    const qreal height = viewport->height();
+
+    // the same arithmetic as for a single point, but without any calls
+    // besides the trigonometric ones
+    for ( int i = 0; i < count; ++i ) {
+        const qreal pointAltitude = altitude ? altitude[i] : 0.0;
+
+        const qreal cosLat = cos( lat[i] );
+        const qreal qx = cosLat * sin( lon[i] );
+        const qreal qy = sin( lat[i] );
+        const qreal qz = cosLat * cos( lon[i] );
+
+        const qreal x = planetAxisMatrix[0][0] * qx + planetAxisMatrix[1][0] * qy + planetAxisMatrix[2][0] * qz;
+        const qreal y = planetAxisMatrix[0][1] * qx + planetAxisMatrix[1][1] * qy + planetAxisMatrix[2][1] * qz;
+        const qreal z = planetAxisMatrix[0][2] * qx + planetAxisMatrix[1][2] * qy + planetAxisMatrix[2][2] * qz;
+
+        const qreal pixelAltitude = (radius / EARTH_RADIUS * ( pointAltitude + EARTH_RADIUS ));
+        const qreal earthCenteredX = pixelAltitude * x;
+        const qreal earthCenteredY = pixelAltitude * y;
+
+        // Placemarks at the other side of the earth are hidden, high ones
+        // (e.g. satellites) only if they are behind the globe.
+        globeHidesPoints[i] = z < 0 && ( pointAltitude < 10000
+                                         || earthCenteredX * earthCenteredX
+                                            + earthCenteredY * earthCenteredY < radius * radius );
+        points[i] = QPointF( width / 2 + earthCenteredX, height / 2 - earthCenteredY );
+    }
+}
+
 bool SphericalProjection::screenCoordinates( const GeoDataCoordinates &coordinates,
                                              const ViewportParams *viewport,
                                              qreal *x, qreal &y,
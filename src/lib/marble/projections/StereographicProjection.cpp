@@ -35,6 +35,11 @@ class StereographicProjectionPrivate : public AzimuthalProjectionPrivate
   public:
     explicit StereographicProjectionPrivate( StereographicProjection * parent );
 
+    void screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                            int count,
+                            const ViewportParams *viewport,
+                            QPointF *points, bool *globeHidesPoints ) const;
+
     Q_DECLARE_PUBLIC( StereographicProjection )
 };
 
@@ -62,6 +67,15 @@ StereographicProjectionPrivate::StereographicProjectionPrivate( StereographicPro
 {
 }
 
+void StereographicProjectionPrivate::screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                                                        int count,
+                                                        const ViewportParams *viewport,
+                                                        QPointF *points, bool *globeHidesPoints ) const
+{
+    Q_Q( const StereographicProjection );
+    q->screenCoordinates( lon, lat, altitude, count, viewport, points, globeHidesPoints );
+}
+
 QString StereographicProjection::name() const
 {
     return QObject::tr( "Stereographic" );
@@ -127,6 +141,42 @@ bool StereographicProjection::screenCoordinates( const GeoDataCoordinates &coord
     return true;
 }
 
+void StereographicProjection::screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                                                 int count,
+                                                 const ViewportParams *viewport,
+                                                 QPointF *points, bool *globeHidesPoints ) const
+{
+    Q_UNUSED( altitude );
+
+    const qreal lambdaPrime = viewport->centerLongitude();
+    const qreal phi1 = viewport->centerLatitude();
+    const qreal sinPhi1 = qSin( phi1 );
+    const qreal cosPhi1 = qCos( phi1 );
+
+    const int scale = viewport->radius();
+    const qint64  radius  = clippingRadius() * viewport->radius();
+    const int halfWidth = viewport->width() / 2;
+    const int halfHeight = viewport->height() / 2;
+
+    for ( int i = 0; i < count; ++i ) {
+        const qreal phi = lat[i];
+        const qreal deltaLambda = lon[i] - lambdaPrime;
+        const qreal sinPhi = qSin( phi );
+        const qreal cosPhi = qCos( phi );
+        const qreal cosDeltaLambda = qCos( deltaLambda );
+
+        const qreal cosC = sinPhi1 * sinPhi + cosPhi1 * cosPhi * cosDeltaLambda;
+        const qreal k = 1 / (1 + cosC);
+
+        const qreal x = ( cosPhi * qSin( deltaLambda ) ) * k * scale;
+        const qreal y = ( cosPhi1 * sinPhi - sinPhi1 * cosPhi * cosDeltaLambda ) * k * scale;
+
+        // points behind the globe and outside of the clipping radius are hidden
+        globeHidesPoints[i] = cosC <= 0 || x * x + y * y > radius * radius;
+        points[i] = QPointF( x + halfWidth, halfHeight - y );
+    }
+}
+
 bool StereographicProjection::screenCoordinates( const GeoDataCoordinates &coordinates,
                                              const ViewportParams *viewport,
                                              qreal *x, qreal &y,
@@ -35,6 +35,11 @@ class VerticalPerspectiveProjectionPrivate : public AzimuthalProjectionPrivate
   public:
     explicit VerticalPerspectiveProjectionPrivate( VerticalPerspectiveProjection * parent );
 
+    void screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                            int count,
+                            const ViewportParams *viewport,
+                            QPointF *points, bool *globeHidesPoints ) const;
+
     void calculateConstants(qreal radius) const;
 
     mutable qreal m_P; ///< Distance of the point of perspective in earth diameters
@@ -75,6 +80,15 @@ VerticalPerspectiveProjectionPrivate::VerticalPerspectiveProjectionPrivate( Vert
 {
 }
 
+void VerticalPerspectiveProjectionPrivate::screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                                                              int count,
+                                                              const ViewportParams *viewport,
+                                                              QPointF *points, bool *globeHidesPoints ) const
+{
+    Q_Q( const VerticalPerspectiveProjection );
+    q->screenCoordinates( lon, lat, altitude, count, viewport, points, globeHidesPoints );
+}
+
 
 QString VerticalPerspectiveProjection::name() const
 {
@@ -157,6 +171,48 @@ bool VerticalPerspectiveProjection::screenCoordinates( const GeoDataCoordinates
     return true;
 }
 
+void VerticalPerspectiveProjection::screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                                                       int count,
+                                                       const ViewportParams *viewport,
+                                                       QPointF *points, bool *globeHidesPoints ) const
+{
+    Q_D(const VerticalPerspectiveProjection);
+    d->calculateConstants(viewport->radius());
+    const qreal P =  d->m_P;
+    const qreal altitudeToPixel = d->m_altitudeToPixel;
+
+    const qreal lambdaPrime = viewport->centerLongitude();
+    const qreal phi1 = viewport->centerLatitude();
+    const qreal sinPhi1 = qSin( phi1 );
+    const qreal cosPhi1 = qCos( phi1 );
+
+    const int radius = viewport->radius();
+    const int halfWidth = viewport->width() / 2;
+    const int halfHeight = viewport->height() / 2;
+
+    for ( int i = 0; i < count; ++i ) {
+        const qreal pointAltitude = altitude ? altitude[i] : 0.0;
+
+        const qreal phi = lat[i];
+        const qreal deltaLambda = lon[i] - lambdaPrime;
+        const qreal sinPhi = qSin( phi );
+        const qreal cosPhi = qCos( phi );
+        const qreal cosDeltaLambda = qCos( deltaLambda );
+
+        const qreal cosC = sinPhi1 * sinPhi + cosPhi1 * cosPhi * cosDeltaLambda;
+
+        const qreal k = (P - 1) / (P - cosC); // scale factor
+        const qreal pixelAltitude = (pointAltitude + EARTH_RADIUS) * altitudeToPixel;
+        const qreal x = ( cosPhi * qSin( deltaLambda ) ) * k * pixelAltitude;
+        const qreal y = ( cosPhi1 * sinPhi - sinPhi1 * cosPhi * cosDeltaLambda ) * k * pixelAltitude;
+
+        // Placemarks below 10km altitude on the Earth's backside (where cosC < 1/P)
+        // are hidden, satellites only if they are behind the Earth.
+        globeHidesPoints[i] = cosC < 1/P && ( pointAltitude < 10000 || x*x+y*y < radius * radius );
+        points[i] = QPointF( x + halfWidth, halfHeight - y );
+    }
+}
+
 bool VerticalPerspectiveProjection::screenCoordinates( const GeoDataCoordinates &coordinates,
                                              const ViewportParams *viewport,
                                              qreal *x, qreal &y,
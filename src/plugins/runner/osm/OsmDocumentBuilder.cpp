@@ -0,0 +1,170 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include "OsmDocumentBuilder.h"
+
+#include "OsmRunner.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataPolyStyle.h"
+#include "GeoDataStyle.h"
+#include "StyleBuilder.h"
+
+namespace Marble {
+
+namespace {
+
+// placemarks per part handed to the runner
+const int PartSize = 5000;
+
+}
+
+OsmDocumentBuilder::OsmDocumentBuilder(DocumentRole role, OsmRunner *runner) :
+    m_role(role),
+    m_runner(runner),
+    m_sorted(false),
+    m_streaming(false),
+    m_stage(NodeStage),
+    m_document(createDocument(role))
+{
+    // nothing to do
+}
+
+OsmDocumentBuilder::~OsmDocumentBuilder()
+{
+    delete m_document;
+}
+
+void OsmDocumentBuilder::setSortedByType(bool sorted)
+{
+    m_sorted = sorted && m_runner != nullptr;
+    m_streaming = m_sorted;
+}
+
+bool OsmDocumentBuilder::isCanceled() const
+{
+    return m_runner && m_runner->isCanceled();
+}
+
+void OsmDocumentBuilder::addNode(const OsmNode &node)
+{
+    enterStage(NodeStage);
+    m_nodes.insert(node);
+
+    // nodes do not depend on other elements, so they are created right away
+    // even if the input turned out not to be sorted
+    if (m_sorted && node.osmData().tagsBegin() != node.osmData().tagsEnd()) {
+        node.create(m_document);
+        deliverPart();
+    }
+}
+
+void OsmDocumentBuilder::addWay(const OsmWay &way)
+{
+    enterStage(WayStage);
+    OsmWay &storedWay = m_ways[way.osmData().id()];
+    storedWay = way;
+
+    if (m_streaming && storedWay.resolveNodes(m_nodes) && isCreatedWhenAdded(storedWay)) {
+        storedWay.create(m_document, m_role, m_nodes);
+        deliverPart();
+    }
+}
+
+void OsmDocumentBuilder::addRelation(const OsmRelation &relation)
+{
+    enterStage(RelationStage);
+
+    if (m_streaming) {
+        relation.create(m_document, m_ways, m_nodes, m_usedWays);
+        deliverPart();
+    } else {
+        m_relations.insert(relation.osmData().id(), relation);
+    }
+}
+
+GeoDataDocument *OsmDocumentBuilder::finish()
+{
+    m_nodes.squeeze();
+
+    foreach(OsmRelation const &relation, m_relations) {
+        relation.create(m_document, m_ways, m_nodes, m_usedWays);
+    }
+    foreach(qint64 id, m_usedWays) {
+        m_ways.remove(id);
+    }
+
+    foreach(OsmWay const &way, m_ways) {
+        // only ways added while streaming got their nodes resolved
+        if (!way.isResolved() || !isCreatedWhenAdded(way)) {
+            way.create(m_document, m_role, m_nodes);
+        }
+    }
+
+    if (!m_sorted) {
+        foreach(OsmNode const &node, m_nodes.dataNodes()) {
+            node.create(m_document);
+        }
+    }
+
+    GeoDataDocument *const document = m_document;
+    m_document = nullptr;
+    return document;
+}
+
+GeoDataDocument *OsmDocumentBuilder::createDocument(DocumentRole role)
+{
+    GeoDataDocument* document = new GeoDataDocument;
+    document->setDocumentRole(role);
+    GeoDataPolyStyle backgroundPolyStyle;
+    backgroundPolyStyle.setFill( true );
+    backgroundPolyStyle.setOutline( false );
+    backgroundPolyStyle.setColor(QStringLiteral("#f1eee8"));
+    GeoDataStyle::Ptr backgroundStyle(new GeoDataStyle);
+    backgroundStyle->setPolyStyle( backgroundPolyStyle );
+    backgroundStyle->setId(QStringLiteral("background"));
+    document->addStyle( backgroundStyle );
+    return document;
+}
+
+bool OsmDocumentBuilder::isCreatedWhenAdded(const OsmWay &way)
+{
+    // a multipolygon replaces the areas that form its boundary if they share
+    // its category, which is only known once the relations are read
+    return !way.isArea() && StyleBuilder::determineVisualCategory(way.osmData()) != GeoDataPlacemark::None;
+}
+
+void OsmDocumentBuilder::enterStage(Stage stage)
+{
+    if (stage < m_stage) {
+        // not sorted after all, the lookups of streaming would miss elements
+        m_streaming = false;
+        return;
+    }
+
+    if (m_streaming && m_stage == NodeStage && stage != NodeStage) {
+        // all nodes are known, ways and relations may look them up now
+        m_nodes.squeeze();
+    }
+    if (m_streaming && m_stage != RelationStage && stage == RelationStage) {
+        // the ways copied their nodes, the nodes with tags are placemarks already
+        m_nodes = OsmNodes();
+    }
+    m_stage = stage;
+}
+
+void OsmDocumentBuilder::deliverPart()
+{
+    if (m_document->size() >= PartSize) {
+        m_runner->addPartialDocument(m_document);
+        m_document = createDocument(m_role);
+    }
+}
+
+}
@@ -0,0 +1,108 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#ifndef MARBLE_OSMDOCUMENTBUILDER_H
+#define MARBLE_OSMDOCUMENTBUILDER_H
+
+#include "OsmNode.h"
+#include "OsmWay.h"
+#include "OsmRelation.h"
+
+#include <GeoDataDocument.h>
+
+#include <QSet>
+
+namespace Marble {
+
+class OsmRunner;
+
+/**
+ * Creates the placemarks of the elements of an OSM file.
+ *
+ * Usually all elements are collected and turned into placemarks by finish().
+ * If the elements arrive sorted by type, which o5m and most PBF files
+ * guarantee, and a runner is given, placemarks are created as soon as the
+ * elements they need are known. They are handed to the runner in parts of
+ * a few thousand placemarks while the file is still being read:
+ *
+ * - nodes with tags right away
+ * - ways with a visual category that are drawn as lines once all nodes
+ *   were read
+ * - multipolygon relations once all ways were read
+ *
+ * Areas and ways without a visual category are held back until finish(), as
+ * they are dropped if they only serve as the boundary of a multipolygon.
+ *
+ * While streaming, each way copies its nodes when it is added, and the nodes
+ * are released once the relations start, so that they do not stay in memory
+ * along with the ways until the end of the file.
+ */
+class OsmDocumentBuilder
+{
+public:
+    explicit OsmDocumentBuilder(DocumentRole role, OsmRunner *runner = nullptr);
+    ~OsmDocumentBuilder();
+
+    /**
+     * Promises that nodes, ways and relations are added in this order, which
+     * allows creating placemarks early. Elements out of this order end
+     * streaming, all further placemarks except those of nodes are then
+     * created by finish(). Ways after the relations miss the nodes released
+     * before.
+     */
+    void setSortedByType(bool sorted);
+
+    /**
+     * Returns true if the runner was asked to stop, readers then stop adding
+     * elements.
+     */
+    bool isCanceled() const;
+
+    void addNode(const OsmNode &node);
+    void addWay(const OsmWay &way);
+    void addRelation(const OsmRelation &relation);
+
+    /**
+     * Creates the remaining placemarks and returns the document holding them.
+     * The caller takes ownership.
+     */
+    GeoDataDocument *finish();
+
+private:
+    Q_DISABLE_COPY(OsmDocumentBuilder)
+
+    enum Stage {
+        NodeStage,
+        WayStage,
+        RelationStage
+    };
+
+    static GeoDataDocument *createDocument(DocumentRole role);
+    static bool isCreatedWhenAdded(const OsmWay &way);
+    void enterStage(Stage stage);
+    void deliverPart();
+
+    const DocumentRole m_role;
+    OsmRunner *const m_runner;
+    bool m_sorted;
+    bool m_streaming;
+    Stage m_stage;
+
+    OsmNodes m_nodes;
+    OsmWays m_ways;
+    OsmRelations m_relations;
+    QSet<qint64> m_usedWays;
+
+    GeoDataDocument *m_document;
+};
+
+}
+
+#endif
@@ -20,6 +20,8 @@
 
 #include <QXmlStreamAttributes>
 
+#include <algorithm>
+
 namespace Marble {
 
 void OsmNode::parseCoordinates(const QXmlStreamAttributes &attributes)
@@ -129,4 +131,153 @@ const OsmPlacemarkData &OsmNode::osmData() const
     return m_osmData;
 }
 
+OsmNodes::OsmNodes() :
+    m_sorted(true)
+{
+    // the compact nodes without any attributes refer to the first entry
+    m_metas.append(Meta());
+    m_metaIndices.insert(Meta(), 0);
+}
+
+void OsmNodes::insert(const OsmNode &node)
+{
+    const qint64 id = node.osmData().id();
+    if (node.osmData().tagsBegin() != node.osmData().tagsEnd()) {
+        m_dataNodes.insert(id, node);
+        return;
+    }
+
+    CompactNode compactNode;
+    compactNode.id = id;
+    compactNode.lat = qRound(node.coordinates().latitude(GeoDataCoordinates::Degree) * 1.0e7);
+    compactNode.lon = qRound(node.coordinates().longitude(GeoDataCoordinates::Degree) * 1.0e7);
+    compactNode.meta = metaIndex(node.osmData());
+    if (!m_compactNodes.isEmpty() && id <= m_compactNodes.last().id) {
+        m_sorted = false;
+    }
+    m_compactNodes.append(compactNode);
+}
+
+void OsmNodes::squeeze()
+{
+    if (!m_sorted) {
+        std::stable_sort(m_compactNodes.begin(), m_compactNodes.end(),
+                         [] (const CompactNode &a, const CompactNode &b) { return a.id < b.id; });
+        m_sorted = true;
+    }
+
+    // keep the last of several nodes with the same id, and none which has
+    // a data node
+    int count = 0;
+    for (int i = 0; i < m_compactNodes.size(); ++i) {
+        const CompactNode &node = m_compactNodes.at(i);
+        if (m_dataNodes.contains(node.id)) {
+            continue;
+        }
+        if (count > 0 && m_compactNodes.at(count - 1).id == node.id) {
+            --count;
+        }
+        m_compactNodes[count] = node;
+        ++count;
+    }
+    m_compactNodes.resize(count);
+    m_compactNodes.squeeze();
+
+    // only needed to share the attributes of nodes still to be inserted
+    m_metaIndices.clear();
+    m_metaIndices.insert(Meta(), 0);
+    m_metas.squeeze();
+}
+
+bool OsmNodes::find(qint64 id, GeoDataCoordinates &coordinates, OsmPlacemarkData *osmData) const
+{
+    const CompactNode *compactNode = findCompact(id);
+    if (compactNode) {
+        coordinates = GeoDataCoordinates(compactNode->lon * 1.0e-7, compactNode->lat * 1.0e-7,
+                                         0.0, GeoDataCoordinates::Degree);
+        if (osmData) {
+            *osmData = OsmPlacemarkData();
+            osmData->setId(id);
+            m_metas.at(compactNode->meta).apply(*osmData);
+        }
+        return true;
+    }
+
+    auto const iter = m_dataNodes.constFind(id);
+    if (iter == m_dataNodes.constEnd()) {
+        return false;
+    }
+    coordinates = iter.value().coordinates();
+    if (osmData) {
+        *osmData = iter.value().osmData();
+    }
+    return true;
+}
+
+const QHash<qint64, OsmNode> &OsmNodes::dataNodes() const
+{
+    return m_dataNodes;
+}
+
+const OsmNodes::CompactNode *OsmNodes::findCompact(qint64 id) const
+{
+    Q_ASSERT(m_sorted);
+    auto const iter = std::lower_bound(m_compactNodes.constBegin(), m_compactNodes.constEnd(), id,
+                                       [] (const CompactNode &node, qint64 id) { return node.id < id; });
+    if (iter == m_compactNodes.constEnd() || iter->id != id) {
+        return nullptr;
+    }
+    return iter;
+}
+
+quint32 OsmNodes::metaIndex(const OsmPlacemarkData &osmData)
+{
+    const Meta meta(osmData);
+    auto const iter = m_metaIndices.constFind(meta);
+    if (iter != m_metaIndices.constEnd()) {
+        return iter.value();
+    }
+
+    const quint32 index = m_metas.size();
+    m_metas.append(meta);
+    m_metaIndices.insert(meta, index);
+    return index;
+}
+
+OsmNodes::Meta::Meta(const OsmPlacemarkData &osmData) :
+    version(osmData.version()),
+    changeset(osmData.changeset()),
+    uid(osmData.uid()),
+    visible(osmData.isVisible()),
+    user(osmData.user()),
+    timestamp(osmData.timestamp()),
+    action(osmData.action())
+{
+    // nothing to do
+}
+
+void OsmNodes::Meta::apply(OsmPlacemarkData &osmData) const
+{
+    osmData.setVersion(version);
+    osmData.setChangeset(changeset);
+    osmData.setUid(uid);
+    osmData.setVisible(visible);
+    osmData.setUser(user);
+    osmData.setTimestamp(timestamp);
+    osmData.setAction(action);
+}
+
+bool OsmNodes::Meta::operator==(const Meta &other) const
+{
+    return version == other.version && changeset == other.changeset && uid == other.uid
+            && visible == other.visible && user == other.user && timestamp == other.timestamp
+            && action == other.action;
+}
+
+uint qHash(const OsmNodes::Meta &meta, uint seed)
+{
+    // nodes of the same changeset mostly differ in their version only
+    return qHash(meta.changeset, seed) ^ qHash(meta.timestamp, seed) ^ qHash(meta.version, seed);
+}
+
 }
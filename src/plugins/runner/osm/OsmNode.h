@@ -13,7 +13,9 @@
 
 #include <osm/OsmPlacemarkData.h>
 
+#include <QHash>
 #include <QString>
+#include <QVector>
 
 class QXmlStreamAttributes;
 
@@ -39,7 +41,77 @@ private:
     GeoDataCoordinates m_coordinates;
 };
 
-typedef QHash<qint64,OsmNode> OsmNodes;
+/**
+ * The nodes of an OSM file, kept in two tiers. Most nodes only serve as
+ * vertices of ways and carry no tags. They are stored in a compact array
+ * sorted by id, with the coordinates in the 1e-7 degree resolution of OSM.
+ * Their attributes (version, changeset, user, timestamp, ...) are kept in a
+ * table of distinct attribute sets the compact nodes refer to, as the nodes
+ * of a changeset share them. Only nodes with tags get a full OsmNode.
+ *
+ * Call squeeze() after all nodes were inserted and before looking any up.
+ */
+class OsmNodes
+{
+public:
+    OsmNodes();
+
+    /**
+     * Adds @p node. A later node replaces an earlier one with the same id,
+     * but a node with tags always wins over one without.
+     */
+    void insert(const OsmNode &node);
+
+    /**
+     * Sorts the compact nodes by id and releases unused memory.
+     */
+    void squeeze();
+
+    /**
+     * Looks up the node @p id. Returns false if there is no such node,
+     * otherwise sets @p coordinates and, if given, @p osmData.
+     */
+    bool find(qint64 id, GeoDataCoordinates &coordinates, OsmPlacemarkData *osmData = 0) const;
+
+    /**
+     * The nodes with tags, which may become placemarks.
+     */
+    const QHash<qint64, OsmNode> &dataNodes() const;
+
+private:
+    struct CompactNode
+    {
+        qint64 id;
+        qint32 lat;
+        qint32 lon;
+        quint32 meta;
+    };
+
+    struct Meta
+    {
+        explicit Meta(const OsmPlacemarkData &osmData = OsmPlacemarkData());
+        void apply(OsmPlacemarkData &osmData) const;
+        bool operator==(const Meta &other) const;
+
+        QString version;
+        QString changeset;
+        QString uid;
+        QString visible;
+        QString user;
+        QString timestamp;
+        QString action;
+    };
+    friend uint qHash(const Meta &meta, uint seed);
+
+    const CompactNode *findCompact(qint64 id) const;
+    quint32 metaIndex(const OsmPlacemarkData &osmData);
+
+    QVector<CompactNode> m_compactNodes;
+    QVector<Meta> m_metas;
+    QHash<Meta, quint32> m_metaIndices;
+    QHash<qint64, OsmNode> m_dataNodes;
+    bool m_sorted;
+};
 
 }
 
@@ -13,13 +13,13 @@
 
 #include "OsmParser.h"
 #include "OsmElementDictionary.h"
+#include "OsmDocumentBuilder.h"
+#include "OsmPbfParser.h"
 #include "osm/OsmObjectManager.h"
 #include "GeoDataDocument.h"
 #include "GeoDataPlacemark.h"
 #include "GeoDataPoint.h"
 #include "GeoDataTypes.h"
-#include "GeoDataStyle.h"
-#include "GeoDataPolyStyle.h"
 #include <MarbleZipReader.h>
 #include "o5mreader.h"
 
@@ -30,7 +30,7 @@
 
 namespace Marble {
 
-GeoDataDocument *OsmParser::parse(const QString &filename, DocumentRole role, QString &error)
+GeoDataDocument *OsmParser::parse(const QString &filename, DocumentRole role, QString &error, OsmRunner *runner)
 {
     QFileInfo const fileInfo(filename);
     if (!fileInfo.exists() || !fileInfo.isReadable()) {
@@ -38,14 +38,20 @@ GeoDataDocument *OsmParser::parse(const QString &filename, DocumentRole role, QS
         return 0;
     }
 
+    OsmDocumentBuilder builder(role, runner);
+    bool ok;
     if (fileInfo.completeSuffix() == QLatin1String("o5m")) {
-        return parseO5m(filename, role, error);
+        ok = parseO5m(filename, builder, error);
+    } else if (fileInfo.completeSuffix() == QLatin1String("osm.pbf")) {
+        ok = OsmPbfParser::read(filename, builder, error);
     } else {
-        return parseXml(filename, role, error);
+        ok = parseXml(filename, builder, error);
     }
+
+    return ok && !builder.isCanceled() ? builder.finish() : nullptr;
 }
 
-GeoDataDocument* OsmParser::parseO5m(const QString &filename, DocumentRole role, QString &error)
+bool OsmParser::parseO5m(const QString &filename, OsmDocumentBuilder &builder, QString &error)
 {
     O5mreader* reader;
     O5mreaderDataset data;
@@ -54,22 +60,22 @@ GeoDataDocument* OsmParser::parseO5m(const QString &filename, DocumentRole role,
     // share string data on the heap at least for this file
     QSet<QString> stringPool;
 
-    OsmNodes nodes;
-    OsmWays ways;
-    OsmRelations relations;
     QHash<uint8_t, QString> relationTypes;
     relationTypes[O5MREADER_DS_NODE] = QStringLiteral("node");
     relationTypes[O5MREADER_DS_WAY] = QStringLiteral("way");
     relationTypes[O5MREADER_DS_REL] = QStringLiteral("relation");
 
+    // o5m files list all nodes, then all ways, then all relations
+    builder.setSortedByType(true);
+
     auto file = fopen(filename.toStdString().c_str(), "rb");
     o5mreader_open(&reader, file);
 
-    while( (outerState = o5mreader_iterateDataSet(reader, &data)) == O5MREADER_ITERATE_RET_NEXT) {
+    while (!builder.isCanceled() && (outerState = o5mreader_iterateDataSet(reader, &data)) == O5MREADER_ITERATE_RET_NEXT) {
         switch (data.type) {
         case O5MREADER_DS_NODE:
         {
-            OsmNode& node = nodes[data.id];
+            OsmNode node;
             node.osmData().setId(data.id);
             node.setCoordinates(GeoDataCoordinates(data.lon*1.0e-7, data.lat*1.0e-7,
                                                    0.0, GeoDataCoordinates::Degree));
@@ -78,11 +84,12 @@ GeoDataDocument* OsmParser::parseO5m(const QString &filename, DocumentRole role,
                 const QString valueString = *stringPool.insert(QString::fromUtf8(value));
                 node.osmData().addTag(keyString, valueString);
             }
+            builder.addNode(node);
         }
             break;
         case O5MREADER_DS_WAY:
         {
-            OsmWay &way = ways[data.id];
+            OsmWay way;
             way.osmData().setId(data.id);
             uint64_t nodeId;
             while ((innerState = o5mreader_iterateNds(reader, &nodeId)) == O5MREADER_ITERATE_RET_NEXT) {
@@ -93,11 +100,12 @@ GeoDataDocument* OsmParser::parseO5m(const QString &filename, DocumentRole role,
                 const QString valueString = *stringPool.insert(QString::fromUtf8(value));
                 way.osmData().addTag(keyString, valueString);
             }
+            builder.addWay(way);
         }
             break;
         case O5MREADER_DS_REL:
         {
-            OsmRelation &relation = relations[data.id];
+            OsmRelation relation;
             relation.osmData().setId(data.id);
             char *role;
             uint8_t type;
@@ -111,6 +119,7 @@ GeoDataDocument* OsmParser::parseO5m(const QString &filename, DocumentRole role,
                 const QString valueString = *stringPool.insert(QString::fromUtf8(value));
                 relation.osmData().addTag(keyString, valueString);
             }
+            builder.addRelation(relation);
         }
             break;
         }
@@ -119,10 +128,10 @@ GeoDataDocument* OsmParser::parseO5m(const QString &filename, DocumentRole role,
     fclose(file);
     error = reader->errMsg;
     o5mreader_close(reader);
-    return createDocument(role, nodes, ways, relations);
+    return true;
 }
 
-GeoDataDocument* OsmParser::parseXml(const QString &filename, DocumentRole role, QString &error)
+bool OsmParser::parseXml(const QString &filename, OsmDocumentBuilder &builder, QString &error)
 {
     QXmlStreamReader parser;
     QFile file;
@@ -133,7 +142,7 @@ GeoDataDocument* OsmParser::parseXml(const QString &filename, DocumentRole role,
         if (zipReader.fileInfoList().size() != 1) {
             int const fileNumber = zipReader.fileInfoList().size();
             error = QStringLiteral("Unexpected number of files (%1) in %2").arg(fileNumber).arg(filename);
-            return nullptr;
+            return false;
         }
         QByteArray const data = zipReader.fileData(zipReader.fileInfoList().first().filePath);
         buffer.setData(data);
@@ -143,43 +152,53 @@ GeoDataDocument* OsmParser::parseXml(const QString &filename, DocumentRole role,
         file.setFileName(filename);
         if (!file.open(QFile::ReadOnly)) {
             error = QStringLiteral("Cannot open file %1").arg(filename);
-            return nullptr;
+            return false;
         }
         parser.setDevice(&file);
     }
 
     OsmPlacemarkData* osmData(0);
+    OsmNode node;
+    OsmWay way;
+    OsmRelation relation;
     QString parentTag;
-    qint64 parentId(0);
     // share string data on the heap at least for this file
     QSet<QString> stringPool;
 
-    OsmNodes m_nodes;
-    OsmWays m_ways;
-    OsmRelations m_relations;
-
-    while (!parser.atEnd()) {
+    while (!parser.atEnd() && !builder.isCanceled()) {
         parser.readNext();
-        if (!parser.isStartElement()) {
+        if (parser.isEndElement()) {
+            QStringRef const tagName = parser.name();
+            if (tagName == osm::osmTag_node) {
+                builder.addNode(node);
+            } else if (tagName == osm::osmTag_way) {
+                builder.addWay(way);
+            } else if (tagName == osm::osmTag_relation) {
+                builder.addRelation(relation);
+            }
+            continue;
+        } else if (!parser.isStartElement()) {
             continue;
         }
 
         QStringRef const tagName = parser.name();
         if (tagName == osm::osmTag_node || tagName == osm::osmTag_way || tagName == osm::osmTag_relation) {
             parentTag = parser.name().toString();
-            parentId = parser.attributes().value(QLatin1String("id")).toLongLong();
 
             if (tagName == osm::osmTag_node) {
-                m_nodes[parentId].osmData() = OsmPlacemarkData::fromParserAttributes(parser.attributes());
-                m_nodes[parentId].parseCoordinates(parser.attributes());
-                osmData = &m_nodes[parentId].osmData();
+                node = OsmNode();
+                node.osmData() = OsmPlacemarkData::fromParserAttributes(parser.attributes());
+                node.parseCoordinates(parser.attributes());
+                osmData = &node.osmData();
             } else if (tagName == osm::osmTag_way) {
-                m_ways[parentId].osmData() = OsmPlacemarkData::fromParserAttributes(parser.attributes());
-                osmData = &m_ways[parentId].osmData();
+                way = OsmWay();
+                way.osmData() = OsmPlacemarkData::fromParserAttributes(parser.attributes());
+                osmData = &way.osmData();
             } else {
                 Q_ASSERT(tagName == osm::osmTag_relation);
-                m_relations[parentId].osmData() = OsmPlacemarkData::fromParserAttributes(parser.attributes());
-                osmData = &m_relations[parentId].osmData();
+                relation = OsmRelation();
+                relation.osmData() = OsmPlacemarkData::fromParserAttributes(parser.attributes());
+                osmData = &relation.osmData();
             }
         } else if (tagName == osm::osmTag_tag) {
             const QXmlStreamAttributes &attributes = parser.attributes();
@@ -187,55 +206,18 @@ GeoDataDocument* OsmParser::parseXml(const QString &filename, DocumentRole role,
             const QString valueString = *stringPool.insert(attributes.value(QLatin1String("v")).toString());
             osmData->addTag(keyString, valueString);
         } else if (tagName == osm::osmTag_nd && parentTag == osm::osmTag_way) {
-            m_ways[parentId].addReference(parser.attributes().value(QLatin1String("ref")).toLongLong());
+            way.addReference(parser.attributes().value(QLatin1String("ref")).toLongLong());
         } else if (tagName == osm::osmTag_member && parentTag == osm::osmTag_relation) {
-            m_relations[parentId].parseMember(parser.attributes());
+            relation.parseMember(parser.attributes());
         } // other tags like osm, bounds ignored
     }
 
     if (parser.hasError()) {
         error = parser.errorString();
-        return nullptr;
-    }
-
-    return createDocument(role, m_nodes, m_ways, m_relations);
-}
-
-GeoDataDocument *OsmParser::createDocument(DocumentRole role, OsmNodes &nodes, OsmWays &ways, OsmRelations &relations)
-{
-    GeoDataDocument* document = new GeoDataDocument;
-    GeoDataPolyStyle backgroundPolyStyle;
-    backgroundPolyStyle.setFill( true );
-    backgroundPolyStyle.setOutline( false );
-    backgroundPolyStyle.setColor(QStringLiteral("#f1eee8"));
-    GeoDataStyle::Ptr backgroundStyle(new GeoDataStyle);
-    backgroundStyle->setPolyStyle( backgroundPolyStyle );
-    backgroundStyle->setId(QStringLiteral("background"));
-    document->addStyle( backgroundStyle );
-
-    QSet<qint64> usedNodes, usedWays;
-    foreach(OsmRelation const &relation, relations) {
-        relation.create(document, ways, nodes, usedNodes, usedWays);
-    }
-    foreach(qint64 id, usedWays) {
-        ways.remove(id);
-    }
-
-    foreach(OsmWay const &way, ways) {
-        way.create(document, role, nodes, usedNodes);
-    }
-
-    foreach(qint64 id, usedNodes) {
-        if (nodes[id].osmData().isEmpty()) {
-            nodes.remove(id);
-        }
-    }
-
-    foreach(OsmNode const &node, nodes) {
-        node.create(document);
+        return false;
     }
 
-    return document;
+    return true;
 }
 
 }
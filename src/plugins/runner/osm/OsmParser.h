@@ -24,16 +24,21 @@
 namespace Marble {
 
 class GeoDataDocument;
+class OsmDocumentBuilder;
+class OsmRunner;
 
 class OsmParser
 {
 public:
-    static GeoDataDocument* parse(const QString &filename, DocumentRole role, QString &error);
+    /**
+     * Parses the OSM file @p filename. If @p runner is given, parts of sorted
+     * files are handed to it while parsing, see OsmDocumentBuilder.
+     */
+    static GeoDataDocument* parse(const QString &filename, DocumentRole role, QString &error, OsmRunner *runner = nullptr);
 
 private:
-    static GeoDataDocument* parseXml(const QString &filename, DocumentRole role, QString &error);
-    static GeoDataDocument* parseO5m(const QString &filename, DocumentRole role, QString &error);
-    static GeoDataDocument *createDocument(DocumentRole role, OsmNodes &nodes, OsmWays &way, OsmRelations &relations);
+    static bool parseXml(const QString &filename, OsmDocumentBuilder &builder, QString &error);
+    static bool parseO5m(const QString &filename, OsmDocumentBuilder &builder, QString &error);
 };
 
 }
@@ -0,0 +1,666 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include "OsmPbfParser.h"
+
+#include "OsmDocumentBuilder.h"
+
+#include <QFile>
+#include <QFuture>
+#include <QList>
+#include <QThread>
+#include <QVector>
+#include <QtConcurrentMap>
+#include <QtEndian>
+
+#include <zlib.h>
+
+namespace Marble {
+
+namespace {
+
+// limits of the format specification
+const quint32 MaxBlobHeaderSize = 64 * 1024;
+const qint64 MaxBlobSize = 32 * 1024 * 1024;
+
+/**
+ * A minimal reader of the protocol buffer wire format. It iterates over the
+ * fields of a single message and does not copy any data, nested messages are
+ * read by separate readers on the same memory.
+ */
+class PbfReader
+{
+public:
+    explicit PbfReader(const char *data = 0, int size = 0) :
+        m_data(reinterpret_cast<const uchar*>(data)),
+        m_end(m_data + size),
+        m_field(0),
+        m_wireType(0),
+        m_error(false)
+    {
+    }
+
+    bool next()
+    {
+        if (atEnd()) {
+            return false;
+        }
+        const quint64 key = varint();
+        m_field = int(key >> 3);
+        m_wireType = int(key & 0x7);
+        return !m_error;
+    }
+
+    int field() const { return m_field; }
+    bool atEnd() const { return m_error || m_data >= m_end; }
+    bool hasError() const { return m_error; }
+
+    quint64 varint()
+    {
+        quint64 result = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (m_data >= m_end) {
+                break;
+            }
+            const uchar byte = *m_data++;
+            result |= quint64(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return result;
+            }
+        }
+        m_error = true;
+        return 0;
+    }
+
+    qint64 svarint()
+    {
+        const quint64 value = varint();
+        return qint64(value >> 1) ^ -qint64(value & 1);
+    }
+
+    bool bytes(const char *&data, int &size)
+    {
+        if (m_wireType != 2) {
+            m_error = true;
+            return false;
+        }
+        const quint64 length = varint();
+        if (m_error || length > quint64(m_end - m_data)) {
+            m_error = true;
+            return false;
+        }
+        data = reinterpret_cast<const char*>(m_data);
+        size = int(length);
+        m_data += length;
+        return true;
+    }
+
+    PbfReader message()
+    {
+        const char *data = 0;
+        int size = 0;
+        bytes(data, size);
+        return PbfReader(data, size);
+    }
+
+    /**
+     * Appends the values of a repeated integer field, packed or not.
+     */
+    void varints(QVector<qint64> &values, bool zigzag)
+    {
+        if (m_wireType == 2) {
+            PbfReader packed = message();
+            while (!packed.atEnd()) {
+                values.append(zigzag ? packed.svarint() : qint64(packed.varint()));
+            }
+            m_error = m_error || packed.hasError();
+        } else {
+            values.append(zigzag ? svarint() : qint64(varint()));
+        }
+    }
+
+    void skip()
+    {
+        switch (m_wireType) {
+        case 0:
+            varint();
+            break;
+        case 1:
+            advance(8);
+            break;
+        case 2: {
+            const quint64 length = varint();
+            advance(length);
+            break;
+        }
+        case 5:
+            advance(4);
+            break;
+        default:
+            m_error = true;
+        }
+    }
+
+private:
+    void advance(quint64 length)
+    {
+        if (length > quint64(m_end - m_data)) {
+            m_error = true;
+        } else {
+            m_data += length;
+        }
+    }
+
+    const uchar *m_data;
+    const uchar *m_end;
+    int m_field;
+    int m_wireType;
+    bool m_error;
+};
+
+/**
+ * The elements of one data block. Blocks are decoded concurrently and
+ * handed to the document builder afterwards, in file order.
+ */
+struct PbfBlock
+{
+    QVector<OsmNode> nodes;
+    QVector<OsmWay> ways;
+    QVector<OsmRelation> relations;
+    QString error;
+};
+
+class PrimitiveBlockDecoder
+{
+public:
+    explicit PrimitiveBlockDecoder(PbfBlock &block) :
+        m_block(block),
+        m_granularity(100),
+        m_latOffset(0),
+        m_lonOffset(0)
+    {
+        m_memberTypes[0] = QStringLiteral("node");
+        m_memberTypes[1] = QStringLiteral("way");
+        m_memberTypes[2] = QStringLiteral("relation");
+    }
+
+    bool decode(const QByteArray &data)
+    {
+        // the groups precede the granularity and the offsets in the block
+        QVector<PbfReader> groups;
+        PbfReader reader(data.constData(), data.size());
+        while (reader.next()) {
+            switch (reader.field()) {
+            case 1:
+                decodeStringTable(reader.message());
+                break;
+            case 2:
+                groups.append(reader.message());
+                break;
+            case 17:
+                m_granularity = qint64(reader.varint());
+                break;
+            case 19:
+                m_latOffset = qint64(reader.varint());
+                break;
+            case 20:
+                m_lonOffset = qint64(reader.varint());
+                break;
+            default:
+                reader.skip();
+            }
+        }
+
+        bool ok = !reader.hasError();
+        foreach (PbfReader group, groups) {
+            while (ok && group.next()) {
+                switch (group.field()) {
+                case 1:
+                    ok = decodeNode(group.message());
+                    break;
+                case 2:
+                    ok = decodeDenseNodes(group.message());
+                    break;
+                case 3:
+                    ok = decodeWay(group.message());
+                    break;
+                case 4:
+                    ok = decodeRelation(group.message());
+                    break;
+                default:
+                    group.skip();
+                }
+            }
+            ok = ok && !group.hasError();
+        }
+
+        if (!ok) {
+            m_block.error = QStringLiteral("Corrupt data block");
+        }
+        return ok;
+    }
+
+private:
+    void decodeStringTable(PbfReader reader)
+    {
+        while (reader.next()) {
+            const char *data = 0;
+            int size = 0;
+            if (reader.field() == 1 && reader.bytes(data, size)) {
+                m_strings.append(QString::fromUtf8(data, size));
+            } else {
+                reader.skip();
+            }
+        }
+    }
+
+    bool decodeNode(PbfReader reader)
+    {
+        m_keys.resize(0);
+        m_values.resize(0);
+        qint64 id = 0;
+        qint64 lat = 0;
+        qint64 lon = 0;
+        while (reader.next()) {
+            switch (reader.field()) {
+            case 1: id = reader.svarint(); break;
+            case 2: reader.varints(m_keys, false); break;
+            case 3: reader.varints(m_values, false); break;
+            case 8: lat = reader.svarint(); break;
+            case 9: lon = reader.svarint(); break;
+            default: reader.skip();
+            }
+        }
+
+        m_block.nodes.append(OsmNode());
+        OsmNode &node = m_block.nodes.last();
+        node.osmData().setId(id);
+        node.setCoordinates(coordinates(lon, lat));
+        addTags(node.osmData());
+        return !reader.hasError();
+    }
+
+    bool decodeDenseNodes(PbfReader reader)
+    {
+        m_ids.resize(0);
+        m_lats.resize(0);
+        m_lons.resize(0);
+        m_keys.resize(0);
+        while (reader.next()) {
+            switch (reader.field()) {
+            case 1: reader.varints(m_ids, true); break;
+            case 8: reader.varints(m_lats, true); break;
+            case 9: reader.varints(m_lons, true); break;
+            case 10: reader.varints(m_keys, false); break;
+            default: reader.skip();
+            }
+        }
+        if (reader.hasError() || m_lats.size() != m_ids.size() || m_lons.size() != m_ids.size()) {
+            return false;
+        }
+
+        // ids and coordinates are delta coded, the tags of all nodes are
+        // stored as key and value pairs, each node's terminated by a zero
+        m_block.nodes.reserve(m_block.nodes.size() + m_ids.size());
+        qint64 id = 0;
+        qint64 lat = 0;
+        qint64 lon = 0;
+        int tag = 0;
+        for (int i = 0; i < m_ids.size(); ++i) {
+            id += m_ids.at(i);
+            lat += m_lats.at(i);
+            lon += m_lons.at(i);
+
+            m_block.nodes.append(OsmNode());
+            OsmNode &node = m_block.nodes.last();
+            node.osmData().setId(id);
+            node.setCoordinates(coordinates(lon, lat));
+            for (; tag + 1 < m_keys.size() && m_keys.at(tag) != 0; tag += 2) {
+                node.osmData().addTag(string(m_keys.at(tag)), string(m_keys.at(tag + 1)));
+            }
+            ++tag;
+        }
+        return true;
+    }
+
+    bool decodeWay(PbfReader reader)
+    {
+        m_keys.resize(0);
+        m_values.resize(0);
+        m_ids.resize(0);
+        qint64 id = 0;
+        while (reader.next()) {
+            switch (reader.field()) {
+            case 1: id = qint64(reader.varint()); break;
+            case 2: reader.varints(m_keys, false); break;
+            case 3: reader.varints(m_values, false); break;
+            case 8: reader.varints(m_ids, true); break;
+            default: reader.skip();
+            }
+        }
+
+        m_block.ways.append(OsmWay());
+        OsmWay &way = m_block.ways.last();
+        way.osmData().setId(id);
+        qint64 reference = 0;
+        foreach (qint64 delta, m_ids) {
+            reference += delta;
+            way.addReference(reference);
+        }
+        addTags(way.osmData());
+        return !reader.hasError();
+    }
+
+    bool decodeRelation(PbfReader reader)
+    {
+        m_keys.resize(0);
+        m_values.resize(0);
+        m_roles.resize(0);
+        m_ids.resize(0);
+        m_types.resize(0);
+        qint64 id = 0;
+        while (reader.next()) {
+            switch (reader.field()) {
+            case 1: id = qint64(reader.varint()); break;
+            case 2: reader.varints(m_keys, false); break;
+            case 3: reader.varints(m_values, false); break;
+            case 8: reader.varints(m_roles, false); break;
+            case 9: reader.varints(m_ids, true); break;
+            case 10: reader.varints(m_types, false); break;
+            default: reader.skip();
+            }
+        }
+        if (reader.hasError() || m_roles.size() != m_ids.size() || m_types.size() != m_ids.size()) {
+            return false;
+        }
+
+        m_block.relations.append(OsmRelation());
+        OsmRelation &relation = m_block.relations.last();
+        relation.osmData().setId(id);
+        qint64 reference = 0;
+        for (int i = 0; i < m_ids.size(); ++i) {
+            reference += m_ids.at(i);
+            const qint64 type = m_types.at(i);
+            if (type >= 0 && type < 3) {
+                relation.addMember(reference, string(m_roles.at(i)), m_memberTypes[type]);
+            }
+        }
+        addTags(relation.osmData());
+        return true;
+    }
+
+    void addTags(OsmPlacemarkData &osmData) const
+    {
+        const int count = qMin(m_keys.size(), m_values.size());
+        for (int i = 0; i < count; ++i) {
+            osmData.addTag(string(m_keys.at(i)), string(m_values.at(i)));
+        }
+    }
+
+    QString string(qint64 index) const
+    {
+        return index >= 0 && index < m_strings.size() ? m_strings.at(int(index)) : QString();
+    }
+
+    GeoDataCoordinates coordinates(qint64 lon, qint64 lat) const
+    {
+        // nanodegrees
+        return GeoDataCoordinates((m_lonOffset + m_granularity * lon) * 1.0e-9,
+                                  (m_latOffset + m_granularity * lat) * 1.0e-9,
+                                  0.0, GeoDataCoordinates::Degree);
+    }
+
+    PbfBlock &m_block;
+    QVector<QString> m_strings;
+    qint64 m_granularity;
+    qint64 m_latOffset;
+    qint64 m_lonOffset;
+    QString m_memberTypes[3];
+
+    // reused for all elements of the block
+    QVector<qint64> m_ids;
+    QVector<qint64> m_lats;
+    QVector<qint64> m_lons;
+    QVector<qint64> m_keys;
+    QVector<qint64> m_values;
+    QVector<qint64> m_roles;
+    QVector<qint64> m_types;
+};
+
+bool inflateBlob(const QByteArray &blob, QByteArray &data, QString &error)
+{
+    const char *raw = 0;
+    int rawLength = 0;
+    const char *zlibData = 0;
+    int zlibLength = 0;
+    qint64 rawSize = -1;
+
+    PbfReader reader(blob.constData(), blob.size());
+    while (reader.next()) {
+        switch (reader.field()) {
+        case 1:
+            reader.bytes(raw, rawLength);
+            break;
+        case 2:
+            rawSize = qint64(reader.varint());
+            break;
+        case 3:
+            reader.bytes(zlibData, zlibLength);
+            break;
+        default:
+            reader.skip();
+        }
+    }
+
+    if (reader.hasError()) {
+        error = QStringLiteral("Corrupt blob");
+        return false;
+    }
+
+    if (raw) {
+        data = QByteArray(raw, rawLength);
+        return true;
+    }
+
+    if (!zlibData) {
+        error = QStringLiteral("Unsupported blob compression");
+        return false;
+    }
+
+    if (rawSize < 0 || rawSize > MaxBlobSize) {
+        error = QStringLiteral("Invalid blob size");
+        return false;
+    }
+
+    data.resize(int(rawSize));
+    uLongf length = uLongf(rawSize);
+    if (uncompress(reinterpret_cast<Bytef*>(data.data()), &length,
+                   reinterpret_cast<const Bytef*>(zlibData), uLong(zlibLength)) != Z_OK
+            || qint64(length) != rawSize) {
+        error = QStringLiteral("Cannot inflate blob");
+        return false;
+    }
+    return true;
+}
+
+PbfBlock decodeBlock(const QByteArray &blob)
+{
+    PbfBlock block;
+    QByteArray data;
+    if (inflateBlob(blob, data, block.error)) {
+        PrimitiveBlockDecoder decoder(block);
+        decoder.decode(data);
+    }
+    return block;
+}
+
+bool checkHeader(const QByteArray &blob, OsmDocumentBuilder &builder, QString &error)
+{
+    QByteArray data;
+    if (!inflateBlob(blob, data, error)) {
+        return false;
+    }
+
+    PbfReader reader(data.constData(), data.size());
+    while (reader.next()) {
+        const char *feature = 0;
+        int size = 0;
+        if (reader.field() == 4 && reader.bytes(feature, size)) {
+            const QByteArray name = QByteArray::fromRawData(feature, size);
+            if (name != "OsmSchema-V0.6" && name != "DenseNodes") {
+                error = QStringLiteral("Unsupported feature %1").arg(QString::fromUtf8(name));
+                return false;
+            }
+        } else if (reader.field() == 5 && reader.bytes(feature, size)) {
+            if (QByteArray::fromRawData(feature, size) == "Sort.Type_then_ID") {
+                builder.setSortedByType(true);
+            }
+        } else {
+            reader.skip();
+        }
+    }
+
+    if (reader.hasError()) {
+        error = QStringLiteral("Corrupt file header");
+        return false;
+    }
+    return true;
+}
+
+bool readBlob(QFile &file, QByteArray &type, QByteArray &blob, QString &error)
+{
+    uchar headerSizeData[4];
+    if (file.read(reinterpret_cast<char*>(headerSizeData), 4) != 4) {
+        error = QStringLiteral("Unexpected end of file");
+        return false;
+    }
+
+    const quint32 headerSize = qFromBigEndian<quint32>(headerSizeData);
+    if (headerSize > MaxBlobHeaderSize) {
+        error = QStringLiteral("Invalid blob header size");
+        return false;
+    }
+
+    const QByteArray header = file.read(headerSize);
+    if (header.size() != int(headerSize)) {
+        error = QStringLiteral("Unexpected end of file");
+        return false;
+    }
+
+    qint64 dataSize = -1;
+    PbfReader reader(header.constData(), header.size());
+    while (reader.next()) {
+        const char *data = 0;
+        int size = 0;
+        if (reader.field() == 1 && reader.bytes(data, size)) {
+            type = QByteArray(data, size);
+        } else if (reader.field() == 3) {
+            dataSize = qint64(reader.varint());
+        } else {
+            reader.skip();
+        }
+    }
+
+    if (reader.hasError() || dataSize < 0 || dataSize > MaxBlobSize) {
+        error = QStringLiteral("Corrupt blob header");
+        return false;
+    }
+
+    blob = file.read(dataSize);
+    if (blob.size() != dataSize) {
+        error = QStringLiteral("Unexpected end of file");
+        return false;
+    }
+    return true;
+}
+
+bool collect(QFuture<PbfBlock> &future, OsmDocumentBuilder &builder, QString &error)
+{
+    future.waitForFinished();
+    const QList<PbfBlock> blocks = future.results();
+    future = QFuture<PbfBlock>();
+
+    foreach (const PbfBlock &block, blocks) {
+        if (!block.error.isEmpty()) {
+            error = block.error;
+            return false;
+        }
+
+        foreach (const OsmNode &node, block.nodes) {
+            builder.addNode(node);
+        }
+        foreach (const OsmWay &way, block.ways) {
+            builder.addWay(way);
+        }
+        foreach (const OsmRelation &relation, block.relations) {
+            builder.addRelation(relation);
+        }
+    }
+    return true;
+}
+
+}
+
+bool OsmPbfParser::read(const QString &filename, OsmDocumentBuilder &builder, QString &error)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = QStringLiteral("Cannot open file %1").arg(filename);
+        return false;
+    }
+
+    // the next batch of blocks is read while the previous one is decoded
+    const int batchSize = 4 * qMax(1, QThread::idealThreadCount());
+    QVector<QByteArray> batch;
+    QFuture<PbfBlock> pending;
+    bool hasHeader = false;
+
+    while (!file.atEnd() && !builder.isCanceled()) {
+        QByteArray type;
+        QByteArray blob;
+        if (!readBlob(file, type, blob, error)) {
+            pending.waitForFinished();
+            return false;
+        }
+
+        if (type == "OSMHeader") {
+            if (!checkHeader(blob, builder, error)) {
+                pending.waitForFinished();
+                return false;
+            }
+            hasHeader = true;
+        } else if (type == "OSMData") {
+            batch.append(blob);
+            if (batch.size() == batchSize) {
+                if (!collect(pending, builder, error)) {
+                    return false;
+                }
+                pending = QtConcurrent::mapped(batch, decodeBlock);
+                batch.clear();
+            }
+        }
+    }
+
+    if (!collect(pending, builder, error)) {
+        return false;
+    }
+    pending = QtConcurrent::mapped(batch, decodeBlock);
+    if (!collect(pending, builder, error)) {
+        return false;
+    }
+
+    if (!hasHeader) {
+        error = QStringLiteral("Missing OSMHeader in %1").arg(filename);
+        return false;
+    }
+    return true;
+}
+
+}
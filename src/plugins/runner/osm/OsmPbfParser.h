@@ -0,0 +1,41 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#ifndef MARBLE_OSMPBFPARSER_H
+#define MARBLE_OSMPBFPARSER_H
+
+#include <QString>
+
+namespace Marble {
+
+class OsmDocumentBuilder;
+
+/**
+ * Reads OpenStreetMap data in the protocol buffer binary format (.osm.pbf).
+ *
+ * The file is read sequentially, but the compressed data blocks are inflated
+ * and decoded on all cores, several blocks at a time. Only dense and plain
+ * nodes, ways and relations of the current (non-historical) data model are
+ * supported, which covers the extracts of all common providers.
+ */
+class OsmPbfParser
+{
+public:
+    /**
+     * Adds the elements of the .osm.pbf file @p filename to @p builder, in
+     * file order. Returns false and sets @p error if the file cannot be read
+     * or decoded.
+     */
+    static bool read(const QString &filename, OsmDocumentBuilder &builder, QString &error);
+};
+
+}
+
+#endif
@@ -50,7 +50,7 @@ void OsmRelation::addMember(qint64 reference, const QString &role, const QString
     m_members << member;
 }
 
-void OsmRelation::create(GeoDataDocument *document, OsmWays &ways, const OsmNodes &nodes, QSet<qint64> &usedNodes, QSet<qint64> &usedWays) const
+void OsmRelation::create(GeoDataDocument *document, OsmWays &ways, const OsmNodes &nodes, QSet<qint64> &usedWays) const
 {
     if (!m_osmData.containsTag(QStringLiteral("type"), QStringLiteral("multipolygon"))) {
         return;
@@ -58,8 +58,7 @@ void OsmRelation::create(GeoDataDocument *document, OsmWays &ways, const OsmNode
 
     QStringList const outerRoles = QStringList() << QStringLiteral("outer") << QString();
     QSet<qint64> outerWays;
-    QSet<qint64> outerNodes;
-    const QList<GeoDataLinearRing> outer = rings(outerRoles, ways, nodes, outerNodes, outerWays);
+    const QList<GeoDataLinearRing> outer = rings(outerRoles, ways, nodes, outerWays);
 
     if (outer.isEmpty()) {
         return;
@@ -94,14 +93,12 @@ void OsmRelation::create(GeoDataDocument *document, OsmWays &ways, const OsmNode
             usedWays << wayId;
         } // else we keep it
 
-        foreach(qint64 nodeId, ways[wayId].references()) {
-            ways[wayId].osmData().addNodeReference(nodes[nodeId].coordinates(), nodes[nodeId].osmData());
-        }
+        addNodeReferences(ways[wayId], nodes);
     }
 
     QStringList const innerRoles = QStringList() << QStringLiteral("inner");
     QSet<qint64> innerWays;
-    const QList<GeoDataLinearRing> inner = rings(innerRoles, ways, nodes, usedNodes, innerWays);
+    const QList<GeoDataLinearRing> inner = rings(innerRoles, ways, nodes, innerWays);
 
     OsmPlacemarkData osmData = m_osmData;
     osmData.addMemberReference(-1, ways[*outerWays.begin()].osmData());
@@ -112,9 +109,7 @@ void OsmRelation::create(GeoDataDocument *document, OsmWays &ways, const OsmNode
             // Schedule way for removal: It's a non-styled way only used to create the inner boundary in this polygon
             usedWays << wayId;
         }
-        foreach(qint64 nodeId, ways[wayId].references()) {
-            ways[wayId].osmData().addNodeReference(nodes[nodeId].coordinates(), nodes[nodeId].osmData());
-        }
+        addNodeReferences(ways[wayId], nodes);
         osmData.addMemberReference(index, ways[wayId].osmData());
         ++index;
     }
@@ -154,16 +149,26 @@ void OsmRelation::create(GeoDataDocument *document, OsmWays &ways, const OsmNode
             OsmObjectManager::registerId(osmData.id());
         }
         placemark->setOsmData(osmData);
-        usedNodes |= outerNodes;
 
         document->append(placemark);
     }
 }
 
-QList<GeoDataLinearRing> OsmRelation::rings(const QStringList &roles, const OsmWays &ways, const OsmNodes &nodes, QSet<qint64> &usedNodes, QSet<qint64> &usedWays) const
+void OsmRelation::addNodeReferences(OsmWay &way, const OsmNodes &nodes)
+{
+    GeoDataCoordinates coordinates;
+    OsmPlacemarkData nodeData;
+    const OsmNodes &wayNodes = way.nodes(nodes);
+    foreach(qint64 nodeId, way.references()) {
+        if (wayNodes.find(nodeId, coordinates, &nodeData)) {
+            way.osmData().addNodeReference(coordinates, nodeData);
+        }
+    }
+}
+
+QList<GeoDataLinearRing> OsmRelation::rings(const QStringList &roles, const OsmWays &ways, const OsmNodes &nodes, QSet<qint64> &usedWays) const
 {
     QSet<qint64> currentWays;
-    QSet<qint64> currentNodes;
     QList<qint64> roleMembers;
     foreach(const OsmMember &member, m_members) {
         if (roles.contains(member.role)) {
@@ -184,12 +189,14 @@ QList<GeoDataLinearRing> OsmRelation::rings(const QStringList &roles, const OsmW
             unclosedWays.append(way);
             continue;
         }
+        GeoDataCoordinates coordinates;
+        const OsmNodes &wayNodes = way.nodes(nodes);
         foreach(qint64 id, way.references()) {
-            if (!nodes.contains(id)) {
+            if (!wayNodes.find(id, coordinates)) {
                 // A node is missing. Return nothing.
                 return QList<GeoDataLinearRing>();
             }
-            ring << nodes[id].coordinates();
+            ring << coordinates;
         }
         Q_ASSERT(ways.contains(wayId));
         currentWays << wayId;
@@ -212,15 +219,16 @@ QList<GeoDataLinearRing> OsmRelation::rings(const QStringList &roles, const OsmW
 
                         bool isReversed = nextWay.references().last() == lastReference;
                         QVector<qint64> v = nextWay.references();
+                        const OsmNodes &wayNodes = nextWay.nodes(nodes);
                         while( !v.isEmpty() ) {
                             qint64 id = isReversed ? v.takeLast() : v.takeFirst();
-                            if (!nodes.contains(id)) {
+                            GeoDataCoordinates coordinates;
+                            if (!wayNodes.find(id, coordinates)) {
                                 // A node is missing. Return nothing.
                                 return QList<GeoDataLinearRing>();
                             }
                             if ( id != lastReference ) {
-                                ring << nodes[id].coordinates();
-                                currentNodes << id;
+                                ring << coordinates;
                             }
                         }
                         lastReference = isReversed ? nextWay.references().first()
@@ -245,7 +253,6 @@ QList<GeoDataLinearRing> OsmRelation::rings(const QStringList &roles, const OsmW
     }
 
     usedWays |= currentWays;
-    usedNodes |= currentNodes;
     return result;
 }
 
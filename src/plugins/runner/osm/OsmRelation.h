@@ -33,7 +33,7 @@ public:
 
     const OsmPlacemarkData & osmData() const;
 
-    void create(GeoDataDocument* document, OsmWays &ways, const OsmNodes &nodes, QSet<qint64> &usedNodes, QSet<qint64> &usedWays) const;
+    void create(GeoDataDocument* document, OsmWays &ways, const OsmNodes &nodes, QSet<qint64> &usedWays) const;
 
 private:
     struct OsmMember
@@ -45,7 +45,8 @@ private:
         OsmMember();
     };
 
-    QList<GeoDataLinearRing> rings(const QStringList &roles, const OsmWays &ways, const OsmNodes &nodes, QSet<qint64> &usedNodes, QSet<qint64> &usedWays) const;
+    static void addNodeReferences(OsmWay &way, const OsmNodes &nodes);
+    QList<GeoDataLinearRing> rings(const QStringList &roles, const OsmWays &ways, const OsmNodes &nodes, QSet<qint64> &usedWays) const;
 
     OsmPlacemarkData m_osmData;
     QVector<OsmMember> m_members;
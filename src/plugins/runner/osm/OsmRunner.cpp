@@ -17,13 +17,16 @@ namespace Marble
 {
 
 OsmRunner::OsmRunner(QObject *parent) :
-    ParsingRunner(parent)
+    ParsingRunner(parent),
+    m_role(UnknownDocument)
 {
 }
 
 GeoDataDocument *OsmRunner::parseFile(const QString &fileName, DocumentRole role, QString &error)
 {
-    GeoDataDocument* document = OsmParser::parse(fileName, role, error);
+    m_fileName = fileName;
+    m_role = role;
+    GeoDataDocument* document = OsmParser::parse(fileName, role, error, partialResultsEnabled() ? this : nullptr);
     if (document) {
         document->setDocumentRole(role);
         document->setFileName(fileName);
@@ -31,6 +34,18 @@ GeoDataDocument *OsmRunner::parseFile(const QString &fileName, DocumentRole role
     return document;
 }
 
+void OsmRunner::addPartialDocument(GeoDataDocument *document)
+{
+    if (isCanceled()) {
+        delete document;
+        return;
+    }
+
+    document->setDocumentRole(m_role);
+    document->setFileName(m_fileName);
+    emit partialDocumentParsed(document);
+}
+
 }
 
 #include "moc_OsmRunner.cpp"
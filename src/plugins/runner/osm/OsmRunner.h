@@ -21,6 +21,16 @@ class OsmRunner : public ParsingRunner
 public:
     explicit OsmRunner(QObject *parent = 0);
     GeoDataDocument* parseFile( const QString &fileName, DocumentRole role, QString& error );
+
+    /**
+     * Hands a part of the file being parsed to the receivers of
+     * partialDocumentParsed().
+     */
+    void addPartialDocument(GeoDataDocument *document);
+
+private:
+    QString m_fileName;
+    DocumentRole m_role;
 };
 
 }
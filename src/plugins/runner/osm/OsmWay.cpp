@@ -24,8 +24,9 @@ namespace Marble {
 
 QSet<StyleBuilder::OsmTag> OsmWay::s_areaTags;
 
-void OsmWay::create(GeoDataDocument *document, DocumentRole role, const OsmNodes &nodes, QSet<qint64> &usedNodes) const
+bool OsmWay::create(GeoDataDocument *document, DocumentRole role, const OsmNodes &allNodes) const
 {
+    const OsmNodes &nodes = this->nodes(allNodes);
     const double height = extractBuildingHeight(m_osmData);
 
     OsmPlacemarkData osmData = m_osmData;
@@ -34,16 +35,15 @@ void OsmWay::create(GeoDataDocument *document, DocumentRole role, const OsmNodes
     if (isArea()) {
         GeoDataLinearRing linearRing;
 
+        GeoDataCoordinates coordinates;
+        OsmPlacemarkData nodeData;
         foreach(qint64 nodeId, m_references) {
-            auto const nodeIter = nodes.constFind(nodeId);
-            if (nodeIter == nodes.constEnd()) {
-                return;
+            if (!nodes.find(nodeId, coordinates, &nodeData)) {
+                return false;
             }
 
-            OsmNode const & node = nodeIter.value();
-            osmData.addNodeReference(node.coordinates(), node.osmData());
-            linearRing.append(node.coordinates());
-            usedNodes << nodeId;
+            osmData.addNodeReference(coordinates, nodeData);
+            linearRing.append(coordinates);
         }
 
         linearRing = GeoDataLinearRing(linearRing.optimized());
@@ -55,16 +55,15 @@ void OsmWay::create(GeoDataDocument *document, DocumentRole role, const OsmNodes
     } else {
         GeoDataLineString lineString;
 
+        GeoDataCoordinates coordinates;
+        OsmPlacemarkData nodeData;
         foreach(qint64 nodeId, m_references) {
-            auto const nodeIter = nodes.constFind(nodeId);
-            if (nodeIter == nodes.constEnd()) {
-                return;
+            if (!nodes.find(nodeId, coordinates, &nodeData)) {
+                return false;
             }
 
-            OsmNode const & node = nodeIter.value();
-            osmData.addNodeReference(node.coordinates(), node.osmData());
-            lineString.append(node.coordinates());
-            usedNodes << nodeId;
+            osmData.addNodeReference(coordinates, nodeData);
+            lineString.append(coordinates);
         }
 
         lineString = lineString.optimized();
@@ -117,6 +116,36 @@ void OsmWay::create(GeoDataDocument *document, DocumentRole role, const OsmNodes
             }
         }
     }
+    return true;
+}
+
+bool OsmWay::resolveNodes(const OsmNodes &nodes)
+{
+    QSharedPointer<OsmNodes> wayNodes(new OsmNodes);
+
+    OsmNode node;
+    GeoDataCoordinates coordinates;
+    foreach(qint64 nodeId, m_references) {
+        if (!nodes.find(nodeId, coordinates, &node.osmData())) {
+            return false;
+        }
+        node.setCoordinates(coordinates);
+        wayNodes->insert(node);
+    }
+
+    wayNodes->squeeze();
+    m_nodes = wayNodes;
+    return true;
+}
+
+bool OsmWay::isResolved() const
+{
+    return !m_nodes.isNull();
+}
+
+const OsmNodes &OsmWay::nodes(const OsmNodes &nodes) const
+{
+    return m_nodes ? *m_nodes : nodes;
 }
 
 const QVector<qint64> &OsmWay::references() const
@@ -17,6 +17,7 @@
 #include <GeoDataDocument.h>
 
 #include <QSet>
+#include <QSharedPointer>
 #include <QString>
 
 namespace Marble {
@@ -32,7 +33,33 @@ public:
     const OsmPlacemarkData & osmData() const;
     const QVector<qint64> &references() const;
 
-    void create(GeoDataDocument* document, DocumentRole role, const OsmNodes &nodes, QSet<qint64> &usedNodes) const;
+    /**
+     * Appends the placemark of the way to @p document. Returns false if nodes
+     * of the way are missing.
+     */
+    bool create(GeoDataDocument* document, DocumentRole role, const OsmNodes &nodes) const;
+
+    /**
+     * Copies the nodes of the way from @p nodes. create() and relations use
+     * them from then on instead of the nodes passed to them, so those may be
+     * released. Returns false if nodes of the way are missing.
+     */
+    bool resolveNodes(const OsmNodes &nodes);
+
+    /**
+     * Returns true if resolveNodes() succeeded.
+     */
+    bool isResolved() const;
+
+    /**
+     * Returns the nodes of the way if they were resolved, @p nodes otherwise.
+     */
+    const OsmNodes &nodes(const OsmNodes &nodes) const;
+
+    /**
+     * Returns true if the way is drawn as a polygon rather than as a line.
+     */
+    bool isArea() const;
 
 private:
     struct NamedEntry {
@@ -41,8 +68,6 @@ private:
         OsmPlacemarkData osmData;
     };
 
-    bool isArea() const;
-
     static bool isAreaTag(const StyleBuilder::OsmTag &keyValue);
 
     static double extractBuildingHeight(const OsmPlacemarkData &osmData);
@@ -50,6 +75,7 @@ private:
 
     OsmPlacemarkData m_osmData;
     QVector<qint64> m_references;
+    QSharedPointer<OsmNodes> m_nodes;
 
     static QSet<StyleBuilder::OsmTag> s_areaTags;
 };
@@ -0,0 +1,180 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include <QObject>
+#include <QtTest>
+
+#include <GeoDataDocument.h>
+#include <GeoDataPlacemark.h>
+#include "OsmDocumentBuilder.h"
+#include "OsmRunner.h"
+
+using namespace Marble;
+
+class TestOsmDocumentBuilder : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void streamingTest();
+    void cancelTest();
+
+private:
+    /**
+     * Adds benches, a forest multipolygon, whose outer way is tagged like
+     * the relation, a building and a street to @p builder, sorted by type.
+     */
+    static void addElements(OsmDocumentBuilder &builder);
+
+    /**
+     * Returns the osm id, visual category and geometry type of all
+     * placemarks in @p documents, sorted.
+     */
+    static QStringList placemarks(const QList<GeoDataDocument*> &documents);
+};
+
+void TestOsmDocumentBuilder::addElements(OsmDocumentBuilder &builder)
+{
+    const qreal coordinates[][2] = {
+        { 10.00, 50.00 }, { 10.10, 50.00 }, { 10.10, 50.10 }, { 10.00, 50.10 },
+        { 10.04, 50.04 }, { 10.06, 50.04 }, { 10.06, 50.06 }, { 10.04, 50.06 },
+        { 10.20, 50.20 }, { 10.21, 50.20 }, { 10.21, 50.21 }, { 10.20, 50.21 },
+        { 10.30, 50.00 }, { 10.40, 50.00 }
+    };
+    for (int i = 0; i < 14; ++i) {
+        OsmNode node;
+        node.osmData().setId(i + 1);
+        node.setCoordinates(GeoDataCoordinates(coordinates[i][0], coordinates[i][1], 0.0, GeoDataCoordinates::Degree));
+        builder.addNode(node);
+    }
+
+    // enough placemarks to be delivered in parts
+    for (int i = 0; i < 6000; ++i) {
+        OsmNode bench;
+        bench.osmData().setId(1000 + i);
+        bench.osmData().addTag(QStringLiteral("amenity"), QStringLiteral("bench"));
+        bench.setCoordinates(GeoDataCoordinates(11.0 + i * 1.0e-4, 51.0, 0.0, GeoDataCoordinates::Degree));
+        builder.addNode(bench);
+    }
+
+    OsmWay outer;
+    outer.osmData().setId(100);
+    outer.osmData().addTag(QStringLiteral("landuse"), QStringLiteral("forest"));
+    outer.addReference(1);
+    outer.addReference(2);
+    outer.addReference(3);
+    outer.addReference(4);
+    outer.addReference(1);
+    builder.addWay(outer);
+
+    OsmWay inner;
+    inner.osmData().setId(101);
+    inner.addReference(5);
+    inner.addReference(6);
+    inner.addReference(7);
+    inner.addReference(8);
+    inner.addReference(5);
+    builder.addWay(inner);
+
+    OsmWay building;
+    building.osmData().setId(102);
+    building.osmData().addTag(QStringLiteral("building"), QStringLiteral("yes"));
+    building.addReference(9);
+    building.addReference(10);
+    building.addReference(11);
+    building.addReference(12);
+    building.addReference(9);
+    builder.addWay(building);
+
+    OsmWay street;
+    street.osmData().setId(103);
+    street.osmData().addTag(QStringLiteral("highway"), QStringLiteral("residential"));
+    street.addReference(13);
+    street.addReference(14);
+    builder.addWay(street);
+
+    OsmRelation forest;
+    forest.osmData().setId(200);
+    forest.osmData().addTag(QStringLiteral("type"), QStringLiteral("multipolygon"));
+    forest.osmData().addTag(QStringLiteral("landuse"), QStringLiteral("forest"));
+    forest.addMember(100, QStringLiteral("outer"), QStringLiteral("way"));
+    forest.addMember(101, QStringLiteral("inner"), QStringLiteral("way"));
+    builder.addRelation(forest);
+}
+
+QStringList TestOsmDocumentBuilder::placemarks(const QList<GeoDataDocument*> &documents)
+{
+    QStringList result;
+    foreach (const GeoDataDocument *document, documents) {
+        foreach (const GeoDataPlacemark *placemark, document->placemarkList()) {
+            result << QStringLiteral("%1 %2 %3").arg(placemark->osmData().id())
+                      .arg(placemark->visualCategory())
+                      .arg(QString::fromLatin1(placemark->geometry()->nodeType()));
+        }
+    }
+    result.sort();
+    return result;
+}
+
+void TestOsmDocumentBuilder::streamingTest()
+{
+    QList<GeoDataDocument*> collected;
+    {
+        OsmDocumentBuilder builder(MapDocument);
+        builder.setSortedByType(false);
+        addElements(builder);
+        collected << builder.finish();
+    }
+    const QStringList expected = placemarks(collected);
+    qDeleteAll(collected);
+    collected.clear();
+
+    // the outer way of the forest is only drawn as part of the multipolygon
+    QCOMPARE(expected.size(), 6003);
+
+    qRegisterMetaType<GeoDataDocument*>("GeoDataDocument*");
+    OsmRunner runner;
+    runner.setPartialResultsEnabled(true);
+    QSignalSpy partSpy(&runner, SIGNAL(partialDocumentParsed(GeoDataDocument*)));
+    {
+        OsmDocumentBuilder builder(MapDocument, &runner);
+        builder.setSortedByType(true);
+        addElements(builder);
+        collected << builder.finish();
+    }
+    QVERIFY(partSpy.count() > 0);
+    foreach (const QList<QVariant> &arguments, partSpy) {
+        collected << arguments.first().value<GeoDataDocument*>();
+    }
+    const QStringList streamed = placemarks(collected);
+    qDeleteAll(collected);
+
+    QCOMPARE(streamed, expected);
+}
+
+void TestOsmDocumentBuilder::cancelTest()
+{
+    qRegisterMetaType<GeoDataDocument*>("GeoDataDocument*");
+    OsmRunner runner;
+    runner.setPartialResultsEnabled(true);
+    QSignalSpy partSpy(&runner, SIGNAL(partialDocumentParsed(GeoDataDocument*)));
+    runner.cancel();
+
+    // parts of a canceled runner are discarded
+    OsmDocumentBuilder builder(MapDocument, &runner);
+    builder.setSortedByType(true);
+    QVERIFY(builder.isCanceled());
+    addElements(builder);
+    QCOMPARE(partSpy.count(), 0);
+    delete builder.finish();
+}
+
+QTEST_MAIN( TestOsmDocumentBuilder )
+
+#include "TestOsmDocumentBuilder.moc"
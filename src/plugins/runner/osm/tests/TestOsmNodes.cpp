@@ -0,0 +1,138 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include <QObject>
+#include <QtTest>
+
+#include "OsmNode.h"
+
+using namespace Marble;
+
+class TestOsmNodes : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void attributesTest();
+    void taggedNodesTest();
+    void replaceTest();
+
+private:
+    static OsmNode createNode(qint64 id, qreal lon, qreal lat, const QString &user = QString(),
+                              const QString &changeset = QString(), const QString &version = QString());
+};
+
+OsmNode TestOsmNodes::createNode(qint64 id, qreal lon, qreal lat, const QString &user,
+                                 const QString &changeset, const QString &version)
+{
+    OsmNode node;
+    node.osmData().setId(id);
+    node.osmData().setUser(user);
+    node.osmData().setUid(user.isEmpty() ? QString() : QString::number(user.size()));
+    node.osmData().setChangeset(changeset);
+    node.osmData().setVersion(version);
+    node.osmData().setTimestamp(changeset.isEmpty() ? QString() : QStringLiteral("2016-05-01T12:00:00Z"));
+    node.setCoordinates(GeoDataCoordinates(lon, lat, 0.0, GeoDataCoordinates::Degree));
+    return node;
+}
+
+void TestOsmNodes::attributesTest()
+{
+    // nodes with attributes but without tags, as in every .osm file, are
+    // kept compact and still return their attributes
+    OsmNodes nodes;
+    nodes.insert(createNode(3, 10.3, 50.3, QStringLiteral("alice"), QStringLiteral("100"), QStringLiteral("2")));
+    nodes.insert(createNode(1, 10.1, 50.1, QStringLiteral("alice"), QStringLiteral("100"), QStringLiteral("1")));
+    nodes.insert(createNode(2, 10.2, 50.2, QStringLiteral("bob"), QStringLiteral("200"), QStringLiteral("1")));
+    nodes.insert(createNode(4, 10.4, 50.4));
+    nodes.squeeze();
+    nodes.insert(createNode(5, 10.5, 50.5, QStringLiteral("alice"), QStringLiteral("100"), QStringLiteral("1")));
+    nodes.squeeze();
+    QVERIFY(nodes.dataNodes().isEmpty());
+
+    GeoDataCoordinates coordinates;
+    OsmPlacemarkData osmData;
+    QVERIFY(nodes.find(1, coordinates, &osmData));
+    QCOMPARE(osmData.id(), qint64(1));
+    QCOMPARE(osmData.user(), QStringLiteral("alice"));
+    QCOMPARE(osmData.uid(), QStringLiteral("5"));
+    QCOMPARE(osmData.changeset(), QStringLiteral("100"));
+    QCOMPARE(osmData.version(), QStringLiteral("1"));
+    QCOMPARE(osmData.timestamp(), QStringLiteral("2016-05-01T12:00:00Z"));
+    QVERIFY(qAbs(coordinates.longitude(GeoDataCoordinates::Degree) - 10.1) < 1.0e-6);
+    QVERIFY(qAbs(coordinates.latitude(GeoDataCoordinates::Degree) - 50.1) < 1.0e-6);
+
+    QVERIFY(nodes.find(2, coordinates, &osmData));
+    QCOMPARE(osmData.id(), qint64(2));
+    QCOMPARE(osmData.user(), QStringLiteral("bob"));
+    QCOMPARE(osmData.changeset(), QStringLiteral("200"));
+
+    QVERIFY(nodes.find(3, coordinates, &osmData));
+    QCOMPARE(osmData.user(), QStringLiteral("alice"));
+    QCOMPARE(osmData.version(), QStringLiteral("2"));
+
+    QVERIFY(nodes.find(4, coordinates, &osmData));
+    QCOMPARE(osmData.id(), qint64(4));
+    QVERIFY(osmData.isEmpty());
+
+    // inserted after squeezing
+    QVERIFY(nodes.find(5, coordinates, &osmData));
+    QCOMPARE(osmData.user(), QStringLiteral("alice"));
+    QCOMPARE(osmData.version(), QStringLiteral("1"));
+
+    QVERIFY(!nodes.find(6, coordinates, &osmData));
+}
+
+void TestOsmNodes::taggedNodesTest()
+{
+    OsmNodes nodes;
+    OsmNode tagged = createNode(1, 10.1, 50.1, QStringLiteral("alice"), QStringLiteral("100"), QStringLiteral("1"));
+    tagged.osmData().addTag(QStringLiteral("amenity"), QStringLiteral("bench"));
+    nodes.insert(tagged);
+    nodes.insert(createNode(2, 10.2, 50.2, QStringLiteral("alice"), QStringLiteral("100"), QStringLiteral("1")));
+    nodes.squeeze();
+
+    QCOMPARE(nodes.dataNodes().size(), 1);
+    QVERIFY(nodes.dataNodes().contains(1));
+
+    GeoDataCoordinates coordinates;
+    OsmPlacemarkData osmData;
+    QVERIFY(nodes.find(1, coordinates, &osmData));
+    QCOMPARE(osmData.tagValue(QStringLiteral("amenity")), QStringLiteral("bench"));
+    QCOMPARE(osmData.user(), QStringLiteral("alice"));
+}
+
+void TestOsmNodes::replaceTest()
+{
+    OsmNodes nodes;
+    nodes.insert(createNode(1, 10.1, 50.1, QStringLiteral("alice"), QStringLiteral("100"), QStringLiteral("1")));
+    nodes.insert(createNode(1, 10.2, 50.2, QStringLiteral("bob"), QStringLiteral("200"), QStringLiteral("2")));
+
+    // a node with tags wins over a later one without
+    OsmNode tagged = createNode(2, 10.3, 50.3);
+    tagged.osmData().addTag(QStringLiteral("amenity"), QStringLiteral("bench"));
+    nodes.insert(tagged);
+    nodes.insert(createNode(2, 10.4, 50.4, QStringLiteral("bob"), QStringLiteral("200"), QStringLiteral("2")));
+    nodes.squeeze();
+
+    GeoDataCoordinates coordinates;
+    OsmPlacemarkData osmData;
+    QVERIFY(nodes.find(1, coordinates, &osmData));
+    QCOMPARE(osmData.user(), QStringLiteral("bob"));
+    QCOMPARE(osmData.version(), QStringLiteral("2"));
+    QVERIFY(qAbs(coordinates.longitude(GeoDataCoordinates::Degree) - 10.2) < 1.0e-6);
+
+    QVERIFY(nodes.find(2, coordinates, &osmData));
+    QCOMPARE(osmData.tagValue(QStringLiteral("amenity")), QStringLiteral("bench"));
+    QVERIFY(qAbs(coordinates.longitude(GeoDataCoordinates::Degree) - 10.3) < 1.0e-6);
+}
+
+QTEST_MAIN( TestOsmNodes )
+
+#include "TestOsmNodes.moc"
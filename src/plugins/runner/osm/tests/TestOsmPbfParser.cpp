@@ -0,0 +1,136 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include <QObject>
+#include <QtTest>
+
+#include <GeoDataDocument.h>
+#include <GeoDataLinearRing.h>
+#include <GeoDataLineString.h>
+#include <GeoDataPlacemark.h>
+#include <GeoDataPolygon.h>
+#include "OsmDocumentBuilder.h"
+#include "OsmPbfParser.h"
+
+#include <QTemporaryFile>
+
+using namespace Marble;
+
+class TestOsmPbfParser : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void readTest();
+    void truncatedFileTest();
+
+private:
+    static QString fixture();
+    static bool isNear(qreal degrees, qreal expected);
+};
+
+QString TestOsmPbfParser::fixture()
+{
+    return QString(OSM_TEST_DATA_PATH) + QLatin1String("/small.osm.pbf");
+}
+
+bool TestOsmPbfParser::isNear(qreal degrees, qreal expected)
+{
+    // the file stores coordinates with a precision of 100 nanodegrees
+    return qAbs(degrees - expected) < 1.0e-6;
+}
+
+void TestOsmPbfParser::readTest()
+{
+    // small.osm.pbf holds one uncompressed header block and one zlib
+    // compressed data block with
+    // - dense nodes 1-8 (untagged), 9 (name=Fountain, amenity=drinking_water), 11, 12
+    // - a plain node 10 (name=Hamlet, place=village)
+    // - the untagged closed ways 100 (nodes 1-4) and 101 (nodes 5-8)
+    // - way 102 (nodes 11, 12; highway=residential, name=Main Street)
+    // - relation 200 (type=multipolygon, landuse=forest, name=Forest) with
+    //   the outer way 100 and the inner way 101
+    OsmDocumentBuilder builder(MapDocument);
+    QString error;
+    QVERIFY(OsmPbfParser::read(fixture(), builder, error));
+    QVERIFY(error.isEmpty());
+
+    QScopedPointer<GeoDataDocument> document(builder.finish());
+    QVERIFY(document);
+
+    QHash<QString, const GeoDataPlacemark*> placemarks;
+    foreach (const GeoDataPlacemark *placemark, document->placemarkList()) {
+        placemarks.insert(placemark->name(), placemark);
+    }
+    // the ways of the multipolygon are not drawn on their own
+    QCOMPARE(placemarks.size(), 4);
+    QCOMPARE(document->placemarkList().size(), 4);
+
+    const GeoDataPlacemark *fountain = placemarks.value(QStringLiteral("Fountain"));
+    QVERIFY(fountain);
+    QCOMPARE(fountain->visualCategory(), GeoDataPlacemark::AmenityDrinkingWater);
+    QCOMPARE(fountain->osmData().id(), qint64(9));
+    QCOMPARE(fountain->osmData().tagValue(QStringLiteral("amenity")), QStringLiteral("drinking_water"));
+    QVERIFY(isNear(fountain->coordinate().longitude(GeoDataCoordinates::Degree), 10.2));
+    QVERIFY(isNear(fountain->coordinate().latitude(GeoDataCoordinates::Degree), 50.2));
+
+    const GeoDataPlacemark *hamlet = placemarks.value(QStringLiteral("Hamlet"));
+    QVERIFY(hamlet);
+    QCOMPARE(hamlet->visualCategory(), GeoDataPlacemark::PlaceVillage);
+    QCOMPARE(hamlet->osmData().id(), qint64(10));
+    QVERIFY(isNear(hamlet->coordinate().longitude(GeoDataCoordinates::Degree), 10.5));
+    QVERIFY(isNear(hamlet->coordinate().latitude(GeoDataCoordinates::Degree), 50.3));
+
+    const GeoDataPlacemark *street = placemarks.value(QStringLiteral("Main Street"));
+    QVERIFY(street);
+    QCOMPARE(street->visualCategory(), GeoDataPlacemark::HighwayResidential);
+    QCOMPARE(street->osmData().id(), qint64(102));
+    const GeoDataLineString *lineString = dynamic_cast<const GeoDataLineString*>(street->geometry());
+    QVERIFY(lineString);
+    QCOMPARE(lineString->size(), 2);
+    QVERIFY(isNear(lineString->first().longitude(GeoDataCoordinates::Degree), 10.3));
+    QVERIFY(isNear(lineString->last().longitude(GeoDataCoordinates::Degree), 10.4));
+
+    const GeoDataPlacemark *forest = placemarks.value(QStringLiteral("Forest"));
+    QVERIFY(forest);
+    QCOMPARE(forest->visualCategory(), GeoDataPlacemark::NaturalWood);
+    QCOMPARE(forest->osmData().id(), qint64(200));
+    QCOMPARE(forest->osmData().tagValue(QStringLiteral("type")), QStringLiteral("multipolygon"));
+    const GeoDataPolygon *polygon = dynamic_cast<const GeoDataPolygon*>(forest->geometry());
+    QVERIFY(polygon);
+    QCOMPARE(polygon->innerBoundaries().size(), 1);
+    const GeoDataLatLonBox box = polygon->outerBoundary().latLonAltBox();
+    QVERIFY(isNear(box.west(GeoDataCoordinates::Degree), 10.0));
+    QVERIFY(isNear(box.east(GeoDataCoordinates::Degree), 10.1));
+    QVERIFY(isNear(box.south(GeoDataCoordinates::Degree), 50.0));
+    QVERIFY(isNear(box.north(GeoDataCoordinates::Degree), 50.1));
+}
+
+void TestOsmPbfParser::truncatedFileTest()
+{
+    QFile file(fixture());
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray data = file.readAll();
+
+    // cut into the data block
+    QTemporaryFile truncated;
+    QVERIFY(truncated.open());
+    truncated.write(data.left(data.size() - 10));
+    truncated.close();
+
+    OsmDocumentBuilder builder(MapDocument);
+    QString error;
+    QVERIFY(!OsmPbfParser::read(truncated.fileName(), builder, error));
+    QVERIFY(!error.isEmpty());
+    delete builder.finish();
+}
+
+QTEST_MAIN( TestOsmPbfParser )
+
+#include "TestOsmPbfParser.moc"
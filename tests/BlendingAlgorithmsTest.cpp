@@ -0,0 +1,142 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include "blendings/BlendingAlgorithms.h"
+#include "TextureTile.h"
+#include "TileId.h"
+#include "TestUtils.h"
+
+#include <QImage>
+
+namespace Marble
+{
+
+class BlendingAlgorithmsTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void blendSemiTransparent_data();
+    void blendSemiTransparent();
+
+ private:
+    static QImage image( int seed, QImage::Format format );
+
+    /**
+     * Blends @p bottom and @p top pixel by pixel like the blendings did
+     * before they got row kernels, on the colors of both images.
+     */
+    static QImage perPixelBlend( const QString &blending, const QImage &bottom, const QImage &top );
+
+    static bool isClose( QRgb pixel, QRgb expected );
+};
+
+QImage BlendingAlgorithmsTest::image( int seed, QImage::Format format )
+{
+    // all kinds of alpha values, including fully transparent and opaque pixels
+    QImage result( 16, 16, QImage::Format_ARGB32 );
+    for ( int y = 0; y < result.height(); ++y ) {
+        for ( int x = 0; x < result.width(); ++x ) {
+            const int alpha = ( 17 * x + 31 * y + seed ) % 5 == 0 ? 255 : ( 61 * x + 13 * y + seed ) % 256;
+            result.setPixel( x, y, qRgba( ( 7 * x + seed ) % 256, ( 11 * y + seed ) % 256,
+                                          ( 5 * x * y + seed ) % 256, alpha ) );
+        }
+    }
+
+    return result.convertToFormat( format );
+}
+
+QImage BlendingAlgorithmsTest::perPixelBlend( const QString &blending, const QImage &bottom, const QImage &top )
+{
+    const QImage bottomColors = bottom.convertToFormat( QImage::Format_ARGB32 );
+    const QImage topColors = top.convertToFormat( QImage::Format_ARGB32 );
+    QImage result( bottom.size(), QImage::Format_ARGB32_Premultiplied );
+
+    for ( int y = 0; y < result.height(); ++y ) {
+        for ( int x = 0; x < result.width(); ++x ) {
+            const QRgb bottomPixel = bottomColors.pixel( x, y );
+            const QRgb topPixel = topColors.pixel( x, y );
+            if ( blending == QLatin1String( "GrayscaleBlending" ) ) {
+                const int gray = qGray( topPixel );
+                result.setPixel( x, y, qRgb( gray, gray, gray ) );
+            } else if ( blending == QLatin1String( "CloudsBlending" ) ) {
+                const qreal c = qRed( topPixel ) / 255.0;
+                result.setPixel( x, y, qRgb( ( int )( qRed( bottomPixel ) + ( 255 - qRed( bottomPixel ) ) * c ),
+                                             ( int )( qGreen( bottomPixel ) + ( 255 - qGreen( bottomPixel ) ) * c ),
+                                             ( int )( qBlue( bottomPixel ) + ( 255 - qBlue( bottomPixel ) ) * c ) ) );
+            } else {
+                // AllanonBlending
+                const qreal red = ( qRed( bottomPixel ) / 255.0 + qRed( topPixel ) / 255.0 ) / 2.0;
+                const qreal green = ( qGreen( bottomPixel ) / 255.0 + qGreen( topPixel ) / 255.0 ) / 2.0;
+                const qreal blue = ( qBlue( bottomPixel ) / 255.0 + qBlue( topPixel ) / 255.0 ) / 2.0;
+                result.setPixel( x, y, qRgb( red * 255.0, green * 255.0, blue * 255.0 ) );
+            }
+        }
+    }
+
+    return result;
+}
+
+bool BlendingAlgorithmsTest::isClose( QRgb pixel, QRgb expected )
+{
+    // unpremultiplying may round differently than converting the image does
+    return qAbs( qRed( pixel ) - qRed( expected ) ) <= 1 && qAbs( qGreen( pixel ) - qGreen( expected ) ) <= 1
+        && qAbs( qBlue( pixel ) - qBlue( expected ) ) <= 1 && qAlpha( pixel ) == qAlpha( expected );
+}
+
+void BlendingAlgorithmsTest::blendSemiTransparent_data()
+{
+    QTest::addColumn<QString>( "blending" );
+    QTest::addColumn<int>( "topFormat" );
+
+    addRow() << QString( "AllanonBlending" ) << int( QImage::Format_ARGB32 );
+    addRow() << QString( "AllanonBlending" ) << int( QImage::Format_ARGB32_Premultiplied );
+    addRow() << QString( "GrayscaleBlending" ) << int( QImage::Format_ARGB32 );
+    addRow() << QString( "GrayscaleBlending" ) << int( QImage::Format_ARGB32_Premultiplied );
+    addRow() << QString( "CloudsBlending" ) << int( QImage::Format_ARGB32 );
+    addRow() << QString( "CloudsBlending" ) << int( QImage::Format_ARGB32_Premultiplied );
+}
+
+void BlendingAlgorithmsTest::blendSemiTransparent()
+{
+    QFETCH( QString, blending );
+    QFETCH( int, topFormat );
+
+    AllanonBlending allanonBlending;
+    GrayscaleBlending grayscaleBlending;
+    CloudsBlending cloudsBlending;
+    const Blending *const algorithm = blending == QLatin1String( "GrayscaleBlending" ) ? static_cast<const Blending *>( &grayscaleBlending )
+                                    : blending == QLatin1String( "CloudsBlending" ) ? static_cast<const Blending *>( &cloudsBlending )
+                                    : static_cast<const Blending *>( &allanonBlending );
+
+    const QImage bottom = image( 3, QImage::Format_ARGB32_Premultiplied );
+    const QImage topImage = image( 101, QImage::Format( topFormat ) );
+    const TextureTile top( TileId( 0, 0, 0, 0 ), topImage, algorithm );
+
+    QImage result = bottom;
+    algorithm->blend( &result, &top );
+
+    const QImage expected = perPixelBlend( blending, bottom, topImage );
+    QCOMPARE( result.format(), expected.format() );
+    for ( int y = 0; y < expected.height(); ++y ) {
+        for ( int x = 0; x < expected.width(); ++x ) {
+            if ( !isClose( result.pixel( x, y ), expected.pixel( x, y ) ) ) {
+                QFAIL( qPrintable( QString( "pixel (%1, %2) is %3 instead of %4" ).arg( x ).arg( y )
+                                   .arg( result.pixel( x, y ), 8, 16 ).arg( expected.pixel( x, y ), 8, 16 ) ) );
+            }
+        }
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::BlendingAlgorithmsTest )
+
+#include "BlendingAlgorithmsTest.moc"
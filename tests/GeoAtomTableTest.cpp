@@ -0,0 +1,68 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include <QTest>
+
+#include "GeoAtomTable.h"
+
+namespace Marble
+{
+
+class GeoAtomTableTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void internAndLookUp();
+    void forget();
+};
+
+static const char testTag_Waypoint[] = "GeoAtomTableTestWaypoint";
+static const char testTag_Route[] = "GeoAtomTableTestRoute";
+
+void GeoAtomTableTest::internAndLookUp()
+{
+    const QString unknown( "GeoAtomTableTestUnknown" );
+    QCOMPARE( GeoAtomTable::atom( QStringRef( &unknown ) ), GeoAtomTable::Unknown );
+
+    const GeoAtomTable::Atom waypoint = GeoAtomTable::intern( testTag_Waypoint );
+    const GeoAtomTable::Atom route = GeoAtomTable::intern( testTag_Route );
+    QVERIFY( waypoint != GeoAtomTable::Unknown );
+    QVERIFY( route != GeoAtomTable::Unknown );
+    QVERIFY( waypoint != route );
+
+    // interning again yields the same atom, by address or by contents
+    QCOMPARE( GeoAtomTable::intern( testTag_Waypoint ), waypoint );
+    QCOMPARE( GeoAtomTable::intern( QString( "GeoAtomTableTestWaypoint" ) ), waypoint );
+
+    QCOMPARE( GeoAtomTable::atom( testTag_Route ), route );
+    const QString element( "<GeoAtomTableTestRoute>" );
+    QCOMPARE( GeoAtomTable::atom( element.midRef( 1, element.size() - 2 ) ), route );
+
+    QCOMPARE( GeoAtomTable::name( waypoint ), QString( "GeoAtomTableTestWaypoint" ) );
+    QCOMPARE( GeoAtomTable::name( GeoAtomTable::Unknown ), QString() );
+}
+
+void GeoAtomTableTest::forget()
+{
+    static const char name[] = "GeoAtomTableTestForget";
+    const GeoAtomTable::Atom atom = GeoAtomTable::intern( name );
+
+    GeoAtomTable::forget( name );
+
+    // the contents are still interned
+    QCOMPARE( GeoAtomTable::atom( name ), atom );
+}
+
+}
+
+QTEST_MAIN( Marble::GeoAtomTableTest )
+
+#include "GeoAtomTableTest.moc"
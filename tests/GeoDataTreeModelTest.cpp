@@ -8,6 +8,7 @@
 // Copyright 2014      Bernhard Beschow <bbeschow@cs.tu-berlin.de>
 //
 
+#include <QSignalSpy>
 #include <QTest>
 
 #include "GeoDataTreeModel.h"
@@ -26,6 +27,7 @@ private Q_SLOTS:
     void defaultConstructor();
     void setRootDocument();
     void addDocument();
+    void addAndRemoveDocuments();
 };
 
 void GeoDataTreeModelTest::defaultConstructor()
@@ -73,6 +75,36 @@ void GeoDataTreeModelTest::addDocument()
     }
 }
 
+void GeoDataTreeModelTest::addAndRemoveDocuments()
+{
+    GeoDataTreeModel model;
+    QSignalSpy insertedSpy( &model, SIGNAL(rowsInserted(QModelIndex,int,int)) );
+    QSignalSpy removedSpy( &model, SIGNAL(rowsRemoved(QModelIndex,int,int)) );
+
+    QVector<GeoDataDocument*> documents;
+    for ( int i = 0; i < 6; ++i ) {
+        documents << new GeoDataDocument;
+    }
+
+    model.addDocuments( documents );
+    QCOMPARE( model.rowCount(), 6 );
+    QCOMPARE( insertedSpy.count(), 1 );
+    QCOMPARE( insertedSpy.at( 0 ).at( 1 ).toInt(), 0 );
+    QCOMPARE( insertedSpy.at( 0 ).at( 2 ).toInt(), 5 );
+
+    // rows 1, 2 and 4 form two ranges
+    QVector<GeoDataDocument*> removed;
+    removed << documents.at( 4 ) << documents.at( 1 ) << documents.at( 2 );
+    model.removeDocuments( removed );
+    QCOMPARE( model.rowCount(), 3 );
+    QCOMPARE( removedSpy.count(), 2 );
+    QCOMPARE( model.rootDocument()->child( 0 ), static_cast<GeoDataFeature*>( documents.at( 0 ) ) );
+    QCOMPARE( model.rootDocument()->child( 1 ), static_cast<GeoDataFeature*>( documents.at( 3 ) ) );
+    QCOMPARE( model.rootDocument()->child( 2 ), static_cast<GeoDataFeature*>( documents.at( 5 ) ) );
+
+    qDeleteAll( removed );
+}
+
 }
 
 QTEST_MAIN( Marble::GeoDataTreeModelTest )
@@ -0,0 +1,202 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include "GeoDataLatLonAltBox.h"
+#include "GeoDataPlacemark.h"
+#include "GeoGraphicsItem.h"
+#include "GeoGraphicsScene.h"
+#include "TestUtils.h"
+
+#include <QSet>
+#include <QVector>
+
+namespace Marble
+{
+
+class BenchmarkGraphicsItem : public GeoGraphicsItem
+{
+public:
+    BenchmarkGraphicsItem( const GeoDataFeature *feature, const GeoDataLatLonAltBox &box ) :
+        GeoGraphicsItem( feature ),
+        m_box( box )
+    {
+    }
+
+    virtual const GeoDataLatLonAltBox &latLonAltBox() const { return m_box; }
+
+    virtual void paint( GeoPainter *, const ViewportParams *, const QString & ) {}
+
+private:
+    const GeoDataLatLonAltBox m_box;
+};
+
+class GeoGraphicsSceneBenchmark : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void addItems();
+
+    void items_data();
+    void items();
+
+    void removeItems();
+
+ private:
+    static GeoDataLatLonBox box( qreal west, qreal east, qreal north, qreal south );
+    static bool intersects( const GeoDataLatLonBox &box, const GeoDataLatLonBox &itemBox );
+    void fillScene( GeoGraphicsScene &scene ) const;
+
+    QVector<GeoDataLatLonAltBox> m_boxes;
+    QVector<GeoDataPlacemark *> m_features;
+};
+
+static const int FeatureCount = 1000000;
+static const int ItemsPerFeature = 1000;
+
+GeoDataLatLonBox GeoGraphicsSceneBenchmark::box( qreal west, qreal east, qreal north, qreal south )
+{
+    return GeoDataLatLonBox( north, south, east, west, GeoDataCoordinates::Degree );
+}
+
+bool GeoGraphicsSceneBenchmark::intersects( const GeoDataLatLonBox &box, const GeoDataLatLonBox &itemBox )
+{
+    // unlike GeoDataLatLonBox::intersects(), this accepts boxes without extent (points)
+    if ( itemBox.south() > box.north() || itemBox.north() < box.south() ) {
+        return false;
+    }
+
+    // GeoDataLatLonBox::crossesDateLine() holds for the whole longitude range as well
+    const bool boxCrossesDateLine = box.west() > box.east();
+    const bool itemCrossesDateLine = itemBox.west() > itemBox.east();
+    if ( boxCrossesDateLine && itemCrossesDateLine ) {
+        return true;
+    }
+    if ( boxCrossesDateLine ) {
+        return itemBox.east() >= box.west() || itemBox.west() <= box.east();
+    }
+    if ( itemCrossesDateLine ) {
+        return box.east() >= itemBox.west() || box.west() <= itemBox.east();
+    }
+
+    return itemBox.west() <= box.east() && itemBox.east() >= box.west();
+}
+
+void GeoGraphicsSceneBenchmark::initTestCase()
+{
+    // mostly points and small ways clustered in a few regions, plus a few
+    // large and date line crossing items
+    qsrand( 42 );
+    m_boxes.reserve( FeatureCount );
+    for ( int i = 0; i < FeatureCount; ++i ) {
+        const qreal cluster = ( i % 7 ) * 50.0 - 170.0;
+        const qreal lon = cluster + ( qrand() % 20000 ) / 1000.0;
+        const qreal lat = ( qrand() % 140000 ) / 1000.0 - 70.0;
+
+        qreal size = 0.0;
+        if ( i % 3 == 0 ) {
+            size = ( qrand() % 1000 ) / 10000.0;
+        } else if ( i % 10007 == 0 ) {
+            size = 30.0;
+        }
+
+        if ( i % 100003 == 0 ) {
+            m_boxes.append( GeoDataLatLonAltBox( box( 170, -170, lat + 1, lat ), 0, 0 ) );
+        } else {
+            m_boxes.append( GeoDataLatLonAltBox( box( lon, qMin<qreal>( lon + size, 180 ), qMin<qreal>( lat + size, 90 ), lat ), 0, 0 ) );
+        }
+    }
+
+    for ( int i = 0; i < FeatureCount / ItemsPerFeature; ++i ) {
+        m_features.append( new GeoDataPlacemark );
+    }
+}
+
+void GeoGraphicsSceneBenchmark::cleanupTestCase()
+{
+    qDeleteAll( m_features );
+}
+
+void GeoGraphicsSceneBenchmark::fillScene( GeoGraphicsScene &scene ) const
+{
+    for ( int i = 0; i < m_boxes.size(); ++i ) {
+        scene.addItem( new BenchmarkGraphicsItem( m_features.at( i / ItemsPerFeature ), m_boxes.at( i ) ) );
+    }
+}
+
+void GeoGraphicsSceneBenchmark::addItems()
+{
+    QBENCHMARK_ONCE {
+        GeoGraphicsScene scene;
+        fillScene( scene );
+    }
+}
+
+void GeoGraphicsSceneBenchmark::items_data()
+{
+    QTest::addColumn<GeoDataLatLonBox>( "box" );
+
+    addNamedRow("city") << box( 8.3, 8.5, 49.1, 48.9 );
+    addNamedRow("country") << box( 5, 15, 55, 47 );
+    addNamedRow("continent") << box( -30, 40, 70, 30 );
+    addNamedRow("world") << box( -180, 180, 90, -90 );
+    addNamedRow("date line") << box( 160, -160, 20, -20 );
+}
+
+void GeoGraphicsSceneBenchmark::items()
+{
+    QFETCH( GeoDataLatLonBox, box );
+
+    GeoGraphicsScene scene;
+    fillScene( scene );
+
+    QVector<GeoGraphicsItem *> result;
+    scene.items( box, 20, result );
+
+    // compare with testing each item
+    QSet<GeoGraphicsItem *> const resultSet = QSet<GeoGraphicsItem *>::fromList( result.toList() );
+    QCOMPARE( resultSet.size(), result.size() );
+    int expectedCount = 0;
+    foreach ( const GeoDataLatLonAltBox &itemBox, m_boxes ) {
+        if ( intersects( box, itemBox ) ) {
+            ++expectedCount;
+        }
+    }
+    QCOMPARE( result.size(), expectedCount );
+
+    QBENCHMARK {
+        result.resize( 0 );
+        scene.items( box, 20, result );
+    }
+}
+
+void GeoGraphicsSceneBenchmark::removeItems()
+{
+    GeoGraphicsScene scene;
+    fillScene( scene );
+
+    // like unloading vector tiles, one feature after the other
+    QBENCHMARK_ONCE {
+        foreach ( const GeoDataPlacemark *feature, m_features ) {
+            scene.removeItem( feature );
+        }
+    }
+
+    QVERIFY( scene.items( box( -180, 180, 90, -90 ), 20 ).isEmpty() );
+}
+
+}
+
+QTEST_MAIN( Marble::GeoGraphicsSceneBenchmark )
+
+#include "GeoGraphicsSceneBenchmark.moc"
@@ -0,0 +1,225 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include "GeoDataDocument.h"
+#include "GeoDataLineString.h"
+#include "GeoDataParser.h"
+#include "GeoDataPlacemark.h"
+#include "MarbleGlobal.h"
+#include "TestUtils.h"
+
+#include <QBuffer>
+#include <QByteArray>
+#include <QStringList>
+#include <QVector>
+
+namespace Marble
+{
+
+class KmlCoordinatesBenchmark : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void matchesSplitting_data();
+    void matchesSplitting();
+
+    void splitting_data();
+    void splitting();
+
+    void parseLineString_data();
+    void parseLineString();
+
+ private:
+    static QString coordinatesText( int count );
+    static QByteArray lineStringKml( const QString &coordinates );
+    static GeoDataDocument *parse( const QByteArray &kml );
+    static QVector<GeoDataCoordinates> splitCoordinates( const QString &coordinates );
+};
+
+static const int PointCount = 1000000;
+
+QString KmlCoordinatesBenchmark::coordinatesText( int count )
+{
+    QString text;
+    text.reserve( 36 * count );
+    for ( int i = 0; i < count; ++i ) {
+        // a GPS track winding around the globe, with the usual seven decimals
+        const qreal lon = -180.0 + 360.0 * ( ( qint64( i ) * 7919 ) % count ) / count;
+        const qreal lat = 80.0 * ( ( qint64( i ) * 104729 ) % count ) / count - 40.0;
+        const qreal altitude = 100.0 + ( i % 1000 ) / 4.0;
+        text += QString::number( lon, 'f', 7 ) + QLatin1Char( ',' )
+              + QString::number( lat, 'f', 7 ) + QLatin1Char( ',' )
+              + QString::number( altitude, 'f', 2 ) + QLatin1Char( ' ' );
+    }
+    return text;
+}
+
+QByteArray KmlCoordinatesBenchmark::lineStringKml( const QString &coordinates )
+{
+    const QString kml = QLatin1String( "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                                       "<kml xmlns=\"http://www.opengis.net/kml/2.2\">"
+                                       "<Placemark><LineString><coordinates>" )
+                      + coordinates
+                      + QLatin1String( "</coordinates></LineString></Placemark></kml>" );
+    return kml.toUtf8();
+}
+
+GeoDataDocument *KmlCoordinatesBenchmark::parse( const QByteArray &kml )
+{
+    QByteArray array( kml );
+    QBuffer buffer( &array );
+    buffer.open( QIODevice::ReadOnly );
+
+    GeoDataParser parser( GeoData_KML );
+    if ( !parser.read( &buffer ) ) {
+        return 0;
+    }
+
+    return static_cast<GeoDataDocument*>( parser.releaseDocument() );
+}
+
+/**
+ * The former way of parsing coordinates: normalize the commas, split into
+ * tuples, split the tuples into numbers and convert each number.
+ */
+QVector<GeoDataCoordinates> KmlCoordinatesBenchmark::splitCoordinates( const QString &coordinates )
+{
+    QString text = coordinates.trimmed();
+    for ( int i = 1; i < text.size() - 1; ++i ) {
+        if ( text[i] == QLatin1Char( ',' ) ) {
+            int l = i - 1;
+            while ( l > 0 && text[l].isSpace() ) {
+                --l;
+            }
+            int r = i + 1;
+            while ( r < text.size() && text[r].isSpace() ) {
+                ++r;
+            }
+            text.remove( l + 1, r - l - 1 ).insert( l + 1, QLatin1Char( ',' ) );
+        }
+    }
+
+    QStringList lines;
+    int index = 0;
+    bool inside = true;
+    for ( int i = 0; i < text.size(); ++i ) {
+        if ( text[i].isSpace() ) {
+            if ( inside ) {
+                lines.append( text.mid( index, i - index ) );
+                inside = false;
+            }
+            index = i + 1;
+        } else {
+            inside = true;
+        }
+    }
+    lines.append( text.mid( index ) );
+
+    QVector<GeoDataCoordinates> result;
+    foreach ( const QString &line, lines ) {
+        const QStringList numbers = line.trimmed().split( QLatin1Char( ',' ) );
+        GeoDataCoordinates coord;
+        if ( numbers.size() == 2 ) {
+            coord.set( DEG2RAD * numbers.at( 0 ).toDouble(), DEG2RAD * numbers.at( 1 ).toDouble() );
+        } else if ( numbers.size() == 3 ) {
+            coord.set( DEG2RAD * numbers.at( 0 ).toDouble(), DEG2RAD * numbers.at( 1 ).toDouble(),
+                       numbers.at( 2 ).toDouble() );
+        }
+        result.append( coord );
+    }
+
+    return result;
+}
+
+void KmlCoordinatesBenchmark::matchesSplitting_data()
+{
+    QTest::addColumn<QString>( "coordinates" );
+
+    addRow() << QString( "13.4,52.5 2.35,48.86" );
+    addRow() << QString( "\n\t 13.4,52.5,34.0\n  2.35,48.86,35.5 \n" );
+    addRow() << QString( "13.4 , 52.5 ,34.0 2.35,\t48.86 ,\n35.5" );
+    addRow() << QString( "-1.5e1,+2.5E-1 0.0000001,-0.0 123456789.123456789,1" );
+    addRow() << QString( "-122.08220354256830,37.42228990140251,0" );
+    addRow() << coordinatesText( 1000 );
+}
+
+void KmlCoordinatesBenchmark::matchesSplitting()
+{
+    QFETCH( QString, coordinates );
+
+    const QVector<GeoDataCoordinates> expected = splitCoordinates( coordinates );
+
+    GeoDataDocument *const document = parse( lineStringKml( coordinates ) );
+    QVERIFY( document );
+    QCOMPARE( document->placemarkList().size(), 1 );
+    const GeoDataLineString *lineString = dynamic_cast<const GeoDataLineString*>( document->placemarkList().first()->geometry() );
+    QVERIFY( lineString );
+
+    QCOMPARE( lineString->size(), expected.size() );
+    for ( int i = 0; i < expected.size(); ++i ) {
+        QCOMPARE( lineString->at( i ).longitude(), expected.at( i ).longitude() );
+        QCOMPARE( lineString->at( i ).latitude(), expected.at( i ).latitude() );
+        QCOMPARE( lineString->at( i ).altitude(), expected.at( i ).altitude() );
+    }
+
+    delete document;
+}
+
+void KmlCoordinatesBenchmark::splitting_data()
+{
+    QTest::addColumn<int>( "count" );
+
+    // the normalization of the commas is quadratic, larger counts take ages
+    addRow() << 1000;
+    addRow() << 10000;
+}
+
+void KmlCoordinatesBenchmark::splitting()
+{
+    QFETCH( int, count );
+
+    const QString coordinates = coordinatesText( count );
+
+    QBENCHMARK {
+        const QVector<GeoDataCoordinates> result = splitCoordinates( coordinates );
+        QCOMPARE( result.size(), count );
+    }
+}
+
+void KmlCoordinatesBenchmark::parseLineString_data()
+{
+    QTest::addColumn<int>( "count" );
+
+    addRow() << 1000;
+    addRow() << 10000;
+    addRow() << PointCount;
+}
+
+void KmlCoordinatesBenchmark::parseLineString()
+{
+    QFETCH( int, count );
+
+    const QByteArray kml = lineStringKml( coordinatesText( count ) );
+
+    QBENCHMARK {
+        GeoDataDocument *const document = parse( kml );
+        QVERIFY( document );
+        const GeoDataLineString *lineString = static_cast<const GeoDataLineString*>( document->placemarkList().first()->geometry() );
+        QCOMPARE( lineString->size(), count );
+        delete document;
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::KmlCoordinatesBenchmark )
+
+#include "KmlCoordinatesBenchmark.moc"
@@ -0,0 +1,209 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include "AbstractProjection.h"
+#include "GeoDataCoordinates.h"
+#include "GeoDataLineString.h"
+#include "ViewportParams.h"
+#include "TestUtils.h"
+
+#include <QPointF>
+#include <QPolygonF>
+#include <QVector>
+
+namespace Marble
+{
+
+class ProjectionBatchBenchmark : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void initTestCase();
+
+    void batchMatchesSinglePoints_data();
+    void batchMatchesSinglePoints();
+
+    void singlePoints_data();
+    void singlePoints();
+
+    void batch_data();
+    void batch();
+
+    void lineString_data();
+    void lineString();
+
+ private:
+    static void addProjectionRows();
+    static void setUpViewport( ViewportParams &viewport, Projection projection );
+
+    QVector<qreal> m_lon;
+    QVector<qreal> m_lat;
+    QVector<qreal> m_altitude;
+};
+
+static const int VertexCount = 1000000;
+
+void ProjectionBatchBenchmark::initTestCase()
+{
+    m_lon.resize( VertexCount );
+    m_lat.resize( VertexCount );
+    m_altitude.resize( VertexCount );
+
+    // a dense spiral around the globe, so every projection sees visible and hidden nodes
+    for ( int i = 0; i < VertexCount; ++i ) {
+        const qreal t = qreal( i ) / VertexCount;
+        m_lon[i] = ( t * 200 - 100 ) * M_PI;
+        m_lat[i] = ( t - 0.5 ) * 0.98 * M_PI;
+        m_altitude[i] = ( i % 100 ) * 100.0;
+    }
+}
+
+void ProjectionBatchBenchmark::addProjectionRows()
+{
+    QTest::addColumn<int>( "projection" );
+
+    addNamedRow("spherical") << int( Spherical );
+    addNamedRow("equirectangular") << int( Equirectangular );
+    addNamedRow("mercator") << int( Mercator );
+    addNamedRow("gnomonic") << int( Gnomonic );
+    addNamedRow("stereographic") << int( Stereographic );
+    addNamedRow("lambert azimuthal") << int( LambertAzimuthal );
+    addNamedRow("azimuthal equidistant") << int( AzimuthalEquidistant );
+    addNamedRow("vertical perspective") << int( VerticalPerspective );
+}
+
+void ProjectionBatchBenchmark::setUpViewport( ViewportParams &viewport, Projection projection )
+{
+    viewport.setProjection( projection );
+    viewport.setRadius( 1500 );
+    viewport.setSize( QSize( 1920, 1080 ) );
+    viewport.centerOn( 8.4 * DEG2RAD, 49.0 * DEG2RAD );
+}
+
+void ProjectionBatchBenchmark::batchMatchesSinglePoints_data()
+{
+    addProjectionRows();
+}
+
+void ProjectionBatchBenchmark::batchMatchesSinglePoints()
+{
+    QFETCH( int, projection );
+
+    ViewportParams viewport;
+    setUpViewport( viewport, Projection( projection ) );
+    const AbstractProjection *const proj = viewport.currentProjection();
+
+    const int count = 10000;
+    QVector<QPointF> points( count );
+    QVector<bool> globeHidesPoints( count );
+    proj->screenCoordinates( m_lon.constData(), m_lat.constData(), m_altitude.constData(), count,
+                             &viewport, points.data(), globeHidesPoints.data() );
+
+    for ( int i = 0; i < count; ++i ) {
+        const GeoDataCoordinates coordinates( m_lon[i], m_lat[i], m_altitude[i] );
+        qreal x, y;
+        bool globeHidesPoint;
+        proj->screenCoordinates( coordinates, &viewport, x, y, globeHidesPoint );
+
+        QCOMPARE( globeHidesPoints[i], globeHidesPoint );
+        if ( !globeHidesPoint ) {
+            QCOMPARE( points[i].x(), x );
+            QCOMPARE( points[i].y(), y );
+        }
+    }
+}
+
+void ProjectionBatchBenchmark::singlePoints_data()
+{
+    addProjectionRows();
+}
+
+void ProjectionBatchBenchmark::singlePoints()
+{
+    QFETCH( int, projection );
+
+    ViewportParams viewport;
+    setUpViewport( viewport, Projection( projection ) );
+    const AbstractProjection *const proj = viewport.currentProjection();
+
+    QVector<GeoDataCoordinates> coordinates;
+    coordinates.reserve( VertexCount );
+    for ( int i = 0; i < VertexCount; ++i ) {
+        coordinates.append( GeoDataCoordinates( m_lon[i], m_lat[i], m_altitude[i] ) );
+    }
+
+    QVector<QPointF> points( VertexCount );
+    QVector<bool> globeHidesPoints( VertexCount );
+
+    QBENCHMARK {
+        for ( int i = 0; i < VertexCount; ++i ) {
+            qreal x, y;
+            bool globeHidesPoint;
+            proj->screenCoordinates( coordinates.at( i ), &viewport, x, y, globeHidesPoint );
+            points[i] = QPointF( x, y );
+            globeHidesPoints[i] = globeHidesPoint;
+        }
+    }
+}
+
+void ProjectionBatchBenchmark::batch_data()
+{
+    addProjectionRows();
+}
+
+void ProjectionBatchBenchmark::batch()
+{
+    QFETCH( int, projection );
+
+    ViewportParams viewport;
+    setUpViewport( viewport, Projection( projection ) );
+    const AbstractProjection *const proj = viewport.currentProjection();
+
+    QVector<QPointF> points( VertexCount );
+    QVector<bool> globeHidesPoints( VertexCount );
+
+    QBENCHMARK {
+        proj->screenCoordinates( m_lon.constData(), m_lat.constData(), m_altitude.constData(), VertexCount,
+                                 &viewport, points.data(), globeHidesPoints.data() );
+    }
+}
+
+void ProjectionBatchBenchmark::lineString_data()
+{
+    addProjectionRows();
+}
+
+void ProjectionBatchBenchmark::lineString()
+{
+    QFETCH( int, projection );
+
+    ViewportParams viewport;
+    setUpViewport( viewport, Projection( projection ) );
+    const AbstractProjection *const proj = viewport.currentProjection();
+
+    GeoDataLineString lineString;
+    lineString.reserve( VertexCount );
+    for ( int i = 0; i < VertexCount; ++i ) {
+        lineString.append( GeoDataCoordinates( m_lon[i], m_lat[i] ) );
+    }
+
+    QBENCHMARK {
+        QVector<QPolygonF*> polygons;
+        proj->screenCoordinates( lineString, &viewport, polygons );
+        qDeleteAll( polygons );
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::ProjectionBatchBenchmark )
+
+#include "ProjectionBatchBenchmark.moc"
@@ -0,0 +1,198 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include "Quaternion.h"
+#include "ScanlineKernels.h"
+#include "TestUtils.h"
+
+#include <QVector>
+
+#include <cmath>
+
+namespace Marble
+{
+
+class ScanlineKernelsBenchmark : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void init();
+    void cleanup();
+
+    void sphericalToLonLat_data();
+    void sphericalToLonLat();
+
+    void sampleNearest_data();
+    void sampleNearest();
+
+    void sampleBilinear_data();
+    void sampleBilinear();
+
+ private:
+    static void addInstructionSetRows();
+
+    QVector<uint> m_tile;
+};
+
+static const int TileSize = 256;
+static const int ScanlineWidth = 1920;
+
+void ScanlineKernelsBenchmark::init()
+{
+    m_tile.resize( TileSize * TileSize );
+    for ( int i = 0; i < m_tile.size(); ++i ) {
+        m_tile[i] = 0xff000000 | ( uint( i ) * 2654435761u >> 8 );
+    }
+}
+
+void ScanlineKernelsBenchmark::cleanup()
+{
+    ScanlineKernels::setInstructionSet( ScanlineKernels::supportedInstructionSet() );
+}
+
+void ScanlineKernelsBenchmark::addInstructionSetRows()
+{
+    QTest::addColumn<int>( "instructionSet" );
+
+    addNamedRow("scalar") << int( ScanlineKernels::Scalar );
+    addNamedRow("sse4.1") << int( ScanlineKernels::SSE41 );
+    addNamedRow("avx2") << int( ScanlineKernels::AVX2 );
+}
+
+void ScanlineKernelsBenchmark::sphericalToLonLat_data()
+{
+    addInstructionSetRows();
+}
+
+void ScanlineKernelsBenchmark::sphericalToLonLat()
+{
+    QFETCH( int, instructionSet );
+
+    if ( instructionSet > ScanlineKernels::supportedInstructionSet() ) {
+        QSKIP( "Instruction set not supported by this CPU" );
+    }
+
+    matrix planetAxisMatrix;
+    Quaternion::fromEuler( 0.3, 1.1, 0.0 ).toMatrix( planetAxisMatrix );
+
+    const qreal qy = 0.4;
+    const qreal qr = 1.0 - qy * qy;
+
+    QVector<qreal> qx( ScanlineWidth );
+    for ( int i = 0; i < qx.size(); ++i ) {
+        qx[i] = -1.0 + 2.0 * i / ScanlineWidth;
+    }
+
+    QVector<qreal> lon( ScanlineWidth );
+    QVector<qreal> lat( ScanlineWidth );
+
+    ScanlineKernels::setInstructionSet( ScanlineKernels::InstructionSet( instructionSet ) );
+    ScanlineKernels::sphericalToLonLat( planetAxisMatrix, qy, qr, qx.constData(), qx.size(), lon.data(), lat.data() );
+
+    // must be bit-identical to the Quaternion code used before
+    for ( int i = 0; i < qx.size(); ++i ) {
+        const qreal qr2z = qr - qx[i] * qx[i];
+        Quaternion qpos( 0.0, qx[i], qy, ( qr2z > 0.0 ) ? sqrt( qr2z ) : 0.0 );
+        qpos.rotateAroundAxis( planetAxisMatrix );
+
+        qreal expectedLon;
+        qreal expectedLat;
+        qpos.getSpherical( expectedLon, expectedLat );
+
+        QCOMPARE( lon[i], expectedLon );
+        QCOMPARE( lat[i], expectedLat );
+    }
+
+    QBENCHMARK {
+        ScanlineKernels::sphericalToLonLat( planetAxisMatrix, qy, qr, qx.constData(), qx.size(), lon.data(), lat.data() );
+    }
+}
+
+void ScanlineKernelsBenchmark::sampleNearest_data()
+{
+    addInstructionSetRows();
+}
+
+void ScanlineKernelsBenchmark::sampleNearest()
+{
+    QFETCH( int, instructionSet );
+
+    if ( instructionSet > ScanlineKernels::supportedInstructionSet() ) {
+        QSKIP( "Instruction set not supported by this CPU" );
+    }
+
+    // a diagonal run through the tile in 25.7 fixed point coordinates
+    const int count = TileSize - 1;
+    const int posX = 3 << 7;
+    const int posY = 1 << 7;
+    const int stepX = 115;
+    const int stepY = 97;
+
+    QVector<uint> scanLine( count );
+
+    ScanlineKernels::setInstructionSet( ScanlineKernels::InstructionSet( instructionSet ) );
+    ScanlineKernels::sampleNearest( m_tile.constData(), TileSize, posX, posY, stepX, stepY, scanLine.data(), count );
+
+    for ( int i = 0; i < count; ++i ) {
+        const int x = ( posX + i * stepX ) >> 7;
+        const int y = ( posY + i * stepY ) >> 7;
+        QCOMPARE( scanLine[i], m_tile[y * TileSize + x] );
+    }
+
+    QBENCHMARK {
+        ScanlineKernels::sampleNearest( m_tile.constData(), TileSize, posX, posY, stepX, stepY, scanLine.data(), count );
+    }
+}
+
+void ScanlineKernelsBenchmark::sampleBilinear_data()
+{
+    addInstructionSetRows();
+}
+
+void ScanlineKernelsBenchmark::sampleBilinear()
+{
+    QFETCH( int, instructionSet );
+
+    if ( instructionSet > ScanlineKernels::supportedInstructionSet() ) {
+        QSKIP( "Instruction set not supported by this CPU" );
+    }
+
+    const int count = TileSize - 1;
+    const qreal posX = 3.25;
+    const qreal posY = 1.5;
+    const qreal stepX = 0.9;
+    const qreal stepY = 0.75;
+
+    QVector<uint> expected( count );
+    ScanlineKernels::setInstructionSet( ScanlineKernels::Scalar );
+    ScanlineKernels::sampleBilinear( m_tile.constData(), TileSize, TileSize, TileSize,
+                                     posX, posY, stepX, stepY, expected.data(), count );
+
+    QVector<uint> scanLine( count );
+    ScanlineKernels::setInstructionSet( ScanlineKernels::InstructionSet( instructionSet ) );
+    ScanlineKernels::sampleBilinear( m_tile.constData(), TileSize, TileSize, TileSize,
+                                     posX, posY, stepX, stepY, scanLine.data(), count );
+
+    for ( int i = 0; i < count; ++i ) {
+        QCOMPARE( scanLine[i], expected[i] );
+    }
+
+    QBENCHMARK {
+        ScanlineKernels::sampleBilinear( m_tile.constData(), TileSize, TileSize, TileSize,
+                                         posX, posY, stepX, stepY, scanLine.data(), count );
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::ScanlineKernelsBenchmark )
+
+#include "ScanlineKernelsBenchmark.moc"
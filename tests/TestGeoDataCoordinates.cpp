@@ -30,6 +30,7 @@ private Q_SLOTS:
     void initTestCase();
 
     void testConstruction();
+    void testValueSemantics();
     void testSet_Degree();
     void testSet_Radian();
     void testSetLongitude_Degree();
@@ -146,6 +147,37 @@ void TestGeoDataCoordinates::testConstruction()
     QCOMPARE(coordinates6, invalid1); // it is equal to an invalid one
 }
 
+/*
+ * test that copies are independent of each other
+ */
+void TestGeoDataCoordinates::testValueSemantics()
+{
+    const GeoDataCoordinates invalid;
+    GeoDataCoordinates coordinates1(invalid);
+
+    coordinates1.setLongitude(1.0);
+
+    QVERIFY(coordinates1.isValid());
+    QVERIFY(!invalid.isValid());
+    QCOMPARE(invalid.longitude(), 0.0);
+
+    GeoDataCoordinates coordinates2(coordinates1);
+    coordinates2.setAltitude(100.0);
+
+    QCOMPARE(coordinates1.altitude(), 0.0);
+    QCOMPARE(coordinates2.altitude(), 100.0);
+    QCOMPARE(coordinates2.longitude(), 1.0);
+
+    // the nodes of a line string are stored without any heap allocation each
+    QVERIFY(sizeof(GeoDataCoordinates) <= 8 * sizeof(qreal));
+
+    // the cached quaternion follows changes of the coordinates
+    const Quaternion before = coordinates2.quaternion();
+    coordinates2.setLongitude(2.0);
+    QVERIFY(!(coordinates2.quaternion() == before));
+    QVERIFY(coordinates2.quaternion() == Quaternion::fromSpherical(2.0, coordinates2.latitude()));
+}
+
 /*
  * test setting coordinates in degree
  */
@@ -13,6 +13,7 @@
 
 #include <QObject>
 #include <QTest>
+#include <qmath.h>
 
 using namespace Marble;
 
@@ -26,6 +27,7 @@ private Q_SLOTS:
     void deleteAndDetachTest1();
     void deleteAndDetachTest2();
     void deleteAndDetachTest3();
+    void levelIndexTest();
 };
 
 void TestGeoDataGeometry::downcastPointTest_data()
@@ -85,6 +87,43 @@ void TestGeoDataGeometry::deleteAndDetachTest3()
     line2 << GeoDataCoordinates();
 }
 
+void TestGeoDataGeometry::levelIndexTest()
+{
+    GeoDataLineString line;
+    for ( int i = 0; i < 2000; ++i ) {
+        line << GeoDataCoordinates( i * 0.05, 10 + 5 * qSin( i * 0.01 ), 0, GeoDataCoordinates::Degree );
+    }
+
+    const GeoDataLineString optimized = line.optimized();
+
+    QVector<int> indices;
+    QVERIFY( !line.nodesForDetail( 1, indices ) ); // no detail values assigned
+
+    bool hasIndex = false;
+    for ( int level = 0; level < 18; ++level ) {
+        if ( !optimized.nodesForDetail( level, indices ) ) {
+            continue;
+        }
+        hasIndex = true;
+
+        QVector<int> expected;
+        for ( int i = 0; i < optimized.size(); ++i ) {
+            if ( optimized.at( i ).detail() <= level ) {
+                expected << i;
+            }
+        }
+        QCOMPARE( indices, expected );
+        QVERIFY( indices.size() <= optimized.size() / 2 );
+    }
+    QVERIFY( hasIndex );
+
+    // changing the nodes rebuilds the index
+    GeoDataLineString changed = optimized;
+    changed.at( 1 ).setDetail( 1 );
+    QVERIFY( changed.nodesForDetail( 1, indices ) );
+    QVERIFY( indices.contains( 1 ) );
+}
+
 QTEST_MAIN( TestGeoDataGeometry )
 #include "TestGeoDataGeometry.moc"
 
@@ -0,0 +1,92 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include "ImageAtlas.h"
+#include "TestUtils.h"
+
+#include <QImage>
+#include <QPainter>
+
+namespace Marble
+{
+
+class TestImageAtlas : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void matchesDirectDrawing();
+
+ private:
+    static QImage image( int index );
+};
+
+QImage TestImageAtlas::image( int index )
+{
+    QImage result( 16 + index % 5, 10, QImage::Format_ARGB32_Premultiplied );
+    result.fill( QColor::fromHsv( ( 37 * index ) % 360, 255, 255, 128 + index % 128 ) );
+    return result;
+}
+
+void TestImageAtlas::matchesDirectDrawing()
+{
+    // two pages hold about 30 of the images, so some get evicted
+    ImageAtlas atlas( QSize( 64, 64 ), 2 );
+
+    for ( int frame = 0; frame < 3; ++frame ) {
+        QImage expected( 200, 200, QImage::Format_ARGB32_Premultiplied );
+        expected.fill( Qt::white );
+        QImage actual = expected;
+
+        QPainter expectedPainter( &expected );
+        QPainter actualPainter( &actual );
+        atlas.begin( &actualPainter );
+
+        for ( int i = 0; i < 100; ++i ) {
+            const int index = ( i + 20 * frame ) % 45;
+            const QPointF position( 20 * ( i % 10 ), 20 * ( i / 10 ) );
+            const QString key = QString::number( index );
+
+            expectedPainter.drawImage( position, image( index ) );
+            if ( !atlas.draw( key, position ) ) {
+                atlas.draw( key, position, image( index ) );
+            }
+        }
+
+        atlas.end();
+        actualPainter.end();
+        expectedPainter.end();
+
+        QVERIFY( atlas.pageCount() <= 2 );
+        QVERIFY( atlas.batchCount() < 100 );
+        QCOMPARE( actual, expected );
+    }
+
+    // images larger than a page get drawn directly
+    QImage expected( 100, 100, QImage::Format_ARGB32_Premultiplied );
+    expected.fill( Qt::blue );
+    QImage actual( 100, 100, QImage::Format_ARGB32_Premultiplied );
+    actual.fill( Qt::white );
+
+    QPainter painter( &actual );
+    atlas.begin( &painter );
+    atlas.draw( QStringLiteral("large"), QPointF( 0, 0 ), expected );
+    atlas.end();
+    painter.end();
+
+    QVERIFY( !atlas.contains( QStringLiteral("large") ) );
+    QCOMPARE( actual, expected );
+}
+
+}
+
+QTEST_MAIN( Marble::TestImageAtlas )
+
+#include "TestImageAtlas.moc"
@@ -0,0 +1,96 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include "LabelGrid.h"
+#include "TestUtils.h"
+
+#include <QFont>
+#include <QFontMetrics>
+#include <QRectF>
+
+namespace Marble
+{
+
+class TestLabelGrid : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void matchesBruteForce();
+    void reset();
+    void textMetricsOfManyFonts();
+};
+
+void TestLabelGrid::matchesBruteForce()
+{
+    LabelGrid grid;
+    grid.reset( QSize( 500, 300 ) );
+
+    QVector<QRectF> labels;
+    qsrand( 42 );
+    for ( int i = 0; i < 2000; ++i ) {
+        // some of the rects reach beyond the screen
+        const QRectF rect( qrand() % 600 - 50, qrand() % 400 - 50, 1 + qrand() % 120, 1 + qrand() % 30 );
+
+        bool expected = true;
+        foreach ( const QRectF &label, labels ) {
+            if ( rect.intersects( label ) ) {
+                expected = false;
+                break;
+            }
+        }
+
+        QCOMPARE( grid.isFree( rect ), expected );
+        QCOMPARE( grid.tryOccupy( rect ), expected );
+        if ( expected ) {
+            labels << rect;
+        }
+    }
+
+    QCOMPARE( grid.labelCount(), labels.size() );
+}
+
+void TestLabelGrid::reset()
+{
+    LabelGrid grid;
+    QVERIFY( grid.isFree( QRectF( 0, 0, 10, 10 ) ) );
+
+    grid.reset( QSize( 200, 100 ) );
+    grid.occupy( QRectF( 10, 10, 50, 20 ) );
+    QVERIFY( !grid.isFree( QRectF( 40, 20, 50, 20 ) ) );
+    QVERIFY( grid.isFree( QRectF( 70, 20, 50, 20 ) ) );
+
+    grid.reset( QSize( 200, 100 ) );
+    QCOMPARE( grid.labelCount(), 0 );
+    QVERIFY( grid.isFree( QRectF( 40, 20, 50, 20 ) ) );
+}
+
+void TestLabelGrid::textMetricsOfManyFonts()
+{
+    // labels following lines change their font size with the zoom level,
+    // more fonts than the cache keeps at once
+    LabelGrid grid;
+    const QString text = QStringLiteral( "Main Street" );
+    for ( int round = 0; round < 2; ++round ) {
+        for ( int i = 0; i < 300; ++i ) {
+            QFont font;
+            font.setPointSizeF( 4.0 + i * 0.05 );
+            const QFontMetrics metrics( font );
+            QCOMPARE( grid.textWidth( font, text ), metrics.width( text ) );
+            QCOMPARE( grid.textHeight( font ), metrics.height() );
+        }
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::TestLabelGrid )
+
+#include "TestLabelGrid.moc"
@@ -0,0 +1,158 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include "GeoDataDocument.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataTreeModel.h"
+#include "MarbleModel.h"
+#include "MarblePlacemarkModel.h"
+#include "PlacemarkLayout.h"
+#include "StyleBuilder.h"
+#include "ViewportParams.h"
+#include "VisiblePlacemark.h"
+#include "TestUtils.h"
+
+#include <QItemSelectionModel>
+#include <QSignalSpy>
+
+namespace Marble
+{
+
+class TestPlacemarkLayout : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void keepsLabelPositions();
+    void completesInterruptedLayout();
+
+ private:
+    /**
+     * Returns the label rectangles of @p marks relative to their symbols.
+     */
+    static QHash<const GeoDataPlacemark *, QRectF> labelRects( const QVector<VisiblePlacemark *> &marks );
+
+    static GeoDataPlacemark *createPlacemark( const QString &name, qreal lon, qreal lat );
+};
+
+QHash<const GeoDataPlacemark *, QRectF> TestPlacemarkLayout::labelRects( const QVector<VisiblePlacemark *> &marks )
+{
+    QHash<const GeoDataPlacemark *, QRectF> rects;
+    foreach ( const VisiblePlacemark *mark, marks ) {
+        rects.insert( mark->placemark(), mark->labelRect().translated( -mark->symbolPosition() ) );
+    }
+
+    return rects;
+}
+
+GeoDataPlacemark *TestPlacemarkLayout::createPlacemark( const QString &name, qreal lon, qreal lat )
+{
+    GeoDataPlacemark *placemark = new GeoDataPlacemark( name );
+    placemark->setCoordinate( lon, lat, 0, GeoDataCoordinates::Degree );
+
+    return placemark;
+}
+
+void TestPlacemarkLayout::keepsLabelPositions()
+{
+    MarbleModel model;
+    StyleBuilder styleBuilder;
+
+    // The label of the city blocks the preferred label position of the
+    // place right next to it, which is laid out after the city.
+    GeoDataPlacemark *const city = createPlacemark( "City", 10.07, 50.0 );
+    city->setVisualCategory( GeoDataPlacemark::SmallCity );
+    city->setPopularity( 1000 );
+    GeoDataPlacemark *const place = createPlacemark( "Place", 10.0, 50.0 );
+
+    GeoDataDocument *document = new GeoDataDocument;
+    document->append( city );
+    document->append( place );
+    model.treeModel()->addDocument( document );
+
+    PlacemarkLayout layout( model.placemarkModel(), model.placemarkSelectionModel(), model.clock(), &styleBuilder );
+    layout.setShowCities( true );
+
+    ViewportParams viewport( Spherical, 10 * DEG2RAD, 50 * DEG2RAD, 20000, QSize( 800, 600 ) );
+
+    const QHash<const GeoDataPlacemark *, QRectF> first = labelRects( layout.generateLayout( &viewport ) );
+    QVERIFY( first.contains( city ) );
+    QVERIFY( first.contains( place ) );
+
+    // Without the city, a new layout would move the label of the place to
+    // its preferred position. The layout of the next frame keeps it.
+    layout.setShowCities( false );
+    {
+        PlacemarkLayout freshLayout( model.placemarkModel(), model.placemarkSelectionModel(), model.clock(), &styleBuilder );
+        const QHash<const GeoDataPlacemark *, QRectF> fresh = labelRects( freshLayout.generateLayout( &viewport ) );
+        QVERIFY( fresh.contains( place ) );
+        QVERIFY( fresh.value( place ) != first.value( place ) );
+    }
+
+    const QHash<const GeoDataPlacemark *, QRectF> second = labelRects( layout.generateLayout( &viewport ) );
+    QVERIFY( !second.contains( city ) );
+    QCOMPARE( second.value( place ), first.value( place ) );
+
+    // Selecting the place resets the styles, but neither moves nor resizes its label
+    for ( int row = 0; row < model.placemarkModel()->rowCount(); ++row ) {
+        const QModelIndex index = model.placemarkModel()->index( row, 0 );
+        if ( qvariant_cast<GeoDataObject*>( index.data( MarblePlacemarkModel::ObjectPointerRole ) ) == place ) {
+            model.placemarkSelectionModel()->select( index, QItemSelectionModel::ClearAndSelect );
+        }
+    }
+    QVERIFY( model.placemarkSelectionModel()->hasSelection() );
+
+    const QHash<const GeoDataPlacemark *, QRectF> third = labelRects( layout.generateLayout( &viewport ) );
+    QCOMPARE( third.value( place ), first.value( place ) );
+}
+
+void TestPlacemarkLayout::completesInterruptedLayout()
+{
+    MarbleModel model;
+    StyleBuilder styleBuilder;
+
+    // far more placemarks than can be laid out within the time budget of a frame
+    GeoDataDocument *document = new GeoDataDocument;
+    for ( int i = 0; i < 20000; ++i ) {
+        document->append( createPlacemark( QString( "Place %1" ).arg( i ), 5.0 + ( i % 200 ) * 0.05, 45.0 + ( i / 200 ) * 0.1 ) );
+    }
+    model.treeModel()->addDocument( document );
+
+    PlacemarkLayout layout( model.placemarkModel(), model.placemarkSelectionModel(), model.clock(), &styleBuilder );
+    ViewportParams viewport( Spherical, 10 * DEG2RAD, 50 * DEG2RAD, 20000, QSize( 4000, 4000 ) );
+
+    layout.setViewContext( Animation );
+    const QHash<const GeoDataPlacemark *, QRectF> animated = labelRects( layout.generateLayout( &viewport ) );
+    if ( !layout.runtimeTrace().contains( QLatin1String( "interrupted" ) ) ) {
+        QSKIP( "The layout completed within the time budget of an animation frame" );
+    }
+
+    // coming to rest asks for a repaint to complete the layout
+    QSignalSpy repaintSpy( &layout, SIGNAL(repaintNeeded()) );
+    layout.setViewContext( Still );
+    QCOMPARE( repaintSpy.count(), 1 );
+
+    const QHash<const GeoDataPlacemark *, QRectF> still = labelRects( layout.generateLayout( &viewport ) );
+    QVERIFY( !layout.runtimeTrace().contains( QLatin1String( "interrupted" ) ) );
+    QVERIFY( still.size() > animated.size() );
+
+    // the placemarks of the interrupted layout stay in place
+    QHash<const GeoDataPlacemark *, QRectF>::const_iterator it = animated.constBegin();
+    for ( ; it != animated.constEnd(); ++it ) {
+        QVERIFY( still.contains( it.key() ) );
+        QCOMPARE( still.value( it.key() ), it.value() );
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::TestPlacemarkLayout )
+
+#include "TestPlacemarkLayout.moc"
@@ -0,0 +1,146 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include "GeoDataLineString.h"
+#include "ProjectedGeometryCache.h"
+#include "ViewportParams.h"
+#include "TestUtils.h"
+
+#include <QPolygonF>
+
+namespace Marble
+{
+
+class TestProjectedGeometryCache : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void matchesProjection_data();
+    void matchesProjection();
+
+ private:
+    static void compare( const QVector<QPolygonF*> &actual, const QVector<QPolygonF*> &expected );
+};
+
+void TestProjectedGeometryCache::compare( const QVector<QPolygonF*> &actual, const QVector<QPolygonF*> &expected )
+{
+    QCOMPARE( actual.size(), expected.size() );
+    for ( int i = 0; i < actual.size(); ++i ) {
+        QCOMPARE( actual.at( i )->size(), expected.at( i )->size() );
+        for ( int j = 0; j < actual.at( i )->size(); ++j ) {
+            QFUZZYCOMPARE( actual.at( i )->at( j ).x(), expected.at( i )->at( j ).x(), 0.0001 );
+            QFUZZYCOMPARE( actual.at( i )->at( j ).y(), expected.at( i )->at( j ).y(), 0.0001 );
+        }
+    }
+}
+
+void TestProjectedGeometryCache::matchesProjection_data()
+{
+    QTest::addColumn<int>( "projection" );
+
+    addNamedRow("equirectangular") << int( Equirectangular );
+    addNamedRow("mercator") << int( Mercator );
+    addNamedRow("spherical") << int( Spherical );
+}
+
+void TestProjectedGeometryCache::matchesProjection()
+{
+    QFETCH( int, projection );
+
+    GeoDataLineString lineString( Tessellate );
+    lineString << GeoDataCoordinates( 5, 45, 0, GeoDataCoordinates::Degree )
+               << GeoDataCoordinates( 10, 50, 0, GeoDataCoordinates::Degree )
+               << GeoDataCoordinates( 20, 48, 0, GeoDataCoordinates::Degree );
+
+    ViewportParams viewport( Projection( projection ), 10 * DEG2RAD, 48 * DEG2RAD, 2000, QSize( 800, 600 ) );
+    ProjectedGeometryCache cache;
+
+    // the first lookup projects, the second one hits the cache
+    for ( int i = 0; i < 2; ++i ) {
+        QVector<QPolygonF*> cached;
+        cache.screenCoordinates( lineString, &viewport, cached );
+        QVector<QPolygonF*> expected;
+        viewport.screenCoordinates( lineString, expected );
+        compare( cached, expected );
+        qDeleteAll( cached );
+        qDeleteAll( expected );
+    }
+
+    // panning translates the cached polygons of cylindrical projections
+    viewport.centerOn( 12 * DEG2RAD, 47 * DEG2RAD );
+    {
+        QVector<QPolygonF*> cached;
+        cache.screenCoordinates( lineString, &viewport, cached );
+        QVector<QPolygonF*> expected;
+        viewport.screenCoordinates( lineString, expected );
+        compare( cached, expected );
+        qDeleteAll( cached );
+        qDeleteAll( expected );
+    }
+
+    // changed nodes are projected again
+    lineString << GeoDataCoordinates( 25, 46, 0, GeoDataCoordinates::Degree );
+    {
+        QVector<QPolygonF*> cached;
+        cache.screenCoordinates( lineString, &viewport, cached );
+        QVector<QPolygonF*> expected;
+        viewport.screenCoordinates( lineString, expected );
+        compare( cached, expected );
+        qDeleteAll( cached );
+        qDeleteAll( expected );
+    }
+
+    // so are nodes modified in place, keeping the node count and the bounding box
+    lineString[2] = GeoDataCoordinates( 15, 47, 0, GeoDataCoordinates::Degree );
+    {
+        QVector<QPolygonF*> cached;
+        cache.screenCoordinates( lineString, &viewport, cached );
+        QVector<QPolygonF*> expected;
+        viewport.screenCoordinates( lineString, expected );
+        compare( cached, expected );
+        qDeleteAll( cached );
+        qDeleteAll( expected );
+    }
+
+    ( lineString.begin() + 2 )->setLatitude( 46.5, GeoDataCoordinates::Degree );
+    {
+        QVector<QPolygonF*> cached;
+        cache.screenCoordinates( lineString, &viewport, cached );
+        QVector<QPolygonF*> expected;
+        viewport.screenCoordinates( lineString, expected );
+        compare( cached, expected );
+        qDeleteAll( cached );
+        qDeleteAll( expected );
+    }
+
+    // and line strings assigned other nodes with the same node count and bounding box
+    GeoDataLineString other( Tessellate );
+    other << GeoDataCoordinates( 5, 45, 0, GeoDataCoordinates::Degree )
+          << GeoDataCoordinates( 10, 50, 0, GeoDataCoordinates::Degree )
+          << GeoDataCoordinates( 12, 47, 0, GeoDataCoordinates::Degree )
+          << GeoDataCoordinates( 25, 46, 0, GeoDataCoordinates::Degree );
+    lineString = other;
+    {
+        QVector<QPolygonF*> cached;
+        cache.screenCoordinates( lineString, &viewport, cached );
+        QVector<QPolygonF*> expected;
+        viewport.screenCoordinates( lineString, expected );
+        compare( cached, expected );
+        qDeleteAll( cached );
+        qDeleteAll( expected );
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::TestProjectedGeometryCache )
+
+#include "TestProjectedGeometryCache.moc"
@@ -0,0 +1,101 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include "GeoPainter.h"
+#include "MarbleDirs.h"
+#include "MarbleMap.h"
+#include "MarbleModel.h"
+#include "TestUtils.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QPixmap>
+#include <QThreadPool>
+
+namespace Marble
+{
+
+class TexturePanningBenchmark : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void initTestCase();
+
+    void panColdCache_data();
+    void panColdCache();
+};
+
+void TexturePanningBenchmark::initTestCase()
+{
+    MarbleDirs::setMarbleDataPath( DATA_PATH );
+    MarbleDirs::setMarblePluginPath( PLUGIN_PATH );
+}
+
+void TexturePanningBenchmark::panColdCache_data()
+{
+    QTest::addColumn<QString>( "mapThemeId" );
+    QTest::addColumn<int>( "projection" );
+
+    addNamedRow("srtm spherical") << "earth/srtm/srtm.dgml" << int( Spherical );
+    addNamedRow("srtm equirectangular") << "earth/srtm/srtm.dgml" << int( Equirectangular );
+    addNamedRow("bluemarble spherical") << "earth/bluemarble/bluemarble.dgml" << int( Spherical );
+}
+
+void TexturePanningBenchmark::panColdCache()
+{
+    QFETCH( QString, mapThemeId );
+    QFETCH( int, projection );
+
+    // a fresh model and map for every run, so no decoded tile is in memory yet
+    MarbleModel model;
+    MarbleMap map( &model );
+    map.setMapThemeId( mapThemeId );
+    map.setProjection( static_cast<Projection>( projection ) );
+    map.setSize( 800, 600 );
+    map.setRadius( 2000 );
+    map.centerOn( 0.0, 0.0 );
+
+    QPixmap paintDevice( map.size() );
+
+    const int frames = 200;
+    qint64 totalTime = 0;
+    qint64 maximumTime = 0;
+
+    for ( int i = 0; i < frames; ++i ) {
+        QElapsedTimer timer;
+        timer.start();
+
+        map.rotateBy( 1.5, 0.0 );
+        GeoPainter painter( &paintDevice, map.viewport(), map.mapQuality() );
+        map.paint( painter, QRect() );
+
+        const qint64 frameTime = timer.elapsed();
+        totalTime += frameTime;
+        maximumTime = qMax( maximumTime, frameTime );
+
+        // deliver decoded tiles and downloads in between frames as a running application would
+        QCoreApplication::processEvents();
+    }
+
+    qDebug() << mapThemeId << "frames:" << frames
+             << "average frame time:" << qreal( totalTime ) / frames << "ms"
+             << "maximum frame time:" << maximumTime << "ms";
+
+    QTest::setBenchmarkResult( qreal( totalTime ) / frames, QTest::WalltimeMilliseconds );
+
+    QThreadPool::globalInstance()->waitForDone();  // wait for all runners to terminate
+}
+
+}
+
+QTEST_MAIN( Marble::TexturePanningBenchmark )
+
+#include "TexturePanningBenchmark.moc"
@@ -0,0 +1,279 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include "TilePackArchive.h"
+#include "TestUtils.h"
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+namespace Marble
+{
+
+class TilePackArchiveTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void parseFileName_data();
+    void parseFileName();
+
+    void insertTile();
+    void growIndex();
+    void removeTiles();
+    void removeOldestTiles();
+    void compactAfterInsertion();
+    void reopen();
+
+private:
+    static bool copyArchive( const QString &source, const QString &destination );
+};
+
+void TilePackArchiveTest::parseFileName_data()
+{
+    QTest::addColumn<QString>( "fileName" );
+    QTest::addColumn<bool>( "valid" );
+    QTest::addColumn<QString>( "directory" );
+    QTest::addColumn<int>( "level" );
+    QTest::addColumn<int>( "x" );
+    QTest::addColumn<int>( "y" );
+
+    addNamedRow("osm layout") << "/cache/maps/earth/openstreetmap/12/2200/1343.png" << true << "/cache/maps/earth/openstreetmap" << 12 << 2200 << 1343;
+    addNamedRow("marble layout") << "/cache/maps/earth/srtm/3/000005/000005_000007.jpg" << true << "/cache/maps/earth/srtm" << 3 << 7 << 5;
+    addNamedRow("relative") << "maps/earth/osm/0/0/0.png" << true << "maps/earth/osm" << 0 << 0 << 0;
+    addNamedRow("no level") << "/cache/maps/earth/osm/legend/0/0.png" << false << "" << 0 << 0 << 0;
+    addNamedRow("too short") << "0/0.png" << false << "" << 0 << 0 << 0;
+}
+
+void TilePackArchiveTest::parseFileName()
+{
+    QFETCH( QString, fileName );
+    QFETCH( bool, valid );
+    QFETCH( QString, directory );
+    QFETCH( int, level );
+    QFETCH( int, x );
+    QFETCH( int, y );
+
+    QString parsedDirectory;
+    TilePackArchive::Key key;
+    QCOMPARE( TilePackArchive::parseFileName( fileName, parsedDirectory, key ), valid );
+    if ( valid ) {
+        QCOMPARE( parsedDirectory, directory );
+        QCOMPARE( int( key.level ), level );
+        QCOMPARE( int( key.x ), x );
+        QCOMPARE( int( key.y ), y );
+    }
+}
+
+void TilePackArchiveTest::insertTile()
+{
+    QTemporaryDir directory;
+    QVERIFY( directory.isValid() );
+
+    QVERIFY( TilePackArchive::find( directory.path() ) == 0 );
+
+    TilePackArchive *const archive = TilePackArchive::create( directory.path() );
+    QVERIFY( archive != 0 );
+    QCOMPARE( TilePackArchive::find( directory.path() ), archive );
+    QCOMPARE( archive->count(), 0 );
+
+    const TilePackArchive::Key key = { 5, 17, 11 };
+    const TilePackArchive::Key otherKey = { 5, 11, 17 };
+    QVERIFY( !archive->contains( key ) );
+
+    const QDateTime lastModified = QDateTime::fromMSecsSinceEpoch( Q_INT64_C( 1450000000000 ), Qt::UTC );
+    QVERIFY( archive->insertTile( key, QByteArray( "first" ), lastModified ) );
+    QVERIFY( archive->contains( key ) );
+    QVERIFY( !archive->contains( otherKey ) );
+    QCOMPARE( archive->tileData( key ), QByteArray( "first" ) );
+    QCOMPARE( archive->lastModified( key ), lastModified );
+
+    // replacing a tile keeps the count
+    QVERIFY( archive->insertTile( key, QByteArray( "second" ) ) );
+    QCOMPARE( archive->count(), 1 );
+    QCOMPARE( archive->tileData( key ), QByteArray( "second" ) );
+}
+
+void TilePackArchiveTest::growIndex()
+{
+    QTemporaryDir directory;
+    QVERIFY( directory.isValid() );
+
+    TilePackArchive *const archive = TilePackArchive::create( directory.path() );
+    QVERIFY( archive != 0 );
+
+    const int count = 10000;
+    for ( int i = 0; i < count; ++i ) {
+        const TilePackArchive::Key key = { 14, quint32( i % 100 ), quint32( i / 100 ) };
+        QVERIFY( archive->insertTile( key, QByteArray::number( i ) ) );
+    }
+
+    QCOMPARE( archive->count(), count );
+    for ( int i = 0; i < count; ++i ) {
+        const TilePackArchive::Key key = { 14, quint32( i % 100 ), quint32( i / 100 ) };
+        QCOMPARE( archive->tileData( key ), QByteArray::number( i ) );
+    }
+}
+
+void TilePackArchiveTest::removeTiles()
+{
+    QTemporaryDir directory;
+    QVERIFY( directory.isValid() );
+
+    TilePackArchive *const archive = TilePackArchive::create( directory.path() );
+    QVERIFY( archive != 0 );
+
+    for ( quint32 level = 0; level < 8; ++level ) {
+        const TilePackArchive::Key key = { level, 0, 0 };
+        QVERIFY( archive->insertTile( key, QByteArray( "tile" ) ) );
+    }
+
+    QCOMPARE( archive->removeTiles( 5 ), qint64( 3 * 4 ) );
+    QCOMPARE( archive->count(), 5 );
+
+    const TilePackArchive::Key baseKey = { 4, 0, 0 };
+    const TilePackArchive::Key removedKey = { 5, 0, 0 };
+    QVERIFY( archive->contains( baseKey ) );
+    QVERIFY( !archive->contains( removedKey ) );
+    QCOMPARE( archive->tileData( baseKey ), QByteArray( "tile" ) );
+    QCOMPARE( archive->size(), qint64( 5 * 4 ) );
+
+    // the old pack file is gone after compacting
+    QCOMPARE( QDir( directory.path() ).entryList( QStringList() << "tiles-*.pack", QDir::Files ).size(), 1 );
+}
+
+void TilePackArchiveTest::removeOldestTiles()
+{
+    QTemporaryDir directory;
+    QVERIFY( directory.isValid() );
+
+    TilePackArchive *const archive = TilePackArchive::create( directory.path() );
+    QVERIFY( archive != 0 );
+
+    const QDateTime lastModified = QDateTime::fromMSecsSinceEpoch( Q_INT64_C( 1450000000000 ), Qt::UTC );
+    for ( quint32 x = 0; x < 10; ++x ) {
+        const TilePackArchive::Key key = { 10, x, 0 };
+        QVERIFY( archive->insertTile( key, QByteArray( 100, 'a' + x ), lastModified.addSecs( 10 - x ) ) );
+    }
+    const TilePackArchive::Key baseKey = { 2, 0, 0 };
+    QVERIFY( archive->insertTile( baseKey, QByteArray( 100, 'b' ), lastModified ) );
+
+    // replaced data is unreferenced until the pack files get compacted
+    const TilePackArchive::Key replacedKey = { 10, 0, 0 };
+    QVERIFY( archive->insertTile( replacedKey, QByteArray( 100, 'r' ), lastModified.addSecs( 100 ) ) );
+    QCOMPARE( archive->size(), qint64( 12 * 100 ) );
+
+    // the base tile is older, but below the minimum level
+    QCOMPARE( archive->removeOldestTiles( 250, 5 ), qint64( 100 + 3 * 100 ) );
+    QCOMPARE( archive->count(), 8 );
+    QCOMPARE( archive->size(), qint64( 8 * 100 ) );
+    QCOMPARE( archive->tileData( baseKey ), QByteArray( 100, 'b' ) );
+    QCOMPARE( archive->tileData( replacedKey ), QByteArray( 100, 'r' ) );
+    for ( quint32 x = 1; x < 10; ++x ) {
+        const TilePackArchive::Key key = { 10, x, 0 };
+        QCOMPARE( archive->contains( key ), x < 7 );
+    }
+
+    const TilePackArchive::Key newKey = { 10, 20, 0 };
+    QVERIFY( archive->insertTile( newKey, QByteArray( "new" ) ) );
+    QCOMPARE( archive->tileData( newKey ), QByteArray( "new" ) );
+}
+
+void TilePackArchiveTest::compactAfterInsertion()
+{
+    QTemporaryDir directory;
+    QVERIFY( directory.isValid() );
+
+    TilePackArchive *const archive = TilePackArchive::create( directory.path() );
+    QVERIFY( archive != 0 );
+
+    // replacing a tile twice leaves more unreferenced data than is in use
+    const int tileSize = 17 * 1024 * 1024;
+    const TilePackArchive::Key key = { 3, 1, 2 };
+    const TilePackArchive::Key otherKey = { 3, 2, 1 };
+    QVERIFY( archive->insertTile( otherKey, QByteArray( "other" ) ) );
+    QVERIFY( archive->insertTile( key, QByteArray( tileSize, 'a' ) ) );
+    QVERIFY( archive->insertTile( key, QByteArray( tileSize, 'b' ) ) );
+    QVERIFY( archive->insertTile( key, QByteArray( tileSize, 'c' ) ) );
+
+    // the pack files are compacted in the background, reading goes on meanwhile
+    QCOMPARE( archive->tileData( otherKey ), QByteArray( "other" ) );
+    QTRY_COMPARE( archive->size(), qint64( tileSize + 5 ) );
+    QCOMPARE( archive->count(), 2 );
+    QCOMPARE( archive->tileData( key ), QByteArray( tileSize, 'c' ) );
+    QCOMPARE( archive->tileData( otherKey ), QByteArray( "other" ) );
+    QCOMPARE( QDir( directory.path() ).entryList( QStringList() << "tiles-*.pack", QDir::Files ).size(), 1 );
+}
+
+void TilePackArchiveTest::reopen()
+{
+    QTemporaryDir directory;
+    QVERIFY( directory.isValid() );
+
+    TilePackArchive *const archive = TilePackArchive::create( directory.path() );
+    QVERIFY( archive != 0 );
+
+    // enough tiles to grow the index, some of them on levels removed below
+    const QDateTime lastModified = QDateTime::fromMSecsSinceEpoch( Q_INT64_C( 1450000000000 ), Qt::UTC );
+    const int count = 5000;
+    for ( int i = 0; i < count; ++i ) {
+        const TilePackArchive::Key key = { quint32( 10 + i % 2 ), quint32( i % 100 ), quint32( i / 100 ) };
+        QVERIFY( archive->insertTile( key, QByteArray::number( i ), lastModified ) );
+    }
+    QVERIFY( archive->removeTiles( 11 ) > 0 );
+
+    // archives stay open per directory, so a copy of the files is opened instead
+    QTemporaryDir copy;
+    QVERIFY( copy.isValid() );
+    QVERIFY( copyArchive( directory.path(), copy.path() ) );
+
+    TilePackArchive *const reopened = TilePackArchive::find( copy.path() );
+    QVERIFY( reopened != 0 );
+    QVERIFY( reopened != archive );
+    QCOMPARE( reopened->count(), count / 2 );
+    QCOMPARE( reopened->size(), archive->size() );
+    for ( int i = 0; i < count; ++i ) {
+        const TilePackArchive::Key key = { quint32( 10 + i % 2 ), quint32( i % 100 ), quint32( i / 100 ) };
+        QCOMPARE( reopened->contains( key ), i % 2 == 0 );
+        if ( i % 2 == 0 ) {
+            QCOMPARE( reopened->tileData( key ), QByteArray::number( i ) );
+            QCOMPARE( reopened->lastModified( key ), lastModified );
+        }
+    }
+
+    // the reopened archive keeps working
+    const TilePackArchive::Key key = { 12, 1, 2 };
+    QVERIFY( reopened->insertTile( key, QByteArray( "appended" ) ) );
+    QCOMPARE( reopened->tileData( key ), QByteArray( "appended" ) );
+    QCOMPARE( reopened->count(), count / 2 + 1 );
+}
+
+bool TilePackArchiveTest::copyArchive( const QString &source, const QString &destination )
+{
+    const QStringList fileNames = QDir( source ).entryList( QStringList() << "tiles.idx" << "tiles-*.pack", QDir::Files );
+    if ( fileNames.size() < 2 ) {
+        return false;
+    }
+
+    foreach ( const QString &fileName, fileNames ) {
+        if ( !QFile::copy( source + QLatin1Char( '/' ) + fileName, destination + QLatin1Char( '/' ) + fileName ) ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+}
+
+QTEST_MAIN( Marble::TilePackArchiveTest )
+
+#include "TilePackArchiveTest.moc"
@@ -0,0 +1,133 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2016      agent <agent@local>
+//
+
+#include "TilePackArchive.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFileInfo>
+#include <QFile>
+#include <QDir>
+#include <QDirIterator>
+#include <QDebug>
+#include <QThreadPool>
+
+using namespace Marble;
+
+bool importTiles(const QString &themeDirectory, bool removeFiles, bool reportProgress, int &count)
+{
+    count = 0;
+    TilePackArchive *archive = TilePackArchive::create(themeDirectory);
+    if (!archive) {
+        qDebug() << "Cannot create a tile pack archive in" << themeDirectory;
+        return false;
+    }
+
+    QDir themeDir(themeDirectory);
+    foreach(const auto &levelInfo, themeDir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        bool isNumber;
+        levelInfo.baseName().toInt(&isNumber);
+        if (!isNumber) {
+            continue;
+        }
+
+        QDirIterator tileIter(levelInfo.absoluteFilePath(), QDir::Files, QDirIterator::Subdirectories);
+        while (tileIter.hasNext()) {
+            QString const fileName = tileIter.next();
+            QString const suffix = tileIter.fileInfo().suffix().toLower();
+            if (suffix != QLatin1String("png") && suffix != QLatin1String("jpg") &&
+                suffix != QLatin1String("jpeg") && suffix != QLatin1String("gif")) {
+                continue;
+            }
+
+            QString directory;
+            TilePackArchive::Key key;
+            if (!TilePackArchive::parseFileName(fileName, directory, key) ||
+                QDir(directory) != themeDir) {
+                continue;
+            }
+
+            QFile file(fileName);
+            if (!file.open(QFile::ReadOnly)) {
+                qDebug() << "Cannot read" << fileName << file.errorString();
+                continue;
+            }
+
+            // keep the download time, tile expiration is based on it
+            if (!archive->insertTile(key, file.readAll(), tileIter.fileInfo().lastModified())) {
+                qDebug() << "Cannot store" << fileName << archive->lastErrorMessage();
+                return false;
+            }
+            file.close();
+
+            if (removeFiles) {
+                file.remove();
+            }
+
+            ++count;
+            if (reportProgress && count % 1000 == 0) {
+                qDebug() << count << "tiles imported";
+            }
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("tilepack-import");
+    QCoreApplication::setApplicationVersion("0.1");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Move the tiles of a map theme's level/x/y tile cache into a tile pack archive. "
+                                     "Marble stores all further downloaded tiles of the theme in the archive.");
+    auto const helpOption = parser.addHelpOption();
+    auto const versionOption = parser.addVersionOption();
+    parser.addPositionalArgument("directory", "Tile cache directory of a map theme, e.g. ~/.local/share/marble/maps/earth/openstreetmap");
+
+    parser.addOptions({
+                          {{"k", "keep"}, "Keep the tile files after importing them"},
+                          {{"q", "quiet"}, "No progress report to stdout"},
+                      });
+
+    if (!parser.parse(QCoreApplication::arguments())) {
+        qDebug() << parser.errorText();
+        parser.showHelp(2);
+    } else if (parser.isSet(helpOption)) {
+        parser.showHelp(0);
+    } else if (parser.isSet(versionOption)) {
+        parser.showVersion();
+        return 0;
+    }
+
+    const QStringList positionalArguments = parser.positionalArguments();
+    if (positionalArguments.size() != 1) {
+        parser.showHelp(positionalArguments.size() == 0 ? 0 : 1);
+    }
+
+    QString const themeDirectory = QFileInfo(positionalArguments[0]).absoluteFilePath();
+    if (!QFileInfo(themeDirectory).isDir()) {
+        qDebug() << themeDirectory << "is not a directory";
+        parser.showHelp(3);
+    }
+
+    int count = 0;
+    bool const success = importTiles(themeDirectory, !parser.isSet("keep"), !parser.isSet("quiet"), count);
+    if (!parser.isSet("quiet")) {
+        qDebug() << count << "tiles imported into" << themeDirectory;
+    }
+
+    // a compaction of the archive may still be running
+    QThreadPool::globalInstance()->waitForDone();
+
+    return success ? 0 : 4;
+}